@@ -28,6 +28,9 @@ void usage(const char* name) {
 	          << " -o bool \t if true, use the old (<1.4) file format\n"
 	          << " -z bool \t if true, GS will try to start at r=zero\n"
 	          << " -k int  \t GS sleeping iterations \n"
+	          << " -l bool \t if true, reorder contacts for memory locality before solving with GS\n"
+	          << " -b bool \t if true, dataFile uses the memory-mapped binary format\n"
+	          << " -B file \t convert dataFile to the binary format, write it to file and exit\n"
 	          << std::endl ;
 
 }
@@ -42,6 +45,8 @@ int main( int argc, const char* argv[] )
 	double problemRegularization = 0. ;
 	bool staticPb = false ;
 	bool old = false ;
+	bool binary = false ;
+	const char* binaryOut = BOGUS_NULL_PTR(const char) ;
 
 	for( int i = 1 ; i < argc ; ++i )
 	{
@@ -108,6 +113,18 @@ int main( int argc, const char* argv[] )
 				if( ++i == argc ) break ;
 				options.tryZeroAsWell = (bool) std::atoi( argv[i] ) ;
 				break ;
+			case 'l':
+				if( ++i == argc ) break ;
+				options.gsReordering = (bool) std::atoi( argv[i] ) ;
+				break ;
+			case 'b':
+				if( ++i == argc ) break ;
+				binary = (bool) std::atoi( argv[i] ) ;
+				break ;
+			case 'B':
+				if( ++i == argc ) break ;
+				binaryOut = argv[i] ;
+				break ;
 			}
 		} else {
 			file = argv[i] ;
@@ -122,10 +139,19 @@ int main( int argc, const char* argv[] )
 	}
 
 
+	if( binaryOut )
+	{
+		if( bogus::MecheFrictionProblem::convertToBinaryFile( file, binaryOut, old ) )
+			return 0 ;
+
+		std::cerr << " Could not convert " << file << std::endl ;
+		return 1 ;
+	}
+
 	bogus::MecheFrictionProblem mfp ;
 
 	double * r = BOGUS_NULL_PTR(double) ;
-	if( mfp.fromFile( file, r, old ) )
+	if( binary ? mfp.fromBinaryFile( file, r ) : mfp.fromFile( file, r, old ) )
 	{
 
 		if( options.maxThreads > 1 )
@@ -0,0 +1,100 @@
+/*
+ * Any copyright is dedicated to the Public Domain.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef BOGUS_BENCH_REPORT_HPP
+#define BOGUS_BENCH_REPORT_HPP
+
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace bogus {
+namespace bench {
+
+//! Result of a single benchmark run
+struct Record
+{
+	std::string benchmark ;
+	std::string problem ;
+	//! Number of rows of blocks of the problem ( contacts for scenes )
+	unsigned size ;
+	//! Number of non-zero blocks of the main matrix
+	std::size_t nBlocks ;
+	int threads ;
+	//! Median and minimum wall-clock times over the repetitions, in seconds
+	double time ;
+	double timeMin ;
+	//! Effective memory bandwidth, in GB/s. Negative if not applicable
+	double gbps ;
+	//! Solver iterations. Negative if not applicable
+	int iterations ;
+	//! Final residual. Negative if not applicable
+	double residual ;
+
+	Record()
+		: size( 0 ), nBlocks( 0 ), threads( 1 ), time( 0 ), timeMin( 0 ),
+		  gbps( -1 ), iterations( -1 ), residual( -1 )
+	{}
+
+	//! Sets time and timeMin from the timings of each repetition
+	void setTimes( std::vector< double > times )
+	{
+		if( times.empty() ) return ;
+		std::sort( times.begin(), times.end() ) ;
+		time = times[ times.size() / 2 ] ;
+		timeMin = times.front() ;
+	}
+} ;
+
+//! Writes records as a JSON array, one object per line
+class JsonReport
+{
+public:
+	explicit JsonReport( std::ostream& out )
+		: m_out( out ), m_count( 0 )
+	{
+		m_out << "[" ;
+	}
+
+	~JsonReport()
+	{
+		m_out << "\n]" << std::endl ;
+	}
+
+	void add( const Record& r )
+	{
+		m_out << ( m_count++ ? ",\n" : "\n" ) << "  {" ;
+		m_out << "\"benchmark\": \"" << r.benchmark << "\", " ;
+		m_out << "\"problem\": \"" << r.problem << "\", " ;
+		m_out << "\"size\": " << r.size << ", " ;
+		m_out << "\"blocks\": " << r.nBlocks << ", " ;
+		m_out << "\"threads\": " << r.threads << ", " ;
+		m_out << "\"time\": " << r.time << ", " ;
+		m_out << "\"time_min\": " << r.timeMin << ", " ;
+		m_out << "\"gbps\": " ; optional( r.gbps ) ;
+		m_out << ", \"iterations\": " ; optional( r.iterations ) ;
+		m_out << ", \"residual\": " ; optional( r.residual ) ;
+		m_out << "}" ;
+		m_out.flush() ;
+	}
+
+private:
+	// Negative values mean not applicable
+	template < typename T >
+	void optional( T x )
+	{
+		if( x >= 0 ) m_out << x ;
+		else m_out << "null" ;
+	}
+
+	std::ostream& m_out ;
+	unsigned m_count ;
+} ;
+
+} //namespace bench
+} //namespace bogus
+
+#endif
@@ -0,0 +1,446 @@
+/*
+ * Any copyright is dedicated to the Public Domain.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include "Scenes.hpp"
+
+#include <bogus/Core/Block.impl.hpp>
+
+#include <Eigen/Geometry>
+
+#include <cmath>
+#include <random>
+
+namespace bogus {
+namespace bench {
+
+namespace {
+
+const double s_dt = 1.e-2 ;
+const double s_pi = 3.14159265358979323846 ;
+
+// Objects and contacts of a scene, before assembly of the primal problem
+struct Assembly
+{
+	struct Contact
+	{
+		int A, B ;
+		//! Columns are the normal and the two tangents, in world coordinates
+		Eigen::Matrix3d frame ;
+		//! Jacobians of the velocity of the contact point on each object, in world coordinates
+		Eigen::MatrixXd HA, HB ;
+	} ;
+
+	std::vector< unsigned > ndofs ;
+	std::vector< Eigen::MatrixXd > masses ;
+	std::vector< Eigen::VectorXd > freeVelocities ;
+	std::vector< Contact > contacts ;
+
+	unsigned addObject( const Eigen::MatrixXd& M, const Eigen::VectorXd& freeVel )
+	{
+		ndofs.push_back( M.rows() ) ;
+		masses.push_back( M ) ;
+		freeVelocities.push_back( freeVel ) ;
+		return masses.size() - 1 ;
+	}
+
+	//! Adds a contact between \p A and \p B ( -1 for the static environment ), with \p n pointing from \p B to \p A
+	void addContact( int A, int B, const Eigen::Vector3d& n,
+	                 const Eigen::MatrixXd& HA, const Eigen::MatrixXd& HB )
+	{
+		Contact c ;
+		c.A = A ;
+		c.B = B ;
+		c.frame.col(0) = n.normalized() ;
+		c.frame.col(1) = c.frame.col(0).unitOrthogonal() ;
+		c.frame.col(2) = c.frame.col(0).cross( c.frame.col(1) ) ;
+		c.HA = HA ;
+		c.HB = HB ;
+		contacts.push_back( c ) ;
+	}
+
+	void assemble( Scene& scene, std::mt19937& rng ) const ;
+} ;
+
+void Assembly::assemble( Scene& scene, std::mt19937& rng ) const
+{
+	typedef PrimalFrictionProblem< 3u > Primal ;
+	Primal& primal = scene.primal ;
+
+	const unsigned nObj = ndofs.size() ;
+	const unsigned n = contacts.size() ;
+
+	primal.M.reserve( nObj ) ;
+	primal.M.setRows( ndofs ) ;
+	primal.M.setCols( ndofs ) ;
+	for( unsigned i = 0 ; i < nObj ; ++i )
+	{
+		primal.M.insertBack( i, i ) = masses[i] ;
+	}
+	primal.M.finalize() ;
+
+	primal.E.reserve( n ) ;
+	primal.E.setRows( n ) ;
+	primal.E.setCols( n ) ;
+	for( unsigned i = 0 ; i < n ; ++i )
+	{
+		primal.E.insertBack( i, i ) = contacts[i].frame ;
+	}
+	primal.E.finalize() ;
+	primal.E.cacheTranspose() ;
+
+	primal.H.setRows( n ) ;
+	primal.H.setCols( ndofs ) ;
+
+	SparseBlockMatrixBuilder< Primal::HType > Hbuilder( 1 ) ;
+	Hbuilder.reserve( 2*n ) ;
+	for( unsigned i = 0 ; i < n ; ++i )
+	{
+		const Contact& c = contacts[i] ;
+		const Eigen::Matrix3d Et = c.frame.transpose() ;
+
+		if( c.B == -1 ) {
+			Hbuilder.insert( i, c.A ) = Et * c.HA ;
+		} else {
+			Hbuilder.insert( i, c.A ) =   Et * c.HA ;
+			Hbuilder.insert( i, c.B ) = - Et * c.HB ;
+		}
+	}
+	Hbuilder.finalize( primal.H ) ;
+
+	// M v + f = H^T r, with f = - M v_free
+	scene.f.resize( primal.M.rows() ) ;
+	for( unsigned i = 0 ; i < nObj ; ++i )
+	{
+		scene.f.segment( primal.M.rowOffsets()[i], ndofs[i] ) = - masses[i] * freeVelocities[i] ;
+	}
+
+	scene.w.setZero( 3*n ) ;
+
+	std::uniform_real_distribution< double > muDist( .3, .7 ) ;
+	scene.mu.resize( n ) ;
+	for( unsigned i = 0 ; i < n ; ++i )
+	{
+		scene.mu[i] = muDist( rng ) ;
+	}
+
+	primal.f  = scene.f.data() ;
+	primal.w  = scene.w.data() ;
+	primal.mu = scene.mu.data() ;
+
+	primal.computeMInv() ;
+}
+
+Eigen::Matrix3d skew( const Eigen::Vector3d& r )
+{
+	Eigen::Matrix3d S ;
+	S <<     0, -r[2],  r[1],
+	      r[2],     0, -r[0],
+	     -r[1],  r[0],     0 ;
+	return S ;
+}
+
+const Eigen::Vector3d& gravity()
+{
+	static const Eigen::Vector3d g( 0, 0, -9.81 ) ;
+	return g ;
+}
+
+// Velocity jacobian of the point at offset r from the center of a rigid body
+Eigen::MatrixXd rigidJacobian( const Eigen::Vector3d& r )
+{
+	Eigen::MatrixXd J( 3, 6 ) ;
+	J.leftCols< 3 >().setIdentity() ;
+	J.rightCols< 3 >() = - skew( r ) ;
+	return J ;
+}
+
+unsigned addRigidBody( Assembly& assembly, double mass, const Eigen::Vector3d& inertia )
+{
+	Eigen::VectorXd diag( 6 ) ;
+	diag << mass, mass, mass, inertia ;
+
+	Eigen::VectorXd freeVel = Eigen::VectorXd::Zero( 6 ) ;
+	freeVel.head< 3 >() = s_dt * gravity() ;
+
+	return assembly.addObject( Eigen::MatrixXd( diag.asDiagonal() ), freeVel ) ;
+}
+
+// Chain of nNodes particles linked by springs, optionally anchored at its first node
+unsigned addChain( Assembly& assembly, unsigned nNodes, double mass, double stiffness, bool anchored )
+{
+	const unsigned ndofs = 3 * nNodes ;
+	const double k = s_dt * s_dt * stiffness ;
+
+	Eigen::MatrixXd M = mass * Eigen::MatrixXd::Identity( ndofs, ndofs ) ;
+	for( unsigned j = 0 ; j+1 < nNodes ; ++j )
+	{
+		for( unsigned d = 0 ; d < 3 ; ++d )
+		{
+			const unsigned a = 3*j + d, b = 3*(j+1) + d ;
+			M( a, a ) += k ;
+			M( b, b ) += k ;
+			M( a, b ) -= k ;
+			M( b, a ) -= k ;
+		}
+	}
+	if( anchored ) {
+		M.diagonal().head< 3 >().array() += k ;
+	}
+
+	Eigen::VectorXd freeVel( ndofs ) ;
+	for( unsigned j = 0 ; j < nNodes ; ++j )
+	{
+		freeVel.segment< 3 >( 3*j ) = s_dt * gravity() ;
+	}
+
+	return assembly.addObject( M, freeVel ) ;
+}
+
+// Velocity jacobian of a node of a chain
+Eigen::MatrixXd nodeJacobian( unsigned nNodes, unsigned node )
+{
+	Eigen::MatrixXd J = Eigen::MatrixXd::Zero( 3, 3*nNodes ) ;
+	J.block< 3, 3 >( 0, 3*node ).setIdentity() ;
+	return J ;
+}
+
+} //namespace
+
+void makeGranularColumn( Scene& scene, unsigned n, unsigned seed )
+{
+	scene.name = "granular" ;
+
+	std::mt19937 rng( seed ) ;
+	std::uniform_real_distribution< double > jitter( -.05, .05 ) ;
+	std::uniform_real_distribution< double > density( .5, 1.5 ) ;
+
+	const double R = .5 ;
+	const unsigned nx = n, ny = n, nz = 4*n ;
+
+	Assembly assembly ;
+	std::vector< Eigen::Vector3d > pos ;
+
+	for( unsigned k = 0 ; k < nz ; ++k )
+		for( unsigned j = 0 ; j < ny ; ++j )
+			for( unsigned i = 0 ; i < nx ; ++i )
+			{
+				const double m = density( rng ) * 4. / 3. * s_pi * R * R * R ;
+				addRigidBody( assembly, m, Eigen::Vector3d::Constant( .4 * m * R * R ) ) ;
+				pos.push_back( Eigen::Vector3d( 2*R*i + jitter( rng ), 2*R*j + jitter( rng ), R + 2*R*k ) ) ;
+			}
+
+	const Eigen::Vector3d up( 0, 0, 1 ) ;
+
+	for( unsigned k = 0 ; k < nz ; ++k )
+		for( unsigned j = 0 ; j < ny ; ++j )
+			for( unsigned i = 0 ; i < nx ; ++i )
+			{
+				const int A = i + nx * ( j + ny * k ) ;
+
+				if( k == 0 ) {
+					assembly.addContact( A, -1, up, rigidJacobian( -R * up ), Eigen::MatrixXd() ) ;
+				}
+
+				// Lower lattice neighbours
+				const int neighbours[3] = {
+				    i > 0 ? A - 1 : -1,
+				    j > 0 ? A - (int) nx : -1,
+				    k > 0 ? A - (int) ( nx * ny ) : -1 } ;
+
+				for( unsigned d = 0 ; d < 3 ; ++d )
+				{
+					const int B = neighbours[d] ;
+					if( B < 0 ) continue ;
+
+					const Eigen::Vector3d normal = ( pos[A] - pos[B] ).normalized() ;
+					assembly.addContact( A, B, normal,
+					                     rigidJacobian( -R * normal ), rigidJacobian( R * normal ) ) ;
+				}
+			}
+
+	assembly.assemble( scene, rng ) ;
+}
+
+void makeBoxStack( Scene& scene, unsigned n, unsigned seed )
+{
+	scene.name = "boxes" ;
+
+	std::mt19937 rng( seed ) ;
+	std::uniform_real_distribution< double > density( .5, 1.5 ) ;
+
+	// Box dimensions
+	const Eigen::Vector3d size( 2, 1, 1 ) ;
+	const Eigen::Vector3d up( 0, 0, 1 ) ;
+
+	Assembly assembly ;
+	std::vector< Eigen::Vector3d > centers ;
+	std::vector< unsigned > rowStart ;
+
+	for( unsigned k = 0 ; k < n ; ++k )
+	{
+		rowStart.push_back( centers.size() ) ;
+		const unsigned nBoxes = ( k % 2 ) ? n - 1 : n ;
+		for( unsigned i = 0 ; i < nBoxes ; ++i )
+		{
+			const double m = density( rng ) * size.prod() ;
+			const Eigen::Vector3d inertia = m / 12. * Eigen::Vector3d(
+			            size[1]*size[1] + size[2]*size[2],
+			            size[0]*size[0] + size[2]*size[2],
+			            size[0]*size[0] + size[1]*size[1] ) ;
+			addRigidBody( assembly, m, inertia ) ;
+			centers.push_back( Eigen::Vector3d( size[0] * ( i + .5 * ( k % 2 ) ), 0, size[2] * ( k + .5 ) ) ) ;
+		}
+	}
+	rowStart.push_back( centers.size() ) ;
+
+	for( unsigned k = 0 ; k < n ; ++k )
+	{
+		for( unsigned A = rowStart[k] ; A < rowStart[k+1] ; ++A )
+		{
+			const Eigen::Vector3d& cA = centers[A] ;
+
+			if( k == 0 ) {
+				for( unsigned c = 0 ; c < 4 ; ++c )
+				{
+					const Eigen::Vector3d r( ( c & 1 ? .5 : -.5 ) * size[0], ( c & 2 ? .5 : -.5 ) * size[1], -.5 * size[2] ) ;
+					assembly.addContact( A, -1, up, rigidJacobian( r ), Eigen::MatrixXd() ) ;
+				}
+				continue ;
+			}
+
+			for( unsigned B = rowStart[k-1] ; B < rowStart[k] ; ++B )
+			{
+				const Eigen::Vector3d& cB = centers[B] ;
+
+				// Overlap of the two boxes along x
+				const double xMin = std::max( cA[0], cB[0] ) - .5 * size[0] ;
+				const double xMax = std::min( cA[0], cB[0] ) + .5 * size[0] ;
+				if( xMax <= xMin ) continue ;
+
+				for( unsigned c = 0 ; c < 4 ; ++c )
+				{
+					const Eigen::Vector3d p( c & 1 ? xMax : xMin, ( c & 2 ? .5 : -.5 ) * size[1], cA[2] - .5 * size[2] ) ;
+					assembly.addContact( A, B, up, rigidJacobian( p - cA ), rigidJacobian( p - cB ) ) ;
+				}
+			}
+		}
+	}
+
+	assembly.assemble( scene, rng ) ;
+}
+
+void makeHair( Scene& scene, unsigned n, unsigned seed )
+{
+	scene.name = "hair" ;
+
+	std::mt19937 rng( seed ) ;
+	std::uniform_real_distribution< double > jitter( -.2, .2 ) ;
+	std::uniform_real_distribution< double > sway( -.5, .5 ) ;
+
+	const unsigned nNodes = 4*n ;
+	const double spacing = 1. ;
+
+	Assembly assembly ;
+	std::vector< Eigen::Vector3d > pos ;
+
+	for( unsigned j = 0 ; j < n ; ++j )
+		for( unsigned i = 0 ; i < n ; ++i )
+		{
+			const unsigned strand = addChain( assembly, nNodes, 1.e-2, 1.e2, true ) ;
+			for( unsigned l = 0 ; l < nNodes ; ++l )
+			{
+				// Random lateral motion, so that neighbouring strands collide
+				assembly.freeVelocities[ strand ].segment< 2 >( 3*l ) += Eigen::Vector2d( sway( rng ), sway( rng ) ) ;
+				pos.push_back( Eigen::Vector3d( spacing * i + jitter( rng ), spacing * j + jitter( rng ), - spacing * l ) ) ;
+			}
+		}
+
+	for( unsigned j = 0 ; j < n ; ++j )
+		for( unsigned i = 0 ; i < n ; ++i )
+		{
+			const int A = i + n * j ;
+			const int neighbours[2] = { i > 0 ? A - 1 : -1, j > 0 ? A - (int) n : -1 } ;
+
+			for( unsigned d = 0 ; d < 2 ; ++d )
+			{
+				const int B = neighbours[d] ;
+				if( B < 0 ) continue ;
+
+				// Strands touch at every other node
+				for( unsigned l = ( i + j ) % 2 ; l < nNodes ; l += 2 )
+				{
+					const Eigen::Vector3d normal = pos[ A*nNodes + l ] - pos[ B*nNodes + l ] ;
+					assembly.addContact( A, B, normal, nodeJacobian( nNodes, l ), nodeJacobian( nNodes, l ) ) ;
+				}
+			}
+		}
+
+	assembly.assemble( scene, rng ) ;
+}
+
+void makeCloth( Scene& scene, unsigned n, unsigned seed )
+{
+	scene.name = "cloth" ;
+
+	std::mt19937 rng( seed ) ;
+	std::uniform_real_distribution< double > jitter( -.1, .1 ) ;
+
+	const unsigned nLayers = 4 ;
+	const double spacing = 1. ;
+
+	Assembly assembly ;
+	std::vector< Eigen::Vector3d > pos ;
+
+	// Object ( j, k ) is the j-th row of the k-th layer
+	for( unsigned k = 0 ; k < nLayers ; ++k )
+		for( unsigned j = 0 ; j < n ; ++j )
+		{
+			const unsigned row = addChain( assembly, n, 1.e-2, 1.e3, false ) ;
+			for( unsigned i = 0 ; i < n ; ++i )
+			{
+				// Upper layers are pushed onto the lower ones
+				assembly.freeVelocities[ row ][ 3*i + 2 ] -= .1 * k ;
+				pos.push_back( Eigen::Vector3d( spacing * i + jitter( rng ), spacing * j + jitter( rng ), .5 * k ) ) ;
+			}
+		}
+
+	for( unsigned k = 1 ; k < nLayers ; ++k )
+		for( unsigned j = 0 ; j < n ; ++j )
+		{
+			const int A = j + n * k ;
+			const int B = j + n * ( k - 1 ) ;
+
+			for( unsigned i = 0 ; i < n ; ++i )
+			{
+				// Closest nodes of the layer below
+				for( unsigned di = 0 ; di < 2 && i + di < n ; ++di )
+				{
+					const Eigen::Vector3d normal = pos[ A*n + i ] - pos[ B*n + i + di ] ;
+					assembly.addContact( A, B, normal, nodeJacobian( n, i ), nodeJacobian( n, i + di ) ) ;
+				}
+			}
+		}
+
+	assembly.assemble( scene, rng ) ;
+}
+
+bool makeScene( const std::string& name, Scene& scene, unsigned n, unsigned seed )
+{
+	if( name == "granular" )
+		makeGranularColumn( scene, n, seed ) ;
+	else if( name == "boxes" )
+		makeBoxStack( scene, n, seed ) ;
+	else if( name == "hair" )
+		makeHair( scene, n, seed ) ;
+	else if( name == "cloth" )
+		makeCloth( scene, n, seed ) ;
+	else
+		return false ;
+
+	return true ;
+}
+
+} //namespace bench
+} //namespace bogus
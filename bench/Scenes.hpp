@@ -0,0 +1,120 @@
+/*
+ * Any copyright is dedicated to the Public Domain.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef BOGUS_BENCH_SCENES_HPP
+#define BOGUS_BENCH_SCENES_HPP
+
+#include <bogus/Interfaces/FrictionProblem.hpp>
+#include <bogus/Core/Block/SparseBlockMatrixBuilder.hpp>
+
+#include <Eigen/Core>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bogus {
+namespace bench {
+
+//! Synthetic friction problem, owning the data pointed to by its PrimalFrictionProblem
+struct Scene
+{
+	std::string name ;
+
+	PrimalFrictionProblem< 3u > primal ;
+
+	Eigen::VectorXd f ;
+	Eigen::VectorXd w ;
+	Eigen::VectorXd mu ;
+
+	unsigned nContacts() const { return primal.H.rowsOfBlocks() ; }
+	unsigned nObjects()  const { return primal.M.rowsOfBlocks() ; }
+
+	Scene() {}
+
+private:
+	// primal points to f, w and mu
+	Scene( const Scene& ) ;
+	Scene& operator=( const Scene& ) ;
+} ;
+
+//! Column of rigid spheres resting on the ground
+/*! The base of the column is \p n x \p n spheres wide, and 4 \p n spheres high.
+	Spheres have 6 degrees of freedom and touch their lattice neighbours */
+void makeGranularColumn( Scene& scene, unsigned n, unsigned seed ) ;
+
+//! Wall of rigid boxes in a running bond pattern, \p n boxes wide and \p n rows high
+/*! Each box-box or box-ground interface is represented by its 4 corner contacts */
+void makeBoxStack( Scene& scene, unsigned n, unsigned seed ) ;
+
+//! Bundle of \p n x \p n hair strands of 4 \p n nodes each
+/*! Each strand is a single object, with a banded mass-spring matrix ; contacts
+	link the nodes of neighbouring strands */
+void makeHair( Scene& scene, unsigned n, unsigned seed ) ;
+
+//! Cloth folded onto itself, made of 4 layers of \p n x \p n nodes
+/*! Each row of nodes is a single object, with a banded mass-spring matrix ; contacts
+	link each node with the closest nodes of the next layer */
+void makeCloth( Scene& scene, unsigned n, unsigned seed ) ;
+
+//! Builds the scene named \p name ( granular, boxes, hair or cloth ). Returns false if the name is unknown.
+bool makeScene( const std::string& name, Scene& scene, unsigned n, unsigned seed ) ;
+
+//! Fills \p A with a random symmetric positive definite matrix
+/*!
+	\p A will have \p nBlocks rows and columns of blocks of size \p blockSize.
+	Each off-diagonal block is present with probability \p density ; diagonal blocks
+	are made dominant so that \p A is positive definite.
+	\warning \p MatrixT should be a SYMMETRIC SparseBlockMatrix
+*/
+template < typename MatrixT >
+void makeRandomSPD( MatrixT& A, unsigned nBlocks, unsigned blockSize, double density, unsigned seed )
+{
+	typedef typename MatrixT::BlockType BlockType ;
+
+	std::mt19937 rng( seed ) ;
+	std::uniform_real_distribution< double > coeff( -1, 1 ) ;
+	std::geometric_distribution< unsigned > skip( std::min( 1., std::max( density, 1.e-12 ) ) ) ;
+
+	SparseBlockMatrixBuilder< MatrixT > builder( 1 ) ;
+	std::vector< double > offDiagNorms( nBlocks, 0. ) ;
+
+	for( unsigned i = 0 ; i < nBlocks ; ++i )
+	{
+		// Lower triangular part
+		for( unsigned j = skip( rng ) ; j < i ; j += 1 + skip( rng ) )
+		{
+			BlockType& block = builder.insert( i, j ) ;
+			block.resize( blockSize, blockSize ) ;
+			for( unsigned k = 0 ; k < blockSize*blockSize ; ++k )
+				block.data()[k] = coeff( rng ) ;
+
+			offDiagNorms[i] += block.norm() ;
+			offDiagNorms[j] += block.norm() ;
+		}
+	}
+
+	for( unsigned i = 0 ; i < nBlocks ; ++i )
+	{
+		BlockType& block = builder.insert( i, i ) ;
+		block.resize( blockSize, blockSize ) ;
+		for( unsigned k = 0 ; k < blockSize*blockSize ; ++k )
+			block.data()[k] = coeff( rng ) ;
+
+		const BlockType sym = .5 * ( block + block.transpose() ) ;
+		block = sym ;
+		block.diagonal().array() += offDiagNorms[i] + sym.norm() + 1. ;
+	}
+
+	A.setRows( nBlocks, blockSize ) ;
+	A.setCols( nBlocks, blockSize ) ;
+	builder.finalize( A ) ;
+}
+
+} //namespace bench
+} //namespace bogus
+
+#endif
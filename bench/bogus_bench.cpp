@@ -0,0 +1,669 @@
+/*
+ * Any copyright is dedicated to the Public Domain.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include "Scenes.hpp"
+#include "Report.hpp"
+
+#include <bogus/Core/Block.impl.hpp>
+#include <bogus/Core/BlockSolvers.impl.hpp>
+#include <bogus/Core/BlockSolvers/Coloring.impl.hpp>
+#include <bogus/Extra/SecondOrder.impl.hpp>
+#include <bogus/Interfaces/FrictionProblem.hpp>
+
+#include <bogus/Core/Utils/Executor.hpp>
+#include <bogus/Core/Utils/WorkStealingExecutor.hpp>
+#include <bogus/Core/Utils/Threads.hpp>
+#include <bogus/Core/Utils/Timer.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+using namespace bogus ;
+using namespace bogus::bench ;
+
+namespace {
+
+const char* const s_benchmarks[] = {
+    "spmv", "spmv_t", "spmv_H", "spmv_Ht", "spgemm", "spgemm_cached", "coloring_greedy", "coloring_jp",
+    "gs", "gs_async", "pg", "pgs", "admm", "local_soc", "local_soc_batch", "cg" } ;
+
+struct Options
+{
+	std::vector< std::string > problems ;
+	std::vector< std::string > benchmarks ;
+	std::vector< int > threads ;
+
+	//! Size parameter of the scene generators
+	unsigned scale ;
+	unsigned repetitions ;
+	unsigned seed ;
+
+	unsigned maxIters ;
+	double tolerance ;
+
+	bool workStealing ;
+
+	//! Random SPD matrix parameters
+	unsigned randomBlocks ;
+	unsigned blockSize ;
+	double density ;
+
+	Options()
+		: scale( 8 ), repetitions( 5 ), seed( 42 ),
+		  maxIters( 100 ), tolerance( 1.e-8 ), workStealing( false ),
+		  randomBlocks( 10000 ), blockSize( 3 ), density( 1.e-3 )
+	{
+		const char* const problemNames[] = { "granular", "boxes", "hair", "cloth", "random" } ;
+		problems.assign( problemNames, problemNames + 5 ) ;
+	}
+
+	bool enabled( const std::string& benchmark ) const
+	{
+		return benchmarks.empty() ||
+		        std::find( benchmarks.begin(), benchmarks.end(), benchmark ) != benchmarks.end() ;
+	}
+} ;
+
+std::vector< std::string > split( const char* list )
+{
+	std::vector< std::string > items ;
+	std::stringstream stream( list ) ;
+	std::string item ;
+	while( std::getline( stream, item, ',' ) )
+	{
+		if( !item.empty() ) items.push_back( item ) ;
+	}
+	return items ;
+}
+
+//! Records the last iteration reported by a solver callback
+struct IterationCounter
+{
+	unsigned iterations ;
+
+	IterationCounter() : iterations( 0 ) {}
+
+	void ack( unsigned iter, double )
+	{
+		iterations = iter ;
+	}
+} ;
+
+//! Runs \p func \p reps times and returns the duration of each run
+template < typename Func >
+std::vector< double > timeRuns( unsigned reps, Func func )
+{
+	std::vector< double > times ;
+	for( unsigned k = 0 ; k < reps ; ++k )
+	{
+		Timer timer ;
+		func() ;
+		times.push_back( timer.elapsed() ) ;
+	}
+	return times ;
+}
+
+//! Bytes moved by a matrix-vector product with \p A ( blocks, inner and outer indices, rhs and result )
+template < typename Derived >
+double spmvBytes( const SparseBlockMatrixBase< Derived >& A )
+{
+	typedef typename SparseBlockMatrixBase< Derived >::Index Index ;
+
+	double bytes = 0 ;
+	for( std::size_t i = 0 ; i < A.nBlocks() ; ++i )
+	{
+		bytes += A.block( i ).size() * sizeof( double ) ;
+	}
+	bytes += A.nBlocks() * sizeof( Index ) ;
+	bytes += ( A.majorIndex().outerSize() + 1 ) * sizeof( Index ) ;
+	bytes += ( A.rows() + A.cols() ) * sizeof( double ) ;
+	return bytes ;
+}
+
+//! Estimates the largest eigenvalue of the symmetric matrix \p A with a few power iterations
+template < typename Derived >
+double largestEigenvalue( const SparseBlockMatrixBase< Derived >& A )
+{
+	Eigen::VectorXd x = Eigen::VectorXd::Ones( A.rows() ).normalized() ;
+	Eigen::VectorXd y( A.rows() ) ;
+	double lambda = 0 ;
+	for( unsigned k = 0 ; k < 20 ; ++k )
+	{
+		A.template multiply< false >( x, y ) ;
+		lambda = x.dot( y ) ;
+		x = y.normalized() ;
+	}
+	return lambda ;
+}
+
+// Products are repeated to get measurable timings
+const unsigned s_productsPerRun = 10 ;
+
+template < typename Derived >
+void benchSpMV( const Options& opts, JsonReport& report, Record proto,
+                const SparseBlockMatrixBase< Derived >& A,
+                const char* name = "spmv", const char* transposeName = "spmv_t" )
+{
+	const Eigen::VectorXd x = Eigen::VectorXd::Ones( A.cols() ) ;
+	const Eigen::VectorXd xt = Eigen::VectorXd::Ones( A.rows() ) ;
+	Eigen::VectorXd y( A.rows() ), yt( A.cols() ) ;
+
+	const double bytes = spmvBytes( A ) ;
+
+	if( opts.enabled( name ) ) {
+		Record r = proto ;
+		r.benchmark = name ;
+		r.setTimes( timeRuns( opts.repetitions, [&]() {
+			for( unsigned k = 0 ; k < s_productsPerRun ; ++k )
+				A.template multiply< false >( x, y ) ;
+		} ) ) ;
+		r.time /= s_productsPerRun ;
+		r.timeMin /= s_productsPerRun ;
+		r.gbps = 1.e-9 * bytes / r.time ;
+		report.add( r ) ;
+	}
+
+	if( opts.enabled( transposeName ) ) {
+		Record r = proto ;
+		r.benchmark = transposeName ;
+		r.setTimes( timeRuns( opts.repetitions, [&]() {
+			for( unsigned k = 0 ; k < s_productsPerRun ; ++k )
+				A.template multiply< true >( xt, yt ) ;
+		} ) ) ;
+		r.time /= s_productsPerRun ;
+		r.timeMin /= s_productsPerRun ;
+		r.gbps = 1.e-9 * bytes / r.time ;
+		report.add( r ) ;
+	}
+}
+
+template < typename Derived >
+void benchColoring( const Options& opts, JsonReport& report, Record proto,
+                    const SparseBlockMatrixBase< Derived >& A )
+{
+	const char* const names[2] = { "coloring_greedy", "coloring_jp" } ;
+	const Coloring::Algorithm algorithms[2] = { Coloring::Greedy, Coloring::JonesPlassmann } ;
+
+	for( unsigned a = 0 ; a < 2 ; ++a )
+	{
+		if( !opts.enabled( names[a] ) ) continue ;
+
+		Coloring coloring ;
+		coloring.setAlgorithm( algorithms[a] ) ;
+		coloring.setBalancing( proto.threads ) ;
+
+		Record r = proto ;
+		r.benchmark = names[a] ;
+		r.setTimes( timeRuns( opts.repetitions, [&]() {
+			coloring.update( true, A ) ;
+		} ) ) ;
+		report.add( r ) ;
+	}
+}
+
+template < typename MatrixT >
+void benchCG( const Options& opts, JsonReport& report, Record proto, const MatrixT& A )
+{
+	if( !opts.enabled( "cg" ) ) return ;
+
+	const Eigen::VectorXd rhs = Eigen::VectorXd::Ones( A.rows() ) ;
+	Eigen::VectorXd x( A.rows() ) ;
+
+	Krylov< MatrixT > cg( A ) ;
+	cg.setMaxIters( opts.maxIters ) ;
+	cg.setTol( opts.tolerance ) ;
+
+	IterationCounter counter ;
+	cg.callback().connect( counter, &IterationCounter::ack ) ;
+
+	Record r = proto ;
+	r.benchmark = "cg" ;
+	r.setTimes( timeRuns( opts.repetitions, [&]() {
+		x.setZero() ;
+		r.residual = cg.solve_CG( rhs, x ) ;
+	} ) ) ;
+	r.iterations = counter.iterations ;
+	report.add( r ) ;
+}
+
+// Solves the local problems of each contact independently
+struct LocalSOCTask : public RangeTask
+{
+	typedef DualFrictionProblem< 3u > Dual ;
+	typedef LocalSOCSolver< 3, double, true > Solver ;
+
+	LocalSOCTask( const Dual& dual_, double tol_, Eigen::VectorXd& r_, std::vector< double >& res_ )
+		: dual( dual_ ), tol( tol_ ), r( r_ ), res( res_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int worker ) const
+	{
+		for( std::ptrdiff_t i = begin ; i < end ; ++i )
+		{
+			Solver::Vector x = r.segment< 3 >( 3*i ) ;
+			res[ worker ] = std::max( res[ worker ],
+			                          Solver::solve( dual.W.diagonal( i ), dual.b.segment< 3 >( 3*i ), x, dual.mu[i], tol ) ) ;
+			r.segment< 3 >( 3*i ) = x ;
+		}
+	}
+
+	const Dual& dual ;
+	double tol ;
+	Eigen::VectorXd& r ;
+	std::vector< double >& res ;
+} ;
+
+// Same as LocalSOCTask, with batches of local problems
+struct LocalSOCBatchTask : public RangeTask
+{
+	enum { BatchSize = 4 } ;
+
+	typedef DualFrictionProblem< 3u > Dual ;
+	typedef LocalSOCSolver< 3, double, true > Solver ;
+	typedef LocalSOCBatch< 3, double, BatchSize > Batch ;
+
+	LocalSOCBatchTask( const Dual& dual_, double tol_, Eigen::VectorXd& r_, std::vector< double >& res_ )
+		: dual( dual_ ), tol( tol_ ), r( r_ ), res( res_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int worker ) const
+	{
+		Batch batch ;
+		double batchRes[ BatchSize ] ;
+
+		for( std::ptrdiff_t i0 = begin ; i0 < end ; i0 += BatchSize )
+		{
+			batch.count = std::min( (std::ptrdiff_t) BatchSize, end - i0 ) ;
+			for( unsigned k = 0 ; k < batch.count ; ++k )
+			{
+				const std::ptrdiff_t i = i0 + k ;
+				batch.set( k, dual.W.diagonal( i ), dual.b.segment< 3 >( 3*i ), r.segment< 3 >( 3*i ) ) ;
+				batch.mu[k] = dual.mu[i] ;
+			}
+
+			Solver::solveBatch( batch, tol, batchRes ) ;
+
+			for( unsigned k = 0 ; k < batch.count ; ++k )
+			{
+				Eigen::Vector3d x ;
+				batch.get( k, x ) ;
+				r.segment< 3 >( 3*(i0 + k) ) = x ;
+				res[ worker ] = std::max( res[ worker ], batchRes[k] ) ;
+			}
+		}
+	}
+
+	const Dual& dual ;
+	double tol ;
+	Eigen::VectorXd& r ;
+	std::vector< double >& res ;
+} ;
+
+template < typename Task >
+void benchLocalSOC( const Options& opts, JsonReport& report, Record proto, const char* name,
+                    const DualFrictionProblem< 3u >& dual )
+{
+	if( !opts.enabled( name ) ) return ;
+
+	const double tol = 1.e-12 ;
+	Eigen::VectorXd r( dual.b.rows() ) ;
+	std::vector< double > res( executor().nWorkers() ) ;
+
+	const Task task( dual, tol, r, res ) ;
+
+	Record rec = proto ;
+	rec.benchmark = name ;
+	rec.setTimes( timeRuns( opts.repetitions, [&]() {
+		r.setZero() ;
+		std::fill( res.begin(), res.end(), 0. ) ;
+		parallel_for( 0, dual.W.rowsOfBlocks(), task, proto.threads > 1, 64 ) ;
+	} ) ) ;
+	rec.residual = *std::max_element( res.begin(), res.end() ) ;
+	report.add( rec ) ;
+}
+
+void benchScene( const Options& opts, JsonReport& report, const Scene& scene, int threads )
+{
+	typedef DualFrictionProblem< 3u > Dual ;
+	typedef PrimalFrictionProblem< 3u > Primal ;
+
+	const Primal& primal = scene.primal ;
+
+	Record proto ;
+	proto.problem = scene.name ;
+	proto.size = scene.nContacts() ;
+	proto.threads = threads ;
+
+	// Delassus operator
+
+	Dual dual ;
+	dual.computeFrom( primal ) ;
+
+	if( opts.enabled( "spgemm" ) ) {
+		Record r = proto ;
+		r.benchmark = "spgemm" ;
+		r.setTimes( timeRuns( opts.repetitions, [&]() {
+			Dual fresh ;
+			fresh.computeFrom( primal ) ;
+		} ) ) ;
+		r.nBlocks = dual.W.nBlocks() ;
+		report.add( r ) ;
+	}
+	if( opts.enabled( "spgemm_cached" ) ) {
+		Record r = proto ;
+		r.benchmark = "spgemm_cached" ;
+		r.setTimes( timeRuns( opts.repetitions, [&]() {
+			dual.computeFrom( primal ) ;
+		} ) ) ;
+		r.nBlocks = dual.W.nBlocks() ;
+		report.add( r ) ;
+	}
+
+	// Products and coloring on W
+
+	proto.nBlocks = dual.W.nBlocks() ;
+	benchSpMV( opts, report, proto, dual.W ) ;
+	benchColoring( opts, report, proto, dual.W ) ;
+
+	// Products with H
+
+	{
+		Record protoH = proto ;
+		protoH.nBlocks = primal.H.nBlocks() ;
+		benchSpMV( opts, report, protoH, primal.H, "spmv_H", "spmv_Ht" ) ;
+	}
+
+	// Solvers
+
+	Eigen::VectorXd r( 3 * scene.nContacts() ) ;
+	IterationCounter counter ;
+
+	for( unsigned async = 0 ; async < 2 ; ++async )
+	{
+		const char* name = async ? "gs_async" : "gs" ;
+		if( !opts.enabled( name ) ) continue ;
+
+		Dual::GaussSeidelType gs ;
+		gs.setTol( opts.tolerance ) ;
+		gs.setMaxIters( opts.maxIters ) ;
+		gs.setMaxThreads( threads ) ;
+		gs.setAsynchronous( async ) ;
+		gs.callback().connect( counter, &IterationCounter::ack ) ;
+
+		gs.coloring().setAlgorithm( Coloring::JonesPlassmann ) ;
+		gs.coloring().setBalancing( threads ) ;
+		gs.coloring().update( threads > 1 && !async, dual.W ) ;
+
+		Record rec = proto ;
+		rec.benchmark = name ;
+		rec.setTimes( timeRuns( opts.repetitions, [&]() {
+			r.setZero() ;
+			rec.residual = dual.solveWith( gs, r.data(), false ) ;
+		} ) ) ;
+		rec.iterations = counter.iterations ;
+		report.add( rec ) ;
+	}
+
+	if( opts.enabled( "pg" ) ) {
+		Dual::ProjectedGradientType pg ;
+		pg.setTol( opts.tolerance ) ;
+		pg.setMaxIters( opts.maxIters ) ;
+		pg.callback().connect( counter, &IterationCounter::ack ) ;
+
+		Record rec = proto ;
+		rec.benchmark = "pg" ;
+		rec.setTimes( timeRuns( opts.repetitions, [&]() {
+			r.setZero() ;
+			rec.residual = dual.solveWith( pg, r.data(), true ) ;
+		} ) ) ;
+		rec.iterations = counter.iterations ;
+		report.add( rec ) ;
+	}
+
+	if( opts.enabled( "pgs" ) ) {
+		Primal::ProductGaussSeidelType pgs ;
+		pgs.setTol( opts.tolerance ) ;
+		pgs.setMaxIters( opts.maxIters ) ;
+		pgs.setMaxThreads( threads ) ;
+		pgs.callback().connect( counter, &IterationCounter::ack ) ;
+
+		Record rec = proto ;
+		rec.benchmark = "pgs" ;
+		rec.nBlocks = primal.H.nBlocks() ;
+		rec.setTimes( timeRuns( opts.repetitions, [&]() {
+			r.setZero() ;
+			rec.residual = primal.solveWith( pgs, r.data(), false ) ;
+		} ) ) ;
+		rec.iterations = counter.iterations ;
+		report.add( rec ) ;
+	}
+
+	if( opts.enabled( "admm" ) ) {
+		Primal::ADMMType admm ;
+		admm.setTol( opts.tolerance ) ;
+		admm.setMaxIters( opts.maxIters ) ;
+		admm.callback().connect( counter, &IterationCounter::ack ) ;
+
+		// AMA converges for step sizes below 2 / || H M^-1 H^T ||
+		admm.setStepSize( 1. / largestEigenvalue( dual.W ) ) ;
+
+		Eigen::VectorXd v( primal.H.cols() ) ;
+
+		Record rec = proto ;
+		rec.benchmark = "admm" ;
+		rec.nBlocks = primal.H.nBlocks() ;
+		rec.setTimes( timeRuns( opts.repetitions, [&]() {
+			r.setZero() ;
+			v = - ( primal.MInv * Eigen::VectorXd::Map( primal.f, primal.H.cols() ) ) ;
+			rec.residual = primal.solveWith( admm, 0., v.data(), r.data() ) ;
+		} ) ) ;
+		rec.iterations = counter.iterations ;
+		report.add( rec ) ;
+	}
+
+	benchLocalSOC< LocalSOCTask >( opts, report, proto, "local_soc", dual ) ;
+	benchLocalSOC< LocalSOCBatchTask >( opts, report, proto, "local_soc_batch", dual ) ;
+}
+
+template < typename BlockT >
+void benchRandom( const Options& opts, JsonReport& report, int threads )
+{
+	typedef SparseBlockMatrix< BlockT, SYMMETRIC > MatrixT ;
+
+	MatrixT A ;
+	makeRandomSPD( A, opts.randomBlocks, opts.blockSize, opts.density, opts.seed ) ;
+
+	std::ostringstream name ;
+	name << "random_" << opts.blockSize << "x" << opts.blockSize ;
+
+	Record proto ;
+	proto.problem = name.str() ;
+	proto.size = A.rowsOfBlocks() ;
+	proto.nBlocks = A.nBlocks() ;
+	proto.threads = threads ;
+
+	if( opts.enabled( "spgemm" ) ) {
+		Record r = proto ;
+		r.benchmark = "spgemm" ;
+		SparseBlockMatrix< BlockT, SYMMETRIC > AA ;
+		r.setTimes( timeRuns( opts.repetitions, [&]() {
+			AA = A * A ;
+		} ) ) ;
+		r.nBlocks = AA.nBlocks() ;
+		report.add( r ) ;
+	}
+
+	benchSpMV( opts, report, proto, A ) ;
+	benchColoring( opts, report, proto, A ) ;
+	benchCG( opts, report, proto, A ) ;
+}
+
+void benchRandom( const Options& opts, JsonReport& report, int threads )
+{
+	switch( opts.blockSize ) {
+	case 2:
+		benchRandom< Eigen::Matrix2d >( opts, report, threads ) ;
+		break ;
+	case 3:
+		benchRandom< Eigen::Matrix3d >( opts, report, threads ) ;
+		break ;
+	case 6:
+		benchRandom< Eigen::Matrix< double, 6, 6 > >( opts, report, threads ) ;
+		break ;
+	default:
+		benchRandom< Eigen::MatrixXd >( opts, report, threads ) ;
+	}
+}
+
+void usage( const char* name )
+{
+	std::cout << "Usage: " << name << " [options] \n "
+	          << "Options: \n"
+	          << " -p list \t comma-separated problems among granular, boxes, hair, cloth, random (default: all)\n"
+	          << " -b list \t comma-separated benchmarks (default: all, see -l)\n"
+	          << " -l      \t list the available benchmarks and exit\n"
+	          << " -n int  \t size parameter of the scene generators (default: 8)\n"
+	          << " -T list \t comma-separated thread counts, 0 meaning OMP_MAX_THREADS (default: 1,0)\n"
+	          << " -e bool \t if true, use the work-stealing executor instead of OpenMP\n"
+	          << " -r int  \t repetitions of each benchmark (default: 5)\n"
+	          << " -m int  \t max number of solver iterations (default: 100)\n"
+	          << " -t real \t solver tolerance (default: 1e-8)\n"
+	          << " -N int  \t number of rows of blocks of the random matrix (default: 10000)\n"
+	          << " -k int  \t block size of the random matrix (default: 3)\n"
+	          << " -d real \t density of the random matrix (default: 1e-3)\n"
+	          << " -s int  \t random seed (default: 42)\n"
+	          << " -o file \t write the JSON report to file instead of the standard output\n"
+	          << std::endl ;
+}
+
+} //namespace
+
+int main( int argc, const char* argv[] )
+{
+	Options opts ;
+	const char* output = BOGUS_NULL_PTR(const char) ;
+	const char* threadList = "1,0" ;
+
+	for( int i = 1 ; i < argc ; ++i )
+	{
+		if( argv[i][0] != '-' ) continue ;
+
+		switch(argv[i][1]) {
+		case 'h':
+			usage( argv[0] ) ;
+			return 0 ;
+		case 'l':
+			for( unsigned b = 0 ; b < sizeof( s_benchmarks ) / sizeof( s_benchmarks[0] ) ; ++b )
+				std::cout << s_benchmarks[b] << "\n" ;
+			return 0 ;
+		case 'p':
+			if( ++i == argc ) break ;
+			opts.problems = split( argv[i] ) ;
+			break ;
+		case 'b':
+			if( ++i == argc ) break ;
+			opts.benchmarks = split( argv[i] ) ;
+			break ;
+		case 'n':
+			if( ++i == argc ) break ;
+			opts.scale = std::atoi( argv[i] ) ;
+			break ;
+		case 'T':
+			if( ++i == argc ) break ;
+			threadList = argv[i] ;
+			break ;
+		case 'e':
+			if( ++i == argc ) break ;
+			opts.workStealing = (bool) std::atoi( argv[i] ) ;
+			break ;
+		case 'r':
+			if( ++i == argc ) break ;
+			opts.repetitions = std::max( 1, std::atoi( argv[i] ) ) ;
+			break ;
+		case 'm':
+			if( ++i == argc ) break ;
+			opts.maxIters = std::atoi( argv[i] ) ;
+			break ;
+		case 't':
+			if( ++i == argc ) break ;
+			opts.tolerance = std::strtod( argv[i], NULL ) ;
+			break ;
+		case 'N':
+			if( ++i == argc ) break ;
+			opts.randomBlocks = std::atoi( argv[i] ) ;
+			break ;
+		case 'k':
+			if( ++i == argc ) break ;
+			opts.blockSize = std::max( 1, std::atoi( argv[i] ) ) ;
+			break ;
+		case 'd':
+			if( ++i == argc ) break ;
+			opts.density = std::strtod( argv[i], NULL ) ;
+			break ;
+		case 's':
+			if( ++i == argc ) break ;
+			opts.seed = std::atoi( argv[i] ) ;
+			break ;
+		case 'o':
+			if( ++i == argc ) break ;
+			output = argv[i] ;
+			break ;
+		}
+	}
+
+	const std::vector< std::string > threadCounts = split( threadList ) ;
+	for( std::size_t t = 0 ; t < threadCounts.size() ; ++t )
+	{
+		const int n = WithMaxThreads( std::atoi( threadCounts[t].c_str() ) ).nThreads() ;
+		if( std::find( opts.threads.begin(), opts.threads.end(), n ) == opts.threads.end() )
+			opts.threads.push_back( n ) ;
+	}
+
+	std::ofstream file ;
+	if( output ) {
+		file.open( output ) ;
+		if( !file ) {
+			std::cerr << " Could not open " << output << std::endl ;
+			return 1 ;
+		}
+	}
+
+	JsonReport report( output ? file : std::cout ) ;
+
+	for( std::size_t p = 0 ; p < opts.problems.size() ; ++p )
+	{
+		const std::string& problem = opts.problems[p] ;
+
+		Scene scene ;
+		if( problem != "random" && !makeScene( problem, scene, opts.scale, opts.seed ) ) {
+			std::cerr << " Unknown problem " << problem << std::endl ;
+			continue ;
+		}
+
+		for( std::size_t t = 0 ; t < opts.threads.size() ; ++t )
+		{
+			const int threads = opts.threads[t] ;
+			const WithMaxThreads wmt( threads ) ;
+
+			std::unique_ptr< WorkStealingExecutor > pool ;
+			if( opts.workStealing ) {
+				pool.reset( new WorkStealingExecutor( threads ) ) ;
+				setExecutor( pool.get() ) ;
+			}
+
+			if( problem == "random" )
+				benchRandom( opts, report, threads ) ;
+			else
+				benchScene( opts, report, scene, threads ) ;
+
+			setExecutor( BOGUS_NULL_PTR( Executor ) ) ;
+		}
+	}
+
+	return 0 ;
+}
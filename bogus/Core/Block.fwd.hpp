@@ -35,6 +35,9 @@ class SparseBlockMatrixBase ;
 template < typename BlockT, int Flags = flags::NONE >
 class SparseBlockMatrix  ;
 
+template < typename MatrixT >
+class SparseBlockProductPlan ;
+
 template < typename BlockT, int Flags = flags::NONE >
 class FlatSparseBlockMatrix  ;
 
@@ -31,5 +31,7 @@
 #include "Block/CompoundMatrix.hpp"
 #include "Block/Zero.hpp"
 #include "Block/Operators.hpp"
+#include "Block/SparseBlockProductPlan.hpp"
+#include "Block/SparseBlockMatrixBuilder.hpp"
 
 #endif
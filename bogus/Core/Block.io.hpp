@@ -10,6 +10,7 @@
 
 #include "Block.hpp"
 #include "Block/Streams.hpp"
+#include "Block/BinaryFormat.hpp"
 
 #ifdef BOGUS_WITH_BOOST_SERIALIZATION
 #include <boost/serialization/version.hpp>
@@ -0,0 +1,560 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2016 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+
+#ifndef BOGUS_BLOCK_BINARY_FORMAT_HPP
+#define BOGUS_BLOCK_BINARY_FORMAT_HPP
+
+#include "SparseBlockMatrixBase.hpp"
+#include "MappedSparseBlockMatrix.hpp"
+
+#include "../Utils/MappedFile.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bogus
+{
+
+//! Versioned binary container whose arrays can be used in-place once the file is memory-mapped
+/*!
+  A file consists of a 64-byte Header, followed by named sections and by a table of SectionEntry
+  describing them. Each section is a raw little-endian array of fixed-size elements,
+  aligned on 64 bytes from the start of the file ; the header, the table and each section
+  are protected by a checksum.
+
+  Sparse block matrices are stored with writeMatrix() as several sections holding a compressed
+  index ( \c name.outer and \c name.inner ), the row and column offsets ( \c name.rows, \c name.cols )
+  and the block data laid out contiguously in index order ( \c name.data ).
+  They can then either be copied into any SparseBlockMatrixBase with readMatrix(),
+  or, for blocks with a fixed size, viewed without any copy through a MappedSparseBlockMatrix
+  with mapMatrix().
+
+  \warning Only little-endian platforms are supported
+  */
+namespace binary
+{
+
+enum {
+	Version   = 1,
+	Alignment = 64,
+	MaxNameLength = 31
+} ;
+
+struct Header
+{
+	char     magic[8] ;
+	uint32_t version ;
+	uint32_t endianness ;
+	uint64_t nSections ;
+	uint64_t tableOffset ;
+	uint64_t tableChecksum ;
+	uint64_t fileSize ;
+	uint64_t headerChecksum ;
+	char     padding[8] ;
+} ;
+
+struct SectionEntry
+{
+	char     name[ MaxNameLength+1 ] ;
+	uint32_t elementSize ;
+	uint32_t reserved ;
+	uint64_t offset ;
+	uint64_t count ;
+	uint64_t checksum ;
+} ;
+
+inline const char* magic() { return "BOGUSBIN" ; }
+
+inline bool isLittleEndian()
+{
+	const uint32_t one = 1 ;
+	return 1 == *reinterpret_cast< const unsigned char* >( &one ) ;
+}
+
+//! Fletcher-like 64 bits checksum, processing the data by 8-byte words
+/*! Can be updated incrementally ; the result does not depend on how the data is split */
+class Checksum
+{
+public:
+	Checksum() : m_a( 0 ), m_b( 0 ), m_nPending( 0 ) {}
+
+	void update( const void* data, std::size_t size )
+	{
+		const unsigned char* bytes = static_cast< const unsigned char* >( data ) ;
+
+		while( m_nPending != 0 && size > 0 ) {
+			m_pending[ m_nPending++ ] = *(bytes++) ;
+			--size ;
+			if( m_nPending == 8 ) {
+				add( m_pending ) ;
+				m_nPending = 0 ;
+			}
+		}
+
+		for( ; size >= 8 ; size -= 8, bytes += 8 )
+			add( bytes ) ;
+
+		for( ; size > 0 ; --size )
+			m_pending[ m_nPending++ ] = *(bytes++) ;
+	}
+
+	uint64_t value() const
+	{
+		Checksum tail( *this ) ;
+		if( tail.m_nPending ) {
+			std::memset( tail.m_pending + tail.m_nPending, 0, 8 - tail.m_nPending ) ;
+			tail.add( tail.m_pending ) ;
+		}
+		return tail.m_b ^ ( tail.m_a << 32 | tail.m_a >> 32 ) ;
+	}
+
+	static uint64_t of( const void* data, std::size_t size )
+	{
+		Checksum c ;
+		c.update( data, size ) ;
+		return c.value() ;
+	}
+
+private:
+	void add( const unsigned char* word )
+	{
+		uint64_t w ;
+		std::memcpy( &w, word, 8 ) ;
+		m_a += w ;
+		m_b += m_a ;
+	}
+
+	uint64_t m_a ;
+	uint64_t m_b ;
+	unsigned char m_pending[8] ;
+	unsigned m_nPending ;
+} ;
+
+//! Writes a binary container section by section
+class Writer
+{
+public:
+	Writer() : m_inSection( false ) {}
+
+	//! Opens \p fileName for writing, returns false on failure
+	bool open( const char* fileName )
+	{
+		m_sections.clear() ;
+		m_inSection = false ;
+
+		if( !isLittleEndian() ) return false ;
+
+		m_ofs.open( fileName, std::ios::binary | std::ios::trunc ) ;
+		if( !m_ofs.is_open() ) return false ;
+
+		// Header will be overwritten by close()
+		const Header header = Header() ;
+		m_ofs.write( reinterpret_cast< const char* >( &header ), sizeof( Header ) ) ;
+		return m_ofs.good() ;
+	}
+
+	//! Starts a new section named \p name, with elements of \p elementSize bytes
+	void beginSection( const char* name, std::size_t elementSize )
+	{
+		assert( !m_inSection ) ;
+		assert( std::strlen( name ) <= MaxNameLength ) ;
+
+		pad() ;
+
+		SectionEntry entry = SectionEntry() ;
+		std::strncpy( entry.name, name, MaxNameLength ) ;
+		entry.elementSize = elementSize ;
+		entry.offset = m_ofs.tellp() ;
+		m_sections.push_back( entry ) ;
+
+		m_checksum = Checksum() ;
+		m_inSection = true ;
+	}
+
+	//! Appends \p count elements to the current section
+	template < typename T >
+	void append( const T* data, std::size_t count )
+	{
+		assert( m_inSection ) ;
+		assert( sizeof( T ) == m_sections.back().elementSize ) ;
+
+		const std::size_t size = count * sizeof( T ) ;
+		m_ofs.write( reinterpret_cast< const char* >( data ), size ) ;
+		m_checksum.update( data, size ) ;
+		m_sections.back().count += count ;
+	}
+
+	void endSection()
+	{
+		assert( m_inSection ) ;
+		m_sections.back().checksum = m_checksum.value() ;
+		m_inSection = false ;
+	}
+
+	//! Writes a whole section at once
+	template < typename T >
+	void write( const char* name, const T* data, std::size_t count )
+	{
+		beginSection( name, sizeof( T ) ) ;
+		append( data, count ) ;
+		endSection() ;
+	}
+
+	//! Writes the section table and the header, and closes the file. Returns false on failure
+	bool close()
+	{
+		assert( !m_inSection ) ;
+		pad() ;
+
+		Header header = Header() ;
+		std::memcpy( header.magic, magic(), 8 ) ;
+		header.version     = Version ;
+		header.endianness  = 0x01020304u ;
+		header.nSections   = m_sections.size() ;
+		header.tableOffset = m_ofs.tellp() ;
+
+		const std::size_t tableSize = m_sections.size() * sizeof( SectionEntry ) ;
+		header.tableChecksum = Checksum::of( data_pointer( m_sections ), tableSize ) ;
+		header.fileSize = header.tableOffset + tableSize ;
+		header.headerChecksum = Checksum::of( &header, offsetof( Header, headerChecksum ) ) ;
+
+		m_ofs.write( reinterpret_cast< const char* >( data_pointer( m_sections ) ), tableSize ) ;
+		m_ofs.seekp( 0 ) ;
+		m_ofs.write( reinterpret_cast< const char* >( &header ), sizeof( Header ) ) ;
+
+		const bool ok = m_ofs.good() ;
+		m_ofs.close() ;
+		m_sections.clear() ;
+		return ok ;
+	}
+
+private:
+	void pad()
+	{
+		static const char zeros[ Alignment ] = { 0 } ;
+		const std::size_t rem = static_cast< std::size_t >( m_ofs.tellp() ) % Alignment ;
+		if( rem ) m_ofs.write( zeros, Alignment - rem ) ;
+	}
+
+	std::ofstream m_ofs ;
+	std::vector< SectionEntry > m_sections ;
+	Checksum m_checksum ;
+	bool m_inSection ;
+} ;
+
+//! Gives access to the sections of a memory-mapped binary container
+/*!
+  The file is mapped privately : its sections may be modified in-place,
+  but such modifications are never written back to disk.
+  Pointers returned by section() remain valid until close() is called or the Reader is destroyed.
+  */
+class Reader
+{
+public:
+	//! Maps \p fileName and checks its header and section table
+	/*! \param verify If true, also checks the checksum of every section, which
+	  reads the whole file at once. Otherwise, pages are only read from disk when first accessed,
+	  and verifySection() may be used later on.
+	  \return false if the file could not be opened or is not a valid container */
+	bool open( const char* fileName, bool verify = false )
+	{
+		close() ;
+
+		if( !isLittleEndian() || !m_file.open( fileName ) ) return false ;
+		if( m_file.size() < sizeof( Header ) ) return fail() ;
+
+		const Header& header = *reinterpret_cast< const Header* >( m_file.data() ) ;
+		if( 0 != std::memcmp( header.magic, magic(), 8 )
+		        || header.version > Version
+		        || header.endianness != 0x01020304u
+		        || header.headerChecksum != Checksum::of( &header, offsetof( Header, headerChecksum ) )
+		        || header.fileSize != m_file.size()
+		        || header.tableOffset + header.nSections * sizeof( SectionEntry ) > m_file.size() )
+			return fail() ;
+
+		const SectionEntry* table = reinterpret_cast< const SectionEntry* >( m_file.data() + header.tableOffset ) ;
+		if( header.tableChecksum != Checksum::of( table, header.nSections * sizeof( SectionEntry ) ) )
+			return fail() ;
+
+		m_sections.assign( table, table + header.nSections ) ;
+		for( std::size_t i = 0 ; i < m_sections.size() ; ++i )
+		{
+			const SectionEntry& s = m_sections[i] ;
+			if( s.offset % Alignment
+			        || s.offset + s.count * s.elementSize > header.tableOffset
+			        || ( verify && !checkSection( s ) ) )
+				return fail() ;
+		}
+
+		return true ;
+	}
+
+	void close()
+	{
+		m_sections.clear() ;
+		m_file.close() ;
+	}
+
+	bool isOpen() const { return m_file.isOpen() ; }
+
+	//! Returns whether the file contains a section named \p name
+	bool has( const char* name ) const { return find( name ) != BOGUS_NULL_PTR( const SectionEntry ) ; }
+
+	//! Returns a pointer to the elements of section \p name and sets \p count to their number
+	/*! Returns NULL if no such section exists or if its elements are not of size \c sizeof(T) */
+	template < typename T >
+	T* section( const char* name, std::size_t& count )
+	{
+		const SectionEntry* s = find( name ) ;
+		if( !s || s->elementSize != sizeof( T ) ) {
+			count = 0 ;
+			return BOGUS_NULL_PTR( T ) ;
+		}
+		count = s->count ;
+		return reinterpret_cast< T* >( m_file.data() + s->offset ) ;
+	}
+
+	//! Hints that section \p name will soon be accessed
+	void prefetch( const char* name ) const
+	{
+		const SectionEntry* s = find( name ) ;
+		if( s ) m_file.prefetch( s->offset, s->count * s->elementSize ) ;
+	}
+
+	//! Checks the checksum of section \p name
+	bool verifySection( const char* name ) const
+	{
+		const SectionEntry* s = find( name ) ;
+		return s && checkSection( *s ) ;
+	}
+
+private:
+	bool fail()
+	{
+		close() ;
+		return false ;
+	}
+
+	const SectionEntry* find( const char* name ) const
+	{
+		for( std::size_t i = 0 ; i < m_sections.size() ; ++i )
+		{
+			if( 0 == std::strncmp( m_sections[i].name, name, MaxNameLength+1 ) )
+				return &m_sections[i] ;
+		}
+		return BOGUS_NULL_PTR( const SectionEntry ) ;
+	}
+
+	bool checkSection( const SectionEntry& s ) const
+	{
+		return s.checksum == Checksum::of( m_file.data() + s.offset, s.count * s.elementSize ) ;
+	}
+
+	MappedFile m_file ;
+	std::vector< SectionEntry > m_sections ;
+} ;
+
+namespace binary_impl {
+
+inline std::string sectionName( const char* matrix, const char* field )
+{
+	return std::string( matrix ) + "." + field ;
+}
+
+template < typename Index >
+void sizesFromOffsets( const Index* offsets, std::size_t count, std::vector< unsigned > &sizes )
+{
+	sizes.resize( count - 1 ) ;
+	for( std::size_t i = 0 ; i+1 < count ; ++i )
+		sizes[i] = offsets[i+1] - offsets[i] ;
+}
+
+//! Reads the index and dimensions of matrix \p name, and checks their consistency
+template < typename Traits >
+struct MatrixSections
+{
+	typedef typename Traits::Index Index ;
+	typedef typename Traits::Scalar Scalar ;
+
+	const Index *rows, *cols, *outer, *inner ;
+	Scalar* data ;
+	std::size_t nRows, nCols, nOuter, nBlocks, nScalars ;
+
+	bool read( Reader& reader, const char* name )
+	{
+		std::size_t nFlags ;
+		const int32_t* flags = reader.section< const int32_t >( sectionName( name, "flags" ).c_str(), nFlags ) ;
+		if( nFlags != 1 || *flags != ( Traits::flags & ~flags::UNCOMPRESSED ) )
+			return false ;
+
+		rows  = reader.section< const Index >( sectionName( name, "rows"  ).c_str(), nRows  ) ;
+		cols  = reader.section< const Index >( sectionName( name, "cols"  ).c_str(), nCols  ) ;
+		outer = reader.section< const Index >( sectionName( name, "outer" ).c_str(), nOuter ) ;
+		inner = reader.section< const Index >( sectionName( name, "inner" ).c_str(), nBlocks ) ;
+		data  = reader.section< Scalar >( sectionName( name, "data" ).c_str(), nScalars ) ;
+
+		if( !rows || !cols || !outer || ( nBlocks && !inner ) || ( nScalars && !data ) )
+			return false ;
+
+		const std::size_t nInner = Traits::is_col_major ? nRows : nCols ;
+		if( nRows == 0 || nCols == 0 || nOuter != ( Traits::is_col_major ? nCols : nRows )
+		        || outer[0] != 0 || (std::size_t) outer[ nOuter - 1 ] != nBlocks )
+			return false ;
+
+		for( std::size_t i = 0 ; i+1 < nOuter ; ++i )
+			if( outer[i+1] < outer[i] ) return false ;
+
+		return nBlocks == 0 || (std::size_t) *std::max_element( inner, inner + nBlocks ) < nInner - 1 ;
+	}
+} ;
+
+} //namespace binary_impl
+
+//! Writes \p matrix as the sections \c name.* of \p writer
+/*! The blocks must be dense Eigen matrices ( or anything providing \c data() and \c size() ).
+  Uncompressed matrices are stored using a compressed index, and should have been finalized. */
+template < typename Derived >
+void writeMatrix( Writer& writer, const char* name, const SparseBlockMatrixBase< Derived >& matrix )
+{
+	typedef BlockMatrixTraits< Derived > Traits ;
+	typedef typename Traits::Index Index ;
+	typedef typename Traits::Scalar Scalar ;
+	typedef typename SparseBlockMatrixBase< Derived >::MajorIndexType MajorIndexType ;
+
+	const MajorIndexType& index = matrix.majorIndex() ;
+
+	const int32_t flags = Traits::flags & ~flags::UNCOMPRESSED ;
+	writer.write( binary_impl::sectionName( name, "flags" ).c_str(), &flags, 1 ) ;
+	writer.write( binary_impl::sectionName( name, "rows" ).c_str(), matrix.rowOffsets(), matrix.rowsOfBlocks() + 1 ) ;
+	writer.write( binary_impl::sectionName( name, "cols" ).c_str(), matrix.colOffsets(), matrix.colsOfBlocks() + 1 ) ;
+
+	writer.beginSection( binary_impl::sectionName( name, "outer" ).c_str(), sizeof( Index ) ) ;
+	Index nnz = 0 ;
+	writer.append( &nnz, 1 ) ;
+	for( Index i = 0 ; i < index.outerSize() ; ++i )
+	{
+		nnz += index.size( i ) ;
+		writer.append( &nnz, 1 ) ;
+	}
+	writer.endSection() ;
+
+	writer.beginSection( binary_impl::sectionName( name, "inner" ).c_str(), sizeof( Index ) ) ;
+	for( Index i = 0 ; i < index.outerSize() ; ++i )
+	{
+		for( typename MajorIndexType::InnerIterator it( index, i ) ; it ; ++it )
+		{
+			const Index inner = it.inner() ;
+			writer.append( &inner, 1 ) ;
+		}
+	}
+	writer.endSection() ;
+
+	writer.beginSection( binary_impl::sectionName( name, "data" ).c_str(), sizeof( Scalar ) ) ;
+	for( Index i = 0 ; i < index.outerSize() ; ++i )
+	{
+		for( typename MajorIndexType::InnerIterator it( index, i ) ; it ; ++it )
+		{
+			const typename Traits::ConstBlockRef block = matrix.block( it.ptr() ) ;
+			writer.append( block.data(), block.size() ) ;
+		}
+	}
+	writer.endSection() ;
+}
+
+//! Copies the matrix stored as sections \c name.* of \p reader into \p matrix
+/*! Returns false if the sections are missing or incompatible with the type of \p matrix */
+template < typename Derived >
+bool readMatrix( Reader& reader, const char* name, SparseBlockMatrixBase< Derived >& matrix )
+{
+	typedef BlockMatrixTraits< Derived > Traits ;
+	typedef typename Traits::Index Index ;
+	typedef typename Traits::BlockType BlockType ;
+
+	binary_impl::MatrixSections< Traits > s ;
+	if( !s.read( reader, name ) ) return false ;
+
+	std::vector< unsigned > sizes ;
+	binary_impl::sizesFromOffsets( s.rows, s.nRows, sizes ) ;
+	matrix.setRows( sizes ) ;
+	binary_impl::sizesFromOffsets( s.cols, s.nCols, sizes ) ;
+	matrix.setCols( sizes ) ;
+
+	matrix.clear() ;
+	matrix.derived().reserve( s.nBlocks, s.nScalars ) ;
+
+	std::size_t offset = 0 ;
+	for( Index i = 0 ; i+1 < (Index) s.nOuter ; ++i )
+	{
+		for( Index k = s.outer[i] ; k < s.outer[i+1] ; ++k )
+		{
+			const Index row = Traits::is_col_major ? s.inner[k] : i ;
+			const Index col = Traits::is_col_major ? i : s.inner[k] ;
+			const std::size_t size = matrix.blockRows( row ) * matrix.blockCols( col ) ;
+			if( offset + size > s.nScalars ) {
+				matrix.clear() ;
+				return false ;
+			}
+
+			matrix.insertBackAndResize( row, col ) =
+			        typename BlockType::ConstMapType( s.data + offset, matrix.blockRows( row ), matrix.blockCols( col ) ) ;
+			offset += size ;
+		}
+	}
+	matrix.finalize() ;
+
+	return offset == s.nScalars ;
+}
+
+//! Makes \p matrix a view of the matrix stored as sections \c name.* of \p reader, without copying its blocks
+/*! Requires blocks with fixed dimensions. The returned matrix is valid as long as \p reader is open.
+  Returns false if the sections are missing or incompatible with the type of \p matrix */
+template < typename BlockT, int Flags, typename Index_ >
+bool mapMatrix( Reader& reader, const char* name, MappedSparseBlockMatrix< BlockT, Flags, Index_ >& matrix )
+{
+	typedef MappedSparseBlockMatrix< BlockT, Flags, Index_ > MatrixType ;
+	typedef BlockMatrixTraits< MatrixType > Traits ;
+	typedef typename Traits::Scalar Scalar ;
+
+	BOGUS_STATIC_ASSERT( (int) Traits::RowsPerBlock != (int) internal::DYNAMIC
+	                     && (int) Traits::ColsPerBlock != (int) internal::DYNAMIC,
+	                     BLOCKS_MUST_HAVE_FIXED_DIMENSIONS ) ;
+	BOGUS_STATIC_ASSERT( sizeof( BlockT ) == Traits::RowsPerBlock * Traits::ColsPerBlock * sizeof( Scalar ),
+	                     BLOCKS_MUST_HAVE_FIXED_DIMENSIONS ) ;
+
+	binary_impl::MatrixSections< Traits > s ;
+	if( !s.read( reader, name ) ) return false ;
+	if( s.nScalars != s.nBlocks * Traits::RowsPerBlock * Traits::ColsPerBlock )
+		return false ;
+
+	// Check that all blocks have the expected dimensions
+	for( std::size_t i = 0 ; i+1 < s.nRows ; ++i )
+		if( s.rows[i+1] - s.rows[i] != Traits::RowsPerBlock ) return false ;
+	for( std::size_t i = 0 ; i+1 < s.nCols ; ++i )
+		if( s.cols[i+1] - s.cols[i] != Traits::ColsPerBlock ) return false ;
+
+	matrix.setRows( s.nRows - 1 ) ;
+	matrix.setCols( s.nCols - 1 ) ;
+
+	matrix.mapTo( s.nBlocks, reinterpret_cast< const BlockT* >( s.data ), s.outer, s.inner ) ;
+
+	return true ;
+}
+
+} //namespace binary
+
+} //namespace bogus
+
+#endif
@@ -73,6 +73,7 @@ struct BlockObjectBase
 	//! Performs a matrix vector multiplication
 	/*! \tparam DoTranspose If true, performs \c res = \c alpha * \c M' * \c rhs + beta * res,
 						  otherwise \c res = \c alpha * M * \c rhs + beta * res
+		\c rhs and \c res may also be dense matrices, in which case all their columns are multiplied at once
 	  */
 	template < bool DoTranspose, typename RhsT, typename ResT >
 	void multiply( const RhsT& rhs, ResT& res, Scalar alpha = 1, Scalar beta = 0 ) const
@@ -62,7 +62,14 @@ namespace flags
 			Linear algebra operations such as matrix-vector and matrix-matrix multiplication will work
 			just like if the matrix was fully populated, but at a lower memory access cost
 		*/
-		SYMMETRIC = 0x4
+		SYMMETRIC = 0x4,
+		//! Let solvers operate on double precision vectors, whatever the scalar type of the blocks
+		/*! Storing single-precision blocks nearly halves the memory traffic of matrix-vector products,
+			while the vectors and local problems of solvers are kept in double precision.
+			Products with double-precision vectors are only supported for 2x2 and 3x3 dense blocks.
+			\sa SolverScalar
+		*/
+		MIXED_PRECISION = 0x8
 	} ;
 }
 // Reduce verbosity of public API
@@ -0,0 +1,316 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+
+#ifndef BOGUS_FIXED_BLOCK_KERNELS_HPP
+#define BOGUS_FIXED_BLOCK_KERNELS_HPP
+
+#include "Traits.hpp"
+#include "Access.hpp"
+
+#include "../Utils/CppTools.hpp"
+
+#include <cstddef>
+
+#ifndef BOGUS_DONT_VECTORIZE
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+#endif
+
+namespace bogus {
+
+namespace mv_impl {
+
+//! Block-vector product kernel for small fixed-size blocks stored as plain arrays
+/*!
+	Accumulates the contributions of all the blocks of a block-row before writing them back
+	to the result vector, so that a whole row can be processed with the result kept in registers.
+
+	\tparam Rows Number of rows of the ( possibly transposed ) block
+	\tparam Cols Number of columns of the ( possibly transposed ) block
+	\tparam ColMajor Whether the ( possibly transposed ) block coefficients are stored column-wise
+	\tparam NRhs Number of right-hand-side columns that are multiplied at once
+	\tparam BlockScalar Scalar type in which the block coefficients are stored ; arithmetic is
+	performed in \p Scalar, the scalar type of the vectors
+
+	Vector coefficients are accessed as \c x[ row * rowStride + col * colStride ], so that both
+	column-major and row-interleaved multi-vectors can be processed.
+
+	This generic version relies on compile-time loop bounds for unrolling ;
+	SIMD specializations exist for 2x2 and 3x3 double blocks with a single right-hand-side,
+	as well as for 3x3 float blocks multiplied with double vectors
+*/
+template < int Rows, int Cols, bool ColMajor, typename Scalar, int NRhs = 1, typename BlockScalar = Scalar >
+struct FixedBlockKernel
+{
+	typedef std::ptrdiff_t Stride ;
+
+	struct Accumulator {
+		Scalar v[ Rows ][ NRhs ] ;
+	} ;
+
+	static inline void init( Accumulator& acc )
+	{
+		for( int r = 0 ; r < Rows ; ++r )
+			for( int k = 0 ; k < NRhs ; ++k )
+				acc.v[r][k] = 0 ;
+	}
+
+	static inline void add( Accumulator& acc, const BlockScalar* block, const Scalar* x,
+	                        const Stride xRowStride, const Stride xColStride, const Scalar alpha )
+	{
+		Scalar ax[ Cols ][ NRhs ] ;
+		for( int c = 0 ; c < Cols ; ++c )
+			for( int k = 0 ; k < NRhs ; ++k )
+				ax[c][k] = alpha * x[ c*xRowStride + k*xColStride ] ;
+
+		for( int r = 0 ; r < Rows ; ++r )
+			for( int c = 0 ; c < Cols ; ++c )
+			{
+				const Scalar b = static_cast< Scalar >( block[ ColMajor ? c*Rows + r : r*Cols + c ] ) ;
+				for( int k = 0 ; k < NRhs ; ++k )
+					acc.v[r][k] += b * ax[c][k] ;
+			}
+	}
+
+	static inline void store( const Accumulator& acc, Scalar* res,
+	                          const Stride resRowStride, const Stride resColStride )
+	{
+		for( int r = 0 ; r < Rows ; ++r )
+			for( int k = 0 ; k < NRhs ; ++k )
+				res[ r*resRowStride + k*resColStride ] += acc.v[r][k] ;
+	}
+} ;
+
+#ifndef BOGUS_DONT_VECTORIZE
+#if defined( __AVX__ )
+
+namespace simd {
+
+inline __m256d fmadd( __m256d a, __m256d b, __m256d c )
+{
+#ifdef __FMA__
+	return _mm256_fmadd_pd( a, b, c ) ;
+#else
+	return _mm256_add_pd( _mm256_mul_pd( a, b ), c ) ;
+#endif
+}
+
+//! Loads three contiguous doubles without touching the fourth one
+inline __m256d load3( const double* src )
+{
+	return _mm256_maskload_pd( src, _mm256_set_epi64x( 0, -1, -1, -1 ) ) ;
+}
+
+//! Loads three contiguous floats converted to double precision, without touching the fourth one
+inline __m256d load3( const float* src )
+{
+	return _mm256_cvtps_pd( _mm_maskload_ps( src, _mm_set_epi32( 0, -1, -1, -1 ) ) ) ;
+}
+
+inline double hsum( __m256d v )
+{
+	const __m128d s = _mm_add_pd( _mm256_castpd256_pd128( v ), _mm256_extractf128_pd( v, 1 ) ) ;
+	return _mm_cvtsd_f64( _mm_add_sd( s, _mm_unpackhi_pd( s, s ) ) ) ;
+}
+
+} //namespace simd
+
+//! 3x3 column-major : linear combination of the block columns
+/*! \p BlockScalar may be double or float */
+template < typename BlockScalar >
+struct FixedBlockKernel< 3, 3, true, double, 1, BlockScalar >
+{
+	typedef std::ptrdiff_t Stride ;
+
+	struct Accumulator {
+		__m256d v ;
+	} ;
+
+	static inline void init( Accumulator& acc )
+	{
+		acc.v = _mm256_setzero_pd() ;
+	}
+
+	static inline void add( Accumulator& acc, const BlockScalar* block, const double* x,
+	                        const Stride, const Stride, const double alpha )
+	{
+		acc.v = simd::fmadd( simd::load3( block     ), _mm256_set1_pd( alpha * x[0] ), acc.v ) ;
+		acc.v = simd::fmadd( simd::load3( block + 3 ), _mm256_set1_pd( alpha * x[1] ), acc.v ) ;
+		acc.v = simd::fmadd( simd::load3( block + 6 ), _mm256_set1_pd( alpha * x[2] ), acc.v ) ;
+	}
+
+	static inline void store( const Accumulator& acc, double* res, const Stride, const Stride )
+	{
+		double tmp[4] ;
+		_mm256_storeu_pd( tmp, acc.v ) ;
+		res[0] += tmp[0] ; res[1] += tmp[1] ; res[2] += tmp[2] ;
+	}
+} ;
+
+//! 3x3 row-major : one partial dot-product per block row, reduced once per row of blocks
+/*! \p BlockScalar may be double or float */
+template < typename BlockScalar >
+struct FixedBlockKernel< 3, 3, false, double, 1, BlockScalar >
+{
+	typedef std::ptrdiff_t Stride ;
+
+	struct Accumulator {
+		__m256d v[3] ;
+	} ;
+
+	static inline void init( Accumulator& acc )
+	{
+		acc.v[0] = acc.v[1] = acc.v[2] = _mm256_setzero_pd() ;
+	}
+
+	static inline void add( Accumulator& acc, const BlockScalar* block, const double* x,
+	                        const Stride, const Stride, const double alpha )
+	{
+		const __m256d ax = _mm256_mul_pd( _mm256_set1_pd( alpha ), simd::load3( x ) ) ;
+		acc.v[0] = simd::fmadd( simd::load3( block     ), ax, acc.v[0] ) ;
+		acc.v[1] = simd::fmadd( simd::load3( block + 3 ), ax, acc.v[1] ) ;
+		acc.v[2] = simd::fmadd( simd::load3( block + 6 ), ax, acc.v[2] ) ;
+	}
+
+	static inline void store( const Accumulator& acc, double* res, const Stride, const Stride )
+	{
+		res[0] += simd::hsum( acc.v[0] ) ;
+		res[1] += simd::hsum( acc.v[1] ) ;
+		res[2] += simd::hsum( acc.v[2] ) ;
+	}
+} ;
+
+#endif // __AVX__
+
+#if defined( __SSE2__ )
+
+//! 2x2 column-major : linear combination of the block columns
+template < >
+struct FixedBlockKernel< 2, 2, true, double >
+{
+	typedef std::ptrdiff_t Stride ;
+
+	struct Accumulator {
+		__m128d v ;
+	} ;
+
+	static inline void init( Accumulator& acc )
+	{
+		acc.v = _mm_setzero_pd() ;
+	}
+
+	static inline void add( Accumulator& acc, const double* block, const double* x,
+	                        const Stride, const Stride, const double alpha )
+	{
+		acc.v = _mm_add_pd( acc.v, _mm_mul_pd( _mm_loadu_pd( block     ), _mm_set1_pd( alpha * x[0] ) ) ) ;
+		acc.v = _mm_add_pd( acc.v, _mm_mul_pd( _mm_loadu_pd( block + 2 ), _mm_set1_pd( alpha * x[1] ) ) ) ;
+	}
+
+	static inline void store( const Accumulator& acc, double* res, const Stride, const Stride )
+	{
+		_mm_storeu_pd( res, _mm_add_pd( _mm_loadu_pd( res ), acc.v ) ) ;
+	}
+} ;
+
+//! 2x2 row-major : one partial dot-product per block row, reduced once per row of blocks
+template < >
+struct FixedBlockKernel< 2, 2, false, double >
+{
+	typedef std::ptrdiff_t Stride ;
+
+	struct Accumulator {
+		__m128d v[2] ;
+	} ;
+
+	static inline void init( Accumulator& acc )
+	{
+		acc.v[0] = acc.v[1] = _mm_setzero_pd() ;
+	}
+
+	static inline void add( Accumulator& acc, const double* block, const double* x,
+	                        const Stride, const Stride, const double alpha )
+	{
+		const __m128d ax = _mm_mul_pd( _mm_set1_pd( alpha ), _mm_loadu_pd( x ) ) ;
+		acc.v[0] = _mm_add_pd( acc.v[0], _mm_mul_pd( _mm_loadu_pd( block     ), ax ) ) ;
+		acc.v[1] = _mm_add_pd( acc.v[1], _mm_mul_pd( _mm_loadu_pd( block + 2 ), ax ) ) ;
+	}
+
+	static inline void store( const Accumulator& acc, double* res, const Stride, const Stride )
+	{
+		// Transpose the two partial sums so that a single add reduces both rows
+		const __m128d lo = _mm_unpacklo_pd( acc.v[0], acc.v[1] ) ;
+		const __m128d hi = _mm_unpackhi_pd( acc.v[0], acc.v[1] ) ;
+		_mm_storeu_pd( res, _mm_add_pd( _mm_loadu_pd( res ), _mm_add_pd( lo, hi ) ) ) ;
+	}
+} ;
+
+#endif // __SSE2__
+#endif // BOGUS_DONT_VECTORIZE
+
+//! Compile-time selection of the fixed-size kernels from the BlockTraits of \p BlockType
+/*! The kernels are used for square 2x2 and 3x3 blocks with plain array storage, when both the
+	rhs and the result are dense vectors, or multi-vectors with 2, 4 or 8 columns,
+	of the same scalar type as the blocks. Single-precision blocks may also be multiplied
+	with double-precision vectors, see flags::MIXED_PRECISION.
+	\sa DenseVectorTraits
+*/
+template < typename BlockType, bool Transpose, typename RhsT, typename ResT >
+struct FixedBlockKernelSelector
+{
+	typedef BlockTraits< BlockType > Traits ;
+	typedef typename Traits::Scalar BlockScalar ;
+	typedef typename RhsT::Scalar Scalar ;
+
+	typedef DenseVectorTraits< RhsT > RhsTraits ;
+	typedef DenseVectorTraits< ResT > ResTraits ;
+
+	enum {
+		Rows = BlockDims< BlockType, Transpose >::Rows,
+		Cols = BlockDims< BlockType, Transpose >::Cols,
+		ColMajor = ( !Traits::is_row_major ) != Transpose,
+		NRhs = RhsTraits::Columns
+	} ;
+
+	enum {
+		Value = Traits::uses_plain_array_storage
+			&& Rows == Cols && ( Rows == 2 || Rows == 3 )
+			&& ( NRhs == 1 || NRhs == 2 || NRhs == 4 || NRhs == 8 )
+			&& int( ResTraits::Columns ) == int( NRhs )
+			&& IsSame< Scalar, typename ResT::Scalar >::Value
+			&& ( IsSame< Scalar, BlockScalar >::Value
+			     || ( IsSame< Scalar, double >::Value && IsSame< BlockScalar, float >::Value ) )
+	} ;
+
+	typedef FixedBlockKernel< Rows, Cols, ColMajor, Scalar, NRhs, BlockScalar > Kernel ;
+	typedef typename Kernel::Stride Stride ;
+
+	//! Distance between two consecutive rows of \p vec
+	template < typename VecT >
+	static Stride rowStride( const VecT& vec )
+	{
+		return ( NRhs > 1 && DenseVectorTraits< VecT >::is_row_major ) ? vec.outerStride() : 1 ;
+	}
+	//! Distance between two consecutive columns of \p vec
+	template < typename VecT >
+	static Stride colStride( const VecT& vec )
+	{
+		return ( NRhs == 1 || DenseVectorTraits< VecT >::is_row_major ) ? 1 : vec.outerStride() ;
+	}
+} ;
+
+} //namespace mv_impl
+
+} //namespace bogus
+
+#endif
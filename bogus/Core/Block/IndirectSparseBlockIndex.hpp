@@ -0,0 +1,307 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+
+#ifndef BOGUS_INDIRECT_SPARSE_BLOCK_INDEX_HPP
+#define BOGUS_INDIRECT_SPARSE_BLOCK_INDEX_HPP
+
+#include "SparseBlockIndex.hpp"
+#include "../Utils/CppTools.hpp"
+
+namespace bogus
+{
+
+//! Compressed index with explicit block pointers
+/*!
+  Like the compressed SparseBlockIndex, inner vectors are stored contiguously and delimited by
+  an array of outer offsets ; however each entry also stores the pointer to its block,
+  so this index can reference blocks that are not stored in its own order ( e.g. the minor index
+  of a SparseBlockMatrixBase ).
+
+  Block pointers are stored using the \c Index type, so each entry uses \c 2*sizeof(Index) bytes,
+  and the whole index consists of two flat arrays.
+
+  \warning Insertion must be performed in order, and a call to \ref finalize() is required
+  once it is finished. setToTranspose() does not have this restriction.
+  */
+template< typename Index_, typename BlockPtr_ >
+struct IndirectSparseBlockIndex : public SparseBlockIndexBase< IndirectSparseBlockIndex< Index_, BlockPtr_ > >
+{
+	typedef Index_ Index ;
+	typedef BlockPtr_ BlockPtr ;
+
+	typedef SparseBlockIndexBase< IndirectSparseBlockIndex< Index_, BlockPtr_ > > Base ;
+	typedef typename Base::InnerOffsetsType InnerOffsetsType ;
+	typedef typename Base::InnerIterator    InnerIterator ;
+	using Base::valid ;
+
+	//! ( inner index ; block pointer ) tuple
+	typedef std::pair< Index, Index > Entry ;
+
+	typedef std::vector< Entry > Inner ;
+	typedef std::vector< Index > Outer ;
+
+	InnerOffsetsType innerOffsets ;
+
+	//! Vector of entries of all inner vectors
+	Inner inner ;
+	//! Vector encoding the start and end of inner vectors
+	Outer outer ;
+
+	IndirectSparseBlockIndex( )
+		: Base()
+	{}
+
+	void resizeOuter( Index size )
+	{
+		outer.assign( size+1, 0 ) ;
+	}
+	void reserve( Index nnz)
+	{
+		inner.reserve( nnz ) ;
+	}
+
+	Index outerSize( ) const { return outer.size() - 1 ; }
+	Index nonZeros() const { return inner.size() ; }
+
+	const InnerOffsetsType& innerOffsetsArray() const { return innerOffsets ; }
+
+	template < bool Ordered >
+	void insert( Index outIdx, Index inIdx, BlockPtr ptr )
+	{
+		BOGUS_STATIC_ASSERT( Ordered, UNORDERED_INSERTION_WITH_COMPRESSED_INDEX
+	 ) ;
+
+		valid &= ( 0 == outer[ outIdx+1 ] || inIdx > inner.back().first ) ;
+		++outer[ outIdx+1 ] ;
+		inner.push_back( Entry( inIdx, (Index) ptr ) ) ;
+	}
+	void insertBack( Index outIdx, Index inIdx, BlockPtr ptr )
+	{ insert< true >( outIdx, inIdx, ptr ) ; }
+
+	//! Finalizes the outer indices vector
+	/*! \sa SparseBlockIndex< true >::finalize() */
+	void finalize()
+	{
+		for( unsigned i = 1 ; i < outer.size() ; ++i )
+		{
+			outer[i] += outer[i-1] ;
+		}
+	}
+
+	void clear()
+	{
+		outer.assign( outer.size(), 0 ) ;
+		inner.clear() ;
+
+		valid = true ;
+	}
+
+	IndirectSparseBlockIndex &operator=( const IndirectSparseBlockIndex &o )
+	{
+		if( &o != this )
+		{
+			outer = o.outer ;
+			inner = o.inner ;
+			if( !o.innerOffsets.empty() )
+				innerOffsets = o.innerOffsets ;
+			valid = o.valid ;
+		}
+		return *this ;
+	}
+
+	template < typename SourceDerived >
+	IndirectSparseBlockIndex &operator=( const SparseBlockIndexBase< SourceDerived > &source )
+	{
+		resizeOuter( source.outerSize() ) ;
+		reserve( source.nonZeros() ) ;
+
+		inner.clear() ;
+		if( source.hasInnerOffsets() ) {
+			innerOffsets.resize( source.innerOffsetsArray().size() ) ;
+			std::copy( source.innerOffsetsArray().begin(), source.innerOffsetsArray().end(), innerOffsets.begin() ) ;
+		}
+		valid = source.valid ;
+
+		for( typename SourceDerived::Index i = 0 ; i < source.outerSize() ; ++i )
+		{
+			for( typename SourceDerived::InnerIterator it( source.derived(), i ) ;
+				 it ; ++ it )
+			{
+				insertBack( i, it.inner(), it.ptr() ) ;
+			}
+		}
+
+		finalize() ;
+
+		return *this ;
+	}
+
+	IndirectSparseBlockIndex & move( IndirectSparseBlockIndex &o )
+	{
+		if( &o != this )
+		{
+			inner.swap( o.inner );
+			outer.swap( o.outer );
+
+			if( !o.innerOffsets.empty() )
+				innerOffsets.swap( o.innerOffsets ) ;
+			valid = o.valid ;
+			o.valid = false ;
+		}
+		return *this ;
+	}
+
+	template < typename SourceDerived >
+	IndirectSparseBlockIndex &move( const SparseBlockIndexBase< SourceDerived > &source )
+	{
+		return ( *this = source ) ;
+	}
+
+	//! Sets this index to the transpose of \p source, using a counting sort over its inner indices
+	template < bool Symmetric, typename SourceDerived >
+	IndirectSparseBlockIndex& setToTranspose( const SparseBlockIndexBase< SourceDerived > &source )
+	{
+		const Index n = source.innerSize() ;
+
+		resizeOuter( n ) ;
+		valid = source.valid ;
+
+		// For a symmetric matrix, do not store diagonal block in col-major index
+		for( typename SourceDerived::Index i = 0 ; i < source.outerSize() ; ++i )
+		{
+			for( typename SourceDerived::InnerIterator it( source.derived(), i ) ;
+				 it && ( !Symmetric || it.inner() < i ) ; ++ it )
+			{
+				++outer[ it.inner() + 1 ] ;
+			}
+		}
+		finalize() ;
+
+		inner.resize( outer[ n ] ) ;
+		Outer cursor( outer.begin(), outer.end() - 1 ) ;
+
+		for( typename SourceDerived::Index i = 0 ; i < source.outerSize() ; ++i )
+		{
+			for( typename SourceDerived::InnerIterator it( source.derived(), i ) ;
+				 it && ( !Symmetric || it.inner() < i ) ; ++ it )
+			{
+				inner[ cursor[ it.inner() ]++ ] = Entry( i, (Index) it.ptr() ) ;
+			}
+		}
+
+		return *this ;
+	}
+
+	Index size( const Index outerIdx ) const
+	{
+		return  outer[ outerIdx + 1 ] - outer[ outerIdx ] ;
+	}
+
+	const Index* outerIndexPtr() const { return data_pointer(outer) ; }
+
+} ;
+
+template < typename Index_, typename BlockPtr_ >
+struct SparseBlockIndexTraits<  IndirectSparseBlockIndex< Index_, BlockPtr_ > >
+{
+	typedef Index_ Index;
+	typedef BlockPtr_ BlockPtr;
+
+	typedef IndirectSparseBlockIndex< Index_, BlockPtr_ > SparseBlockIndexType ;
+	typedef std::pair< Index, Index > Entry ;
+
+	//! Forward iterator
+	struct InnerIterator
+	{
+		// Warning: This class does not implement the full RandomAccessIterator concept ;
+		// only the operations that are required by std::lower_bound are implemented
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef Index                           value_type;
+		typedef std::ptrdiff_t                  difference_type;
+		typedef const Index*                    pointer;
+		typedef const Index&                    reference;
+
+		InnerIterator( ) : m_entries( BOGUS_NULL_PTR(const Entry) ) { }
+
+		InnerIterator( const SparseBlockIndexType& index, Index outer )
+			: m_it( index.outer[ outer ] ), m_end( index.outer[ outer + 1] ),
+			  m_entries( data_pointer( index.inner ) )
+		{
+		}
+
+		operator bool() const
+		{
+			return m_it != m_end ;
+		}
+
+		InnerIterator& operator++()
+		{
+			++ m_it ;
+			return *this ;
+		}
+		InnerIterator& operator--()
+		{
+			-- m_it ;
+			return *this ;
+		}
+
+		InnerIterator& operator+= ( const std::size_t n )
+		{
+			m_it = std::min( m_it + (Index) n, m_end ) ;
+			return *this ;
+		}
+
+		difference_type operator- ( const InnerIterator& other ) const
+		{
+			return ( (difference_type) m_it ) - ( difference_type ) other.m_it ;
+		}
+
+		bool operator< (const InnerIterator& other) const
+		{
+			return m_it < other.m_it;
+		}
+
+		Index operator* () const
+		{
+			return inner() ;
+		}
+
+		InnerIterator end() const
+		{
+			return InnerIterator( *this ).toEnd() ;
+		}
+
+		InnerIterator& toEnd()
+		{
+			m_it = m_end ;
+			return *this ;
+		}
+
+		bool after( Index outer ) const
+		{
+			return inner() > outer ;
+		}
+
+		Index inner() const { return m_entries[ m_it ].first ; }
+		BlockPtr ptr() const { return m_entries[ m_it ].second ; }
+
+	private:
+
+		Index m_it ;
+		Index m_end ;
+		const Entry* m_entries ;
+	} ;
+} ;
+
+} //namespace bogus
+
+
+#endif
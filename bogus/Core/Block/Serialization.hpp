@@ -25,7 +25,7 @@ struct version < bogus::SparseBlockIndex<true, Index, BlockPtr > >
 template < typename BlockT, int Flags >
 struct version < bogus::SparseBlockMatrix< BlockT, Flags > >
 {
-	enum { value = 1 };
+	enum { value = 2 };
 } ;
 
 template<typename Archive, typename Index, typename BlockPtr  >
@@ -58,6 +58,20 @@ inline void serialize(
 	ar & index.outer ;
 }
 
+template<typename Archive, typename Index, typename BlockPtr  >
+inline void serialize(
+       Archive & ar,
+       bogus::IndirectSparseBlockIndex< Index, BlockPtr > & index,
+       const unsigned int file_version
+   )
+{
+	(void) file_version ;
+	ar & index.valid ;
+	ar & index.innerOffsets ;
+	ar & index.inner ;
+	ar & index.outer ;
+}
+
 } //serialization
 } //boost
 
@@ -78,7 +92,14 @@ void SparseBlockMatrixBase< Derived >::serialize(
 	if( file_version == 0 )
 		ar & dummyNBlocks ;
 	ar & m_majorIndex ;
-	ar & m_minorIndex ;
+	if( file_version < 2 ) {
+		// Minor index used to be uncompressed
+		UncompressedIndexType minorIndex ;
+		if( Archive::is_saving::value ) minorIndex = m_minorIndex ;
+		ar & minorIndex ;
+		if( Archive::is_loading::value ) m_minorIndex = minorIndex ;
+	} else
+		ar & m_minorIndex ;
 	ar & m_transposeIndex ;
 
 	if( file_version == 0 ) {
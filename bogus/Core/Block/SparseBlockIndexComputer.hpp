@@ -23,7 +23,7 @@ template < typename Derived, bool Major >
 struct SparseBlockIndexGetter
 {
 	typedef SparseBlockMatrixBase< Derived > MatrixType ;
-	typedef typename MatrixType::UncompressedIndexType ReturnType ;
+	typedef typename MatrixType::MinorIndexType ReturnType ;
 
 	static ReturnType& get( MatrixType& matrix )
 	{
@@ -37,7 +37,7 @@ struct SparseBlockIndexGetter
 
 	static const ReturnType&
 	getOrCompute( const MatrixType& matrix,
-				  typename MatrixType::UncompressedIndexType& tempIndex
+				  typename MatrixType::MinorIndexType& tempIndex
 				  )
 	{
 		return matrix.getOrComputeMinorIndex( tempIndex ) ;
@@ -61,7 +61,7 @@ struct SparseBlockIndexGetter< Derived, true >
 
 	static const ReturnType&
 	getOrCompute( const MatrixType& matrix,
-				  typename MatrixType::UncompressedIndexType& )
+				  typename MatrixType::MinorIndexType& )
 	{
 		return matrix.majorIndex() ;
 	}
@@ -90,7 +90,7 @@ struct SparseBlockIndexComputer
 
 private:
 	const MatrixType& m_matrix ;
-	typename MatrixType::UncompressedIndexType m_aux ;
+	typename MatrixType::MinorIndexType m_aux ;
 } ;
 
 template < typename MatrixType, bool ColWise, bool Transpose >
@@ -55,6 +55,14 @@ struct BlockMatrixTraits< SparseBlockMatrix< BlockT, Flags > >
 
 } ;
 
+//! Solvers operate in double precision on matrices with the MIXED_PRECISION flag
+template < typename BlockT, int Flags >
+struct SolverScalar< SparseBlockMatrix< BlockT, Flags > >
+{
+	typedef typename TypeSwapIf< !!( Flags & flags::MIXED_PRECISION ),
+	        typename BlockTraits< BlockT >::Scalar, double >::First Type ;
+} ;
+
 //! Sparse Block Matrix
 /*!
   \tparam BlockT the type of the blocks of the matrix. Can be scalar, Eigen dense of sparse matrices,
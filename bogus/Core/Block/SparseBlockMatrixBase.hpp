@@ -18,6 +18,7 @@
 
 #include "SparseBlockIndex.hpp"
 #include "CompressedSparseBlockIndex.hpp"
+#include "IndirectSparseBlockIndex.hpp"
 
 #include "../Utils/CppTools.hpp"
 #include "../Utils/Lock.hpp"
@@ -58,9 +59,10 @@ public:
 	typedef SparseBlockIndex< false, Index, BlockPtr > UncompressedIndexType ;
 	typedef SparseBlockIndex<  true, Index, BlockPtr > CompressedIndexType ;
 
-	// Minor index is always uncompressed, as the blocks cannot be contiguous
+	// Minor index needs explicit block pointers, as the blocks cannot be contiguous ;
+	// it is still stored in flat arrays as it is always built at once
 	// For a symmetric matrix, it does not store diagonal block in the minor and transpose index
-	typedef UncompressedIndexType MinorIndexType ;
+	typedef IndirectSparseBlockIndex< Index, BlockPtr > MinorIndexType ;
 	// Transpose index is compressed for perf, as we always create it in a compressed-compatible way
 	typedef CompressedIndexType TransposeIndexType ;
 
@@ -389,6 +391,11 @@ public:
 	template < bool ColWise, typename LhsT, typename RhsT >
 	void setFromProduct( const Product< LhsT, RhsT > &prod ) ;
 
+	//! Sets this matrix to \p prod, reusing the product structure cached in \p plan when possible
+	/*! \sa SparseBlockProductPlan */
+	template < typename LhsT, typename RhsT >
+	Derived& setFromProduct( const Product< LhsT, RhsT > &prod, SparseBlockProductPlan< Derived > &plan ) ;
+
 	//! Performs *this *= alpha
 	Derived& scale( Scalar alpha ) ;
 
@@ -532,6 +539,11 @@ protected:
 
 	void computeMinorIndex( MinorIndexType &cmIndex) const ;
 
+	//! Numeric phase of setFromProduct(), and symbolic phase if \p computeIndex is true
+	template < bool ColWise, typename Prod, typename LhsMatrixT, typename RhsMatrixT, typename ProductIndexT >
+	void evalProduct( const Prod &prod, const LhsMatrixT &lhs, const RhsMatrixT &rhs,
+	                  ProductIndexT &productIndex, bool computeIndex ) ;
+
 	const MinorIndexType& getOrComputeMinorIndex( MinorIndexType &tempIndex) const ;
 
 	ColIndexType& colMajorIndex() ;
@@ -285,8 +285,9 @@ template < typename Derived >
 template < typename OtherDerived >
 void SparseBlockMatrixBase<Derived>::cloneStructure( const SparseBlockMatrixBase< OtherDerived > &source )
 {
-	BOGUS_STATIC_ASSERT( static_cast<unsigned>(BlockMatrixTraits< Derived >::flags)
-	                     == static_cast< unsigned >(BlockMatrixTraits< OtherDerived >::flags),
+	// MIXED_PRECISION does not affect the structure
+	BOGUS_STATIC_ASSERT( ( static_cast<unsigned>(BlockMatrixTraits< Derived >::flags) & ~flags::MIXED_PRECISION )
+	                     == ( static_cast< unsigned >(BlockMatrixTraits< OtherDerived >::flags) & ~flags::MIXED_PRECISION ),
 	                     OPERANDS_HAVE_INCONSISTENT_FLAGS ) ;
 
 	rowMajorIndex() = source.rowMajorIndex() ;
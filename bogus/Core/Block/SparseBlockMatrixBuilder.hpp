@@ -0,0 +1,258 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2016 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+
+#ifndef BOGUS_SPARSE_BLOCK_MATRIX_BUILDER_HPP
+#define BOGUS_SPARSE_BLOCK_MATRIX_BUILDER_HPP
+
+#include "SparseBlockMatrixBase.hpp"
+
+#include "../Utils/Executor.hpp"
+
+#include <vector>
+#include <algorithm>
+
+namespace bogus
+{
+
+//! Thread-safe assembly of a SparseBlockMatrixBase from blocks inserted in any order
+/*!
+  Blocks are inserted concurrently into per-thread buffers, without any locking ;
+  finalize() then merges them with a counting sort on the outer index, and moves them into the
+  destination matrix so that its blocks are laid out contiguously in index order.
+  The destination may thus use a compressed index, even though insertion was unordered.
+
+  \code
+  SparseBlockMatrixBuilder< HType > builder ;
+  #pragma omp parallel for
+  for( int i = 0 ; i < n ; ++i )
+      builder.insert( i, obj[i] ) = ... ;
+
+  H.setRows( ... ) ;
+  H.setCols( ... ) ;
+  builder.finalize( H ) ;
+  \endcode
+
+  \warning Each block should be inserted at most once, and for symmetric matrices only blocks
+  of the lower triangular part should be inserted.
+  Concurrent insertions must be performed from OpenMP threads whose number does not exceed
+  the one given to the constructor.
+  */
+template < typename MatrixT >
+class SparseBlockMatrixBuilder
+{
+public:
+	typedef BlockMatrixTraits< MatrixT > Traits ;
+	typedef typename Traits::Index Index ;
+	typedef typename Traits::BlockType BlockType ;
+	typedef typename Traits::BlockPtr BlockPtr ;
+
+	//! Constructor
+	/*! \param nThreads Maximum number of threads that may call insert() concurrently.
+	  Defaults to the current maximum number of OpenMP threads */
+	explicit SparseBlockMatrixBuilder( int nThreads = 0 )
+	{
+#ifndef BOGUS_DONT_PARALLELIZE
+		if( nThreads <= 0 ) nThreads = omp_get_max_threads() ;
+#else
+		nThreads = 1 ;
+#endif
+		m_buffers.resize( nThreads ) ;
+	}
+
+	//! Reserves space for \p nBlocks blocks, assuming they will be evenly distributed between threads
+	void reserve( std::size_t nBlocks )
+	{
+		const std::size_t perThread = ( nBlocks + m_buffers.size() - 1 ) / m_buffers.size() ;
+		for( std::size_t t = 0 ; t < m_buffers.size() ; ++t )
+		{
+			m_buffers[t].entries.reserve( perThread ) ;
+			m_buffers[t].blocks.reserve( perThread ) ;
+		}
+	}
+
+	//! Inserts a block, and returns a reference to it
+	/*! Thread-safe. The reference is invalidated by the next call to insert() from the same thread. */
+	BlockType& insert( Index row, Index col )
+	{
+		Buffer& buf = m_buffers[ currentThread() ] ;
+
+		if( Traits::is_col_major )
+			buf.entries.push_back( Entry( col, row ) ) ;
+		else
+			buf.entries.push_back( Entry( row, col ) ) ;
+		buf.blocks.resize( buf.blocks.size() + 1 ) ;
+
+		return buf.blocks.back() ;
+	}
+
+	//! Number of blocks that have been inserted so far
+	std::size_t nBlocks() const
+	{
+		std::size_t n = 0 ;
+		for( std::size_t t = 0 ; t < m_buffers.size() ; ++t )
+			n += m_buffers[t].entries.size() ;
+		return n ;
+	}
+
+	//! Discards all inserted blocks
+	void clear()
+	{
+		for( std::size_t t = 0 ; t < m_buffers.size() ; ++t )
+		{
+			m_buffers[t].entries.clear() ;
+			m_buffers[t].blocks.clear() ;
+		}
+	}
+
+	//! Moves the inserted blocks into \p matrix, and finalizes it
+	/*! The dimensions of \p matrix must have been set using setRows() and setCols() ;
+	  its previous blocks are discarded. The builder is left empty. */
+	void finalize( SparseBlockMatrixBase< MatrixT >& matrix )
+	{
+		const Index outerSize = matrix.majorIndex().outerSize() ;
+
+		// Counting sort on the outer index
+		std::vector< BlockPtr > offsets( outerSize + 1, 0 ) ;
+		std::size_t totalNonZeros = 0 ;
+		for( std::size_t t = 0 ; t < m_buffers.size() ; ++t )
+		{
+			const Buffer& buf = m_buffers[t] ;
+			for( std::size_t k = 0 ; k < buf.entries.size() ; ++k )
+			{
+				const Entry& e = buf.entries[k] ;
+				assert( e.outer < outerSize ) ;
+				++offsets[ e.outer + 1 ] ;
+
+				const Index row = Traits::is_col_major ? e.inner : e.outer ;
+				const Index col = Traits::is_col_major ? e.outer : e.inner ;
+				totalNonZeros += matrix.blockRows( row ) * matrix.blockCols( col ) ;
+			}
+		}
+		for( Index i = 0 ; i < outerSize ; ++i )
+			offsets[i+1] += offsets[i] ;
+
+		std::vector< Source > sources( offsets[ outerSize ] ) ;
+		{
+			std::vector< BlockPtr > cursor( offsets.begin(), offsets.end() - 1 ) ;
+			for( std::size_t t = 0 ; t < m_buffers.size() ; ++t )
+			{
+				const Buffer& buf = m_buffers[t] ;
+				for( std::size_t k = 0 ; k < buf.entries.size() ; ++k )
+				{
+					Source& src = sources[ cursor[ buf.entries[k].outer ]++ ] ;
+					src.inner  = buf.entries[k].inner ;
+					src.thread = t ;
+					src.block  = k ;
+				}
+			}
+		}
+
+		parallel_for( 0, outerSize, SortTask( offsets, sources ) ) ;
+
+		// Index, in final order
+		matrix.clear() ;
+		matrix.derived().reserve( sources.size(), totalNonZeros ) ;
+		for( Index i = 0 ; i < outerSize ; ++i )
+		{
+			for( BlockPtr k = offsets[i] ; k < offsets[i+1] ; ++k )
+			{
+				matrix.template insertByOuterInner< true >( i, sources[k].inner ) ;
+			}
+		}
+
+		// Block data
+		parallel_for( 0, sources.size(), CopyTask( m_buffers, sources, matrix ) ) ;
+
+		matrix.finalize() ;
+		clear() ;
+	}
+
+private:
+
+	struct Entry
+	{
+		Index outer ;
+		Index inner ;
+
+		Entry( Index o, Index i ) : outer( o ), inner( i ) {}
+	} ;
+
+	struct Buffer
+	{
+		std::vector< Entry > entries ;
+		typename ResizableSequenceContainer< BlockType >::Type blocks ;
+
+		// Avoids false sharing between the buffers of different threads
+		char padding[ 64 ] ;
+	} ;
+
+	//! Location of a sorted block in the per-thread buffers
+	struct Source
+	{
+		Index inner ;
+		std::size_t thread ;
+		std::size_t block ;
+
+		bool operator< ( const Source& o ) const { return inner < o.inner ; }
+	} ;
+
+	struct SortTask : public RangeTask
+	{
+		SortTask( const std::vector< BlockPtr >& offsets_, std::vector< Source >& sources_ )
+			: offsets( offsets_ ), sources( sources_ )
+		{}
+
+		void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+		{
+			for( std::ptrdiff_t i = begin ; i < end ; ++i )
+				std::sort( sources.begin() + offsets[i], sources.begin() + offsets[i+1] ) ;
+		}
+
+		const std::vector< BlockPtr >& offsets ;
+		std::vector< Source >& sources ;
+	} ;
+
+	struct CopyTask : public RangeTask
+	{
+		CopyTask( const std::vector< Buffer >& buffers_, const std::vector< Source >& sources_,
+		          SparseBlockMatrixBase< MatrixT >& matrix_ )
+			: buffers( buffers_ ), sources( sources_ ), matrix( matrix_ )
+		{}
+
+		void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+		{
+			for( std::ptrdiff_t k = begin ; k < end ; ++k )
+			{
+				const Source& src = sources[k] ;
+				matrix.block( (BlockPtr) k ) = buffers[ src.thread ].blocks[ src.block ] ;
+			}
+		}
+
+		const std::vector< Buffer >& buffers ;
+		const std::vector< Source >& sources ;
+		SparseBlockMatrixBase< MatrixT >& matrix ;
+	} ;
+
+	static int currentThread()
+	{
+#ifndef BOGUS_DONT_PARALLELIZE
+		return omp_get_thread_num() ;
+#else
+		return 0 ;
+#endif
+	}
+
+	std::vector< Buffer > m_buffers ;
+} ;
+
+} //namespace bogus
+
+#endif
@@ -0,0 +1,262 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+
+#ifndef BOGUS_SPARSE_BLOCK_PRODUCT_INDEX_HPP
+#define BOGUS_SPARSE_BLOCK_PRODUCT_INDEX_HPP
+
+#include "CompressedSparseBlockIndex.hpp"
+
+#include <vector>
+#include <algorithm>
+
+#ifndef BOGUS_DONT_PARALLELIZE
+#include <omp.h>
+#endif
+
+namespace bogus
+{
+
+namespace mm_impl
+{
+
+// A block-block product
+template < typename Index_, typename BlockPtr >
+struct SparseBlockProductTerm
+{
+	typedef Index_ Index ;
+	Index index ;			//Inner index in product matrix
+
+	BlockPtr lhsPtr ;
+	BlockPtr rhsPtr ;
+	bool 	 lhsIsAfterDiag ;
+	bool 	 rhsIsAfterDiag ;
+
+	SparseBlockProductTerm(
+	        Index idx,
+	        BlockPtr lPtr, BlockPtr rPtr,
+	        bool lIAD, bool rIAD
+	        )
+	    : index( idx ),
+	      lhsPtr( lPtr ), rhsPtr( rPtr ),
+	      lhsIsAfterDiag( lIAD ), rhsIsAfterDiag( rIAD )
+	{}
+
+	// Ordering so all terms for a single final block are consecutive
+	bool operator< ( const SparseBlockProductTerm& rhs ) const
+	{
+		return index < rhs.index ;
+	}
+
+} ;
+
+// Block structure computation using row-major startegy (deprecated)
+template < bool ColWise, typename Index, typename BlockPtr, bool is_symmetric, bool is_col_major >
+struct SparseBlockProductIndex
+{
+	typedef SparseBlockProductTerm<Index, BlockPtr>  Term ;
+
+	typedef std::vector< Term > InnerType;
+	std::vector< InnerType > to_compute ;
+
+	typedef SparseBlockIndex< true, Index, BlockPtr > CompressedIndexType ;
+	CompressedIndexType compressed ;
+
+	template< typename LhsIndex, typename RhsIndex >
+	void compute(
+	        const Index outerSize,
+	        const Index innerSize,
+	        const LhsIndex &lhsIdx,
+	        const RhsIndex &rhsIdx )
+	{
+		assert( lhsIdx.innerSize() == rhsIdx.innerSize() ) ;
+
+		to_compute.resize( outerSize ) ;
+
+#ifndef BOGUS_DONT_PARALLELIZE
+		SparseBlockIndex< false, Index, BlockPtr > uncompressed ;
+		uncompressed.resizeOuter( outerSize ) ;
+#else
+		compressed.resizeOuter( outerSize ) ;
+#endif
+
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for
+#endif
+		for( Index i = 0 ; i < outerSize ; ++i )
+		{
+			const Index last = is_symmetric ? i+1 : innerSize ;
+			for( Index j = 0 ; j != last ; ++ j )
+			{
+				bool nonZero = false ;
+
+				const Index lhsOuter = is_col_major ? j : i ;
+				const Index rhsOuter = is_col_major ? i : j ;
+				typename LhsIndex::InnerIterator lhs_it ( lhsIdx, lhsOuter ) ;
+				typename RhsIndex::InnerIterator rhs_it ( rhsIdx, rhsOuter ) ;
+
+				while( lhs_it && rhs_it )
+				{
+					if( lhs_it.inner() > rhs_it.inner() ) ++rhs_it ;
+					else if( lhs_it.inner() < rhs_it.inner() ) ++lhs_it ;
+					else {
+						to_compute[i].push_back(
+						            Term( j, lhs_it.ptr(), rhs_it.ptr(),
+						                  lhs_it.after( lhsOuter ), rhs_it.after( rhsOuter ) ) ) ;
+						nonZero = true ;
+						++lhs_it ;
+						++rhs_it ;
+					}
+				}
+
+				if( nonZero )
+				{
+#ifndef BOGUS_DONT_PARALLELIZE
+					uncompressed.insertBack( i, j, 0 ) ;
+#else
+					compressed.insertBack( i, j, 0 ) ;
+#endif
+				}
+			}
+		}
+
+#ifndef BOGUS_DONT_PARALLELIZE
+		compressed = uncompressed ;
+#else
+		compressed.finalize() ;
+#endif
+
+	}
+} ;
+
+// Block structure computation using col-major strategy
+// (Using less conditionals, as it does not have to compare inner indices in the tighter loop)
+template < typename Index, typename BlockPtr, bool is_symmetric, bool is_col_major >
+struct SparseBlockProductIndex< true, Index, BlockPtr, is_symmetric, is_col_major >
+{
+	typedef SparseBlockProductTerm<Index, BlockPtr>  Term ;
+
+	typedef std::vector< Term > InnerType;
+	std::vector< InnerType > to_compute ;
+
+	typedef SparseBlockIndex< true, Index, BlockPtr > CompressedIndexType ;
+	CompressedIndexType compressed ;
+
+
+	template< typename LhsIndex, typename RhsIndex >
+	void compute(
+	        const Index outerSize,
+	        const Index innerSize,
+	        const LhsIndex &lhsIdx,
+	        const RhsIndex &rhsIdx )
+	{
+		assert( lhsIdx.outerSize() == rhsIdx.outerSize() ) ;
+		( void ) innerSize ;
+
+		const Index productSize = lhsIdx.outerSize() ;
+
+		to_compute.resize( outerSize ) ;
+		compressed.resizeOuter( outerSize ) ;
+
+
+#ifdef BOGUS_DONT_PARALLELIZE
+		std::vector< InnerType >& loc_compute = to_compute ;
+#else
+
+		std::vector< std::vector< InnerType > > temp_compute ;
+
+
+#pragma omp parallel
+		{
+
+#pragma omp	master
+			{
+				temp_compute.resize( omp_get_num_threads() )  ;
+			}
+#pragma omp barrier
+
+			std::vector< InnerType >& loc_compute = temp_compute[ omp_get_thread_num() ] ;
+			loc_compute.resize( outerSize ) ;
+
+#pragma omp for
+#endif
+			for( Index i = 0 ; i < productSize ; ++i )
+			{
+				if( is_col_major )
+				{
+					for( typename RhsIndex::InnerIterator rhs_it ( rhsIdx, i ) ; rhs_it ; ++rhs_it )
+					{
+						for( typename LhsIndex::InnerIterator lhs_it ( lhsIdx, i ) ;
+						     lhs_it && ( !is_symmetric || lhs_it.inner() <= rhs_it.inner() ) ;
+						     ++lhs_it )
+						{
+							loc_compute[ rhs_it.inner() ].push_back(
+							            Term( (Index) lhs_it.inner(),
+							                  lhs_it.ptr(), rhs_it.ptr(),
+							                  lhs_it.after( i ), rhs_it.after( i ) ) )  ;
+						}
+					}
+				} else {
+					for( typename LhsIndex::InnerIterator lhs_it ( lhsIdx, i ) ; lhs_it ; ++lhs_it )
+					{
+						for( typename RhsIndex::InnerIterator rhs_it ( rhsIdx, i ) ;
+						     rhs_it && ( !is_symmetric || rhs_it.inner() <= lhs_it.inner() ) ;
+						     ++rhs_it )
+						{
+							loc_compute[ lhs_it.inner() ].push_back(
+							            Term( (Index) rhs_it.inner(),
+							                  lhs_it.ptr(), rhs_it.ptr(),
+							                  lhs_it.after( i ), rhs_it.after( i ) ) )  ;
+						}
+					}
+				}
+			}
+
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp for
+			for( Index i = 0 ; i < outerSize ; ++i )
+			{
+				for( int t = 0 ; t < (int) temp_compute.size() ; ++t )
+				{
+					const std::vector< InnerType >& loc_compute = temp_compute[ t ] ;
+					to_compute[i].insert( to_compute[i].end(), loc_compute[i].begin(), loc_compute[i].end() ) ;
+				}
+				std::sort( to_compute[i].begin(), to_compute[i].end() ) ;
+			}
+		}
+#endif
+
+		for( Index i = 0 ; i < outerSize ; ++i )
+		{
+#ifdef BOGUS_DONT_PARALLELIZE
+			std::sort( to_compute[i].begin(), to_compute[i].end() ) ;
+#endif
+			Index prevIndex = -1 ;
+			for( std::size_t j = 0 ; j != to_compute[i].size() ; ++j )
+			{
+				if( to_compute[i][j].index != prevIndex )
+				{
+					prevIndex = to_compute[i][j].index ;
+					compressed.insertBack( i, prevIndex, 0 );
+				}
+			}
+		}
+
+		compressed.finalize() ;
+
+	}
+
+} ;
+
+} //namespace mm_impl
+
+} //namespace bogus
+
+#endif
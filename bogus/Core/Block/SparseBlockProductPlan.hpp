@@ -0,0 +1,170 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+
+#ifndef BOGUS_SPARSE_BLOCK_PRODUCT_PLAN_HPP
+#define BOGUS_SPARSE_BLOCK_PRODUCT_PLAN_HPP
+
+#include "SparseBlockMatrixBase.hpp"
+#include "SparseBlockProductIndex.hpp"
+
+#include <vector>
+
+namespace bogus
+{
+
+//! Sparsity pattern of a SparseBlockMatrixBase, used to detect structural changes
+/*! Stores the block sizes and the ( inner index, block pointer ) pairs of the major index */
+template < typename Index, typename BlockPtr >
+struct SparseBlockPattern
+{
+	typedef std::pair< Index, BlockPtr > Entry ;
+
+	std::vector< Index > rowOffsets ;
+	std::vector< Index > colOffsets ;
+	std::vector< Index > outer ;
+	std::vector< Entry > entries ;
+
+	void clear()
+	{
+		rowOffsets.clear() ;
+		colOffsets.clear() ;
+		outer.clear() ;
+		entries.clear() ;
+	}
+
+	template < typename MatrixT >
+	void set( const SparseBlockMatrixBase< MatrixT >& matrix )
+	{
+		typedef typename SparseBlockMatrixBase< MatrixT >::MajorIndexType MajorIndexType ;
+		const MajorIndexType& index = matrix.majorIndex() ;
+
+		rowOffsets.assign( matrix.rowOffsets(), matrix.rowOffsets() + matrix.rowsOfBlocks() + 1 ) ;
+		colOffsets.assign( matrix.colOffsets(), matrix.colOffsets() + matrix.colsOfBlocks() + 1 ) ;
+
+		outer.resize( index.outerSize() + 1 ) ;
+		entries.clear() ;
+		entries.reserve( matrix.nBlocks() ) ;
+
+		outer[0] = 0 ;
+		for( Index i = 0 ; i < (Index) index.outerSize() ; ++i )
+		{
+			for( typename MajorIndexType::InnerIterator it( index, i ) ; it ; ++it )
+			{
+				entries.push_back( Entry( (Index) it.inner(), (BlockPtr) it.ptr() ) ) ;
+			}
+			outer[i+1] = entries.size() ;
+		}
+	}
+
+	//! Returns whether \p matrix has the exact same pattern as the one recorded by set()
+	template < typename MatrixT >
+	bool matches( const SparseBlockMatrixBase< MatrixT >& matrix ) const
+	{
+		typedef typename SparseBlockMatrixBase< MatrixT >::MajorIndexType MajorIndexType ;
+		const MajorIndexType& index = matrix.majorIndex() ;
+
+		if( outer.empty() || (Index) index.outerSize() + 1 != (Index) outer.size()
+		        || (Index) matrix.rowsOfBlocks() + 1 != (Index) rowOffsets.size()
+		        || (Index) matrix.colsOfBlocks() + 1 != (Index) colOffsets.size()
+		        || !std::equal( rowOffsets.begin(), rowOffsets.end(), matrix.rowOffsets() )
+		        || !std::equal( colOffsets.begin(), colOffsets.end(), matrix.colOffsets() ) )
+			return false ;
+
+		for( Index i = 0 ; i < (Index) index.outerSize() ; ++i )
+		{
+			Index k = outer[i] ;
+			for( typename MajorIndexType::InnerIterator it( index, i ) ; it ; ++it, ++k )
+			{
+				if( k == outer[i+1] || entries[k].first != (Index) it.inner()
+				        || entries[k].second != (BlockPtr) it.ptr() )
+					return false ;
+			}
+			if( k != outer[i+1] )
+				return false ;
+		}
+
+		return true ;
+	}
+} ;
+
+//! Cached symbolic structure of the product of two sparse block matrices
+/*!
+	The symbolic phase of a sparse block matrix product ( determining the non-zero blocks of
+	the result and the list of block products that contribute to each of them ) is usually
+	much more expensive than the numeric phase. When products of matrices with an unchanging
+	sparsity pattern have to be evaluated repeatedly, such as the Delassus operator \f$ H M^{-1} H^T \f$
+	between consecutive time-steps, a SparseBlockProductPlan can be used to only compute this
+	symbolic phase once :
+	\code
+	SparseBlockProductPlan< WType > plan ;
+	W.setFromProduct( H * MInvHt, plan ) ; // Computes and stores the product structure
+	...
+	W.setFromProduct( H * MInvHt, plan ) ; // Only recomputes the blocks, as long as
+	                                       // the patterns of H and MInvHt are unchanged
+	\endcode
+
+	Before each evaluation, the sparsity patterns of both operands are compared to the ones
+	of the previous evaluation ; the symbolic phase is performed again if they differ.
+
+	\tparam MatrixT the type of the product result
+	\sa SparseBlockMatrixBase::setFromProduct()
+*/
+template < typename MatrixT >
+class SparseBlockProductPlan
+{
+public:
+	typedef BlockMatrixTraits< MatrixT > Traits ;
+	typedef typename Traits::Index Index ;
+	typedef typename Traits::BlockPtr BlockPtr ;
+
+	typedef mm_impl::SparseBlockProductIndex< true, Index, BlockPtr,
+	        Traits::is_symmetric, Traits::is_col_major > ProductIndex ;
+
+	SparseBlockProductPlan()
+		: m_valid( false ), m_reused( false )
+	{}
+
+	//! Drops the cached structure, forcing a new symbolic phase at the next evaluation
+	void clear()
+	{
+		m_valid = false ;
+		m_reused = false ;
+		m_lhsPattern.clear() ;
+		m_rhsPattern.clear() ;
+		m_productIndex = ProductIndex() ;
+	}
+
+	//! Whether a product structure has been computed
+	bool valid() const { return m_valid ; }
+
+	//! Whether the last evaluation could reuse the cached product structure
+	bool reused() const { return m_reused ; }
+
+	const ProductIndex& productIndex() const { return m_productIndex ; }
+
+private:
+	template < typename Derived >
+	friend class SparseBlockMatrixBase ;
+
+	typedef SparseBlockPattern< Index, BlockPtr > Pattern ;
+
+	bool m_valid ;
+	bool m_reused ;
+
+	Pattern m_lhsPattern ;
+	Pattern m_rhsPattern ;
+
+	ProductIndex m_productIndex ;
+} ;
+
+} //namespace bogus
+
+#endif
@@ -15,9 +15,12 @@
 #include "SparseBlockMatrixBase.hpp"
 #include "Expressions.hpp"
 #include "Access.hpp"
+#include "FixedBlockKernels.hpp"
 
 #include "SparseBlockIndexComputer.hpp"
 
+#include "../Utils/Executor.hpp"
+
 namespace bogus {
 
 namespace mv_impl {
@@ -31,10 +34,84 @@ void scale_vector( ResT& res, const Scalar beta )
 		res *= beta ;
 }
 
+template < bool DoTranspose, typename Matrix, typename RhsT, typename ResT, typename Scalar >
+inline void mv_add_pre( const Matrix& matrix, const RhsT& rhs, ResT& res, Scalar alpha ) ;
+
+//! Generic block/vector products, through the block type's own operators
+template < bool UseFixedKernel >
+struct BlockVectorMultiplier
+{
+	template < bool DoTranspose, typename Matrix, typename RhsT, typename ResT, typename Scalar >
+	static inline void add_pre( const Matrix& matrix, const RhsT& rhs, ResT& res, Scalar alpha )
+	{
+		res.noalias() += TransposeIf< DoTranspose >::get( matrix ) * ( alpha * rhs ) ;
+	}
+
+	template < bool Transpose, typename BlockType, typename BlocksT,typename IndexT, typename RhsT, typename ResT, typename ScalarT >
+	static inline void innerRowMultiply( const BlocksT& blocks, const IndexT &index,
+	                                     const typename IndexT::Index outerIdx, const RhsT& rhs, ResT& res, ScalarT alpha )
+	{
+		const Segmenter< BlockDims< BlockType, Transpose >::Cols, const RhsT, typename IndexT::Index >
+		        segmenter( rhs, index.innerOffsetsData() ) ;
+
+		for( typename IndexT::InnerIterator it( index, outerIdx ) ; it ; ++ it )
+		{
+			if( alpha.has_element(it.inner()) ) {
+				mv_add_pre< Transpose >( blocks[ it.ptr() ], segmenter[ it.inner() ], res, alpha[ it.inner() ] ) ;
+			}
+		}
+	}
+} ;
+
+//! Block/vector products using the FixedBlockKernel matching the block type
+template < >
+struct BlockVectorMultiplier< true >
+{
+	template < bool DoTranspose, typename Matrix, typename RhsT, typename ResT, typename Scalar >
+	static inline void add_pre( const Matrix& matrix, const RhsT& rhs, ResT& res, Scalar alpha )
+	{
+		typedef FixedBlockKernelSelector< Matrix, DoTranspose, RhsT, ResT > Selector ;
+		typedef typename Selector::Kernel Kernel ;
+
+		typename Kernel::Accumulator acc ;
+		Kernel::init( acc ) ;
+		Kernel::add( acc, data_pointer( matrix ), rhs.data(),
+		             Selector::rowStride( rhs ), Selector::colStride( rhs ), alpha ) ;
+		Kernel::store( acc, res.data(), Selector::rowStride( res ), Selector::colStride( res ) ) ;
+	}
+
+	template < bool Transpose, typename BlockType, typename BlocksT,typename IndexT, typename RhsT, typename ResT, typename ScalarT >
+	static inline void innerRowMultiply( const BlocksT& blocks, const IndexT &index,
+	                                     const typename IndexT::Index outerIdx, const RhsT& rhs, ResT& res, ScalarT alpha )
+	{
+		typedef FixedBlockKernelSelector< BlockType, Transpose, RhsT, ResT > Selector ;
+		typedef typename Selector::Kernel Kernel ;
+
+		const typename Selector::Scalar* rhsData = rhs.data() ;
+		const typename Selector::Stride rhsRowStride = Selector::rowStride( rhs ) ;
+		const typename Selector::Stride rhsColStride = Selector::colStride( rhs ) ;
+
+		typename Kernel::Accumulator acc ;
+		Kernel::init( acc ) ;
+
+		for( typename IndexT::InnerIterator it( index, outerIdx ) ; it ; ++ it )
+		{
+			if( alpha.has_element(it.inner()) ) {
+				Kernel::add( acc, data_pointer( blocks[ it.ptr() ] ),
+				             rhsData + Selector::Cols * it.inner() * rhsRowStride,
+				             rhsRowStride, rhsColStride, alpha[ it.inner() ] ) ;
+			}
+		}
+
+		Kernel::store( acc, res.data(), Selector::rowStride( res ), Selector::colStride( res ) ) ;
+	}
+} ;
+
 template < bool DoTranspose, typename Matrix, typename RhsT, typename ResT, typename Scalar >
 inline void mv_add_pre( const Matrix& matrix, const RhsT& rhs, ResT& res, Scalar alpha )
 {
-	res.noalias() += TransposeIf< DoTranspose >::get( matrix ) * ( alpha * rhs ) ;
+	BlockVectorMultiplier< FixedBlockKernelSelector< Matrix, DoTranspose, RhsT, ResT >::Value >
+	        ::template add_pre< DoTranspose >( matrix, rhs, res, alpha ) ;
 }
 
 template < bool DoTranspose, typename Matrix, typename RhsT, typename ResT, typename Scalar >
@@ -47,15 +124,8 @@ template < bool Transpose, typename BlockType, typename BlocksT,typename IndexT,
 static inline void innerRowMultiply( const BlocksT& blocks, const IndexT &index,
                             const typename IndexT::Index outerIdx, const RhsT& rhs, ResT& res, ScalarT alpha )
 {
-	const Segmenter< BlockDims< BlockType, Transpose >::Cols, const RhsT, typename IndexT::Index >
-	        segmenter( rhs, index.innerOffsetsData() ) ;
-
-	for( typename IndexT::InnerIterator it( index, outerIdx ) ; it ; ++ it )
-	{
-		if( alpha.has_element(it.inner()) ) {
-			mv_add_pre< Transpose >( blocks[ it.ptr() ], segmenter[ it.inner() ], res, alpha[ it.inner() ] ) ;
-		}
-	}
+	BlockVectorMultiplier< FixedBlockKernelSelector< BlockType, Transpose, RhsT, ResT >::Value >
+	        ::template innerRowMultiply< Transpose, BlockType >( blocks, index, outerIdx, rhs, res, alpha ) ;
 }
 
 template < bool Transpose, typename BlockType, typename BlocksT, typename IndexT, typename RhsT, typename ResT, typename ScalarT >
@@ -74,78 +144,249 @@ static inline void innerColMultiply( const BlocksT& blocks, const IndexT &index,
 	}
 }
 
-//! Implementation for non-symmetric, in order matrix/vector products
-template < bool Symmetric, bool NativeOrder, bool Transpose >
-struct SparseBlockMatrixVectorMultiplier
+// Parallel tasks
+
+//! Products with the rows of the major index
+template < bool Transpose >
+struct MajorRowsKernel
 {
 	template < typename Derived, typename RhsT, typename ResT, typename ScalarT >
-	static void multiply( const SparseBlockMatrixBase< Derived >& matrix,  const RhsT& rhs, ResT& res, ScalarT alpha )
+	static void apply( const SparseBlockMatrixBase< Derived >& matrix, typename Derived::Index i,
+	                   const RhsT& rhs, ResT& res, ScalarT alpha )
 	{
-		const int ResSegDim = BlockDims< typename Derived::BlockType, Transpose >::Rows ;
-		typedef Segmenter< ResSegDim, ResT, typename Derived::Index > ResSegmenter ;
-		ResSegmenter resSegmenter( res, matrix.minorIndex().innerOffsetsData() ) ;
+		innerRowMultiply< Transpose, typename Derived::BlockType >
+		        ( matrix.blocks(), matrix.majorIndex(), i, rhs, res, make_constant_array(alpha) ) ;
+	}
+} ;
 
-#ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp parallel for
-#endif
-		for( typename Derived::Index i = 0 ; i < (typename Derived::Index) matrix.majorIndex().outerSize() ; ++i )
+//! Products with the rows of the cached transpose index
+struct TransposeRowsKernel
+{
+	template < typename Derived, typename RhsT, typename ResT, typename ScalarT >
+	static void apply( const SparseBlockMatrixBase< Derived >& matrix, typename Derived::Index i,
+	                   const RhsT& rhs, ResT& res, ScalarT alpha )
+	{
+		innerRowMultiply< false, typename Derived::TransposeBlockType >
+		        ( matrix.transposeBlocks(), matrix.transposeIndex(), i, rhs, res, make_constant_array(alpha) ) ;
+	}
+} ;
+
+//! Products with the full rows of a symmetric matrix, using the cached transpose index
+template < bool ColMajor >
+struct SymmetricTransposeRowsKernel
+{
+	template < typename Derived, typename RhsT, typename ResT, typename ScalarT >
+	static void apply( const SparseBlockMatrixBase< Derived >& matrix, typename Derived::Index i,
+	                   const RhsT& rhs, ResT& res, ScalarT alpha )
+	{
+		innerRowMultiply< ColMajor, typename Derived::BlockType >
+		        ( matrix.blocks(), matrix.majorIndex(), i, rhs, res, make_constant_array(alpha) ) ;
+		innerRowMultiply< ColMajor, typename Derived::TransposeBlockType >
+		        ( matrix.transposeBlocks(), matrix.transposeIndex(), i, rhs, res, make_constant_array(alpha) ) ;
+	}
+} ;
+
+//! Products with the full rows of a symmetric matrix, using the minor index
+template < bool ColMajor >
+struct SymmetricMinorRowsKernel
+{
+	template < typename Derived, typename RhsT, typename ResT, typename ScalarT >
+	static void apply( const SparseBlockMatrixBase< Derived >& matrix, typename Derived::Index i,
+	                   const RhsT& rhs, ResT& res, ScalarT alpha )
+	{
+		innerRowMultiply< ColMajor, typename Derived::BlockType >
+		        ( matrix.blocks(), matrix.majorIndex(), i, rhs, res, make_constant_array(alpha) ) ;
+		innerRowMultiply< !ColMajor, typename Derived::BlockType >
+		        ( matrix.blocks(), matrix.minorIndex(), i, rhs, res, make_constant_array(alpha) ) ;
+	}
+} ;
+
+//! Applies a row kernel to a range of segments of the result vector
+template < typename Kernel, int SegDim, typename Derived, typename RhsT, typename ResT, typename ScalarT >
+struct RowsMultiplyTask : public RangeTask
+{
+	typedef typename Derived::Index Index ;
+
+	RowsMultiplyTask( const SparseBlockMatrixBase< Derived >& matrix_, const RhsT& rhs_, ResT& res_,
+	                  const Index* offsets_, ScalarT alpha_ )
+	    : matrix( matrix_ ), rhs( rhs_ ), res( res_ ), offsets( offsets_ ), alpha( alpha_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		typedef Segmenter< SegDim, ResT, Index > ResSegmenter ;
+		ResSegmenter resSegmenter( res, offsets ) ;
+
+		for( Index i = begin ; i < (Index) end ; ++i )
+		{
+			typename ResSegmenter::ReturnType seg( resSegmenter[ i ] ) ;
+			Kernel::apply( matrix, i, rhs, seg, alpha ) ;
+		}
+	}
+
+	const SparseBlockMatrixBase< Derived >& matrix ;
+	const RhsT& rhs ;
+	ResT& res ;
+	const Index* offsets ;
+	const ScalarT alpha ;
+} ;
+
+template < typename Kernel, int SegDim, typename Derived, typename RhsT, typename ResT, typename ScalarT >
+void multiply_rows( const SparseBlockMatrixBase< Derived >& matrix, const RhsT& rhs, ResT& res,
+                    const typename Derived::Index* offsets, typename Derived::Index nRows, ScalarT alpha )
+{
+	const RowsMultiplyTask< Kernel, SegDim, Derived, RhsT, ResT, ScalarT > task( matrix, rhs, res, offsets, alpha ) ;
+	parallel_for( 0, nRows, task ) ;
+}
+
+//! Accumulates the contributions of a range of rows into per-worker result vectors
+/*! Local vectors are only allocated for the workers that actually run a chunk */
+template < typename Derived, typename LocalResT >
+struct ReductTask : public RangeTask
+{
+	ReductTask( typename Derived::Index rows_, typename Derived::Index cols_ )
+	    : locals( executor().nWorkers(), BOGUS_NULL_PTR( LocalResT ) ), rows( rows_ ), cols( cols_ )
+	{}
+
+	~ReductTask()
+	{
+		for( std::size_t w = 0 ; w < locals.size() ; ++w )
+			delete locals[w] ;
+	}
+
+	LocalResT& local( int worker ) const
+	{
+		LocalResT* &locRes = locals[ worker ] ;
+		if( !locRes ) {
+			locRes = new LocalResT( rows, cols ) ;
+			locRes->setZero() ;
+		}
+		return *locRes ;
+	}
+
+	template < typename ResT >
+	void reduce( ResT& res ) const
+	{
+		for( std::size_t w = 0 ; w < locals.size() ; ++w )
 		{
-			typename ResSegmenter::ReturnType seg = resSegmenter[ i ] ;
-			innerRowMultiply< Transpose, typename Derived::BlockType >
-			        ( matrix.blocks(), matrix.majorIndex(), i, rhs, seg, make_constant_array(alpha) ) ;
+			if( locals[w] )
+				res += *locals[w] ;
 		}
 	}
 
+	mutable std::vector< LocalResT* > locals ;
+	const typename Derived::Index rows ;
+	const typename Derived::Index cols ;
 
+private:
+	ReductTask( const ReductTask& ) ;
+	ReductTask& operator=( const ReductTask& ) ;
 } ;
 
-//! Implementation for symmetric products
-template < bool NativeOrder, bool Transpose >
-struct SparseBlockMatrixVectorMultiplier< true, NativeOrder, Transpose >
+//! Symmetric products using only the stored half of the matrix
+template < bool Transpose, typename Derived, typename RhsT, typename LocalResT, typename ScalarT >
+struct SymmetricReductTask : public ReductTask< Derived, LocalResT >
 {
-#ifndef BOGUS_DONT_PARALLELIZE
-	template < typename Derived, typename RhsT, typename ResT, typename LocalResT, typename ScalarT >
-	static void multiplyAndReduct( const SparseBlockMatrixBase< Derived >& matrix,  const RhsT& rhs, ResT& res, const LocalResT&, ScalarT alpha )
+	typedef ReductTask< Derived, LocalResT > Base ;
+
+	SymmetricReductTask( const SparseBlockMatrixBase< Derived >& matrix_, const RhsT& rhs_,
+	                     typename Derived::Index rows_, typename Derived::Index cols_, ScalarT alpha_ )
+	    : Base( rows_, cols_ ), matrix( matrix_ ), rhs( rhs_ ), alpha( alpha_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int worker ) const
 	{
 		const int SegDim = BlockDims< typename Derived::BlockType, Transpose >::Rows ;
-
 		typedef Segmenter< SegDim, LocalResT, typename Derived::Index > ResSegmenter ;
 		typedef Segmenter< SegDim, const RhsT, typename Derived::Index > RhsSegmenter ;
-		const RhsSegmenter rhsSegmenter( rhs, matrix.majorIndex().innerOffsetsData() ) ;
-
-		const Lock& lock = matrix.lock();
-
 		typedef typename SparseBlockMatrixBase< Derived >::MajorIndexType MajorIndexType ;
-#pragma omp parallel
-		{
-			LocalResT locRes( res.rows(), res.cols() ) ;
-			locRes.setZero() ;
+		enum { ColMajor = BlockMatrixTraits< Derived >::is_col_major } ;
 
-			ResSegmenter resSegmenter( locRes, matrix.minorIndex().innerOffsetsData() ) ;
+		const RhsSegmenter rhsSegmenter( rhs, matrix.majorIndex().innerOffsetsData() ) ;
+		ResSegmenter resSegmenter( Base::local( worker ), matrix.minorIndex().innerOffsetsData() ) ;
 
-#pragma omp for
-			for( typename Derived::Index i = 0 ; i < matrix.majorIndex().outerSize() ; ++i )
+		for( typename Derived::Index i = begin ; i < (typename Derived::Index) end ; ++i )
+		{
+			typename RhsSegmenter::ConstReturnType rhs_seg( rhsSegmenter[ i ] ) ;
+			typename ResSegmenter::ReturnType res_seg(resSegmenter[ i ] ) ;
+			for( typename MajorIndexType::InnerIterator it( matrix.majorIndex(), i ) ;
+			     it ; ++ it )
 			{
-				typename RhsSegmenter::ConstReturnType rhs_seg( rhsSegmenter[ i ] ) ;
-				typename ResSegmenter::ReturnType res_seg(resSegmenter[ i ] ) ;
-				for( typename MajorIndexType::InnerIterator it( matrix.majorIndex(), i ) ;
-				     it ; ++ it )
-				{
-					const typename Derived::BlockType &b = matrix.block( it.ptr() ) ;
-					mv_add_pre< false >( b, rhsSegmenter[ it.inner() ], res_seg, alpha ) ;
-					if( it.inner() != i ) {
-						typename ResSegmenter::ReturnType inner_res_seg(resSegmenter[ it.inner() ] ) ;
-						mv_add_pre< true >( b, rhs_seg, inner_res_seg, alpha ) ;
-					}
+				const typename Derived::BlockType &b = matrix.block( it.ptr() ) ;
+				mv_add_pre< ColMajor >( b, rhsSegmenter[ it.inner() ], res_seg, alpha ) ;
+				if( it.inner() != i ) {
+					typename ResSegmenter::ReturnType inner_res_seg(resSegmenter[ it.inner() ] ) ;
+					mv_add_pre< !ColMajor >( b, rhs_seg, inner_res_seg, alpha ) ;
 				}
 			}
+		}
+	}
 
-			{
-				Lock::Guard<> guard( lock ) ;
-				res += locRes ;
-			}
+	const SparseBlockMatrixBase< Derived >& matrix ;
+	const RhsT& rhs ;
+	const ScalarT alpha ;
+} ;
+
+//! Out-of-order products, scattering the contributions of each column of the major index
+template < bool Transpose, typename Derived, typename RhsT, typename LocalResT, typename ScalarT >
+struct OutOfOrderReductTask : public ReductTask< Derived, LocalResT >
+{
+	typedef ReductTask< Derived, LocalResT > Base ;
+
+	OutOfOrderReductTask( const SparseBlockMatrixBase< Derived >& matrix_, const RhsT& rhs_,
+	                      typename Derived::Index rows_, typename Derived::Index cols_, ScalarT alpha_ )
+	    : Base( rows_, cols_ ), matrix( matrix_ ), rhs( rhs_ ), alpha( alpha_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int worker ) const
+	{
+		const int RhsSegDim = BlockDims< typename Derived::BlockType, Transpose >::Cols ;
+		typedef Segmenter< RhsSegDim, const RhsT, typename Derived::Index > RhsSegmenter ;
+		const RhsSegmenter rhsSegmenter( rhs, matrix.minorIndex().innerOffsetsData() ) ;
+
+		LocalResT& locRes = Base::local( worker ) ;
+
+		for( typename Derived::Index i = begin ; i < (typename Derived::Index) end ; ++i )
+		{
+			innerColMultiply< Transpose, typename Derived::BlockType >( matrix.blocks(), matrix.majorIndex(), i, rhsSegmenter[i], locRes, make_constant_array(alpha) ) ;
 		}
 	}
+
+	const SparseBlockMatrixBase< Derived >& matrix ;
+	const RhsT& rhs ;
+	const ScalarT alpha ;
+} ;
+
+//! Implementation for non-symmetric, in order matrix/vector products
+template < bool Symmetric, bool NativeOrder, bool Transpose >
+struct SparseBlockMatrixVectorMultiplier
+{
+	template < typename Derived, typename RhsT, typename ResT, typename ScalarT >
+	static void multiply( const SparseBlockMatrixBase< Derived >& matrix,  const RhsT& rhs, ResT& res, ScalarT alpha )
+	{
+		const int ResSegDim = BlockDims< typename Derived::BlockType, Transpose >::Rows ;
+		multiply_rows< MajorRowsKernel< Transpose >, ResSegDim >
+		        ( matrix, rhs, res, matrix.minorIndex().innerOffsetsData(), matrix.majorIndex().outerSize(), alpha ) ;
+	}
+
+
+} ;
+
+//! Implementation for symmetric products
+template < bool NativeOrder, bool Transpose >
+struct SparseBlockMatrixVectorMultiplier< true, NativeOrder, Transpose >
+{
+#ifndef BOGUS_DONT_PARALLELIZE
+	template < typename Derived, typename RhsT, typename ResT, typename LocalResT, typename ScalarT >
+	static void multiplyAndReduct( const SparseBlockMatrixBase< Derived >& matrix,  const RhsT& rhs, ResT& res, const LocalResT&, ScalarT alpha )
+	{
+		typedef SymmetricReductTask< Transpose, Derived, RhsT, LocalResT, ScalarT > Task ;
+
+		const Task task( matrix, rhs, res.rows(), res.cols(), alpha ) ;
+		parallel_for( 0, matrix.majorIndex().outerSize(), task ) ;
+
+		task.reduce( res ) ;
+	}
 #endif
 
 	template < typename Derived, typename RhsT, typename ResT, typename ScalarT >
@@ -153,28 +394,22 @@ struct SparseBlockMatrixVectorMultiplier< true, NativeOrder, Transpose >
 	{
 		const int SegDim = BlockDims< typename Derived::BlockType, Transpose >::Rows ;
 
-		typedef Segmenter< SegDim, ResT, typename Derived::Index > ResSegmenter ;
-		ResSegmenter resSegmenter( res, matrix.minorIndex().innerOffsetsData() ) ;
-		typedef Segmenter< SegDim, const RhsT, typename Derived::Index > RhsSegmenter ;
-		const RhsSegmenter rhsSegmenter( rhs, matrix.majorIndex().innerOffsetsData() ) ;
+		// As the matrix is symmetric, Transpose is irrelevant ;
+		// only the storage order decides whether stored blocks have to be transposed
+		enum { ColMajor = BlockMatrixTraits< Derived >::is_col_major } ;
 
-		typedef typename Derived::Index Index ;
 		if( matrix.transposeIndex().valid )
 		{
-#ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp parallel for
-#endif
-			for( Index i = 0 ; i < matrix.majorIndex().outerSize() ; ++i )
-			{
-				typename ResSegmenter::ReturnType seg( resSegmenter[ i ] ) ;
-				innerRowMultiply< false, typename Derived::BlockType >
-				        ( matrix.blocks(), matrix.majorIndex(), i, rhs, seg, make_constant_array(alpha) ) ;
-				innerRowMultiply< false, typename Derived::TransposeBlockType >
-				        ( matrix.transposeBlocks(), matrix.transposeIndex(), i, rhs, seg, make_constant_array(alpha) ) ;
-			}
+			multiply_rows< SymmetricTransposeRowsKernel< ColMajor >, SegDim >
+			        ( matrix, rhs, res, matrix.minorIndex().innerOffsetsData(), matrix.majorIndex().outerSize(), alpha ) ;
 		} else {
 #ifdef BOGUS_DONT_PARALLELIZE
-			for( Index i = 0 ; i < matrix.majorIndex().outerSize() ; ++i )
+			typedef Segmenter< SegDim, ResT, typename Derived::Index > ResSegmenter ;
+			ResSegmenter resSegmenter( res, matrix.minorIndex().innerOffsetsData() ) ;
+			typedef Segmenter< SegDim, const RhsT, typename Derived::Index > RhsSegmenter ;
+			const RhsSegmenter rhsSegmenter( rhs, matrix.majorIndex().innerOffsetsData() ) ;
+
+			for( typename Derived::Index i = 0 ; i < matrix.majorIndex().outerSize() ; ++i )
 			{
 				typename RhsSegmenter::ConstReturnType rhs_seg( rhsSegmenter[ i ] ) ;
 				typename ResSegmenter::ReturnType      res_seg( resSegmenter[ i ] ) ;
@@ -182,16 +417,24 @@ struct SparseBlockMatrixVectorMultiplier< true, NativeOrder, Transpose >
 				     it ; ++ it )
 				{
 					const typename Derived::BlockType &b = matrix.block( it.ptr() ) ;
-					mv_add_pre< false >( b, rhsSegmenter[ it.inner() ], res_seg, alpha ) ;
+					mv_add_pre< ColMajor >( b, rhsSegmenter[ it.inner() ], res_seg, alpha ) ;
 					if( it.inner() != i )
 					{
 						typename ResSegmenter::ReturnType inner_res_seg(resSegmenter[ it.inner() ] ) ;
-						mv_add_pre< true >( b, rhs_seg, inner_res_seg, alpha ) ;
+						mv_add_pre< !ColMajor >( b, rhs_seg, inner_res_seg, alpha ) ;
 					}
 				}
 			}
 #else
-			multiplyAndReduct( matrix, rhs, res, get_mutable_vector( res ), alpha ) ;
+			if( matrix.minorIndex().valid )
+			{
+				// Each thread only writes to the result segments of the rows it owns ;
+				// transpose contributions are gathered through the ( strictly upper ) minor index
+				multiply_rows< SymmetricMinorRowsKernel< ColMajor >, SegDim >
+				        ( matrix, rhs, res, matrix.minorIndex().innerOffsetsData(), matrix.majorIndex().outerSize(), alpha ) ;
+			} else {
+				multiplyAndReduct( matrix, rhs, res, get_mutable_vector( res ), alpha ) ;
+			}
 #endif
 		}
 	}
@@ -206,30 +449,12 @@ struct OutOfOrderSparseBlockMatrixVectorMultiplier
 	template < typename Derived, typename RhsT, typename ResT, typename LocalResT, typename ScalarT >
 	static void multiplyAndReduct( const SparseBlockMatrixBase< Derived >& matrix,  const RhsT& rhs, ResT& res, const LocalResT&, ScalarT alpha )
 	{
-		typedef typename Derived::Index Index ;
-
-		const int RhsSegDim = BlockDims< typename Derived::BlockType, Transpose >::Cols ;
-		typedef Segmenter< RhsSegDim, const RhsT, Index > RhsSegmenter ;
-		const RhsSegmenter rhsSegmenter( rhs, matrix.minorIndex().innerOffsetsData() ) ;
-
-		const Lock& lock = matrix.lock();
-
-#pragma omp parallel
-		{
-			LocalResT locRes( res.rows(), res.cols() ) ;
-			locRes.setZero() ;
+		typedef OutOfOrderReductTask< Transpose, Derived, RhsT, LocalResT, ScalarT > Task ;
 
-#pragma omp for
-			for( Index i = 0 ; i < matrix.majorIndex().outerSize() ; ++i )
-			{
-				innerColMultiply< Transpose, typename Derived::BlockType >( matrix.blocks(), matrix.majorIndex(), i, rhsSegmenter[i], locRes, make_constant_array(alpha) ) ;
-			}
+		const Task task( matrix, rhs, res.rows(), res.cols(), alpha ) ;
+		parallel_for( 0, matrix.majorIndex().outerSize(), task ) ;
 
-			{
-				Lock::Guard<> guard( lock ) ;
-				res += locRes ;
-			}
-		}
+		task.reduce( res ) ;
 	}
 #endif
 
@@ -273,18 +498,8 @@ struct SparseBlockMatrixVectorMultiplier< false, false, true >
 		if( matrix.transposeIndex().valid )
 		{
 			const int ResSegDim = BlockDims< typename Derived::BlockType, true >::Rows ;
-			typedef Segmenter< ResSegDim, ResT, typename Derived::Index > ResSegmenter ;
-			ResSegmenter resSegmenter( res, matrix.majorIndex().innerOffsetsData() ) ;
-
-#ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp parallel for
-#endif
-			for( typename Derived::Index i = 0 ; i < matrix.transposeIndex().outerSize() ; ++i )
-			{
-				typename ResSegmenter::ReturnType seg( resSegmenter[ i ] ) ;
-				innerRowMultiply< false, typename Derived::TransposeBlockType >
-				        ( matrix.transposeBlocks(), matrix.transposeIndex(), i, rhs, seg, make_constant_array(alpha) ) ;
-			}
+			multiply_rows< TransposeRowsKernel, ResSegDim >
+			        ( matrix, rhs, res, matrix.majorIndex().innerOffsetsData(), matrix.transposeIndex().outerSize(), alpha ) ;
 		} else {
 			Base::multiply( matrix, rhs, res, alpha ) ;
 		}
@@ -18,6 +18,13 @@ namespace bogus {
 template< typename Derived >
 struct BlockMatrixTraits { } ;
 
+//! Scalar type of the vectors and local problems of the solvers operating on a \p MatrixType
+/*! Defaults to the scalar type of the matrix. \sa flags::MIXED_PRECISION */
+template< typename MatrixType >
+struct SolverScalar {
+	typedef typename BlockMatrixTraits< MatrixType >::Scalar Type ;
+} ;
+
 //! Default container type, that should resizable and use contiguous storage
 template< typename ElementType >
 struct ResizableSequenceContainer {
@@ -59,6 +66,19 @@ struct BlockTransposeTraits {} ;
 template< typename VectorType >
 struct BlockVectorProductTraits {} ;
 
+//! Memory layout of dense vectors and multi-vectors ( i.e. blocks of right-hand sides )
+/*! Specializations should set Columns to the number of columns known at compile time for types whose
+	coefficients can be accessed through a data() method with a unit inner stride, and provide an
+	outerStride() method when Columns > 1. Allows the use of the fixed-size block kernels
+	for matrix-vector products */
+template< typename VectorType >
+struct DenseVectorTraits {
+	enum {
+		Columns = 0,       //!< Number of columns, or 0 if the type is not supported
+		is_row_major = 0   //!< Whether consecutive coefficients belong to the same row
+	} ;
+} ;
+
 //! Defines the return type of the product of two blocks potentially transposed
 template< typename LhsBlockType, typename RhsBlockType, bool TransposeLhs, bool TransposeRhs >
 struct BlockBlockProductTraits {
@@ -24,7 +24,11 @@ enum Method
 	BiCGSTAB, 		//!< BiConjugate Gradient Stabilized \sa krylov::solvers::BiCGSTAB
 	CGS, 			//!< Conjugate Gradient Squared \sa krylov::solvers::CGS
 	GMRES,			//!< Generalized Minimal Residual \sa krylov::solvers::GMRES
-	TFQMR			//!< Tranpose-free Quasi Minimal Residual \sa krylov::solvers::TFQMR
+	TFQMR,			//!< Tranpose-free Quasi Minimal Residual \sa krylov::solvers::TFQMR
+	PipelinedCG,		//!< Pipelined Conjugate Gradient \sa krylov::solvers::PipelinedCG
+	ChronopoulosGearCG,	//!< Single-reduction Conjugate Gradient \sa krylov::solvers::ChronopoulosGearCG
+	BlockCG,		//!< Block Conjugate Gradient, for multiple rhs \sa krylov::solvers::BlockCG
+	BlockGMRES		//!< Block Generalized Minimal Residual, for multiple rhs \sa krylov::solvers::BlockGMRES
 } ;
 
 } //namespace krylov
@@ -46,6 +50,17 @@ enum Variant {
 } ;
 } //namespace projected_gradient
 
+//! Options for InteriorPoint solvers
+namespace interior_point {
+//! Solvers for the Newton systems
+enum LinearSolver {
+	//! Sparse Cholesky factorization \sa SparseBlockCholesky
+	Cholesky,
+	//! Conjugate Gradient with a block-diagonal LDLT preconditioner
+	ConjugateGradient
+} ;
+} //namespace interior_point
+
 template < typename MatrixType >
 struct ProblemTraits ;
 
@@ -67,6 +82,18 @@ class ADMM ;
 template < typename BlockMatrixType >
 class DualAMA ;
 
+template < typename BlockMatrixType >
+class SparseBlockCholesky ;
+
+template < typename BlockMatrixType >
+class SemismoothNewton ;
+
+template < typename BlockMatrixType >
+class InteriorPoint ;
+
+template < typename BlockMatrixType >
+class MultilevelGaussSeidel ;
+
 template < typename MatrixType >
 class TrivialPreconditioner ;
 
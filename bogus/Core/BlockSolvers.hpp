@@ -19,6 +19,11 @@
 #include "BlockSolvers/Krylov.hpp"
 #include "BlockSolvers/ProjectedGradient.hpp"
 #include "BlockSolvers/ADMM.hpp"
+#include "BlockSolvers/Reordering.hpp"
+#include "BlockSolvers/SparseCholesky.hpp"
+#include "BlockSolvers/SemismoothNewton.hpp"
+#include "BlockSolvers/InteriorPoint.hpp"
+#include "BlockSolvers/MultilevelGaussSeidel.hpp"
 
 #include "BlockSolvers/LCPLaw.hpp"
 
@@ -18,6 +18,11 @@
 #include "BlockSolvers/ProjectedGradient.impl.hpp"
 #include "BlockSolvers/ADMM.impl.hpp"
 #include "BlockSolvers/Krylov.impl.hpp"
+#include "BlockSolvers/Reordering.impl.hpp"
+#include "BlockSolvers/SparseCholesky.impl.hpp"
+#include "BlockSolvers/SemismoothNewton.impl.hpp"
+#include "BlockSolvers/InteriorPoint.impl.hpp"
+#include "BlockSolvers/MultilevelGaussSeidel.impl.hpp"
 
 #include "BlockSolvers/LCPLaw.impl.hpp"
 
@@ -112,6 +112,7 @@ protected:
 	using Base::m_matrix ;
 	using Base::m_maxIters ;
 	using Base::m_tol ;
+	using Base::m_stats ;
 
 	Scalar m_stepSize ;
 
@@ -295,6 +296,7 @@ protected:
 	using Base::m_matrix ;
 	using Base::m_maxIters ;
 	using Base::m_tol ;
+	using Base::m_stats ;
 
 	Scalar m_fpStepSize ;
 	Scalar m_projStepSize ;
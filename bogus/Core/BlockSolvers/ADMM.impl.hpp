@@ -66,6 +66,8 @@ ADMM< BlockMatrixType >::solve(
         const RhsT &w, ResT &x, ResT &r ) const
 {
 
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
+
 	const Scalar lambda = op.coefficient() ;
 	const Scalar gamma  = stepSize() ; // gamma/(lambda*lambda)
 	const Scalar inv_gamma = 1./ gamma ;
@@ -106,6 +108,7 @@ ADMM< BlockMatrixType >::solve(
 		            ? (ut-z).template lpNorm< Eigen::Infinity >()
 		            : (ut-z).squaredNorm() / (1 + ut.rows() ) ) ;
 		        ;
+		BOGUS_STATS( if( m_stats ) ++m_stats->iterations ; )
 		this->callback().trigger( adIter, res );
 
 		if( res < this->tol() )
@@ -196,6 +199,8 @@ DualAMA< BlockMatrixType>::solveWithLinearConstraints(
 {
 	typedef typename GlobalProblemTraits::DynVector DynVec ;
 
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
+
 	Scalar lambda = projStepSize() ;
 	const Scalar gamma  = fpStepSize() ;
 
@@ -248,6 +253,7 @@ DualAMA< BlockMatrixType>::solveWithLinearConstraints(
 			         : g2.squaredNorm() / (1 + g2.rows() ) )
 			        ;
 
+		BOGUS_STATS( if( m_stats ) ++m_stats->iterations ; )
 		this->callback().trigger( adIter, res );
 
 		if( res < min_res || adIter == 0 ) {
@@ -30,7 +30,7 @@ class BlockSolverBase
 {
 public:
 	typedef BlockMatrixTraits< BlockMatrixType > BlockTraits ;
-	typedef typename BlockTraits::Scalar Scalar ;
+	typedef typename SolverScalar< BlockMatrixType >::Type Scalar ;
 	typedef ProblemTraits< Scalar > GlobalProblemTraits ;
 	typedef Signal< unsigned, Scalar > CallBackType ;
 
@@ -13,17 +13,37 @@
 
 #include "../Block.fwd.hpp"
 
+#include <vector>
+
 namespace bogus {
 
+struct RowGraph ;
+
 //! Coloring algorithm to determine which rows of a matrix can be treated in parallel
-/*! Computes a permutation of the rows indices so that they become contiguous for each color */
+/*! Computes a permutation of the rows indices so that they become contiguous for each color.
+
+	Each color is processed in parallel, with a synchronization barrier between two consecutive colors.
+	Using few colors, and avoiding colors with fewer rows than threads, therefore reduces the
+	synchronization overhead. \sa setAlgorithm(), setBalancing()
+*/
 struct Coloring {
+
+	//! Algorithm used to assign a color to each row
+	enum Algorithm {
+		//! Sequential first-fit greedy coloring, in the order of the rows
+		Greedy,
+		//! Parallel Jones-Plassmann coloring with pseudo-random row priorities.
+		//! Deterministic, regardless of the number of threads
+		JonesPlassmann
+	} ;
+
 	//! Computed permuation so that each color is contiguous
 	std::vector< std::size_t > 	  permutation ;
 	//! Index of first row for each color
 	std::vector< std::ptrdiff_t > colors ;
 
 	Coloring()
+		: m_algorithm( Greedy ), m_balancing( 0 )
 	{}
 
 	//! Computes a coloring for \p matrix, or simply reset it if \p enable is false
@@ -32,6 +52,29 @@ struct Coloring {
 
 	std::size_t size() const { return permutation.size() ; }
 
+	//! Number of colors of the current coloring
+	std::size_t nColors() const { return colors.empty() ? 0 : colors.size() - 1 ; }
+
+	//! Number of rows of the color \p c
+	std::size_t colorSize( std::size_t c ) const { return colors[ c+1 ] - colors[ c ] ; }
+
+	//! Computes the histogram of color sizes
+	/*! \p histogram[k] is set to the number of colors having between \f$ 2^k \f$ and \f$ 2^{k+1} - 1 \f$ rows */
+	void sizeHistogram( std::vector< std::size_t > &histogram ) const ;
+
+	//! Sets the algorithm used by update(). Defaults to Greedy.
+	void setAlgorithm( Algorithm algorithm ) { m_algorithm = algorithm ; }
+	Algorithm algorithm() const { return m_algorithm ; }
+
+	//! Enables color balancing for \p nThreads threads ( 0 disables balancing, which is the default )
+	/*!
+		Rows of colors that have fewer than \p nThreads rows are moved to other colors whenever possible,
+		so as to remove such colors ; then rows of the largest colors are moved to the smallest ones
+		until every color has about the same number of rows.
+	 */
+	void setBalancing( unsigned nThreads ) { m_balancing = nThreads ; }
+	unsigned balancing() const { return m_balancing ; }
+
 	//! Sets the permutation to the identity. Keep the current colors.
 	void resetPermutation( )
 	{
@@ -59,6 +102,16 @@ private:
 
 	template < typename Derived >
 	void compute( const BlockMatrixBase< Derived >& matrix ) ;
+
+	static std::ptrdiff_t computeGreedy( const RowGraph& graph, std::vector< std::ptrdiff_t > &rowColors ) ;
+	static std::ptrdiff_t computeJonesPlassmann( const RowGraph& graph, std::vector< std::ptrdiff_t > &rowColors ) ;
+	static std::ptrdiff_t balance( const RowGraph& graph, std::ptrdiff_t nColors, std::size_t nThreads,
+	                               std::vector< std::ptrdiff_t > &rowColors ) ;
+
+	void setFromRowColors( const std::vector< std::ptrdiff_t > &rowColors, std::ptrdiff_t nColors ) ;
+
+	Algorithm m_algorithm ;
+	unsigned m_balancing ;
 } ;
 
 }
@@ -13,64 +13,334 @@
 
 #include "Coloring.hpp"
 
-#include "../Block/SparseBlockMatrixBase.hpp"
+#include "RowGraph.hpp"
+
+#include "../Utils/Executor.hpp"
+
+#include <algorithm>
 
 namespace bogus {
 
+namespace coloring_impl {
+
+// Pseudo-random priority of a row for the Jones-Plassmann algorithm
+inline unsigned priority( std::ptrdiff_t row )
+{
+	unsigned x = static_cast< unsigned >( row ) ;
+	x = ( ( x >> 16 ) ^ x ) * 0x45d9f3bu ;
+	x = ( ( x >> 16 ) ^ x ) * 0x45d9f3bu ;
+	return ( x >> 16 ) ^ x ;
+}
+
+// Whether \p row1 should be colored before \p row2
+inline bool precedes( std::ptrdiff_t row1, std::ptrdiff_t row2 )
+{
+	const unsigned p1 = priority( row1 ), p2 = priority( row2 ) ;
+	return p1 > p2 || ( p1 == p2 && row1 > row2 ) ;
+}
+
+// Returns the first color which is not used by any neighbour of \p row
+// marks should be of size maxDegree+1 and never have contained \p row before
+inline std::ptrdiff_t first_free_color( const RowGraph& graph, const std::vector< std::ptrdiff_t > &rowColors,
+                                         const std::ptrdiff_t row, std::vector< std::ptrdiff_t > &marks )
+{
+	const std::ptrdiff_t nMarks = marks.size() ;
+	for( std::ptrdiff_t k = graph.offsets[ row ] ; k != graph.offsets[ row+1 ] ; ++k )
+	{
+		const std::ptrdiff_t c = rowColors[ graph.neighbours[ k ] ] ;
+		if( c >= 0 && c < nMarks ) marks[ c ] = row ;
+	}
+
+	std::ptrdiff_t c = 0 ;
+	while( marks[ c ] == row ) ++c ;
+	return c ;
+}
+
+struct SizeComparator
+{
+	const std::vector< std::ptrdiff_t > &sizes ;
+
+	explicit SizeComparator( const std::vector< std::ptrdiff_t > &s ) : sizes( s ) {}
+
+	bool operator()( std::ptrdiff_t c1, std::ptrdiff_t c2 ) const
+	{ return sizes[ c1 ] < sizes[ c2 ] ; }
+} ;
+
+// Selects the remaining rows that precede all their uncolored neighbours
+struct SelectTask : public RangeTask
+{
+	SelectTask( const RowGraph& graph_, const std::vector< std::ptrdiff_t > &rowColors_,
+	            const std::vector< std::ptrdiff_t > &remaining_, std::vector< unsigned char > &selected_ )
+	    : graph( graph_ ), rowColors( rowColors_ ), remaining( remaining_ ), selected( selected_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		for( std::ptrdiff_t k = begin ; k < end ; ++k )
+		{
+			const std::ptrdiff_t i = remaining[k] ;
+			unsigned char ok = 1 ;
+			for( std::ptrdiff_t e = graph.offsets[ i ] ; ok && e != graph.offsets[ i+1 ] ; ++e )
+			{
+				const std::ptrdiff_t j = graph.neighbours[ e ] ;
+				if( rowColors[ j ] < 0 && precedes( j, i ) )
+					ok = 0 ;
+			}
+			selected[k] = ok ;
+		}
+	}
+
+	const RowGraph& graph ;
+	const std::vector< std::ptrdiff_t > &rowColors ;
+	const std::vector< std::ptrdiff_t > &remaining ;
+	std::vector< unsigned char > &selected ;
+} ;
+
+// Colors the selected rows ; as they form an independent set, they can be processed concurrently
+struct ColorTask : public RangeTask
+{
+	ColorTask( const RowGraph& graph_, std::vector< std::ptrdiff_t > &rowColors_,
+	           const std::vector< std::ptrdiff_t > &remaining_, const std::vector< unsigned char > &selected_ )
+	    : graph( graph_ ), rowColors( rowColors_ ), remaining( remaining_ ), selected( selected_ ),
+	      maxDegree( graph.maxDegree() )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		std::vector< std::ptrdiff_t > marks( maxDegree + 1, -1 ) ;
+
+		for( std::ptrdiff_t k = begin ; k < end ; ++k )
+		{
+			if( !selected[k] ) continue ;
+
+			const std::ptrdiff_t i = remaining[k] ;
+			rowColors[i] = first_free_color( graph, rowColors, i, marks ) ;
+		}
+	}
+
+	const RowGraph& graph ;
+	std::vector< std::ptrdiff_t > &rowColors ;
+	const std::vector< std::ptrdiff_t > &remaining ;
+	const std::vector< unsigned char > &selected ;
+	const std::ptrdiff_t maxDegree ;
+} ;
+
+} //namespace coloring_impl
+
 template < typename Derived >
 void Coloring::compute( const SparseBlockMatrixBase< Derived >& matrix )
 {
+	RowGraph graph ;
+	graph.setFrom( matrix ) ;
+
+	std::vector< std::ptrdiff_t > rowColors ;
+	std::ptrdiff_t nColors = m_algorithm == JonesPlassmann
+	        ? computeJonesPlassmann( graph, rowColors )
+	        : computeGreedy( graph, rowColors ) ;
+
+	if( m_balancing > 0 )
+		nColors = balance( graph, nColors, m_balancing, rowColors ) ;
 
-	// Affects each contact to the first color with which it does not have any interaction
+	setFromRowColors( rowColors, nColors ) ;
+}
+
+inline std::ptrdiff_t Coloring::computeGreedy( const RowGraph& graph, std::vector< std::ptrdiff_t > &rowColors )
+{
+	// Affects each row to the first color with which it does not have any interaction
 	// This is not optimimal, but optimality would be costly
 
-	const std::ptrdiff_t n = static_cast< std::ptrdiff_t >( matrix.rowsOfBlocks() ) ;
+	const std::ptrdiff_t n = graph.size() ;
+	rowColors.assign( n, -1 ) ;
+
+	std::vector< std::ptrdiff_t > marks( graph.maxDegree() + 1, -1 ) ;
+
+	std::ptrdiff_t nColors = 0 ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		rowColors[i] = coloring_impl::first_free_color( graph, rowColors, i, marks ) ;
+		nColors = std::max( nColors, rowColors[i] + 1 ) ;
+	}
+
+	return nColors ;
+}
+
+inline std::ptrdiff_t Coloring::computeJonesPlassmann( const RowGraph& graph, std::vector< std::ptrdiff_t > &rowColors )
+{
+	// At each round, the uncolored rows that have a higher priority than all their uncolored
+	// neighbours form an independent set, and can be colored concurrently
+
+	const std::ptrdiff_t n = graph.size() ;
+	rowColors.assign( n, -1 ) ;
 
-	std::vector< std::vector< std::ptrdiff_t > > tmp_colors ;
+	std::vector< std::ptrdiff_t > remaining( n ) ;
 	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		remaining[i] = i ;
+
+	std::vector< unsigned char > selected ;
+
+	const coloring_impl::SelectTask selectTask( graph, rowColors, remaining, selected ) ;
+	const coloring_impl::ColorTask   colorTask( graph, rowColors, remaining, selected ) ;
+
+	std::ptrdiff_t nColors = 0 ;
+	while( !remaining.empty() )
 	{
-		bool ok = false ;
+		const std::ptrdiff_t nRemaining = remaining.size() ;
+		selected.assign( nRemaining, 0 ) ;
 
-		const unsigned nColors = tmp_colors.size() ;
+		parallel_for( 0, nRemaining, selectTask ) ;
+		parallel_for( 0, nRemaining, colorTask ) ;
 
-		for( unsigned c = 0 ; c < nColors ; ++c )
+		std::ptrdiff_t nLeft = 0 ;
+		for( std::ptrdiff_t k = 0 ; k < nRemaining ; ++k )
 		{
-			std::vector< std::ptrdiff_t > &color = tmp_colors[ c ] ;
-			ok = true ;
-			for( typename Derived::MajorIndexType::InnerIterator it( matrix.majorIndex(), i ) ;
-				 it && it.inner() < i ; ++ it )
-			{
-				if( color.end() !=
-						std::lower_bound( color.begin(), color.end(), it.inner() ) )
-				{
-					ok = false ;
-					break ;
-				}
+			if( selected[k] ) {
+				nColors = std::max( nColors, rowColors[ remaining[k] ] + 1 ) ;
+			} else {
+				remaining[ nLeft++ ] = remaining[k] ;
 			}
-			if( ok )
+		}
+		remaining.resize( nLeft ) ;
+	}
+
+	return nColors ;
+}
+
+inline std::ptrdiff_t Coloring::balance( const RowGraph& graph, std::ptrdiff_t nColors, std::size_t nThreads,
+                                         std::vector< std::ptrdiff_t > &rowColors )
+{
+	const std::ptrdiff_t n = graph.size() ;
+
+	std::vector< std::ptrdiff_t > sizes( nColors, 0 ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		++sizes[ rowColors[i] ] ;
+
+	// marks[ c ] == i iff color c is used by a neighbour of row i
+	std::vector< std::ptrdiff_t > marks( nColors, -1 ) ;
+
+	// Moves row i to the smallest permissible color whose size is in [ minSize, maxSize [,
+	// returns false if there is no such color
+	struct Mover {
+		const RowGraph& graph ;
+		std::vector< std::ptrdiff_t > &rowColors ;
+		std::vector< std::ptrdiff_t > &sizes ;
+		std::vector< std::ptrdiff_t > &marks ;
+
+		bool operator()( std::ptrdiff_t i, std::ptrdiff_t minSize, std::ptrdiff_t maxSize ) const
+		{
+			for( std::ptrdiff_t k = graph.offsets[ i ] ; k != graph.offsets[ i+1 ] ; ++k )
+				marks[ rowColors[ graph.neighbours[ k ] ] ] = i ;
+
+			const std::ptrdiff_t c = rowColors[ i ] ;
+			std::ptrdiff_t target = -1 ;
+			for( std::ptrdiff_t d = 0 ; d < (std::ptrdiff_t) sizes.size() ; ++d )
 			{
-				color.push_back( i ) ;
-				break ;
+				if( d != c && marks[ d ] != i && sizes[ d ] >= minSize && sizes[ d ] < maxSize
+				        && ( target < 0 || sizes[ d ] < sizes[ target ] ) )
+					target = d ;
 			}
+
+			if( target < 0 ) return false ;
+
+			--sizes[ c ] ;
+			++sizes[ target ] ;
+			rowColors[ i ] = target ;
+			return true ;
 		}
-		if( !ok )
+	} moveRow = { graph, rowColors, sizes, marks } ;
+
+	// Rows of each color, before balancing
+	std::vector< std::ptrdiff_t > colorOffsets( nColors + 1, 0 ), colorRows( n ) ;
+	for( std::ptrdiff_t c = 0 ; c < nColors ; ++c )
+		colorOffsets[ c+1 ] = colorOffsets[ c ] + sizes[ c ] ;
+	{
+		std::vector< std::ptrdiff_t > cursor( colorOffsets.begin(), colorOffsets.end() - 1 ) ;
+		for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+			colorRows[ cursor[ rowColors[i] ]++ ] = i ;
+	}
+
+	// 1 - Try to get rid of the colors that cannot keep all threads busy, smallest first
+
+	const std::ptrdiff_t minSize = nThreads ;
+	std::vector< std::ptrdiff_t > order( nColors ) ;
+	for( std::ptrdiff_t c = 0 ; c < nColors ; ++c )
+		order[c] = c ;
+	std::stable_sort( order.begin(), order.end(), coloring_impl::SizeComparator( sizes ) ) ;
+
+	for( std::ptrdiff_t o = 0 ; o < nColors ; ++o )
+	{
+		const std::ptrdiff_t c = order[ o ] ;
+		if( sizes[ c ] == 0 || sizes[ c ] >= minSize )
+			continue ;
+
+		for( std::ptrdiff_t k = colorOffsets[ c ] ; k != colorOffsets[ c+1 ] ; ++k )
 		{
-			tmp_colors.resize( nColors+1 ) ;
-			tmp_colors.back().push_back( i ) ;
+			const std::ptrdiff_t i = colorRows[ k ] ;
+			if( rowColors[ i ] == c )
+				moveRow( i, std::max< std::ptrdiff_t >( 1, sizes[ c ] ), n+1 ) ;
 		}
 	}
 
-	permutation.clear() ;
+	// 2 - Move rows from the colors larger than the average to the smaller ones
 
-	colors.resize( tmp_colors.size()+1 ) ;
-	colors[ 0 ] = 0 ;
+	std::ptrdiff_t nActive = 0 ;
+	for( std::ptrdiff_t c = 0 ; c < nColors ; ++c )
+		if( sizes[ c ] > 0 ) ++nActive ;
 
-	for( unsigned c = 0 ; c < tmp_colors.size() ; ++c )
+	if( nActive > 0 )
 	{
-		colors[ c+1 ] = colors[c] + tmp_colors[c].size() ;
-		permutation.insert( permutation.end(), tmp_colors[c].begin(), tmp_colors[c].end() ) ;
+		const std::ptrdiff_t avgSize = ( n + nActive - 1 ) / nActive ;
+		for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		{
+			if( sizes[ rowColors[i] ] > avgSize )
+				moveRow( i, 1, avgSize ) ;
+		}
 	}
 
+	// Renumber non-empty colors
+
+	std::vector< std::ptrdiff_t > renumber( nColors, -1 ) ;
+	nActive = 0 ;
+	for( std::ptrdiff_t c = 0 ; c < nColors ; ++c )
+		if( sizes[ c ] > 0 ) renumber[ c ] = nActive++ ;
+
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		rowColors[ i ] = renumber[ rowColors[ i ] ] ;
+
+	return nActive ;
+}
+
+inline void Coloring::setFromRowColors( const std::vector< std::ptrdiff_t > &rowColors, std::ptrdiff_t nColors )
+{
+	const std::ptrdiff_t n = rowColors.size() ;
+
+	colors.assign( nColors + 1, 0 ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		++colors[ rowColors[i] + 1 ] ;
+	for( std::ptrdiff_t c = 0 ; c < nColors ; ++c )
+		colors[ c+1 ] += colors[ c ] ;
+
+	// Rows keep their relative order within each color
+	permutation.resize( n ) ;
+	std::vector< std::ptrdiff_t > cursor( colors.begin(), colors.end() - 1 ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		permutation[ cursor[ rowColors[i] ]++ ] = i ;
+}
+
+inline void Coloring::sizeHistogram( std::vector< std::size_t > &histogram ) const
+{
+	histogram.clear() ;
+	for( std::size_t c = 0 ; c < nColors() ; ++c )
+	{
+		std::size_t s = colorSize( c ) ;
+		if( s == 0 ) continue ;
+
+		std::size_t k = 0 ;
+		while( s >>= 1 ) ++k ;
+
+		if( histogram.size() <= k )
+			histogram.resize( k+1, 0 ) ;
+		++histogram[ k ] ;
+	}
 }
 
 template < typename Derived >
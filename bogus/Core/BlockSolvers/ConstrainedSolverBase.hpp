@@ -13,6 +13,8 @@
 
 #include "BlockSolverBase.hpp"
 
+#include "../Utils/SolverStats.hpp"
+
 namespace bogus
 {
 
@@ -33,6 +35,12 @@ public:
 	void useInfinityNorm( bool useInfNorm ) { m_useInfinityNorm = useInfNorm ; }
 	bool usesInfinityNorm( ) const { return m_useInfinityNorm ; }
 
+	//! Sets the SolverStats object that will accumulate profiling data, or disables profiling if null
+	/*! The \p stats object is not owned by the solver, and is only updated when
+		BOGUS_WITH_SOLVER_STATS is defined. \sa SolverStats */
+	void setStats( SolverStats* stats ) { m_stats = stats ; }
+	SolverStats* stats( ) const { return m_stats ; }
+
 	//! Eval the current global residual as a function of the local ones
 	/*! \p y should be such that \p y = \ref m_matrix * \p x + rhs
 		\return the current residual \c err defined as follow :
@@ -68,7 +76,7 @@ protected:
 
 	void updateScalings( ) ;
 
-	ConstrainedSolverBase() : Base(), m_useInfinityNorm( false ) {}
+	ConstrainedSolverBase() : Base(), m_useInfinityNorm( false ), m_stats( BOGUS_NULL_PTR( SolverStats ) ) {}
 	using Base::m_matrix ;
 
 	typename GlobalProblemTraits::DynVector m_scaling ;
@@ -76,6 +84,9 @@ protected:
 	//! See useInfinityNorm(). Defaults to false.
 	bool m_useInfinityNorm ;
 
+	//! See setStats(). Defaults to null.
+	SolverStats* m_stats ;
+
 };
 
 } //namespace bogus
@@ -15,73 +15,80 @@
 
 #include "../Block/Access.hpp"
 #include "../Block/BlockMatrixBase.hpp"
+#include "../Utils/Executor.hpp"
 
-namespace bogus {
-
+#include <vector>
 
-template < typename Derived, typename BlockMatrixType >
-template < typename NSLaw, typename RhsT, typename ResT >
-typename ConstrainedSolverBase< Derived, BlockMatrixType >::Scalar
-ConstrainedSolverBase< Derived, BlockMatrixType >::eval( const NSLaw &law,
-							const ResT &y, const RhsT &x ) const
-{
-	const Index dimension = BlockProblemTraits::dimension ;
+namespace bogus {
 
-	const Segmenter< dimension, const RhsT, typename BlockMatrixType::Index >
-			xSegmenter( x, m_matrix->rowOffsets() ) ;
-	const Segmenter< dimension, const ResT, typename BlockMatrixType::Index >
-			ySegmenter( y, m_matrix->rowOffsets() ) ;
 
-	typedef typename BlockMatrixTraits< BlockMatrixType >::Index Index ;
+namespace block_solvers_impl {
 
-	const Index n = m_matrix->rowsOfBlocks() ;
+//! Evaluates the local errors of a range of rows, accumulating them in per-worker partial results
+template < typename NSLaw, int Dimension, typename Index, typename RhsT, typename ResT, typename ScalingT >
+struct EvalTask : public RangeTask
+{
+	typedef typename NSLaw::Traits::Scalar Scalar ;
 
-	Scalar err = 0., lres ;
-	typename NSLaw::Traits::Vector lx, ly ;
+	EvalTask( const NSLaw &law_, const ResT &y_, const RhsT &x_, const Index* offsets_,
+	          const ScalingT& scaling_, bool infinityNorm_, std::vector< Scalar >& partials_ )
+	    : law( law_ ), y( y_ ), x( x_ ), offsets( offsets_ ), scaling( scaling_ ),
+	      infinityNorm( infinityNorm_ ), partials( partials_ )
+	{}
 
-	if( m_useInfinityNorm )
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int worker ) const
 	{
+		const Segmenter< Dimension, const RhsT, Index > xSegmenter( x, offsets ) ;
+		const Segmenter< Dimension, const ResT, Index > ySegmenter( y, offsets ) ;
+
+		typename NSLaw::Traits::Vector lx, ly ;
+		Scalar &lres = partials[ worker ] ;
 
-	#ifndef BOGUS_DONT_PARALLELIZE
-	#pragma omp parallel private( lx, ly, lres )
-	#endif
+		for( Index i = begin ; i < (Index) end ; ++ i )
 		{
-			lres = 0. ;
+			lx = xSegmenter[ i ] * scaling[i] ;
+			ly = ySegmenter[ i ] ;
+			const Scalar err = law.eval( i, lx, ly ) ;
+			lres = infinityNorm ? std::max( err, lres ) : lres + err ;
+		}
+	}
 
-#ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp for
-#endif
-			for( Index i = 0 ; i < n ; ++ i )
-			{
-				lx = xSegmenter[ i ] * m_scaling[i] ;
-				ly = ySegmenter[ i ] ;
-				lres = std::max( law.eval( i, lx, ly ), lres ) ;
-			}
+	const NSLaw &law ;
+	const ResT &y ;
+	const RhsT &x ;
+	const Index* offsets ;
+	const ScalingT& scaling ;
+	const bool infinityNorm ;
+	std::vector< Scalar >& partials ;
+} ;
 
-#ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp critical
-#endif
-			err = std::max( err, lres ) ;
-		}
+} //block_solvers_impl
 
-		return err ;
+template < typename Derived, typename BlockMatrixType >
+template < typename NSLaw, typename RhsT, typename ResT >
+typename ConstrainedSolverBase< Derived, BlockMatrixType >::Scalar
+ConstrainedSolverBase< Derived, BlockMatrixType >::eval( const NSLaw &law,
+							const ResT &y, const RhsT &x ) const
+{
+	typedef typename BlockMatrixTraits< BlockMatrixType >::Index Index ;
+	typedef block_solvers_impl::EvalTask< NSLaw, BlockProblemTraits::dimension, Index, RhsT, ResT,
+			typename GlobalProblemTraits::DynVector > Task ;
 
-	} else {
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Eval ) ; )
 
-	#ifndef BOGUS_DONT_PARALLELIZE
-	#pragma omp parallel for private( lx, ly, lres ) reduction ( + : err )
-	#endif
-		for( Index i = 0 ; i < n ; ++ i )
-		{
-			lx = xSegmenter[ i ] * m_scaling[i] ;
-			ly = ySegmenter[ i ] ;
-			lres = law.eval( i, lx, ly ) ;
-			err += lres ;
-		}
+	const Index n = m_matrix->rowsOfBlocks() ;
 
-		return err / ( 1 + n );
+	std::vector< Scalar > partials( executor().nWorkers(), 0. ) ;
+	const Task task( law, y, x, m_matrix->rowOffsets(), m_scaling, m_useInfinityNorm, partials ) ;
+	parallel_for( 0, n, task ) ;
 
+	Scalar err = 0. ;
+	for( std::size_t w = 0 ; w < partials.size() ; ++w )
+	{
+		err = m_useInfinityNorm ? std::max( err, partials[w] ) : err + partials[w] ;
 	}
+
+	return m_useInfinityNorm ? err : err / ( 1 + n ) ;
 }
 
 namespace block_solvers_impl {
@@ -92,15 +99,13 @@ typename MatrixT::Scalar estimate_block_scaling( const MatrixT& block )
 	return std::max( (typename MatrixT::Scalar) 1, block.trace()/block.rows() ) ;
 }
 
-template< typename Derived >
-void estimate_row_scaling( const BlockObjectBase< Derived >& ,
-					   typename BlockObjectBase< Derived >::Scalar* )
+template< typename Derived, typename Scalar >
+void estimate_row_scaling( const BlockObjectBase< Derived >& , Scalar* )
 {
 }
 
-template< typename Derived >
-void estimate_row_scaling( const BlockMatrixBase< Derived >& mat,
-					 typename Derived::Scalar* scalings )
+template< typename Derived, typename Scalar >
+void estimate_row_scaling( const BlockMatrixBase< Derived >& mat, Scalar* scalings )
 {
 	typedef BlockMatrixTraits< Derived > BlockTraits ;
 	typedef typename BlockTraits::BlockType LocalMatrixType ;
@@ -14,6 +14,7 @@
 
 #include "GaussSeidelBase.hpp"
 #include "Coloring.hpp"
+#include "RowGraph.hpp"
 
 #include <vector>
 
@@ -49,9 +50,9 @@ public:
 	typedef typename GlobalProblemTraits::Scalar Scalar ;
 
 	//! Default constructor -- you will have to call setMatrix() before using the solve() function
-	GaussSeidel( ) : Base() { }
+	GaussSeidel( ) : Base(), m_asynchronous( false ) { }
 	//! Constructor with the system matrix
-	explicit GaussSeidel( const BlockObjectBase< BlockMatrixType > & matrix ) : Base()
+	explicit GaussSeidel( const BlockObjectBase< BlockMatrixType > & matrix ) : Base(), m_asynchronous( false )
 	{  setMatrix( matrix ) ; }
 
 	//! Sets the system matrix and initializes internal structures
@@ -131,6 +132,20 @@ public:
 	  and all contacts within a given color can be solver in parallel */
 	Coloring& coloring( ) { return m_coloring ; }
 
+	//! Enables asynchronous ( a.k.a. chaotic ) parallel iterations
+	/*!
+	  In this mode, each thread repeatedly solves the same subset of local problems without waiting
+	  for the other ones ; threads are only synchronized when the global error has to be evaluated
+	  ( see setEvalEvery() ) or the linear constraints updated.
+	  Blocks of \b x are published and read through per-block sequence locks, so that each local problem
+	  always sees a consistent, although possibly outdated, version of its neighbours.
+
+	  Coloring is ignored when asynchronous iterations are enabled, and results are not deterministic.
+	  Has no effect when multi-threading is disabled \sa setMaxThreads()
+	  */
+	GaussSeidel& setAsynchronous( bool asynchronous = true ) ;
+	bool asynchronous() const { return m_asynchronous ; }
+
 	using Base::solve ;
 protected:
 	void updateLocalMatrices() ;
@@ -141,12 +156,23 @@ protected:
 	    std::vector< unsigned char > &skip, Scalar &ndxRef,
 	    ResT &x	) const ;
 
+	//! Solves the local problems of a range of the coloring permutation
+	template < typename NSLaw,  typename RhsT, typename ResT >
+	struct RowsTask ;
+
+	template < typename NSLaw,  typename RhsT, typename ResT >
+	void asyncLoop (
+	    unsigned nSweeps, const NSLaw &law, const RhsT& b,
+	    std::vector< unsigned char > &skip, std::vector< unsigned > &versions,
+	    Scalar &ndxRef, ResT &x	) const ;
+
 	typedef typename Base::Index Index ;
 
 	using Base::m_matrix ;
 	using Base::m_maxIters ;
 	using Base::m_tol ;
 	using Base::m_scaling ;
+	using Base::m_stats ;
 	using Base::m_maxThreads ;
 	using Base::m_evalEvery ;
 	using Base::m_skipTol ;
@@ -156,6 +182,11 @@ protected:
 
 	//! \sa coloring()
 	Coloring m_coloring ;
+
+	//! \sa setAsynchronous()
+	bool m_asynchronous ;
+	//! Neighbours of each row, for asynchronous iterations
+	RowGraph m_rowGraph ;
 } ;
 
 } //namespace bogus
@@ -16,6 +16,9 @@
 #include "Coloring.impl.hpp"
 #include "GaussSeidelBase.impl.hpp"
 
+#include "../Utils/Atomics.hpp"
+#include "../Utils/Executor.hpp"
+
 #ifndef BOGUS_DONT_PARALLELIZE
 #include <omp.h>
 #endif
@@ -26,18 +29,38 @@ namespace bogus
 template < typename BlockMatrixType >
 GaussSeidel< BlockMatrixType >& GaussSeidel< BlockMatrixType >::setMatrix( const BlockObjectBase< BlockMatrixType > & M )
 {
-	if( m_matrix != &M && ( m_matrix != BOGUS_NULL_PTR( const BlockObjectBase< BlockMatrixType >) ||
-							m_coloring.size() != (std::size_t) M.rowsOfBlocks() )) {
-		m_coloring.update( false, M.derived() );
-	}
+	{
+		BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Setup ) ; )
 
-	m_matrix = &M ;
+		if( m_matrix != &M && ( m_matrix != BOGUS_NULL_PTR( const BlockObjectBase< BlockMatrixType >) ||
+								m_coloring.size() != (std::size_t) M.rowsOfBlocks() )) {
+			m_coloring.update( false, M.derived() );
+		}
+
+		m_matrix = &M ;
+
+		if( m_asynchronous ) {
+			m_rowGraph.setFrom( M.derived() ) ;
+		}
+	}
 
 	updateLocalMatrices() ;
 
 	return *this ;
 }
 
+template < typename BlockMatrixType >
+GaussSeidel< BlockMatrixType >& GaussSeidel< BlockMatrixType >::setAsynchronous( bool asynchronous )
+{
+	m_asynchronous = asynchronous ;
+
+	if( m_asynchronous && m_matrix && m_rowGraph.size() != (std::ptrdiff_t) m_matrix->rowsOfBlocks() ) {
+		m_rowGraph.setFrom( m_matrix->derived() ) ;
+	}
+
+	return *this ;
+}
+
 template < typename BlockMatrixType >
 void GaussSeidel< BlockMatrixType >::updateLocalMatrices( )
 {
@@ -45,6 +68,8 @@ void GaussSeidel< BlockMatrixType >::updateLocalMatrices( )
 	if( !m_matrix )
 		return ;
 
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Setup ) ; )
+
 	const Index n = m_matrix->rowsOfBlocks() ;
 	m_localMatrices.resize( n ) ;
 
@@ -60,7 +85,7 @@ void GaussSeidel< BlockMatrixType >::updateLocalMatrices( )
 			set_zero( m_localMatrices[i] ) ;
 		} else {
 			m_localMatrices[i] = MatrixTraits<typename BlockMatrixType::BlockType>
-					::asConstMatrix( Base::explicitMatrix().block( ptr ) ) ;
+					::asConstMatrix( Base::explicitMatrix().block( ptr ) ).template cast< Scalar >() ;
 		}
 	}
 
@@ -68,76 +93,191 @@ void GaussSeidel< BlockMatrixType >::updateLocalMatrices( )
 }
 
 
+template < typename BlockMatrixType >
+template < typename NSLaw,  typename RhsT, typename ResT >
+struct GaussSeidel< BlockMatrixType >::RowsTask : public RangeTask
+{
+	typedef typename NSLaw::Traits LocalProblemTraits ;
+	typedef typename BlockMatrixType::Index BlockIndex ;
+
+	RowsTask( const GaussSeidel& gs_, const NSLaw &law_, const RhsT& b_,
+	          std::vector< unsigned char > &skip_, Scalar &ndxRef_, ResT &x_ )
+	    : gs( gs_ ), law( law_ ), b( b_ ), skip( skip_ ), ndxRef( ndxRef_ ), x( x_ ),
+	      absSkipTol( std::min( gs.m_skipTol, gs.m_tol ) ),
+	      absSkipIters( std::min( gs.m_skipIters, (unsigned) std::sqrt( (Scalar) skip.size() ) ) )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int worker ) const
+	{
+#ifdef BOGUS_WITH_SOLVER_STATS
+		SolverStats::WorkerScope workerStats( gs.m_stats, worker ) ;
+#else
+		(void) worker ;
+#endif
+		const Index dimension = Base::BlockProblemTraits::dimension ;
+
+		Segmenter< dimension, ResT, BlockIndex >
+				xSegmenter( x, gs.m_matrix->rowOffsets() ) ;
+		const Segmenter< dimension, const RhsT, BlockIndex >
+				bSegmenter( b, gs.m_matrix->rowOffsets() ) ;
+
+		typename LocalProblemTraits::Vector lb, lx, ldx ;
+
+		for( std::ptrdiff_t pi = begin ; pi < end ; ++ pi )
+		{
+
+			const std::size_t i = gs.m_coloring.permutation[ pi ] ;
+
+			if( skip[i] ) {
+				--skip[i] ;
+				BOGUS_STATS( workerStats.skipped() ; )
+				continue ;
+			}
+
+			lx = xSegmenter[ i ] ;
+			lb = bSegmenter[ i ] - gs.m_regularization(i) * lx ;
+			gs.explicitMatrix().splitRowMultiply( i, x, lb ) ;
+			ldx = -lx ;
+
+			const bool ok = law.solveLocal( i, gs.m_localMatrices[i], lb, lx, gs.m_scaling[ i ] ) ;
+			BOGUS_STATS( workerStats.solved( ok ) ; )
+			ldx += lx ;
+
+			if( !ok ) { ldx *= .5 ; }
+			xSegmenter[ i ] += ldx ;
+
+			const Scalar nx2 = gs.m_scaling[ i ] * gs.m_scaling[ i ] * lx.squaredNorm() ;
+			const Scalar ndx2 = gs.m_scaling[ i ] * gs.m_scaling[ i ] * ldx.squaredNorm() ;
+			atomics::fetch_max( &ndxRef, ndx2 ) ;
+
+			if(  std::min(nx2, ndx2) < absSkipTol ||
+				 ndx2 < gs.m_skipTol * std::min( nx2, atomics::load_relaxed( &ndxRef ) ) )
+			{
+				skip[i] = absSkipIters ;
+			}
+		}
+	}
+
+	const GaussSeidel& gs ;
+	const NSLaw &law ;
+	const RhsT &b ;
+	std::vector< unsigned char > &skip ;
+	Scalar &ndxRef ;
+	ResT &x ;
+
+	const Scalar absSkipTol ;
+	const Scalar absSkipIters ;
+} ;
+
 template < typename BlockMatrixType >
 template < typename NSLaw,  typename RhsT, typename ResT >
 void GaussSeidel< BlockMatrixType >::innerLoop(
 		bool parallelize, const NSLaw &law, const RhsT& b,
 		std::vector< unsigned char > &skip, Scalar &ndxRef,
 		ResT &x	) const
+{
+	// Rows within a color do not interact and can be processed in parallel
+	const RowsTask< NSLaw, RhsT, ResT > task( *this, law, b, skip, ndxRef, x ) ;
+
+	for( unsigned c = 0 ; c+1 < m_coloring.colors.size() ; ++ c )
+	{
+		parallel_for( m_coloring.colors[c], m_coloring.colors[c+1], task, parallelize ) ;
+	}
+}
+
+template < typename BlockMatrixType >
+template < typename NSLaw,  typename RhsT, typename ResT >
+void GaussSeidel< BlockMatrixType >::asyncLoop(
+		unsigned nSweeps, const NSLaw &law, const RhsT& b,
+		std::vector< unsigned char > &skip, std::vector< unsigned > &versions,
+		Scalar &ndxRef, ResT &x	) const
 {
 	typedef typename NSLaw::Traits LocalProblemTraits ;
+	typedef typename GlobalProblemTraits::DynVector DynVector ;
+	typedef typename BlockMatrixType::Index BlockIndex ;
 	const Index dimension = Base::BlockProblemTraits::dimension ;
 
-	Segmenter< dimension, ResT, typename BlockMatrixType::Index >
-			xSegmenter( x, m_matrix->rowOffsets() ) ;
-	const Segmenter< dimension, const RhsT, typename BlockMatrixType::Index >
-			bSegmenter( b, m_matrix->rowOffsets() ) ;
+	assert( m_rowGraph.size() == (std::ptrdiff_t) m_matrix->rowsOfBlocks() ) ;
+
+	const BlockIndex* offsets = m_matrix->rowOffsets() ;
+	const std::ptrdiff_t n = m_matrix->rowsOfBlocks() ;
+	Scalar* xShared = x.data() ;
 
 	const Scalar absSkipTol = std::min( m_skipTol, m_tol ) ;
 	const Scalar absSkipIters = std::min( m_skipIters, (unsigned) std::sqrt( (Scalar) skip.size() ) ) ;
 
-#ifdef BOGUS_DONT_PARALLELIZE
-	(void) parallelize ;
-#else
-#pragma omp parallel if ( parallelize )
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel
 	{
 #endif
+#ifdef BOGUS_WITH_SOLVER_STATS
+		SolverStats::WorkerScope workerStats( m_stats, currentThread() ) ;
+#endif
+		// Thread-local view of x ; the neighbours of each row are refreshed before solving it
+		DynVector xLocal = x ;
+
+		Segmenter< dimension, DynVector, BlockIndex >
+				xSegmenter( xLocal, offsets ) ;
+		const Segmenter< dimension, const RhsT, BlockIndex >
+				bSegmenter( b, offsets ) ;
+
 		typename LocalProblemTraits::Vector lb, lx, ldx ;
-		for( unsigned c = 0 ; c+1 < m_coloring.colors.size() ; ++ c )
-		{
 
 #ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp for
+#pragma omp barrier
 #endif
-			for( std::ptrdiff_t pi = m_coloring.colors[c] ; pi < m_coloring.colors[c+1] ; ++ pi )
+		for( unsigned sweep = 0 ; sweep < nSweeps ; ++sweep )
+		{
+			// Static scheduling: each row is always updated by the same thread
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp for schedule( static ) nowait
+#endif
+			for( std::ptrdiff_t pi = 0 ; pi < n ; ++ pi )
 			{
 
 				const std::size_t i = m_coloring.permutation[ pi ] ;
 
 				if( skip[i] ) {
 					--skip[i] ;
+					BOGUS_STATS( workerStats.skipped() ; )
 					continue ;
 				}
 
+				for( std::ptrdiff_t e = m_rowGraph.offsets[ i ] ; e != m_rowGraph.offsets[ i+1 ] ; ++e )
+				{
+					const std::ptrdiff_t j = m_rowGraph.neighbours[ e ] ;
+					atomics::read_versioned( &versions[ j ], xShared + offsets[ j ],
+											 xLocal.data() + offsets[ j ], offsets[ j+1 ] - offsets[ j ] ) ;
+				}
+
 				lx = xSegmenter[ i ] ;
 				lb = bSegmenter[ i ] - m_regularization(i) * lx ;
-				Base::explicitMatrix().splitRowMultiply( i, x, lb ) ;
+				Base::explicitMatrix().splitRowMultiply( i, xLocal, lb ) ;
 				ldx = -lx ;
 
 				const bool ok = law.solveLocal( i, m_localMatrices[i], lb, lx, m_scaling[ i ] ) ;
+				BOGUS_STATS( workerStats.solved( ok ) ; )
 				ldx += lx ;
 
 				if( !ok ) { ldx *= .5 ; }
 				xSegmenter[ i ] += ldx ;
 
+				atomics::write_versioned( &versions[ i ], xLocal.data() + offsets[ i ],
+										  xShared + offsets[ i ], offsets[ i+1 ] - offsets[ i ] ) ;
+
 				const Scalar nx2 = m_scaling[ i ] * m_scaling[ i ] * lx.squaredNorm() ;
 				const Scalar ndx2 = m_scaling[ i ] * m_scaling[ i ] * ldx.squaredNorm() ;
-				// Thread-safety:
-				// we do not care if we lose an update of ndxRef to a data race,
-				// but we need its bytes to be consistent.
-				// Ok on x86(_64) if ndxRef is aligned as assignment is atomic
-				if( ndx2 > ndxRef ) ndxRef = ndx2 ;
+				atomics::fetch_max( &ndxRef, ndx2 ) ;
 
 				if(  std::min(nx2, ndx2) < absSkipTol ||
-					 ndx2 < m_skipTol * std::min( nx2, ndxRef ) )
+					 ndx2 < m_skipTol * std::min( nx2, atomics::load_relaxed( &ndxRef ) ) )
 				{
 					skip[i] = absSkipIters ;
 				}
 			}
-
 		}
 #ifndef BOGUS_DONT_PARALLELIZE
-		}
+	}
 #endif
 
 }
@@ -182,15 +322,20 @@ GaussSeidel< BlockMatrixType >::solveWithLinearConstraints( const NSLaw &law,
 	assert( m_matrix ) ;
 	assert( solveEvery == 0 || 0 == m_evalEvery % solveEvery ) ;
 
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
+
 	typename GlobalProblemTraits::DynVector y, x_best ;
 
 	typename GlobalProblemTraits::DynVector w = b;
-	W.template multiply< false >(x, w, 1, 1) ;
+	{
+		BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+		W.template multiply< false >(x, w, 1, 1) ;
+		y = w ;
+		m_matrix->template multiply< false >( x, y, 1, 1 ) ;
+	}
 
 	Scalar err_best = std::numeric_limits< Scalar >::max() ;
 
-	y = w ;
-	m_matrix->template multiply< false >( x, y, 1, 1 ) ;
 	Base::evalAndKeepBest( law, x, y, x_best, err_best ) ;
 
 	if( tryZeroAsWell && Base::tryZero( law, b, x, x_best, err_best ) ) {
@@ -208,22 +353,46 @@ GaussSeidel< BlockMatrixType >::solveWithLinearConstraints( const NSLaw &law,
 	std::vector< unsigned char > skip( n, 0 ) ;
 	Scalar ndxRef = 0 ; //Reference step size
 
+	// Asynchronous iterations only synchronize before evaluating the error or updating w
+	const bool asynchronous = parallelize && m_asynchronous ;
+	const unsigned syncEvery = solveEvery > 0 ? solveEvery : m_evalEvery ;
+	std::vector< unsigned > versions( asynchronous ? n : 0, 0 ) ;
+
+	BOGUS_STATS( if( m_stats ) m_stats->reserveWorkers( parallelize ? std::max( newMaxThreads, executor().nWorkers() ) : 1 ) ; )
+
 	unsigned GSIter ;
 	for( GSIter = 1 ; GSIter <= m_maxIters ; ++GSIter )
 	{
 
-		innerLoop( parallelize, law, w, skip, ndxRef, x ) ;
+		{
+			BOGUS_STATS( const SolverStats::Scope sweepsScope( m_stats, SolverStats::Sweeps ) ; )
+
+			if( asynchronous )
+			{
+				const unsigned nSweeps = std::min( syncEvery - ( GSIter - 1 ) % syncEvery, m_maxIters + 1 - GSIter ) ;
+				asyncLoop( nSweeps, law, w, skip, versions, ndxRef, x ) ;
+				GSIter += nSweeps - 1 ;
+				BOGUS_STATS( if( m_stats ) m_stats->iterations += nSweeps ; )
+			} else {
+				innerLoop( parallelize, law, w, skip, ndxRef, x ) ;
+				BOGUS_STATS( if( m_stats ) ++m_stats->iterations ; )
+			}
+		}
 
 		if( solveEvery > 0 && 0 == ( GSIter % solveEvery ) )
 		{
+			BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
 			w = b ;
 			W.template multiply< false >(x, w, 1, 1) ;
 		}
 
 		if( 0 == ( GSIter % m_evalEvery ) )
 		{
-			y = w ;
-			m_matrix->template multiply< false >( x, y, 1, 1 ) ;
+			{
+				BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+				y = w ;
+				m_matrix->template multiply< false >( x, y, 1, 1 ) ;
+			}
 			const Scalar err = Base::evalAndKeepBest( law, x, y, x_best, err_best ) ;
 
 			this->m_callback.trigger( GSIter, err ) ;
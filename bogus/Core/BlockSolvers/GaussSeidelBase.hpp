@@ -136,6 +136,7 @@ protected:
 	using Base::m_maxIters ;
 	using Base::m_tol ;
 	using Base::m_scaling ;
+	using Base::m_stats ;
 
 	typedef typename Base::Index Index ;
 	typedef typename Base::BlockProblemTraits::Matrix DiagonalBlockType ;
@@ -0,0 +1,128 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_INTERIOR_POINT_HPP
+#define BOGUS_INTERIOR_POINT_HPP
+
+#include "ConstrainedSolverBase.hpp"
+#include "SparseCholesky.hpp"
+
+#include "../Block/SparseBlockMatrix.hpp"
+
+namespace bogus
+{
+
+//! Primal-dual interior-point solver for Second Order Cone Quadratic Programs
+/*!
+  Finds the minimum of
+  \f[ \min_{x \in K} \frac 1 2 x^T M x + x^T b \f]
+  where \f$ K = \prod_i K_{\mu_i} \f$ is a product of second order cones, whose apertures are
+  given by the \p NSLaw ( see SOCLaw::mu() ), by solving the associated complementarity problem
+  \f[ K \ni x \perp y := M x + b \in K^* \f]
+  Problems with a negative aperture have no constraint on \p x, and \f$ y_i = 0 \f$.
+
+  Each cone is mapped to the canonical Lorentz cone, on which a Mehrotra predictor-corrector method
+  with Nesterov-Todd scaling is performed \cite NT97. Both Newton systems of an iteration share the same
+  matrix \f$ M + D \f$, where \p D is block-diagonal ; it is solved either with a SparseBlockCholesky
+  factorization, whose symbolic analysis is reused across iterations and solves, or with a
+  Conjugate Gradient preconditioned by the LDLT factorization of its diagonal blocks.
+  See setLinearSolver().
+
+  The number of iterations is typically a few tens, and mostly independent of the conditioning of \p M.
+
+  \warning Only the SOCQP interpretation of the \p NSLaw is used ; the De Saxce change of variable
+  is ignored, so Coulomb friction problems should be solved as SOCLaw< ..., false > laws.
+  \warning The system matrix should be a symmetric positive semi-definite SparseBlockMatrix
+  \note Cones with a zero aperture are approximated by cones with a small positive aperture
+  */
+template < typename BlockMatrixType >
+class InteriorPoint : public ConstrainedSolverBase< InteriorPoint< BlockMatrixType >, BlockMatrixType >
+{
+public:
+	typedef ConstrainedSolverBase< InteriorPoint, BlockMatrixType > Base ;
+	typedef typename Base::GlobalProblemTraits GlobalProblemTraits ;
+	typedef typename Base::Scalar Scalar ;
+	typedef typename Base::Index Index ;
+
+	typedef BlockMatrixTraits< BlockMatrixType > Traits ;
+	typedef typename Traits::BlockType BlockType ;
+
+	//! Matrix of the Newton systems, with the same sparsity pattern as the system matrix
+	typedef SparseBlockMatrix< Eigen::Matrix< Scalar, BlockType::RowsAtCompileTime, BlockType::ColsAtCompileTime >,
+	                           Traits::flags & ~flags::MIXED_PRECISION > SystemMatrixType ;
+
+	//! Default constructor -- you will have to call setMatrix() before using the solve() function
+	InteriorPoint( ) : Base() { init() ; }
+	//! Constructor with the system matrix
+	explicit InteriorPoint( const BlockObjectBase< BlockMatrixType > & matrix ) : Base()
+	{ init() ; setMatrix( matrix ) ; }
+
+	//! Finds an approximate solution for a SOCQP
+	/*!
+	  \param law The non-smooth law, providing the cone apertures
+	  \param b   The constant term of the linear system
+	  \param x   The result. The initial guess is only used for unconstrained problems.
+	  \returns the error as returned by the eval() function
+	  */
+	template < typename NSLaw, typename RhsT, typename ResT >
+	Scalar solve( const NSLaw &law, const RhsT &b, ResT &x ) const ;
+
+	//! Sets the system matrix
+	InteriorPoint& setMatrix( const BlockObjectBase< BlockMatrixType > & matrix ) ;
+
+	//! Sets how the Newton systems are solved. Default is interior_point::Cholesky
+	void setLinearSolver( interior_point::LinearSolver linearSolver ) { m_linearSolver = linearSolver ; }
+	//! Sets the maximum number of Conjugate Gradient iterations per Newton system
+	void setLinearSolverIterations( unsigned iterations ) { m_linearSolverIters = iterations ; }
+	//! Sets the fraction of the distance to the boundary of the cones that may be travelled by each step
+	/*! Should be in ]0,1[ */
+	void setStepFraction( Scalar fraction ) { m_stepFraction = fraction ; }
+
+	interior_point::LinearSolver linearSolver() const { return m_linearSolver ; }
+	unsigned linearSolverIterations() const { return m_linearSolverIters ; }
+	Scalar stepFraction() const { return m_stepFraction ; }
+
+protected:
+
+	typedef typename GlobalProblemTraits::DynVector DynVector ;
+
+	//! Sets up the default values for all parameters
+	void init()
+	{
+		m_tol = 1.e-12 ;
+		m_maxIters = 60 ;
+		m_linearSolver = interior_point::Cholesky ;
+		m_linearSolverIters = 200 ;
+		m_stepFraction = .99 ;
+	}
+
+	//! Copies the system matrix into m_system, adding \p diagonal to its diagonal blocks
+	template < typename MatrixArray >
+	void assembleSystem( const MatrixArray &diagonal, const std::vector< bool > &constrained ) const ;
+
+	//! Solves m_system * x = rhs
+	bool solveSystem( const DynVector& rhs, DynVector& x ) const ;
+
+	using Base::m_matrix ;
+	using Base::m_maxIters ;
+	using Base::m_tol ;
+	using Base::m_stats ;
+
+	interior_point::LinearSolver m_linearSolver ;
+	unsigned m_linearSolverIters ;
+	Scalar m_stepFraction ;
+
+	mutable SystemMatrixType m_system ;
+	mutable SparseBlockCholesky< SystemMatrixType > m_cholesky ;
+} ;
+
+} //namespace bogus
+
+#endif
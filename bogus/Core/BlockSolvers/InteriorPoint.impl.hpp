@@ -0,0 +1,405 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_INTERIOR_POINT_IMPL_HPP
+#define BOGUS_INTERIOR_POINT_IMPL_HPP
+
+#include "InteriorPoint.hpp"
+#include "ConstrainedSolverBase.impl.hpp"
+#include "SparseCholesky.impl.hpp"
+#include "Krylov.impl.hpp"
+
+#include "../Block/Access.hpp"
+#include "../Utils/NumTraits.hpp"
+
+#include <limits>
+
+namespace bogus
+{
+
+//! Jordan algebra of the canonical second order cone \f$ \vert x_T \vert \leq x_N \f$
+namespace interior_point_impl
+{
+
+template < typename LocalTraits >
+struct Lorentz
+{
+	typedef typename LocalTraits::Scalar Scalar ;
+	typedef typename LocalTraits::Vector Vector ;
+	typedef typename LocalTraits::Matrix Matrix ;
+
+	//! \f$ x^T J x \f$, with \f$ J = diag( 1, -1, ..., -1 ) \f$
+	static Scalar det( const Vector& x )
+	{
+		const Scalar nt = LocalTraits::tp( x ).norm() ;
+		return ( LocalTraits::np( x ) - nt ) * ( LocalTraits::np( x ) + nt ) ;
+	}
+
+	//! Identity element
+	static void unit( Vector& e )
+	{
+		e.setZero() ;
+		LocalTraits::np( e ) = 1 ;
+	}
+
+	//! Jordan product \f$ u \circ v \f$
+	static void product( const Vector& u, const Vector& v, Vector& res )
+	{
+		LocalTraits::np( res ) = u.dot( v ) ;
+		LocalTraits::tp( res ) = LocalTraits::np( u ) * LocalTraits::tp( v ) + LocalTraits::np( v ) * LocalTraits::tp( u ) ;
+	}
+
+	//! Solves \f$ \lambda \circ u = d \f$ for \p u, with \f$ \lambda \f$ in the interior of the cone
+	static void divide( const Vector& lambda, const Vector& d, Vector& u )
+	{
+		LocalTraits::np( u ) = ( LocalTraits::np( lambda ) * LocalTraits::np( d )
+		                         - LocalTraits::tp( lambda ).dot( LocalTraits::tp( d ) ) ) / det( lambda ) ;
+		LocalTraits::tp( u ) = ( LocalTraits::tp( d ) - LocalTraits::np( u ) * LocalTraits::tp( lambda ) )
+		                       / LocalTraits::np( lambda ) ;
+	}
+
+	//! Nesterov-Todd scaling matrix \p G of \p x and \p y, such that \f$ G x = G^{-1} y =: \lambda \f$
+	/*! \p G is symmetric positive definite, and \f$ G^2 x = y \f$ */
+	static void scaling( const Vector& x, const Vector& y, Matrix& G, Matrix& Ginv )
+	{
+		const Scalar xn = std::sqrt( det( x ) ) ;
+		const Scalar yn = std::sqrt( det( y ) ) ;
+
+		const Vector xb = x / xn ;
+		const Vector yb = y / yn ;
+		const Scalar gamma = std::sqrt( ( 1 + xb.dot( yb ) ) / 2 ) ;
+
+		// w := ( yb + J xb ) / ( 2 gamma ) is a unit point of the cone
+		Vector w = yb ;
+		LocalTraits::np( w ) += LocalTraits::np( xb ) ;
+		LocalTraits::tp( w ) -= LocalTraits::tp( xb ) ;
+		w /= 2 * gamma ;
+
+		const Scalar beta = std::sqrt( yn / xn ) ;
+		const Scalar w0 = LocalTraits::np( w ) ;
+
+		G.setIdentity( x.rows(), x.rows() ) ;
+		G.block( 1, 1, x.rows() - 1, x.rows() - 1 ).noalias() +=
+		        LocalTraits::tp( w ) * LocalTraits::tp( w ).transpose() / ( 1 + w0 ) ;
+		Ginv = G ;
+
+		G( 0, 0 ) = w0 ;
+		Ginv( 0, 0 ) = w0 ;
+		G.row( 0 ).tail( x.rows() - 1 ) = LocalTraits::tp( w ).transpose() ;
+		G.col( 0 ).tail( x.rows() - 1 ) = LocalTraits::tp( w ) ;
+		Ginv.row( 0 ).tail( x.rows() - 1 ) = - LocalTraits::tp( w ).transpose() ;
+		Ginv.col( 0 ).tail( x.rows() - 1 ) = - LocalTraits::tp( w ) ;
+
+		G *= beta ;
+		Ginv /= beta ;
+	}
+
+	//! Largest step \p t such that \f$ x + t dx \f$ remains in the cone, or infinity
+	/*! \p x should be in the interior of the cone */
+	static Scalar maxStep( const Vector& x, const Vector& dx )
+	{
+		// Smallest positive root of ( x + t dx )^T J ( x + t dx ) = a t^2 + 2 b t + c
+		const Scalar a = det( dx ) ;
+		const Scalar b = LocalTraits::np( x ) * LocalTraits::np( dx ) - LocalTraits::tp( x ).dot( LocalTraits::tp( dx ) ) ;
+		const Scalar c = det( x ) ;
+
+		const Scalar inf = std::numeric_limits< Scalar >::infinity() ;
+
+		const Scalar disc = b*b - a*c ;
+		if( disc < 0 )
+			return inf ;
+
+		const Scalar q = - ( b + ( b < 0 ? -1 : 1 ) * std::sqrt( disc ) ) ;
+		Scalar t = inf ;
+		if( q != 0 && c / q > 0 )
+			t = c / q ;
+		if( a != 0 && q / a > 0 )
+			t = std::min( t, q / a ) ;
+
+		return t ;
+	}
+} ;
+
+} //namespace interior_point_impl
+
+template < typename BlockMatrixType >
+InteriorPoint< BlockMatrixType >& InteriorPoint< BlockMatrixType >::setMatrix(
+		const BlockObjectBase< BlockMatrixType > & matrix )
+{
+	m_matrix = &matrix ;
+	Base::updateScalings() ;
+
+	m_system.cloneStructure( matrix.derived() ) ;
+
+	return *this ;
+}
+
+template < typename BlockMatrixType >
+template < typename MatrixArray >
+void InteriorPoint< BlockMatrixType >::assembleSystem(
+		const MatrixArray &diagonal, const std::vector< bool > &constrained ) const
+{
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Setup ) ; )
+
+	const BlockMatrixType &M = m_matrix->derived() ;
+
+	const std::ptrdiff_t nBlocks = M.nBlocks() ;
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for
+#endif
+	for( std::ptrdiff_t k = 0 ; k < nBlocks ; ++k )
+		m_system.block( k ) = M.block( k ).template cast< Scalar >() ;
+
+	const Index n = M.rowsOfBlocks() ;
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for
+#endif
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		if( constrained[ i ] )
+			m_system.diagonal( i ) += diagonal[ i ] ;
+	}
+}
+
+template < typename BlockMatrixType >
+bool InteriorPoint< BlockMatrixType >::solveSystem( const DynVector& rhs, DynVector& x ) const
+{
+	if( m_linearSolver == interior_point::ConjugateGradient )
+	{
+		typedef Krylov< SystemMatrixType, DiagonalLDLTPreconditioner > CGType ;
+
+		CGType cg( m_system ) ;
+		cg.setMaxIters( m_linearSolverIters ) ;
+		cg.setTol( NumTraits< Scalar >::epsilon() * rhs.squaredNorm() / ( 1 + rhs.rows() ) ) ;
+
+		x.setZero( rhs.rows() ) ;
+		cg.solve_CG( rhs, x ) ;
+	} else {
+		if( m_cholesky.status() != SparseBlockCholesky< SystemMatrixType >::Success )
+			return false ;
+
+		m_cholesky.solve( rhs, x ) ;
+	}
+
+	return x.allFinite() ;
+}
+
+template < typename BlockMatrixType >
+template < typename NSLaw, typename RhsT, typename ResT >
+typename InteriorPoint< BlockMatrixType >::Scalar
+InteriorPoint< BlockMatrixType >::solve( const NSLaw &law, const RhsT &b, ResT &x ) const
+{
+	assert( m_matrix ) ;
+
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
+
+	typedef typename NSLaw::Traits LocalTraits ;
+	typedef typename LocalTraits::Vector LocalVector ;
+	typedef typename LocalTraits::Matrix LocalMatrix ;
+	typedef interior_point_impl::Lorentz< LocalTraits > Cone ;
+	typedef typename ResizableSequenceContainer< LocalMatrix >::Type MatrixArray ;
+
+	typedef Segmenter< NSLaw::dimension, DynVector, Index > VectorSegmenter ;
+
+	const Index n = m_matrix->rowsOfBlocks() ;
+	const Index* offsets = m_matrix->rowOffsets() ;
+
+	// Cone apertures ; the cone K_mu is mapped to the canonical one by x -> ( mu x_N, x_T ),
+	// and its dual cone K_1/mu by y -> ( y_N / mu, y_T )
+	const Scalar minAperture = std::sqrt( NumTraits< Scalar >::epsilon() ) ;
+	std::vector< Scalar > mu( n ) ;
+	std::vector< bool > constrained( n ) ;
+	Index nCones = 0 ;
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		constrained[ i ] = !( law.mu( i ) < 0 ) ;
+		mu[ i ] = constrained[ i ] ? std::max( (Scalar) law.mu( i ), minAperture ) : 1 ;
+		if( constrained[ i ] )
+			++nCones ;
+	}
+
+	// Primal and dual variables in canonical coordinates, starting from the cone axis
+	DynVector xc = x, yc = DynVector::Zero( x.rows() ) ;
+	DynVector xk = x ;
+
+	VectorSegmenter xcSeg( xc, offsets ), ycSeg( yc, offsets ), xkSeg( xk, offsets ) ;
+
+	LocalVector e( LocalTraits::dimension == Eigen::Dynamic ? m_matrix->blockRows( 0 ) : LocalTraits::dimension ) ;
+	Cone::unit( e ) ;
+
+	LocalVector e0 = e ;
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		if( constrained[ i ] ) {
+			xcSeg[ i ] = e ;
+			ycSeg[ i ] = e ;
+			LocalTraits::np( e0 ) = 1 / mu[ i ] ;
+			xkSeg[ i ] = e0 ;
+		}
+	}
+
+	MatrixArray G( n ), Ginv( n ), G2( n ) ;
+
+	DynVector y( x.rows() ), r( x.rows() ), rhs( x.rows() ), dx( x.rows() ),
+	          dxc( x.rows() ), dyc( x.rows() ), lambda( x.rows() ) ;
+	VectorSegmenter ySeg( y, offsets ), rSeg( r, offsets ), rhsSeg( rhs, offsets ),
+	          dxSeg( dx, offsets ), dxcSeg( dxc, offsets ), dycSeg( dyc, offsets ),
+	          lambdaSeg( lambda, offsets ) ;
+
+	// Unconstrained problems have no canonical coordinates
+	dxc.setZero() ;
+	dyc.setZero() ;
+
+	Scalar err = std::numeric_limits< Scalar >::max() ;
+	Scalar errBest = err ;
+	DynVector xBest = xk ;
+
+	for( unsigned k = 0 ; k < m_maxIters ; ++k )
+	{
+		y = b ;
+		{
+			BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+			m_matrix->template multiply< false >( xk, y, 1, 1 ) ;
+		}
+
+		err = Base::eval( law, y, xk ) ;
+		if( err < errBest ) {
+			errBest = err ;
+			xBest = xk ;
+		}
+
+		this->m_callback.trigger( k, err ) ;
+		if( err < m_tol )
+			break ;
+
+		// Infeasibility r = y - yc, Nesterov-Todd scalings, duality gap
+
+		Scalar gap = 0 ;
+		for( Index i = 0 ; i < n ; ++i )
+		{
+			if( !constrained[ i ] ) {
+				rSeg[ i ] = ySeg[ i ] ;
+				continue ;
+			}
+
+			LocalVector li = ySeg[ i ] ;
+			LocalTraits::np( li ) /= mu[ i ] ;
+			rSeg[ i ] = li - ycSeg[ i ] ;
+
+			const LocalVector xi = xcSeg[ i ] ;
+			const LocalVector yi = ycSeg[ i ] ;
+			Cone::scaling( xi, yi, G[ i ], Ginv[ i ] ) ;
+			lambdaSeg[ i ] = G[ i ] * xi ;
+			gap += xi.dot( yi ) ;
+
+			// D G^2 D, with D = diag( mu, 1, ..., 1 )
+			G2[ i ] = G[ i ] * G[ i ] ;
+			G2[ i ].row( 0 ) *= mu[ i ] ;
+			G2[ i ].col( 0 ) *= mu[ i ] ;
+		}
+		gap /= std::max( nCones, (Index) 1 ) ;
+
+		assembleSystem( G2, constrained ) ;
+		if( m_linearSolver == interior_point::Cholesky )
+		{
+			BOGUS_STATS( const SolverStats::Scope setupScope( m_stats, SolverStats::Setup ) ; )
+			m_cholesky.compute( m_system ) ;
+		}
+
+		// Predictor, then corrector direction
+
+		Scalar alpha = 0 ;
+		bool ok = true ;
+		for( unsigned corrector = 0 ; ok && corrector < 2 ; ++corrector )
+		{
+			Scalar sigma = 0 ;
+			if( corrector )
+			{
+				Scalar gapAff = 0 ;
+				for( Index i = 0 ; i < n ; ++i )
+				{
+					if( constrained[ i ] )
+						gapAff += ( xcSeg[ i ] + alpha * dxcSeg[ i ] ).dot( ycSeg[ i ] + alpha * dycSeg[ i ] ) ;
+				}
+				gapAff /= std::max( nCones, (Index) 1 ) ;
+				sigma = gap > 0 ? std::pow( gapAff / gap, 3 ) : 0 ;
+			}
+
+			// Rhs of ( M + D G^2 D ) dx = D ( G ( lambda \ d ) - r ),
+			// with d = sigma gap e - lambda o lambda - ( G dxc ) o ( G^-1 dyc ) for the corrector
+			for( Index i = 0 ; i < n ; ++i )
+			{
+				if( !constrained[ i ] ) {
+					rhsSeg[ i ] = -rSeg[ i ] ;
+					continue ;
+				}
+
+				const LocalVector li = lambdaSeg[ i ] ;
+				LocalVector d( li.rows() ), u( li.rows() ) ;
+				Cone::product( li, li, d ) ;
+				d = -d ;
+				if( corrector )
+				{
+					const LocalVector gx = G[ i ] * dxcSeg[ i ] ;
+					const LocalVector gy = Ginv[ i ] * dycSeg[ i ] ;
+					LocalVector second( li.rows() ) ;
+					Cone::product( gx, gy, second ) ;
+					d += sigma * gap * e - second ;
+				}
+				Cone::divide( li, d, u ) ;
+
+				LocalVector ri = G[ i ] * u - rSeg[ i ] ;
+				LocalTraits::np( ri ) *= mu[ i ] ;
+				rhsSeg[ i ] = ri ;
+			}
+
+			ok = solveSystem( rhs, dx ) ;
+			if( !ok )
+				break ;
+
+			// Directions in canonical coordinates, and step length
+			Scalar maxStep = std::numeric_limits< Scalar >::infinity() ;
+			for( Index i = 0 ; i < n ; ++i )
+			{
+				if( !constrained[ i ] )
+					continue ;
+
+				LocalVector dxi = dxSeg[ i ] ;
+				LocalTraits::np( dxi ) *= mu[ i ] ;
+				dxcSeg[ i ] = dxi ;
+
+				// dyc = G u - G^2 dxc, with G u = ( rhs / D + r )
+				LocalVector gu = rhsSeg[ i ] ;
+				LocalTraits::np( gu ) /= mu[ i ] ;
+				gu += rSeg[ i ] ;
+				dycSeg[ i ] = gu - G[ i ] * ( G[ i ] * dxi ) ;
+
+				maxStep = std::min( maxStep, Cone::maxStep( xcSeg[ i ], dxi ) ) ;
+				maxStep = std::min( maxStep, Cone::maxStep( ycSeg[ i ], LocalVector( dycSeg[ i ] ) ) ) ;
+			}
+
+			alpha = corrector ? std::min( (Scalar) 1, m_stepFraction * maxStep ) : std::min( (Scalar) 1, maxStep ) ;
+		}
+
+		if( !ok || !( alpha > 0 ) )
+			break ;
+
+		xk  += alpha * dx ;
+		xc  += alpha * dxc ;
+		yc  += alpha * dyc ;
+	}
+
+	x = xBest ;
+	return errBest ;
+}
+
+} //namespace bogus
+
+#endif
@@ -26,7 +26,8 @@ namespace bogus
   \tparam BlockMatrixT The type of system matrix, which should be a subclass of BlockObjectBase
   \tparam PreconditionerType The preconditioner type. It should accept BlockMatrixT as a template parameter.
 	The default value, TrivialPreconditioner, means that no preconditioning will be done.
-	\sa TrivialPreconditioner, DiagonalPreconditioner, DiagonalLUPreconditioner, DiagonalLDLTPreconditioner
+	\sa TrivialPreconditioner, DiagonalPreconditioner, DiagonalLUPreconditioner, DiagonalLDLTPreconditioner,
+		IncompleteLDLTPreconditioner
 	\sa krylov
   */
 
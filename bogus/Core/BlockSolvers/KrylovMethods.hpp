@@ -24,7 +24,11 @@
 	BOGUS_PROCESS_KRYLOV_METHOD(BiCGSTAB)\
 	BOGUS_PROCESS_KRYLOV_METHOD(CGS     )\
 	BOGUS_PROCESS_KRYLOV_METHOD(GMRES   )\
-	BOGUS_PROCESS_KRYLOV_METHOD(TFQMR   )
+	BOGUS_PROCESS_KRYLOV_METHOD(TFQMR   )\
+	BOGUS_PROCESS_KRYLOV_METHOD(PipelinedCG)\
+	BOGUS_PROCESS_KRYLOV_METHOD(ChronopoulosGearCG)\
+	BOGUS_PROCESS_KRYLOV_METHOD(BlockCG )\
+	BOGUS_PROCESS_KRYLOV_METHOD(BlockGMRES)
 
 
 namespace bogus {
@@ -34,7 +38,8 @@ namespace krylov {
 
 /*!
   Base class for Krylov solvers implementations
-	\note These implementations are not able to process multiple rhs simultaneously ;
+	\note Except for the block methods BlockCG and BlockGMRES, these implementations
+		are not able to process multiple rhs simultaneously ;
 		instead they will be solved for sequentially
 		( or in parallel if parallelizeRhs( true ) has been called )
 */
@@ -308,6 +313,131 @@ struct TFQMR : public KrylovSolverBase< TFQMR, Matrix, Preconditioner, Traits>
 	BOGUS_MAKE_KRYLOV_SOLVER_HEADER( TFQMR )
 };
 
+//! Solves ( m_A * \p x = \p b ) using the pipelined Conjugate Gradient algorithm of \cite Ghysels14
+/*! For symmetric matrices only. Mathematically equivalent to CG, but the only global reduction of each iteration
+		is computed in the same pass over memory as all the vector updates, and does not depend on the
+		matrix-vector product and preconditioner call of the same iteration.
+		Better suited to high thread counts than CG, at the price of more storage and a slightly
+		lower numerical stability.
+
+		<b>Matrix-vector mults/iter: </b> 1
+		<b>Preconditionner calls/iter: </b> 1
+		<b>Reductions/iter: </b> 1 ( 3 fused dot products )
+		<b>Storage requirements: </b> 9n
+	*/
+template < typename Matrix,
+		   typename Preconditioner = TrivialPreconditioner< Matrix >,
+		   typename Traits = ProblemTraits< typename MatrixTraits<Matrix>::Scalar > >
+struct PipelinedCG : public KrylovSolverBase< PipelinedCG, Matrix, Preconditioner, Traits>
+{
+	BOGUS_MAKE_KRYLOV_SOLVER_HEADER( PipelinedCG )
+};
+
+//! Solves ( m_A * \p x = \p b ) using the single-reduction Conjugate Gradient algorithm of Chronopoulos and Gear
+/*! For symmetric matrices only. Mathematically equivalent to CG, but the two dot products of each iteration
+		are computed in a single reduction, and the vector updates are fused in a single pass over memory.
+
+		<b>Matrix-vector mults/iter: </b> 1
+		<b>Preconditionner calls/iter: </b> 1
+		<b>Reductions/iter: </b> 1 ( 3 fused dot products )
+		<b>Storage requirements: </b> 5n
+	*/
+template < typename Matrix,
+		   typename Preconditioner = TrivialPreconditioner< Matrix >,
+		   typename Traits = ProblemTraits< typename MatrixTraits<Matrix>::Scalar > >
+struct ChronopoulosGearCG : public KrylovSolverBase< ChronopoulosGearCG, Matrix, Preconditioner, Traits>
+{
+	BOGUS_MAKE_KRYLOV_SOLVER_HEADER( ChronopoulosGearCG )
+};
+
+//! Solves ( m_A * \p X = \p B ) for all the columns of \p B at once using the Block Conjugate Gradient algorithm
+/*! For symmetric matrices only. Converges for positive definite linear systems.
+
+		All the right-hand-sides share the same Krylov subspace, which is searched
+		using one multi-column matrix-vector product per iteration. This usually requires
+		far fewer iterations, and thus matrix traversals, than solving for each column separately.
+
+		The search directions are orthonormalized at each iteration, and linearly dependent
+		ones are dropped ( breakdown-free variant ). Columns of \p B that have converged
+		are deflated, i.e. removed from the active block and no longer updated.
+
+		The returned residual, and the one passed to the callback, is the sum of the residuals of all columns.
+
+		<b>Matrix-vector mults/iter: </b> 1 with s columns ( s: number of active rhs )
+		<b>Preconditionner calls/iter: </b> s
+		<b>Other ops/iter: </b> 1 n*s*s rank-revealing QR, 1 s*s LDLT, 4 n*s*s m-m mult
+		<b>Storage requirements: </b> 5ns
+	*/
+template < typename Matrix,
+		   typename Preconditioner = TrivialPreconditioner< Matrix >,
+		   typename Traits = ProblemTraits< typename MatrixTraits<Matrix>::Scalar > >
+struct BlockCG : public KrylovSolverBase< BlockCG, Matrix, Preconditioner, Traits>
+{
+	BOGUS_MAKE_KRYLOV_SOLVER_HEADER( BlockCG )
+
+	using Base::solve ;
+
+	//! Solves for all the columns of \p b simultaneously
+	template < typename ResT, typename RhsT >
+	Scalar solve( const RhsT &b, ResT &x ) const ;
+};
+
+//! Solves ( m_A * \p X = \p B ) for all the columns of \p B at once using the (restarted) Block GMRES algorithm
+/*!
+		\param restart If non-zero, use the restarted algorithm, with at most \p restart block Arnoldi
+		iterations per cycle.
+
+		Works for non-symmetric linear systems. The right-hand-sides share the same
+		block Krylov subspace, which is built using one multi-column matrix-vector product per iteration.
+		Linearly dependent directions are dropped from the block Arnoldi basis, and the columns of \p B that
+		have converged are deflated from the initial block of each cycle.
+
+		The returned residual, and the one passed to the callback, is the sum of the residuals of all columns.
+
+		<b>Matrix-vector mults/iter: </b> 1 with at most s columns ( s: number of active rhs )
+		<b>Preconditionner calls/iter: </b> s
+		<b>Other ops/iter: </b> 1 n*s*s rank-revealing QR, 4 k*n*s*s m-m mult, 1 ks*ks QR
+		<b>Storage requirements: </b> (m+2)*n*s + (m*s)^2
+	*/
+template < typename Matrix,
+		   typename Preconditioner = TrivialPreconditioner< Matrix >,
+		   typename Traits = ProblemTraits< typename MatrixTraits<Matrix>::Scalar > >
+struct BlockGMRES : public KrylovSolverBase< BlockGMRES, Matrix, Preconditioner, Traits>
+{
+	BOGUS_MAKE_KRYLOV_SOLVER_TYPEDEFS( BlockGMRES )
+
+	BlockGMRES() : Base(), m_restart( 0 )
+	{}
+
+	BlockGMRES( const Matrix &A,
+		   unsigned maxIters,
+		   Scalar tol = NumTraits< Scalar >::epsilon(),
+		   const Preconditioner *P = BOGUS_NULL_PTR( const Preconditioner),
+		   const typename Base::SignalType *callback = BOGUS_NULL_PTR(const typename Base::SignalType),
+		   unsigned restart = 0 )
+		: Base( A, maxIters, tol, P, callback ),
+		  m_restart( restart )
+	{}
+
+	BlockGMRES &setRestart( unsigned restart )
+	{
+		m_restart = restart ;
+		return *this ;
+	}
+
+	using Base::solve ;
+
+	//! Solves for all the columns of \p b simultaneously
+	template < typename ResT, typename RhsT >
+	Scalar solve( const RhsT &b, ResT &x ) const ;
+
+	template < typename RhsT, typename ResT >
+	Scalar vectorSolve( const RhsT &b, ResT x ) const ;
+
+protected:
+	unsigned m_restart ;
+} ;
+
 
 } //namespace solvers
 
@@ -16,6 +16,11 @@
 #include "../Utils/NumTraits.hpp"
 #include "../Block/Access.hpp"
 
+#include <Eigen/QR>
+#include <Eigen/Cholesky>
+
+#include <vector>
+
 namespace bogus {
 
 namespace krylov {
@@ -51,6 +56,103 @@ void apply( const Preconditioner *P,  const RhsT &b, ResT& x )
 	else    x = b ;
 }
 
+// Block methods utilities
+
+//! Block version of init(), computing the residual of each column in \p res
+template < typename Matrix, typename RhsT, typename ResT, typename WorkMatrix, typename WorkVector, typename Scalar >
+Scalar blockInit(
+		const Matrix& A, const RhsT &b, ResT &x, WorkMatrix &R0,
+		WorkVector &res, Scalar &scale )
+{
+	R0 = b ;
+	R0.noalias() -= A*x ;
+
+	scale =  1. / ( 1 + b.rows() ) ;
+	res.resize( b.cols() ) ;
+
+	for( std::ptrdiff_t c = 0 ; c < (std::ptrdiff_t) b.cols() ; ++c )
+	{
+		res[c] = R0.col( c ).squaredNorm() ;
+		const Scalar resAt0 = b.col( c ).squaredNorm() ;
+
+		if( res[c] > resAt0 ) {
+			R0.col( c ) = b.col( c ) ;
+			x.col( c ).setZero() ;
+			res[c] = resAt0 ;
+		}
+		res[c] *= scale ;
+	}
+
+	return res.sum() ;
+}
+
+//! Column-wise application of the preconditioner
+template < bool DoTranspose, typename Preconditioner, typename RhsT, typename WorkMatrix >
+void applyColumns( const Preconditioner *P,  const RhsT &B, WorkMatrix& X )
+{
+	if( !P ) {
+		X = B ;
+		return ;
+	}
+
+	X.resize( B.rows(), B.cols() ) ;
+	for( std::ptrdiff_t c = 0 ; c < (std::ptrdiff_t) B.cols() ; ++c )
+	{
+		typename WorkMatrix::ColXpr xc( X.col( c ) ) ;
+		P->template apply< DoTranspose >( B.col( c ), xc ) ;
+	}
+}
+
+//! Computes an orthonormal basis \p Q of the range of \p Z
+/*! Uses a rank-revealing QR decomposition ; directions whose pivot
+	is lower than \p threshold are considered linearly dependent and dropped */
+template < typename WorkMatrix, typename Scalar >
+void orthonormalize( const WorkMatrix &Z, const Scalar threshold, WorkMatrix &Q )
+{
+	const Eigen::ColPivHouseholderQR< WorkMatrix > qr( Z ) ;
+
+	std::ptrdiff_t rank = 0 ;
+	while( rank < (std::ptrdiff_t) std::min( Z.rows(), Z.cols() ) &&
+		   std::abs( qr.matrixQR()( rank, rank ) ) > threshold )
+		++rank ;
+
+	Q = qr.householderQ() * WorkMatrix::Identity( Z.rows(), rank ) ;
+}
+
+//! orthonormalize() after scaling each column to unit norm, so that only linear dependency is detected
+template < typename WorkMatrix >
+void orthonormalizeColumns( WorkMatrix &Z, WorkMatrix &Q )
+{
+	typedef typename WorkMatrix::Scalar Scalar ;
+
+	for( std::ptrdiff_t c = 0 ; c < (std::ptrdiff_t) Z.cols() ; ++c )
+	{
+		const Scalar nrm = Z.col( c ).norm() ;
+		if( nrm > 0 ) Z.col( c ) /= nrm ;
+	}
+
+	orthonormalize( Z, std::sqrt( NumTraits< Scalar >::epsilon() ), Q ) ;
+}
+
+//! Removes the columns of the right-hand-sides that have converged from the active set
+template < typename WorkVector, typename Scalar, typename WorkMatrix >
+void deflate( const WorkVector &res, const Scalar tol,
+			  std::vector< std::ptrdiff_t > &active, WorkMatrix &R )
+{
+	std::size_t kept = 0 ;
+	for( std::size_t j = 0 ; j < active.size() ; ++j )
+	{
+		if( res[ active[j] ] < tol )
+			continue ;
+
+		if( kept != j ) R.col( kept ) = R.col( j ) ;
+		active[ kept++ ] = active[j] ;
+	}
+
+	active.resize( kept ) ;
+	R.conservativeResize( R.rows(), kept ) ;
+}
+
 // Conjugate Gradient
 
 template < typename Mat, typename Prec, typename Traits >
@@ -500,6 +602,344 @@ TFQMR< Mat, Prec, Traits >::vectorSolve( const RhsT &b, ResT x ) const
 	return res ;
 }
 
+// Pipelined CG
+
+template < typename Mat, typename Prec, typename Traits >
+template < typename RhsT, typename ResT >
+typename PipelinedCG< Mat, Prec, Traits >::Scalar
+PipelinedCG< Mat, Prec, Traits >::vectorSolve( const RhsT &b, ResT x ) const
+{
+	typedef typename Traits::template MutableClone< RhsT >::Type Vector ;
+	Vector r ;
+
+	Scalar scale ;
+	Scalar res = init( *m_A, b, x, r, scale ) ;
+	if( res < m_tol ) return res ;
+
+	const std::ptrdiff_t n = m_A->rows() ;
+
+	Vector u( n ), w( n ), m( n ), nu( n ),
+		   p( n ), s( n ), q( n ), z( n ) ;
+	p.setZero() ; s.setZero() ; q.setZero() ; z.setZero() ;
+
+	apply< false >( m_P, r, u ) ;
+	w = ( *m_A ) * u ;
+
+	Scalar gamma = r.dot( u ) ;
+	Scalar delta = w.dot( u ) ;
+	Scalar gamma0 = gamma, alpha = 1, beta = 0 ;
+
+	for( unsigned k = 0 ; k < m_maxIters ; ++k )
+	{
+		apply< false >( m_P, w, m ) ;
+		nu = ( *m_A ) * m ;
+
+		if( k > 0 ) {
+			beta  = gamma / gamma0 ;
+			alpha = gamma / ( delta - beta * gamma / alpha ) ;
+		} else {
+			alpha = gamma / delta ;
+		}
+		gamma0 = gamma ;
+
+		// Single pass over memory : vector updates and dot products of the next iteration
+		Scalar rr = 0 ;
+		gamma = 0 ;
+		delta = 0 ;
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for reduction( +:gamma, delta, rr )
+#endif
+		for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		{
+			z[i] = nu[i] + beta * z[i] ;
+			q[i] =  m[i] + beta * q[i] ;
+			s[i] =  w[i] + beta * s[i] ;
+			p[i] =  u[i] + beta * p[i] ;
+
+			x[i] += alpha * p[i] ;
+			r[i] -= alpha * s[i] ;
+			u[i] -= alpha * q[i] ;
+			w[i] -= alpha * z[i] ;
+
+			gamma += r[i] * u[i] ;
+			delta += w[i] * u[i] ;
+			rr    += r[i] * r[i] ;
+		}
+
+		res = rr * scale ;
+		if( m_callback ) m_callback->trigger( k, res ) ;
+		if( res < m_tol ) break ;
+	}
+
+	return res ;
+}
+
+// Chronopoulos-Gear CG
+
+template < typename Mat, typename Prec, typename Traits >
+template < typename RhsT, typename ResT >
+typename ChronopoulosGearCG< Mat, Prec, Traits >::Scalar
+ChronopoulosGearCG< Mat, Prec, Traits >::vectorSolve( const RhsT &b, ResT x ) const
+{
+	typedef typename Traits::template MutableClone< RhsT >::Type Vector ;
+	Vector r ;
+
+	Scalar scale ;
+	Scalar res = init( *m_A, b, x, r, scale ) ;
+	if( res < m_tol ) return res ;
+
+	const std::ptrdiff_t n = m_A->rows() ;
+
+	Vector u( n ), w( n ), p( n ), s( n ) ;
+	p.setZero() ; s.setZero() ;
+
+	apply< false >( m_P, r, u ) ;
+	w = ( *m_A ) * u ;
+
+	Scalar gamma = r.dot( u ) ;
+	Scalar alpha = gamma / w.dot( u ) ;
+	Scalar beta = 0 ;
+
+	for( unsigned k = 0 ; k < m_maxIters ; ++k )
+	{
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for
+#endif
+		for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		{
+			p[i] = u[i] + beta * p[i] ;
+			s[i] = w[i] + beta * s[i] ;
+			x[i] += alpha * p[i] ;
+			r[i] -= alpha * s[i] ;
+		}
+
+		apply< false >( m_P, r, u ) ;
+		w = ( *m_A ) * u ;
+
+		// Single reduction for the three dot products
+		Scalar gamma1 = 0, delta = 0, rr = 0 ;
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for reduction( +:gamma1, delta, rr )
+#endif
+		for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		{
+			gamma1 += r[i] * u[i] ;
+			delta  += w[i] * u[i] ;
+			rr     += r[i] * r[i] ;
+		}
+
+		res = rr * scale ;
+		if( m_callback ) m_callback->trigger( k, res ) ;
+		if( res < m_tol ) break ;
+
+		beta  = gamma1 / gamma ;
+		alpha = gamma1 / ( delta - beta * gamma1 / alpha ) ;
+		gamma = gamma1 ;
+	}
+
+	return res ;
+}
+
+// Block CG
+
+template < typename Mat, typename Prec, typename Traits >
+template < typename ResT, typename RhsT >
+typename BlockCG< Mat, Prec, Traits >::Scalar
+BlockCG< Mat, Prec, Traits >::solve( const RhsT &b, ResT &x ) const
+{
+	typedef typename Traits::DynMatrix WorkMatrix ;
+	typedef typename Traits::DynVector WorkVector ;
+
+	WorkMatrix R ;
+	WorkVector colRes ;
+
+	Scalar scale ;
+	Scalar res = blockInit( *m_A, b, x, R, colRes, scale ) ;
+
+	std::vector< std::ptrdiff_t > active ;
+	for( std::ptrdiff_t c = 0 ; c < (std::ptrdiff_t) b.cols() ; ++c )
+		active.push_back( c ) ;
+	deflate( colRes, m_tol, active, R ) ;
+
+	if( active.empty() ) return res ;
+
+	WorkMatrix Z, P, Q, alpha, beta, dX ;
+	applyColumns< false >( m_P, R, Z ) ;
+	orthonormalizeColumns( Z, P ) ;
+
+	for( unsigned k = 0 ; k < m_maxIters && P.cols() > 0 ; ++k )
+	{
+		Q = ( *m_A ) * P ;
+		const Eigen::LDLT< WorkMatrix > PtQ( P.transpose() * Q ) ;
+
+		alpha = PtQ.solve( P.transpose() * R ) ;
+		R.noalias() -= Q * alpha ;
+		dX = P * alpha ;
+
+		for( std::size_t j = 0 ; j < active.size() ; ++j )
+		{
+			x.col( active[j] ) += dX.col( j ) ;
+			colRes[ active[j] ] = R.col( j ).squaredNorm() * scale ;
+		}
+
+		res = colRes.sum() ;
+		if( m_callback ) m_callback->trigger( k, res ) ;
+
+		deflate( colRes, m_tol, active, R ) ;
+		if( active.empty() ) break ;
+
+		// New search directions, A-conjugate to the previous ones
+		applyColumns< false >( m_P, R, Z ) ;
+		beta = PtQ.solve( Q.transpose() * Z ) ;
+		Z.noalias() -= P * beta ;
+		orthonormalizeColumns( Z, P ) ;
+	}
+
+	return res ;
+}
+
+template < typename Mat, typename Prec, typename Traits >
+template < typename RhsT, typename ResT >
+typename BlockCG< Mat, Prec, Traits >::Scalar
+BlockCG< Mat, Prec, Traits >::vectorSolve( const RhsT &b, ResT x ) const
+{
+	return solve( b, x ) ;
+}
+
+// Block GMRES
+
+template < typename Mat, typename Prec, typename Traits >
+template < typename ResT, typename RhsT >
+typename BlockGMRES< Mat, Prec, Traits >::Scalar
+BlockGMRES< Mat, Prec, Traits >::solve( const RhsT &b, ResT &x ) const
+{
+	typedef typename Traits::DynMatrix WorkMatrix ;
+	typedef typename Traits::DynVector WorkVector ;
+
+	WorkMatrix R ;
+	WorkVector colRes ;
+
+	Scalar scale ;
+	Scalar res = blockInit( *m_A, b, x, R, colRes, scale ) ;
+
+	std::vector< std::ptrdiff_t > active ;
+	for( std::ptrdiff_t c = 0 ; c < (std::ptrdiff_t) b.cols() ; ++c )
+		active.push_back( c ) ;
+	deflate( colRes, m_tol, active, R ) ;
+
+	const std::ptrdiff_t n = b.rows() ;
+
+	const unsigned restart = ( m_restart == 0 ) ? n : m_restart ;
+	const unsigned m = std::min( restart, m_maxIters ) ;
+
+	// Relative threshold for dropping new Arnoldi directions
+	const Scalar dropTol = n * NumTraits< Scalar >::epsilon() ;
+
+	WorkMatrix V, H, W, Vn, h, E, Y, Z ;
+	std::vector< std::ptrdiff_t > offsets ; // First column of each block of the Arnoldi basis
+
+	// Restart loop
+	unsigned globalIter = 0 ;
+	while( !active.empty() && globalIter < m_maxIters )
+	{
+		const std::ptrdiff_t s = active.size() ;
+
+		// Initial block : orthonormal basis of the preconditioned residuals
+		applyColumns< false >( m_P, R, W ) ;
+		Z = W ;
+		orthonormalizeColumns( Z, V ) ;
+		if( V.cols() == 0 ) break ;
+
+		const WorkMatrix G = V.transpose() * W ;
+
+		offsets.assign( 1, 0 ) ;
+		offsets.push_back( V.cols() ) ;
+		H.resize( V.cols(), 0 ) ;
+
+		unsigned k = 0 ;
+		while( k < m && globalIter + k < m_maxIters )
+		{
+			const std::ptrdiff_t cols = offsets[k+1] ;
+
+			// 1 - Block Arnoldi iteration, with one reorthogonalization pass
+			Z = ( *m_A ) * V.middleCols( offsets[k], cols - offsets[k] ) ;
+			applyColumns< false >( m_P, Z, W ) ;
+			const Scalar ref = W.colwise().norm().maxCoeff() ;
+
+			h = V.transpose() * W ;
+			W.noalias() -= V * h ;
+			Z = V.transpose() * W ;
+			W.noalias() -= V * Z ;
+			h += Z ;
+
+			orthonormalize( W, dropTol * ref, Vn ) ;
+			const std::ptrdiff_t pn = Vn.cols() ;
+
+			// Grow Hessenberg matrix and basis
+			H.conservativeResize( cols + pn, cols ) ;
+			H.bottomLeftCorner( pn, offsets[k] ).setZero() ;
+			H.rightCols( cols - offsets[k] ).topRows( cols ) = h ;
+			H.rightCols( cols - offsets[k] ).bottomRows( pn ) = Vn.transpose() * W ;
+
+			V.conservativeResize( n, cols + pn ) ;
+			V.rightCols( pn ) = Vn ;
+			offsets.push_back( cols + pn ) ;
+			++k ;
+
+			// 2 - Least squares
+			E.setZero( cols + pn, s ) ;
+			E.topRows( G.rows() ) = G ;
+			Y = Eigen::ColPivHouseholderQR< WorkMatrix >( H ).solve( E ) ;
+
+			// 3 - Update residual
+			E.noalias() -= H * Y ;
+			for( std::ptrdiff_t j = 0 ; j < s ; ++j )
+				colRes[ active[j] ] = E.col( j ).squaredNorm() * scale ;
+
+			res = colRes.sum() ;
+			if( m_callback ) m_callback->trigger( globalIter + k - 1, res ) ;
+
+			if( pn == 0 || ( colRes.maxCoeff() < m_tol ) )
+				break ;
+		}
+
+		Z = V.leftCols( Y.rows() ) * Y ;
+		for( std::ptrdiff_t j = 0 ; j < s ; ++j )
+			x.col( active[j] ) += Z.col( j ) ;
+
+		globalIter += k ;
+		deflate( colRes, m_tol, active, R ) ;
+
+		if( active.empty() || globalIter >= m_maxIters )
+			break ;
+
+		// Restart : true residuals of remaining columns
+		W.resize( n, active.size() ) ;
+		for( std::size_t j = 0 ; j < active.size() ; ++j )
+		{
+			W.col( j ) = x.col( active[j] ) ;
+			R.col( j ) = b.col( active[j] ) ;
+		}
+		R.noalias() -= ( *m_A ) * W ;
+
+		for( std::size_t j = 0 ; j < active.size() ; ++j )
+			colRes[ active[j] ] = R.col( j ).squaredNorm() * scale ;
+		res = colRes.sum() ;
+
+		deflate( colRes, m_tol, active, R ) ;
+	}
+
+	return res ;
+}
+
+template < typename Mat, typename Prec, typename Traits >
+template < typename RhsT, typename ResT >
+typename BlockGMRES< Mat, Prec, Traits >::Scalar
+BlockGMRES< Mat, Prec, Traits >::vectorSolve( const RhsT &b, ResT x ) const
+{
+	return solve( b, x ) ;
+}
+
 } //namespace solvers
 
 } //namespace krylov
@@ -0,0 +1,182 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_MULTILEVEL_GAUSS_SEIDEL_HPP
+#define BOGUS_MULTILEVEL_GAUSS_SEIDEL_HPP
+
+#include "ConstrainedSolverBase.hpp"
+#include "GaussSeidel.hpp"
+#include "SparseCholesky.hpp"
+
+#include "../Block/SparseBlockMatrix.hpp"
+
+#include <limits>
+#include <vector>
+
+namespace bogus
+{
+
+//! Multilevel Gauss-Seidel solver, using aggregation-based coarse corrections
+/*!
+  Gauss-Seidel sweeps only propagate information between neighbouring rows, so that
+  problems with long chains of interactions, such as tall stacks, require many iterations.
+
+  This solver performs V-cycles where
+   - the non-smooth problem is smoothed by a few sweeps of a colored GaussSeidel solver ;
+   - neighbouring rows are grouped in aggregates, and a correction \f$ P e \f$, with \p P the
+     piecewise-constant prolongation from the aggregates, is computed by solving the linear
+     Galerkin system \f$ P^T M P e = - P^T y \f$ ; rows for which \p x is zero, such as separating
+     contacts, are excluded from the residual \p y ;
+   - the corrected \p x is projected on the constraints, and accepted only if it decreases the error
+     as computed by eval(), possibly after a few backtracking steps.
+
+  The Galerkin system is itself solved by a linear V-cycle on a hierarchy of aggregates, with block
+  Gauss-Seidel smoothing and a SparseBlockCholesky factorization of the coarsest level. The hierarchy
+  is built once by setMatrix(), from the block graph of the system matrix.
+
+  The \p NSLaw should define a projectOnConstraint() function, as SOCLaw does.
+  \warning All the rows of the system matrix should have the same dimension
+  */
+template < typename BlockMatrixType >
+class MultilevelGaussSeidel : public ConstrainedSolverBase< MultilevelGaussSeidel< BlockMatrixType >, BlockMatrixType >
+{
+public:
+	typedef ConstrainedSolverBase< MultilevelGaussSeidel, BlockMatrixType > Base ;
+	typedef typename Base::GlobalProblemTraits GlobalProblemTraits ;
+	typedef typename Base::Scalar Scalar ;
+	typedef typename Base::Index Index ;
+
+	typedef BlockMatrixTraits< BlockMatrixType > Traits ;
+	typedef typename Traits::BlockType BlockType ;
+
+	//! Coarse Galerkin operators
+	typedef SparseBlockMatrix< BlockType, flags::SYMMETRIC > CoarseMatrixType ;
+	//! Piecewise-constant prolongation from one level to the previous one
+	typedef SparseBlockMatrix< BlockType > ProlongationType ;
+
+	typedef GaussSeidel< BlockMatrixType > GaussSeidelType ;
+	typedef GaussSeidel< CoarseMatrixType > CoarseGaussSeidelType ;
+
+	//! Default constructor -- you will have to call setMatrix() before using the solve() function
+	MultilevelGaussSeidel( ) : Base() { init() ; }
+	//! Constructor with the system matrix
+	explicit MultilevelGaussSeidel( const BlockObjectBase< BlockMatrixType > & matrix ) : Base()
+	{ init() ; setMatrix( matrix ) ; }
+
+	//! Finds an approximate solution for a constrained linear problem
+	/*!
+	  Stops when the residual computed in eval() is below \ref m_tol, or the number
+	  of V-cycles exceeds \ref m_maxIters
+	  \param law The non-smooth law
+	  \param b   The constant term of the linear system
+	  \param x   Both the initial guess and the result
+	  \returns the error as returned by the eval() function
+	  */
+	template < typename NSLaw, typename RhsT, typename ResT >
+	Scalar solve( const NSLaw &law, const RhsT &b, ResT &x ) const ;
+
+	//! Sets the system matrix, and builds the hierarchy of aggregates and coarse operators
+	MultilevelGaussSeidel& setMatrix( const BlockObjectBase< BlockMatrixType > & matrix ) ;
+
+	//! Sets the number of Gauss-Seidel sweeps before and after each coarse correction
+	void setSmoothingSweeps( unsigned sweeps )
+	{
+		m_smoothingSweeps = sweeps ;
+		m_gs.setMaxIters( sweeps ) ;
+		m_gs.setEvalEvery( sweeps ) ;
+	}
+	//! Sets the number of Gauss-Seidel sweeps before and after each coarse correction of the linear V-cycle
+	/*! Takes effect at the next call to setMatrix() */
+	void setCoarseSmoothingSweeps( unsigned sweeps ) { m_coarseSweeps = sweeps ; }
+	//! Sets the maximum number of levels, including the finest one. Takes effect at the next call to setMatrix()
+	void setMaxLevels( unsigned levels ) { m_maxLevels = levels ; }
+	//! Sets the number of rows below which a level is not coarsened further. Takes effect at the next call to setMatrix()
+	void setCoarsestSize( unsigned size ) { m_coarsestSize = size ; }
+	//! Sets the maximum number of backtracking steps of the coarse correction
+	void setLineSearchIterations( unsigned lsIterations ) { m_lsIters = lsIterations ; }
+
+	unsigned smoothingSweeps() const { return m_smoothingSweeps ; }
+	unsigned coarseSmoothingSweeps() const { return m_coarseSweeps ; }
+	unsigned maxLevels() const { return m_maxLevels ; }
+	unsigned coarsestSize() const { return m_coarsestSize ; }
+	unsigned lineSearchIterations() const { return m_lsIters ; }
+
+	//! Number of levels of the current hierarchy, including the finest one
+	unsigned nLevels() const { return m_nCoarseLevels + 1 ; }
+	//! Number of rows of the \p level -th level
+	Index levelSize( unsigned level ) const
+	{ return level == 0 ? m_matrix->rowsOfBlocks() : m_levels[ level-1 ].matrix.rowsOfBlocks() ; }
+
+	//! Smoother of the finest level
+	GaussSeidelType& gaussSeidel() { return m_gs ; }
+	const GaussSeidelType& gaussSeidel() const { return m_gs ; }
+
+protected:
+
+	typedef typename GlobalProblemTraits::DynVector DynVector ;
+
+	//! Coarse level of the hierarchy
+	struct Level {
+		//! Prolongation from this level to the previous one
+		ProlongationType prolongation ;
+		//! Galerkin operator
+		CoarseMatrixType matrix ;
+		CoarseGaussSeidelType gs ;
+	} ;
+
+	//! Sets up the default values for all parameters
+	void init()
+	{
+		m_tol = 1.e-6 ;
+		m_maxIters = 100 ;
+		m_coarseSweeps = 2 ;
+		m_maxLevels = 10 ;
+		m_coarsestSize = 64 ;
+		m_lsIters = 4 ;
+		m_nCoarseLevels = 0 ;
+
+		// The smoother stops after its evaluation, so that it never reverts to a previous iterate
+		m_gs.setTol( std::numeric_limits< Scalar >::max() ) ;
+		setSmoothingSweeps( 3 ) ;
+	}
+
+	//! Groups the rows of \p matrix in aggregates ; returns the number of aggregates
+	template < typename Derived >
+	static Index aggregate( const SparseBlockMatrixBase< Derived >& matrix, std::vector< Index > &aggregates ) ;
+
+	//! Appends a coarse level to the hierarchy
+	template < typename Derived >
+	bool coarsen( const SparseBlockMatrixBase< Derived >& matrix ) ;
+
+	//! Approximately solves the linear system of the \p level -th level, \f$ M_l e = -r \f$, with a V-cycle
+	void linearCycle( unsigned level, const DynVector &r, DynVector &e ) const ;
+
+	using Base::m_matrix ;
+	using Base::m_maxIters ;
+	using Base::m_tol ;
+	using Base::m_stats ;
+	using Base::m_scaling ;
+
+	unsigned m_smoothingSweeps ;
+	unsigned m_coarseSweeps ;
+	unsigned m_maxLevels ;
+	unsigned m_coarsestSize ;
+	unsigned m_lsIters ;
+
+	GaussSeidelType m_gs ;
+	//! Coarse levels ; only the first m_nCoarseLevels ones are in use
+	std::vector< Level > m_levels ;
+	unsigned m_nCoarseLevels ;
+	SparseBlockCholesky< CoarseMatrixType > m_coarsest ;
+} ;
+
+} //namespace bogus
+
+#endif
@@ -0,0 +1,348 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_MULTILEVEL_GAUSS_SEIDEL_IMPL_HPP
+#define BOGUS_MULTILEVEL_GAUSS_SEIDEL_IMPL_HPP
+
+#include "MultilevelGaussSeidel.hpp"
+#include "ConstrainedSolverBase.impl.hpp"
+#include "GaussSeidel.impl.hpp"
+#include "SparseCholesky.impl.hpp"
+#include "RowGraph.hpp"
+
+#include "../Block/Access.hpp"
+
+#include <limits>
+
+namespace bogus
+{
+
+namespace multilevel_impl
+{
+
+//! Unconstrained law, with which GaussSeidel solves the linear system \f$ M x + b = 0 \f$
+template < DenseIndexType Dimension, typename Scalar >
+struct LinearLaw
+{
+	enum { dimension = Dimension } ;
+	typedef LocalProblemTraits< Dimension, Scalar > Traits ;
+
+	Scalar eval( const unsigned,
+	             const typename Traits::Vector &,
+	             const typename Traits::Vector &y ) const
+	{ return y.squaredNorm() ; }
+
+	bool solveLocal( const unsigned,
+	                 const typename Traits::Matrix &A,
+	                 const typename Traits::Vector &b,
+	                 typename Traits::Vector &x,
+	                 const Scalar ) const
+	{
+		x = - A.ldlt().solve( b ) ;
+		return true ;
+	}
+
+	void projectOnConstraint( const unsigned, typename Traits::Vector & ) const
+	{}
+
+	template< typename Segment >
+	void dualityCOV( const unsigned , const Segment& ,
+	                 typename Traits::Vector& s ) const
+	{ s.setZero() ; }
+} ;
+
+} //namespace multilevel_impl
+
+template < typename BlockMatrixType >
+template < typename Derived >
+typename MultilevelGaussSeidel< BlockMatrixType >::Index
+MultilevelGaussSeidel< BlockMatrixType >::aggregate(
+		const SparseBlockMatrixBase< Derived >& matrix, std::vector< Index > &aggregates )
+{
+	RowGraph graph ;
+	graph.setFrom( matrix ) ;
+
+	const std::ptrdiff_t n = graph.size() ;
+	aggregates.assign( n, -1 ) ;
+	Index nAggregates = 0 ;
+
+	// Rows whose neighbours are all free become the roots of new aggregates
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		if( aggregates[ i ] != -1 )
+			continue ;
+
+		bool free = true ;
+		for( std::ptrdiff_t e = graph.offsets[ i ] ; free && e != graph.offsets[ i+1 ] ; ++e )
+			free = ( aggregates[ graph.neighbours[ e ] ] == -1 ) ;
+
+		if( free )
+		{
+			aggregates[ i ] = nAggregates ;
+			for( std::ptrdiff_t e = graph.offsets[ i ] ; e != graph.offsets[ i+1 ] ; ++e )
+				aggregates[ graph.neighbours[ e ] ] = nAggregates ;
+			++nAggregates ;
+		}
+	}
+
+	// Remaining rows join an aggregate of their neighbourhood, or form their own one
+	const std::vector< Index > roots( aggregates ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		if( roots[ i ] != -1 )
+			continue ;
+
+		for( std::ptrdiff_t e = graph.offsets[ i ] ; e != graph.offsets[ i+1 ] ; ++e )
+		{
+			if( roots[ graph.neighbours[ e ] ] != -1 )
+			{
+				aggregates[ i ] = roots[ graph.neighbours[ e ] ] ;
+				break ;
+			}
+		}
+
+		if( aggregates[ i ] == -1 )
+			aggregates[ i ] = nAggregates++ ;
+	}
+
+	return nAggregates ;
+}
+
+template < typename BlockMatrixType >
+template < typename Derived >
+bool MultilevelGaussSeidel< BlockMatrixType >::coarsen( const SparseBlockMatrixBase< Derived >& matrix )
+{
+	const Index n = matrix.rowsOfBlocks() ;
+
+	std::vector< Index > aggregates ;
+	const Index nAggregates = aggregate( matrix, aggregates ) ;
+
+	if( nAggregates == 0 || nAggregates > .8 * n )
+		return false ;
+
+	Level &level = m_levels[ m_nCoarseLevels ] ;
+
+	const Index dimension = matrix.blockRows( 0 ) ;
+	const BlockType identity = BlockType::Identity( dimension, dimension ) ;
+
+	// Tentative piecewise-constant prolongation
+	ProlongationType P0 ;
+	P0.setRows( n, dimension ) ;
+	P0.setCols( nAggregates, dimension ) ;
+	for( Index i = 0 ; i < n ; ++i )
+		P0.insertBack( i, aggregates[ i ] ) = identity ;
+	P0.finalize() ;
+
+	// Smoothing with a damped block-Jacobi step, P = ( I - omega D^-1 M ) P0,
+	// so that coarse corrections do not introduce jumps at the boundaries of the aggregates
+	ProlongationType Dinv ;
+	Dinv.setRows( n, dimension ) ;
+	Dinv.setCols( n, dimension ) ;
+	for( Index i = 0 ; i < n ; ++i )
+		Dinv.insertBack( i, i ) = matrix.diagonal( i ).ldlt().solve( identity ) ;
+	Dinv.finalize() ;
+
+	ProlongationType DM ;
+	DM = Dinv * matrix.derived() ;
+
+	// omega = 4 / ( 3 rho( D^-1 M ) ), with rho bounded by the infinity norm of D^-1 M
+	Scalar rho = 0 ;
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		typename GlobalProblemTraits::DynVector rowSums = GlobalProblemTraits::DynVector::Zero( dimension ) ;
+		for( typename ProlongationType::InnerIterator it( DM.innerIterator( i ) ) ; it ; ++it )
+			rowSums += DM.block( it.ptr() ).cwiseAbs().rowwise().sum() ;
+		rho = std::max( rho, rowSums.maxCoeff() ) ;
+	}
+
+	ProlongationType DMP0 ;
+	DMP0 = DM * P0 ;
+	ProlongationType &P = level.prolongation ;
+	P = P0 - ( 4 / ( 3 * rho ) ) * DMP0 ;
+
+	// Galerkin operator
+	ProlongationType MP ;
+	MP = matrix.derived() * P ;
+	level.matrix = P.transpose() * MP ;
+
+	++m_nCoarseLevels ;
+	return true ;
+}
+
+template < typename BlockMatrixType >
+MultilevelGaussSeidel< BlockMatrixType >& MultilevelGaussSeidel< BlockMatrixType >::setMatrix(
+		const BlockObjectBase< BlockMatrixType > & matrix )
+{
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Setup ) ; )
+
+	m_matrix = &matrix ;
+	Base::updateScalings() ;
+
+	m_gs.setMatrix( matrix ) ;
+	m_gs.coloring().update( true, matrix.derived() ) ;
+
+	// Levels are allocated once, as the coarse solvers keep pointers to their matrices
+	std::vector< Level >( m_maxLevels > 1 ? m_maxLevels - 1 : 0 ).swap( m_levels ) ;
+	m_nCoarseLevels = 0 ;
+
+	if( m_levels.empty() || m_matrix->rowsOfBlocks() <= (Index) m_coarsestSize
+			|| !coarsen( matrix.derived() ) )
+		return *this ;
+
+	while( m_nCoarseLevels < m_levels.size()
+	       && m_levels[ m_nCoarseLevels-1 ].matrix.rowsOfBlocks() > (Index) m_coarsestSize
+	       && coarsen( m_levels[ m_nCoarseLevels-1 ].matrix ) )
+	{}
+
+	for( unsigned l = 0 ; l < m_nCoarseLevels ; ++l )
+	{
+		Level &level = m_levels[ l ] ;
+		level.gs.setMatrix( level.matrix ) ;
+		level.gs.coloring().update( true, level.matrix ) ;
+		level.gs.setTol( std::numeric_limits< Scalar >::max() ) ;
+		level.gs.setMaxIters( m_coarseSweeps ) ;
+		level.gs.setEvalEvery( m_coarseSweeps ) ;
+	}
+
+	// The coarsest level is solved directly, unless its Galerkin operator is singular
+	m_coarsest.compute( m_levels[ m_nCoarseLevels-1 ].matrix ) ;
+
+	return *this ;
+}
+
+template < typename BlockMatrixType >
+void MultilevelGaussSeidel< BlockMatrixType >::linearCycle(
+		unsigned level, const DynVector &r, DynVector &e ) const
+{
+	typedef multilevel_impl::LinearLaw< BlockType::RowsAtCompileTime, Scalar > LinearLaw ;
+	const LinearLaw law ;
+
+	const Level &current = m_levels[ level-1 ] ;
+	e.setZero( r.rows() ) ;
+
+	if( level == m_nCoarseLevels )
+	{
+		if( m_coarsest.status() == SparseBlockCholesky< CoarseMatrixType >::Success )
+		{
+			m_coarsest.solve( -r, e ) ;
+		} else {
+			// Rank-deficient operator ; approximate solve
+			for( unsigned sweep = 0 ; sweep < 10 ; ++sweep )
+				current.gs.solve( law, r, e, false ) ;
+		}
+		return ;
+	}
+
+	const ProlongationType &P = m_levels[ level ].prolongation ;
+
+	current.gs.solve( law, r, e, false ) ;
+
+	DynVector res = r ;
+	current.matrix.template multiply< false >( e, res, 1, 1 ) ;
+
+	const DynVector rc = P.transpose() * res ;
+	DynVector ec ;
+	linearCycle( level+1, rc, ec ) ;
+	P.template multiply< false >( ec, e, 1, 1 ) ;
+
+	current.gs.solve( law, r, e, false ) ;
+}
+
+template < typename BlockMatrixType >
+template < typename NSLaw, typename RhsT, typename ResT >
+typename MultilevelGaussSeidel< BlockMatrixType >::Scalar
+MultilevelGaussSeidel< BlockMatrixType >::solve( const NSLaw &law, const RhsT &b, ResT &x ) const
+{
+	assert( m_matrix ) ;
+
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
+
+	typedef Segmenter< NSLaw::dimension, DynVector, Index > VectorSegmenter ;
+	typedef Segmenter< NSLaw::dimension, const ResT, Index > ResSegmenter ;
+
+	const Index n = m_matrix->rowsOfBlocks() ;
+	const Index* offsets = m_matrix->rowOffsets() ;
+
+	DynVector y( x.rows() ), r( x.rows() ), rc, ec, dx( x.rows() ), xt( x.rows() ) ;
+	VectorSegmenter rSeg( r, offsets ) ;
+	const ResSegmenter xSeg( x, offsets ) ;
+
+	Scalar err = std::numeric_limits< Scalar >::max() ;
+
+	for( unsigned cycle = 0 ; ; ++cycle )
+	{
+		if( cycle > 0 )
+			m_gs.solve( law, b, x, false ) ;
+
+		{
+			BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+			r = b ;
+			m_matrix->template multiply< false >( x, r, 1, 1 ) ;
+		}
+		err = m_gs.eval( law, r, x ) ;
+
+		this->m_callback.trigger( cycle, err ) ;
+
+		if( err < m_tol || cycle == m_maxIters )
+			break ;
+
+		if( m_nCoarseLevels == 0 )
+			continue ;
+
+		// Coarse correction of the natural residual  s_i x_i - P_K( s_i x_i - y_i ), with s_i the row scaling ;
+		// it vanishes at the solution, and is equal to y_i on rows where x_i is in the interior of the cone
+		typename NSLaw::Traits::Vector lx, ly ;
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for private( lx, ly )
+#endif
+		for( Index i = 0 ; i < n ; ++i )
+		{
+			law.dualityCOV( i, rSeg[ i ], ly ) ;
+			ly += rSeg[ i ] ;
+			lx = m_scaling[ i ] * xSeg[ i ] ;
+			ly = lx - ly ;
+			law.projectOnConstraint( i, ly ) ;
+			rSeg[ i ] = lx - ly ;
+		}
+
+		const ProlongationType &P = m_levels[ 0 ].prolongation ;
+		rc = P.transpose() * r ;
+		linearCycle( 1, rc, ec ) ;
+		dx.setZero() ;
+		P.template multiply< false >( ec, dx, 1, 1 ) ;
+
+		// Backtracking on the projected correction
+		Scalar step = 1 ;
+		for( unsigned ls = 0 ; ls <= m_lsIters ; ++ls, step *= .5 )
+		{
+			xt = x + step * dx ;
+			Base::projectOnConstraints( law, xt ) ;
+			m_gs.solve( law, b, xt, false ) ;
+
+			{
+				BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+				y = b ;
+				m_matrix->template multiply< false >( xt, y, 1, 1 ) ;
+			}
+			const Scalar DBGe = m_gs.eval( law, y, xt ) ; fprintf(stderr,"DBG ls %u %g -> %g\n", ls, err, DBGe) ;
+			if( DBGe < err )
+			{
+				x = xt ;
+				break ;
+			}
+		}
+	}
+
+	return err ;
+}
+
+} //namespace bogus
+
+#endif
@@ -59,6 +59,26 @@ class DiagonalLDLTPreconditioner
 {
 } ;
 
+//! Block incomplete LDLT preconditioner
+/*! Defines the preconditioner matrix \f$ P^{-1} \f$ as \f$ ( L D L^T )^{-1} \f$, where \p L is a unit
+	block-lower-triangular matrix and \p D a block-diagonal matrix such that \f$ L D L^T \f$ matches the
+	system matrix on the sparsity pattern of \p L.
+	With the default fill level of zero, this pattern is the one of the lower triangle of the system matrix,
+	which amounts to a block IC(0) factorization without the square roots.
+	Higher fill levels ( ILDLT(k) ) may be selected with setFillLevel().
+
+	The symbolic analysis is reused as long as the sparsity pattern of the system matrix does not change.
+	Both the numeric factorization and the triangular solves are parallelized over the rows that
+	are independent from each other, grouped in levels.
+
+	Requires a row-major SparseBlockMatrix with fixed-size square blocks,
+	and works best for symmetric positive definite matrices.
+	*/
+template < typename MatrixType >
+class IncompleteLDLTPreconditioner
+{
+} ;
+
 //! Matrix preconditioner
 /*! Explicitely define the preconditioner with an arbitray matrix*/
 
@@ -10,6 +10,12 @@
 
 #include "Preconditioners.hpp"
 #include "../Utils/NumTraits.hpp"
+#include "../Utils/Executor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
 
 #ifndef BOGUS_PRECONDITIONERS_IMPL_HPP
 #define BOGUS_PRECONDITIONERS_IMPL_HPP
@@ -101,6 +107,385 @@ class DiagonalLDLTPreconditioner< BlockObjectBase< BlockMatrixType > >
 {
 } ;
 
+namespace preconditioners_impl {
+
+//! Numeric factorization of the rows of a level of an IncompleteLDLTPreconditioner
+template < typename Precond, typename MatrixT >
+struct ILDLTFactorizeTask : public RangeTask
+{
+	ILDLTFactorizeTask( Precond& precond_, const MatrixT& matrix_, const std::size_t* rows_ )
+	    : precond( precond_ ), matrix( matrix_ ), rows( rows_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		typename Precond::BlockArray F ;
+		for( std::ptrdiff_t r = begin ; r < end ; ++r )
+			precond.factorizeRow( matrix, rows[ r ], F ) ;
+	}
+
+	Precond& precond ;
+	const MatrixT& matrix ;
+	const std::size_t* rows ;
+} ;
+
+//! Forward or backward substitution on the rows of a level of an IncompleteLDLTPreconditioner
+template < typename Precond, bool Backward >
+struct ILDLTSolveTask : public RangeTask
+{
+	ILDLTSolveTask( const Precond& precond_, typename Precond::Vector& x_, const std::size_t* rows_ )
+	    : precond( precond_ ), x( x_ ), rows( rows_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		for( std::ptrdiff_t r = begin ; r < end ; ++r )
+		{
+			if( Backward ) precond.backwardRow( rows[ r ], x ) ;
+			else           precond.forwardRow ( rows[ r ], x ) ;
+		}
+	}
+
+	const Precond& precond ;
+	typename Precond::Vector& x ;
+	const std::size_t* rows ;
+} ;
+
+} //namespace preconditioners_impl
+
+template < typename BlockMatrixType >
+class IncompleteLDLTPreconditioner< BlockObjectBase< BlockMatrixType > >
+{
+public:
+	typedef BlockMatrixTraits< BlockMatrixType > Traits ;
+	typedef typename Traits::Scalar    Scalar ;
+	typedef typename Traits::Index     Index ;
+	typedef ProblemTraits< Scalar > GlobalProblemTraits ;
+	typedef typename GlobalProblemTraits::DynVector Vector ;
+
+	enum { Dimension = Traits::RowsPerBlock } ;
+	typedef LocalProblemTraits< Dimension, Scalar > BlockProblemTraits ;
+	typedef typename BlockProblemTraits::Matrix Block ;
+	typedef typename ResizableSequenceContainer< Block >::Type BlockArray ;
+
+	IncompleteLDLTPreconditioner() : m_fillLevel( 0 )
+	{}
+
+	//! Sets the maximum level of fill-in of the factorization ; 0 keeps the sparsity pattern of the matrix
+	/*! Takes effect at the next call to setMatrix() */
+	void setFillLevel( unsigned level )
+	{
+		m_fillLevel = level ;
+		m_patternStart.clear() ;
+	}
+	unsigned fillLevel() const { return m_fillLevel ; }
+
+	void setMatrix( const SparseBlockMatrixBase< BlockMatrixType > &matrix )
+	{
+		BOGUS_STATIC_ASSERT( !Traits::is_col_major, MATRICES_ORDERING_IS_INCONSISTENT ) ;
+		BOGUS_STATIC_ASSERT( (int) Traits::RowsPerBlock != (int) internal::DYNAMIC &&
+		                     (int) Traits::RowsPerBlock == (int) Traits::ColsPerBlock,
+		                     BLOCKS_MUST_HAVE_FIXED_DIMENSIONS ) ;
+
+		if( !samePattern( matrix ) )
+			analyze( matrix ) ;
+
+		factorize( matrix ) ;
+	}
+
+	template < bool transpose, typename ResT, typename RhsT >
+	void apply( const RhsT& rhs, ResT &res ) const
+	{
+		// P^-1 is symmetric
+		Vector x ;
+		for( Index c = 0 ; c < (Index) rhs.cols() ; ++c )
+		{
+			x = rhs.col( c ) ;
+			substitute< false >( m_forwardLevels, m_forwardRows, x ) ;
+			substitute< true  >( m_backwardLevels, m_backwardRows, x ) ;
+			res.col( c ) = x ;
+		}
+	}
+
+	// Row kernels of the parallel tasks
+
+	void factorizeRow( const SparseBlockMatrixBase< BlockMatrixType > &matrix, const std::size_t i, BlockArray& F ) ;
+
+	void forwardRow( const std::size_t i, Vector& x ) const
+	{
+		typename BlockProblemTraits::Vector xi = x.template segment< Dimension >( Dimension*i ) ;
+		for( std::size_t p = m_rowStart[i] ; p < m_rowStart[i+1] ; ++p )
+			xi -= m_L[p] * x.template segment< Dimension >( Dimension*m_cols[p] ) ;
+		x.template segment< Dimension >( Dimension*i ) = xi ;
+	}
+
+	void backwardRow( const std::size_t i, Vector& x ) const
+	{
+		typename BlockProblemTraits::Vector xi = m_Dinv[i] * x.template segment< Dimension >( Dimension*i ) ;
+		for( std::size_t t = m_transposeStart[i] ; t < m_transposeStart[i+1] ; ++t )
+			xi.noalias() -= m_L[ m_transposePtr[t] ].transpose() * x.template segment< Dimension >( Dimension*m_transposeRows[t] ) ;
+		x.template segment< Dimension >( Dimension*i ) = xi ;
+	}
+
+private:
+
+	//! Whether the strictly lower pattern of \p matrix is the one used for the last analysis
+	bool samePattern( const SparseBlockMatrixBase< BlockMatrixType > &matrix ) const ;
+
+	//! Computes the pattern of the factor, its transpose, and the level schedules
+	void analyze( const SparseBlockMatrixBase< BlockMatrixType > &matrix ) ;
+
+	void factorize( const SparseBlockMatrixBase< BlockMatrixType > &matrix )
+	{
+		typedef preconditioners_impl::ILDLTFactorizeTask< IncompleteLDLTPreconditioner,
+		        SparseBlockMatrixBase< BlockMatrixType > > Task ;
+
+		for( std::size_t l = 0 ; l + 1 < m_forwardLevels.size() ; ++l )
+		{
+			const Task task( *this, matrix, &m_forwardRows[ m_forwardLevels[l] ] ) ;
+			const std::ptrdiff_t n = m_forwardLevels[l+1] - m_forwardLevels[l] ;
+			parallel_for( 0, n, task, n >= MinParallelRows ) ;
+		}
+	}
+
+	template < bool Backward >
+	void substitute( const std::vector< std::size_t > &levels, const std::vector< std::size_t > &rows, Vector& x ) const
+	{
+		typedef preconditioners_impl::ILDLTSolveTask< IncompleteLDLTPreconditioner, Backward > Task ;
+
+		for( std::size_t l = 0 ; l + 1 < levels.size() ; ++l )
+		{
+			const Task task( *this, x, &rows[ levels[l] ] ) ;
+			const std::ptrdiff_t n = levels[l+1] - levels[l] ;
+			parallel_for( 0, n, task, n >= MinParallelRows ) ;
+		}
+	}
+
+	//! Groups rows in levels, such that a row only depends on rows from previous levels
+	static void schedule( const std::vector< std::size_t >& start, const std::vector< std::size_t >& deps,
+	                      bool reverse, std::vector< std::size_t >& levels, std::vector< std::size_t >& rows ) ;
+
+	//! Levels with less rows are processed serially
+	enum { MinParallelRows = 64 } ;
+
+	unsigned m_fillLevel ;
+
+	// Strictly lower pattern of the analyzed matrix
+	std::vector< std::size_t > m_patternStart ;
+	std::vector< Index > m_pattern ;
+
+	// Strictly lower part of L, by rows
+	std::vector< std::size_t > m_rowStart ;
+	std::vector< std::size_t > m_cols ;
+	BlockArray m_L ;
+	// Inverse of the diagonal blocks of D
+	BlockArray m_Dinv ;
+
+	// Transpose of L : rows of L with a block in each column
+	std::vector< std::size_t > m_transposeStart ;
+	std::vector< std::size_t > m_transposeRows ;
+	std::vector< std::size_t > m_transposePtr ;
+
+	// Level schedules
+	std::vector< std::size_t > m_forwardLevels ;
+	std::vector< std::size_t > m_forwardRows ;
+	std::vector< std::size_t > m_backwardLevels ;
+	std::vector< std::size_t > m_backwardRows ;
+} ;
+
+template < typename BlockMatrixType >
+bool IncompleteLDLTPreconditioner< BlockObjectBase< BlockMatrixType > >::samePattern(
+        const SparseBlockMatrixBase< BlockMatrixType > &matrix ) const
+{
+	const Index n = matrix.rowsOfBlocks() ;
+	if( m_patternStart.size() != (std::size_t) n + 1 )
+		return false ;
+
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		std::size_t p = m_patternStart[i] ;
+		for( typename BlockMatrixType::InnerIterator it( matrix.innerIterator( i ) ) ; it ; ++it )
+		{
+			if( it.inner() >= i ) continue ;
+			if( p == m_patternStart[i+1] || m_pattern[p] != it.inner() )
+				return false ;
+			++p ;
+		}
+		if( p != m_patternStart[i+1] )
+			return false ;
+	}
+
+	return true ;
+}
+
+template < typename BlockMatrixType >
+void IncompleteLDLTPreconditioner< BlockObjectBase< BlockMatrixType > >::analyze(
+        const SparseBlockMatrixBase< BlockMatrixType > &matrix )
+{
+	const std::size_t n = matrix.rowsOfBlocks() ;
+
+	m_patternStart.assign( 1, 0 ) ;
+	m_pattern.clear() ;
+	m_rowStart.assign( 1, 0 ) ;
+	m_cols.clear() ;
+
+	// Rows of L having a block in each column, with the corresponding fill levels
+	std::vector< std::vector< std::pair< std::size_t, unsigned > > > colRows( n ) ;
+	std::map< std::size_t, unsigned > row ;
+
+	for( std::size_t i = 0 ; i < n ; ++i )
+	{
+		row.clear() ;
+		for( typename BlockMatrixType::InnerIterator it( matrix.innerIterator( i ) ) ; it ; ++it )
+		{
+			if( (std::size_t) it.inner() < i ) {
+				m_pattern.push_back( it.inner() ) ;
+				row[ it.inner() ] = 0 ;
+			}
+		}
+		m_patternStart.push_back( m_pattern.size() ) ;
+
+		// Symbolic elimination : L(i,k) and L(j,k) create fill at L(i,j)
+		// Columns are visited in increasing order, and fill only appears on the right
+		for( std::map< std::size_t, unsigned >::iterator k = row.begin() ; m_fillLevel > 0 && k != row.end() ; ++k )
+		{
+			for( std::size_t e = 0 ; e < colRows[ k->first ].size() ; ++e )
+			{
+				const std::pair< std::size_t, unsigned >& jk = colRows[ k->first ][ e ] ;
+				const unsigned level = k->second + jk.second + 1 ;
+				if( level > m_fillLevel ) continue ;
+
+				std::map< std::size_t, unsigned >::iterator ij = row.find( jk.first ) ;
+				if( ij == row.end() )
+					row[ jk.first ] = level ;
+				else
+					ij->second = std::min( ij->second, level ) ;
+			}
+		}
+
+		for( std::map< std::size_t, unsigned >::const_iterator k = row.begin() ; k != row.end() ; ++k )
+		{
+			m_cols.push_back( k->first ) ;
+			if( m_fillLevel > 0 )
+				colRows[ k->first ].push_back( std::make_pair( i, k->second ) ) ;
+		}
+		m_rowStart.push_back( m_cols.size() ) ;
+	}
+
+	const std::size_t nnz = m_cols.size() ;
+	m_L.resize( nnz ) ;
+	m_Dinv.resize( n ) ;
+
+	// Transpose structure
+	m_transposeStart.assign( n + 1, 0 ) ;
+	for( std::size_t p = 0 ; p < nnz ; ++p )
+		++m_transposeStart[ m_cols[p] + 1 ] ;
+	for( std::size_t i = 0 ; i < n ; ++i )
+		m_transposeStart[ i+1 ] += m_transposeStart[ i ] ;
+
+	m_transposeRows.resize( nnz ) ;
+	m_transposePtr.resize( nnz ) ;
+	{
+		std::vector< std::size_t > cursor( m_transposeStart.begin(), m_transposeStart.end() - 1 ) ;
+		for( std::size_t i = 0 ; i < n ; ++i )
+		{
+			for( std::size_t p = m_rowStart[i] ; p < m_rowStart[i+1] ; ++p )
+			{
+				const std::size_t t = cursor[ m_cols[p] ]++ ;
+				m_transposeRows[t] = i ;
+				m_transposePtr [t] = p ;
+			}
+		}
+	}
+
+	schedule( m_rowStart, m_cols, false, m_forwardLevels, m_forwardRows ) ;
+	schedule( m_transposeStart, m_transposeRows, true, m_backwardLevels, m_backwardRows ) ;
+}
+
+template < typename BlockMatrixType >
+void IncompleteLDLTPreconditioner< BlockObjectBase< BlockMatrixType > >::schedule(
+        const std::vector< std::size_t >& start, const std::vector< std::size_t >& deps, bool reverse,
+        std::vector< std::size_t >& levels, std::vector< std::size_t >& rows )
+{
+	const std::size_t n = start.size() - 1 ;
+
+	std::vector< std::size_t > level( n, 0 ) ;
+	std::size_t nLevels = 0 ;
+	for( std::size_t r = 0 ; r < n ; ++r )
+	{
+		const std::size_t i = reverse ? n - 1 - r : r ;
+		for( std::size_t p = start[i] ; p < start[i+1] ; ++p )
+			level[i] = std::max( level[i], level[ deps[p] ] + 1 ) ;
+		nLevels = std::max( nLevels, level[i] + 1 ) ;
+	}
+
+	levels.assign( nLevels + 1, 0 ) ;
+	for( std::size_t i = 0 ; i < n ; ++i )
+		++levels[ level[i] + 1 ] ;
+	for( std::size_t l = 0 ; l < nLevels ; ++l )
+		levels[ l+1 ] += levels[ l ] ;
+
+	rows.resize( n ) ;
+	std::vector< std::size_t > cursor( levels.begin(), levels.end() - 1 ) ;
+	for( std::size_t i = 0 ; i < n ; ++i )
+		rows[ cursor[ level[i] ]++ ] = i ;
+}
+
+template < typename BlockMatrixType >
+void IncompleteLDLTPreconditioner< BlockObjectBase< BlockMatrixType > >::factorizeRow(
+        const SparseBlockMatrixBase< BlockMatrixType > &matrix, const std::size_t i, BlockArray& F )
+{
+	const std::size_t begin = m_rowStart[i], end = m_rowStart[i+1] ;
+
+	// F(i,j) = L(i,j) D(j), initialized with A(i,j) on the pattern of L
+	F.resize( end - begin ) ;
+	for( std::size_t p = begin ; p < end ; ++p )
+		F[ p - begin ].setZero() ;
+
+	Block D ;
+	D.setZero() ;
+
+	std::size_t p = begin ;
+	for( typename BlockMatrixType::InnerIterator it( matrix.innerIterator( i ) ) ; it ; ++it )
+	{
+		const std::size_t j = it.inner() ;
+		if( j == i ) {
+			D = MatrixTraits< typename BlockMatrixType::BlockType >::asConstMatrix( matrix.block( it.ptr() ) ) ;
+		} else if( j < i ) {
+			while( m_cols[p] < j ) ++p ;
+			F[ p - begin ] = MatrixTraits< typename BlockMatrixType::BlockType >::asConstMatrix( matrix.block( it.ptr() ) ) ;
+		}
+	}
+	const Block Aii = D ;
+
+	for( p = begin ; p < end ; ++p )
+	{
+		const std::size_t j = m_cols[p] ;
+
+		// F(i,j) -= sum_{k<j} F(i,k) L(j,k)^T
+		std::size_t q = begin, r = m_rowStart[j] ;
+		while( q < p && r < m_rowStart[j+1] )
+		{
+			if( m_cols[q] < m_cols[r] ) ++q ;
+			else if( m_cols[r] < m_cols[q] ) ++r ;
+			else {
+				F[ p - begin ].noalias() -= F[ q - begin ] * m_L[r].transpose() ;
+				++q ; ++r ;
+			}
+		}
+
+		m_L[p] = F[ p - begin ] * m_Dinv[j] ;
+		D.noalias() -= F[ p - begin ] * m_L[p].transpose() ;
+	}
+
+	// Fall back to the diagonal block of the matrix if the incomplete factorization breaks down
+	const Scalar det = D.determinant() ;
+	if( !( std::fabs( det ) > NumTraits< Scalar >::epsilon() * std::fabs( Aii.determinant() ) ) )
+		D = Aii ;
+
+	m_Dinv[i] = D.inverse() ;
+}
+
 } //naemspace bogus
 
 #endif
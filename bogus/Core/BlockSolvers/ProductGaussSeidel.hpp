@@ -137,6 +137,7 @@ protected:
 	using Base::m_maxIters ;
 	using Base::m_tol ;
 	using Base::m_scaling ;
+	using Base::m_stats ;
 	using Base::m_maxThreads ;
 	using Base::m_evalEvery ;
 	using Base::m_skipTol ;
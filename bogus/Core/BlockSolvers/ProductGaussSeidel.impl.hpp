@@ -15,6 +15,8 @@
 #include "ProductGaussSeidel.hpp"
 #include "GaussSeidelBase.impl.hpp"
 
+#include "../Utils/Atomics.hpp"
+
 #ifndef BOGUS_DONT_PARALLELIZE
 #include <omp.h>
 #endif
@@ -149,6 +151,8 @@ void ProductGaussSeidel< BlockMatrixType, DiagonalType, PrecomputeDMt >::updateL
 	if( !(m_matrix && m_diagonal.valid()) )
 		return ;
 
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Setup ) ; )
+
 	m_DMt.compute( m_matrix->derived(), m_diagonal ) ;
 
 	const Index n = m_matrix->rowsOfBlocks() ;
@@ -193,6 +197,9 @@ void ProductGaussSeidel< BlockMatrixType, DiagonalType, PrecomputeDMt >::innerLo
 #else
 #pragma omp parallel if ( parallelize )
 	{
+#endif
+#ifdef BOGUS_WITH_SOLVER_STATS
+		SolverStats::WorkerScope workerStats( m_stats, currentThread() ) ;
 #endif
 		typename LocalProblemTraits::Vector lb, lx, ldx ;
 
@@ -204,6 +211,7 @@ void ProductGaussSeidel< BlockMatrixType, DiagonalType, PrecomputeDMt >::innerLo
 
 			if( skip[i] ) {
 				--skip[i] ;
+				BOGUS_STATS( workerStats.skipped() ; )
 				continue ;
 			}
 
@@ -215,6 +223,7 @@ void ProductGaussSeidel< BlockMatrixType, DiagonalType, PrecomputeDMt >::innerLo
 			ldx = -lx ;
 
 			const bool ok = law.solveLocal( i, m_localMatrices[i], lb, lx, m_scaling[ i ] ) ;
+			BOGUS_STATS( workerStats.solved( ok ) ; )
 			ldx += lx ;
 
 			if( !ok ) { ldx *= .5 ; }
@@ -224,14 +233,10 @@ void ProductGaussSeidel< BlockMatrixType, DiagonalType, PrecomputeDMt >::innerLo
 
 			const Scalar nx2 = m_scaling[ i ] * m_scaling[ i ] * lx.squaredNorm() ;
 			const Scalar ndx2 = m_scaling[ i ] * m_scaling[ i ] * ldx.squaredNorm() ;
-			// Thread-safety:
-			// we do not care if we lose an update of ndxRef to a data race,
-			// but we need its bytes to be consistent.
-			// Ok on x86(_64) if ndxRef is aligned as assignment is atomic
-			if( ndx2 > ndxRef ) ndxRef = ndx2 ;
+			atomics::fetch_max( &ndxRef, ndx2 ) ;
 
 			if(  std::min(nx2, ndx2) < absSkipTol ||
-			     ndx2 < m_skipTol * std::min( nx2, ndxRef ) )
+			     ndx2 < m_skipTol * std::min( nx2, atomics::load_relaxed( &ndxRef ) ) )
 			{
 				skip[i] = absSkipIters ;
 			}
@@ -284,15 +289,20 @@ ProductGaussSeidel< BlockMatrixType, DiagonalType, PrecomputeDMt >::solveWithLin
 	assert( m_diagonal.valid() ) ;
 	assert( solveEvery == 0 || 0 == m_evalEvery % solveEvery ) ;
 
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
+
 	typename GlobalProblemTraits::DynVector Mx( m_matrix->cols() ), y, x_best ;
 
 	typename GlobalProblemTraits::DynVector w = b;
-	W.template multiply< false >(x, w, 1, 1) ;
+	{
+		BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+		W.template multiply< false >(x, w, 1, 1) ;
+		y = w ;
+		m_DMt.multiply( x, Mx, y ) ;
+	}
 
 	Scalar err_best = std::numeric_limits< Scalar >::max() ;
 
-	y = w ;
-	m_DMt.multiply( x, Mx, y ) ;
 	Base::evalAndKeepBest( law, x, y, x_best, err_best ) ;
 
 	if( tryZeroAsWell && Base::tryZero( law, b, x, x_best, err_best ) ) {
@@ -311,22 +321,32 @@ ProductGaussSeidel< BlockMatrixType, DiagonalType, PrecomputeDMt >::solveWithLin
 	std::vector< unsigned char > skip( n, 0 ) ;
 	Scalar ndxRef = 0 ; //Reference step size
 
+	BOGUS_STATS( if( m_stats ) m_stats->reserveWorkers( parallelize ? newMaxThreads : 1 ) ; )
+
 	unsigned GSIter ;
 	for( GSIter = 1 ; GSIter <= m_maxIters ; ++GSIter )
 	{
 
-		innerLoop( parallelize, law, w, skip, ndxRef, Mx, x ) ;
+		{
+			BOGUS_STATS( const SolverStats::Scope sweepsScope( m_stats, SolverStats::Sweeps ) ; )
+			innerLoop( parallelize, law, w, skip, ndxRef, Mx, x ) ;
+			BOGUS_STATS( if( m_stats ) ++m_stats->iterations ; )
+		}
 
 		if( solveEvery > 0 && 0 == ( GSIter % solveEvery ) )
 		{
+			BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
 			w = b ;
 			W.template multiply< false >(x, w, 1, 1) ;
 		}
 
 		if( 0 == ( GSIter % m_evalEvery ) )
 		{
-			y = w ;
-			m_DMt.multiply( x, Mx, y ) ;
+			{
+				BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+				y = w ;
+				m_DMt.multiply( x, Mx, y ) ;
+			}
 			const Scalar err = Base::evalAndKeepBest( law, x, y, x_best, err_best ) ;
 
 			this->m_callback.trigger( GSIter, err ) ;
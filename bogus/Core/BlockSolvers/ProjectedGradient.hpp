@@ -106,6 +106,7 @@ protected:
 	using Base::m_matrix ;
 	using Base::m_maxIters ;
 	using Base::m_tol ;
+	using Base::m_stats ;
 
 	unsigned m_lsIters ;
 	Scalar m_lsOptimisticFactor ;
@@ -49,6 +49,7 @@ bool test_residual( const ProjectedGradient< BlockMatrixType >& pg, const NSLaw
 					const VecX &x, const VecY &y, VecRes& x_best, Scalar &min_res )
 {
 	const Scalar res = pg.eval( law, y, x ) ;
+	BOGUS_STATS( if( pg.stats() ) ++pg.stats()->iterations ; )
 
 	pg.callback().trigger( pgIter, res );
 	if( 0 == pgIter || res < min_res ) {
@@ -450,6 +451,7 @@ typename ProjectedGradient< BlockMatrixType >::Scalar
 ProjectedGradient< BlockMatrixType >::solve(
 		const NSLaw &law, const RhsT &b, ResT &x ) const
 {
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
 	return pg_impl::PgMethod< variant >::solve( *this, law, Base::matrix(), b, x ) ;
 }
 
@@ -0,0 +1,90 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_REORDERING_HPP
+#define BOGUS_REORDERING_HPP
+
+#include "../Block.fwd.hpp"
+
+#include <vector>
+
+namespace bogus {
+
+struct RowGraph ;
+struct Coloring ;
+
+//! Reordering of the rows of a matrix so that interacting rows are stored close to each other
+/*!
+	Computes a bandwidth-reducing permutation of the rows ( and columns ) of a square sparse block matrix,
+	improving memory locality when iterating over the rows of the matrix, for instance in GaussSeidel.
+
+	The permutation may be applied to the matrix with SparseBlockMatrixBase::applyPermutation(),
+	or to a whole DualFrictionProblem with DualFrictionProblem::applyPermutation().
+	When a Coloring is used, sortColors() can be used to preserve locality within each color.
+*/
+struct Reordering {
+
+	//! Reordering algorithm
+	enum Method {
+		//! No reordering
+		Identity,
+		//! Reverse Cuthill-McKee, starting each connected component from a pseudo-peripheral row
+		ReverseCuthillMcKee,
+		//! Minimum degree, reducing the fill-in of sparse factorizations \sa SparseBlockCholesky
+		MinimumDegree
+	} ;
+
+	//! Computed permutation, such that permutation[ newIndex ] = oldIndex
+	std::vector< std::size_t > permutation ;
+
+	Reordering()
+		: m_method( ReverseCuthillMcKee )
+	{}
+
+	//! Computes a reordering for \p matrix, or simply reset it to the identity if \p enable is false
+	template < typename Derived >
+	void update( const bool enable, const BlockMatrixBase< Derived >& matrix ) ;
+
+	std::size_t size() const { return permutation.size() ; }
+
+	//! Sets the reordering algorithm. Defaults to ReverseCuthillMcKee
+	void setMethod( Method method ) { m_method = method ; }
+	Method method() const { return m_method ; }
+
+	//! Sorts the rows of each color of \p coloring according to the computed reordering
+	/*! \p coloring should have been computed for the same matrix as this Reordering.
+		Its permutation can then be applied to the matrix to get contiguous colors, with
+		interacting rows of different colors remaining close to each other. */
+	void sortColors( Coloring& coloring ) const ;
+
+private:
+
+	void reset( std::size_t n )
+	{
+		permutation.resize( n ) ;
+		for( std::size_t i = 0 ; i < n ; ++ i )
+		{ permutation[i] = i ; }
+	}
+
+	template < typename Derived >
+	void compute( const SparseBlockMatrixBase< Derived >& matrix ) ;
+
+	template < typename Derived >
+	void compute( const BlockMatrixBase< Derived >& matrix ) ;
+
+	static void computeReverseCuthillMcKee( const RowGraph& graph, std::vector< std::size_t > &permutation ) ;
+	static void computeMinimumDegree( const RowGraph& graph, std::vector< std::size_t > &permutation ) ;
+
+	Method m_method ;
+} ;
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_REORDERING_IMPL_HPP
+#define BOGUS_REORDERING_IMPL_HPP
+
+#include "Reordering.hpp"
+#include "Coloring.hpp"
+
+#include "RowGraph.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <set>
+
+namespace bogus {
+
+namespace reordering_impl {
+
+// Orders rows by increasing degree, then by increasing index
+struct DegreeComparator
+{
+	const RowGraph &graph ;
+
+	explicit DegreeComparator( const RowGraph &g ) : graph( g ) {}
+
+	bool operator()( std::ptrdiff_t i, std::ptrdiff_t j ) const
+	{
+		const std::ptrdiff_t di = graph.degree( i ), dj = graph.degree( j ) ;
+		return di < dj || ( di == dj && i < j ) ;
+	}
+} ;
+
+// Orders rows by increasing rank
+struct RankComparator
+{
+	const std::vector< std::size_t > &rank ;
+
+	explicit RankComparator( const std::vector< std::size_t > &r ) : rank( r ) {}
+
+	bool operator()( std::size_t i, std::size_t j ) const
+	{ return rank[ i ] < rank[ j ] ; }
+} ;
+
+// Finds a pseudo-peripheral row in the connected component of \p root,
+// ignoring visited rows ( George-Liu algorithm )
+// depth should be filled with -1, and is left as such
+inline std::ptrdiff_t pseudo_peripheral_row( const RowGraph &graph, std::ptrdiff_t root,
+                                             const std::vector< unsigned char > &visited,
+                                             std::vector< std::ptrdiff_t > &depth,
+                                             std::vector< std::ptrdiff_t > &queue )
+{
+	static const unsigned maxIters = 5 ;
+
+	std::ptrdiff_t eccentricity = -1 ;
+	for( unsigned iter = 0 ; iter < maxIters ; ++iter )
+	{
+		queue.clear() ;
+		queue.push_back( root ) ;
+		depth[ root ] = 0 ;
+
+		for( std::size_t head = 0 ; head < queue.size() ; ++head )
+		{
+			const std::ptrdiff_t i = queue[ head ] ;
+			for( std::ptrdiff_t k = graph.offsets[ i ] ; k != graph.offsets[ i+1 ] ; ++k )
+			{
+				const std::ptrdiff_t j = graph.neighbours[ k ] ;
+				if( !visited[ j ] && depth[ j ] < 0 )
+				{
+					depth[ j ] = depth[ i ] + 1 ;
+					queue.push_back( j ) ;
+				}
+			}
+		}
+
+		// Candidate: row of minimal degree in the last level
+		const std::ptrdiff_t rootEccentricity = depth[ queue.back() ] ;
+		std::ptrdiff_t candidate = queue.back() ;
+		for( std::ptrdiff_t k = queue.size() - 1 ; k >= 0 && depth[ queue[k] ] == rootEccentricity ; --k )
+		{
+			if( graph.degree( queue[k] ) < graph.degree( candidate ) )
+				candidate = queue[k] ;
+		}
+
+		for( std::size_t k = 0 ; k < queue.size() ; ++k )
+			depth[ queue[k] ] = -1 ;
+
+		if( rootEccentricity <= eccentricity )
+			break ;
+
+		eccentricity = rootEccentricity ;
+		root = candidate ;
+	}
+
+	return root ;
+}
+
+} //namespace reordering_impl
+
+template < typename Derived >
+void Reordering::compute( const SparseBlockMatrixBase< Derived >& matrix )
+{
+	RowGraph graph ;
+	graph.setFrom( matrix ) ;
+
+	if( m_method == MinimumDegree )
+		computeMinimumDegree( graph, permutation ) ;
+	else
+		computeReverseCuthillMcKee( graph, permutation ) ;
+}
+
+template < typename Derived >
+void Reordering::compute( const BlockMatrixBase< Derived >& matrix )
+{ reset( matrix.rowsOfBlocks() ) ; }
+
+template < typename Derived >
+void Reordering::update( const bool enable, const BlockMatrixBase< Derived >& matrix )
+{
+	if( enable && m_method != Identity )
+	{
+		compute( matrix.derived() ) ;
+	} else {
+		reset( matrix.rowsOfBlocks() ) ;
+	}
+}
+
+inline void Reordering::computeReverseCuthillMcKee( const RowGraph& graph, std::vector< std::size_t > &permutation )
+{
+	// Breadth-first traversal of each connected component, visiting the neighbours
+	// of each row by increasing degree ; the resulting order is then reversed
+
+	const std::ptrdiff_t n = graph.size() ;
+
+	permutation.clear() ;
+	permutation.reserve( n ) ;
+
+	std::vector< std::ptrdiff_t > byDegree( n ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		byDegree[i] = i ;
+	std::sort( byDegree.begin(), byDegree.end(), reordering_impl::DegreeComparator( graph ) ) ;
+
+	std::vector< unsigned char > visited( n, 0 ) ;
+	std::vector< std::ptrdiff_t > depth( n, -1 ) ;
+	std::vector< std::ptrdiff_t > queue, next ;
+
+	for( std::ptrdiff_t s = 0 ; s < n ; ++s )
+	{
+		if( visited[ byDegree[s] ] ) continue ;
+
+		const std::ptrdiff_t root =
+		        reordering_impl::pseudo_peripheral_row( graph, byDegree[s], visited, depth, queue ) ;
+
+		visited[ root ] = 1 ;
+		permutation.push_back( root ) ;
+
+		for( std::size_t head = permutation.size() - 1 ; head < permutation.size() ; ++head )
+		{
+			const std::ptrdiff_t i = permutation[ head ] ;
+
+			next.clear() ;
+			for( std::ptrdiff_t k = graph.offsets[ i ] ; k != graph.offsets[ i+1 ] ; ++k )
+			{
+				const std::ptrdiff_t j = graph.neighbours[ k ] ;
+				if( !visited[ j ] )
+				{
+					visited[ j ] = 1 ;
+					next.push_back( j ) ;
+				}
+			}
+
+			std::sort( next.begin(), next.end(), reordering_impl::DegreeComparator( graph ) ) ;
+			permutation.insert( permutation.end(), next.begin(), next.end() ) ;
+		}
+	}
+
+	std::reverse( permutation.begin(), permutation.end() ) ;
+}
+
+inline void Reordering::computeMinimumDegree( const RowGraph& graph, std::vector< std::size_t > &permutation )
+{
+	// Explicit symbolic elimination : the row of lowest degree in the elimination graph
+	// is eliminated first, and its remaining neighbours become a clique
+
+	typedef std::pair< std::ptrdiff_t, std::ptrdiff_t > DegreeAndRow ;
+
+	const std::ptrdiff_t n = graph.size() ;
+
+	permutation.clear() ;
+	permutation.reserve( n ) ;
+
+	std::vector< std::vector< std::ptrdiff_t > > adjacency( n ) ;
+	std::set< DegreeAndRow > queue ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		adjacency[i].assign( graph.neighbours.begin() + graph.offsets[ i ],
+		                     graph.neighbours.begin() + graph.offsets[ i+1 ] ) ;
+		std::sort( adjacency[i].begin(), adjacency[i].end() ) ;
+		adjacency[i].erase( std::unique( adjacency[i].begin(), adjacency[i].end() ), adjacency[i].end() ) ;
+		queue.insert( DegreeAndRow( adjacency[i].size(), i ) ) ;
+	}
+
+	std::vector< unsigned char > eliminated( n, 0 ) ;
+	std::vector< std::ptrdiff_t > merged ;
+
+	while( !queue.empty() )
+	{
+		const std::ptrdiff_t i = queue.begin()->second ;
+		queue.erase( queue.begin() ) ;
+
+		eliminated[ i ] = 1 ;
+		permutation.push_back( i ) ;
+
+		const std::vector< std::ptrdiff_t > &clique = adjacency[ i ] ;
+		for( std::size_t k = 0 ; k < clique.size() ; ++k )
+		{
+			const std::ptrdiff_t j = clique[ k ] ;
+			std::vector< std::ptrdiff_t > &adj = adjacency[ j ] ;
+			queue.erase( DegreeAndRow( adj.size(), j ) ) ;
+
+			merged.clear() ;
+			std::set_union( adj.begin(), adj.end(), clique.begin(), clique.end(),
+			                std::back_inserter( merged ) ) ;
+
+			adj.clear() ;
+			for( std::size_t m = 0 ; m < merged.size() ; ++m )
+			{
+				if( merged[ m ] != j && !eliminated[ merged[ m ] ] )
+					adj.push_back( merged[ m ] ) ;
+			}
+
+			queue.insert( DegreeAndRow( adj.size(), j ) ) ;
+		}
+
+		std::vector< std::ptrdiff_t >().swap( adjacency[ i ] ) ;
+	}
+}
+
+inline void Reordering::sortColors( Coloring& coloring ) const
+{
+	assert( coloring.size() == size() ) ;
+
+	std::vector< std::size_t > rank( size() ) ;
+	for( std::size_t k = 0 ; k < size() ; ++k )
+		rank[ permutation[k] ] = k ;
+
+	const std::ptrdiff_t nColors = coloring.nColors() ;
+
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for
+#endif
+	for( std::ptrdiff_t c = 0 ; c < nColors ; ++c )
+	{
+		std::sort( coloring.permutation.begin() + coloring.colors[ c ],
+		           coloring.permutation.begin() + coloring.colors[ c+1 ],
+		           reordering_impl::RankComparator( rank ) ) ;
+	}
+}
+
+} //namespace bogus
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_ROW_GRAPH_HPP
+#define BOGUS_ROW_GRAPH_HPP
+
+#include "../Block/SparseBlockMatrixBase.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace bogus {
+
+//! Symmetric adjacency graph of the rows of a square sparse block matrix, in compressed format
+/*! Two rows are adjacent if there is a non-zero off-diagonal block coupling them in either direction.
+	\sa Coloring, Reordering */
+struct RowGraph {
+	//! Index of the first neighbour of each row in \c neighbours
+	std::vector< std::ptrdiff_t > offsets ;
+	//! Concatenated neighbours of all rows
+	std::vector< std::ptrdiff_t > neighbours ;
+
+	RowGraph()
+		: offsets( 1, 0 )
+	{}
+
+	//! Builds the graph from the major index of \p matrix
+	template < typename Derived >
+	void setFrom( const SparseBlockMatrixBase< Derived >& matrix ) ;
+
+	//! Number of rows
+	std::ptrdiff_t size() const { return offsets.size() - 1 ; }
+
+	std::ptrdiff_t degree( std::ptrdiff_t row ) const { return offsets[ row+1 ] - offsets[ row ] ; }
+
+	std::ptrdiff_t maxDegree() const
+	{
+		std::ptrdiff_t deg = 0 ;
+		for( std::ptrdiff_t i = 0 ; i < size() ; ++i )
+			deg = std::max( deg, degree( i ) ) ;
+		return deg ;
+	}
+} ;
+
+template < typename Derived >
+void RowGraph::setFrom( const SparseBlockMatrixBase< Derived >& matrix )
+{
+	typedef typename Derived::MajorIndexType MajorIndexType ;
+
+	const std::ptrdiff_t n = static_cast< std::ptrdiff_t >( matrix.rowsOfBlocks() ) ;
+	const MajorIndexType &index = matrix.majorIndex() ;
+	const std::ptrdiff_t nOuter = std::min( n, (std::ptrdiff_t) index.outerSize() ) ;
+
+	offsets.assign( n+1, 0 ) ;
+	for( std::ptrdiff_t i = 0 ; i < nOuter ; ++i )
+	{
+		for( typename MajorIndexType::InnerIterator it( index, i ) ; it ; ++ it )
+		{
+			const std::ptrdiff_t j = it.inner() ;
+			if( j != i && j < n )
+			{
+				++offsets[ i+1 ] ;
+				++offsets[ j+1 ] ;
+			}
+		}
+	}
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		offsets[ i+1 ] += offsets[ i ] ;
+
+	neighbours.resize( offsets[ n ] ) ;
+
+	std::vector< std::ptrdiff_t > cursor( offsets.begin(), offsets.end() - 1 ) ;
+	for( std::ptrdiff_t i = 0 ; i < nOuter ; ++i )
+	{
+		for( typename MajorIndexType::InnerIterator it( index, i ) ; it ; ++ it )
+		{
+			const std::ptrdiff_t j = it.inner() ;
+			if( j != i && j < n )
+			{
+				neighbours[ cursor[i]++ ] = j ;
+				neighbours[ cursor[j]++ ] = i ;
+			}
+		}
+	}
+}
+
+} //namespace bogus
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_SEMISMOOTH_NEWTON_HPP
+#define BOGUS_SEMISMOOTH_NEWTON_HPP
+
+#include "ConstrainedSolverBase.hpp"
+#include "GaussSeidel.hpp"
+#include "Krylov.hpp"
+
+#include "../Block/SparseBlockMatrix.hpp"
+
+#include <vector>
+
+namespace bogus
+{
+
+//! Global semismooth Newton solver on the stacked Fischer-Burmeister function
+/*!
+  Finds \p x such that
+  \f[ F( x )_i := fb_i \left( s_i x_i, y_i \right) = 0, \quad y := M x + b \f]
+  where \f$ fb_i \f$ is the Fischer-Burmeister function of the i-th local problem, as defined by the
+  non-smooth law, and \f$ s_i \f$ the scaling factors also used by eval().
+
+  At each iteration, a generalized Jacobian \p J of \p F is assembled as a SparseBlockMatrix having the full
+  sparsity pattern of \p M, and the Newton direction \f$ J d = -F \f$ is computed inexactly with a Krylov solver.
+  The step length is chosen by an Armijo backtracking line-search on \f$ \frac 1 2 \vert F \vert^2 \f$.
+
+  Far from the solution, Newton directions may fail to decrease this merit function ;
+  a few sweeps of an embedded GaussSeidel solver are then performed instead. The same GaussSeidel solver
+  is used to warm-start the Newton iterations, see setWarmStart().
+
+  Each iteration is much more expensive than a Gauss-Seidel sweep, but high accuracy is typically reached
+  in tens of iterations instead of thousands.
+
+  The \p NSLaw should define the \c evalFunction() and \c evalJacobian() methods, as SOCLaw does.
+  */
+template < typename BlockMatrixType >
+class SemismoothNewton : public ConstrainedSolverBase< SemismoothNewton< BlockMatrixType >, BlockMatrixType >
+{
+public:
+	typedef ConstrainedSolverBase< SemismoothNewton, BlockMatrixType > Base ;
+	typedef typename Base::GlobalProblemTraits GlobalProblemTraits ;
+	typedef typename Base::Scalar Scalar ;
+	typedef typename Base::Index Index ;
+
+	typedef BlockMatrixTraits< BlockMatrixType > Traits ;
+	typedef typename Traits::BlockType BlockType ;
+	typedef typename Traits::BlockPtr  BlockPtr ;
+
+	//! Generalized Jacobian of the Fischer-Burmeister function
+	typedef SparseBlockMatrix< BlockType > JacobianType ;
+	//! Solver for the Newton directions
+	typedef Krylov< JacobianType, DiagonalLUPreconditioner > KrylovType ;
+	//! Solver used for warm-starting and as a fallback
+	typedef GaussSeidel< BlockMatrixType > GaussSeidelType ;
+
+	//! Default constructor -- you will have to call setMatrix() before using the solve() function
+	SemismoothNewton( ) : Base() { init() ; }
+	//! Constructor with the system matrix
+	explicit SemismoothNewton( const BlockObjectBase< BlockMatrixType > & matrix ) : Base()
+	{ init() ; setMatrix( matrix ) ; }
+
+	//! Finds an approximate solution for a constrained linear problem
+	/*!
+	  \param law The non-smooth law, providing the Fischer-Burmeister function and its jacobian
+	  \param b   The constant term of the linear system
+	  \param x   Both the initial guess and the result
+	  \returns the error as returned by the eval() function
+	  */
+	template < typename NSLaw, typename RhsT, typename ResT >
+	Scalar solve( const NSLaw &law, const RhsT &b, ResT &x ) const ;
+
+	//! Sets the system matrix, and computes the sparsity pattern of the Jacobian
+	SemismoothNewton& setMatrix( const BlockObjectBase< BlockMatrixType > & matrix ) ;
+
+	//! Sets the Krylov method used to compute the Newton directions
+	/*! Only the transpose-free methods krylov::GMRES, krylov::BiCGSTAB, krylov::CGS and krylov::TFQMR
+		are supported ; other values will be replaced with krylov::GMRES, which is the default */
+	void setLinearSolver( krylov::Method method ) { m_linearSolver = method ; }
+	//! Sets the maximum number of Krylov iterations per Newton iteration
+	void setLinearSolverIterations( unsigned iterations ) { m_linearSolverIters = iterations ; }
+	//! Sets the tolerance of the inexact Newton directions, relative to the current value of \f$ \vert F \vert^2 \f$
+	void setForcingFactor( Scalar factor ) { m_forcingFactor = factor ; }
+	//! Sets the maximum number of line-search iterations
+	void setLineSearchIterations( unsigned lsIterations ) { m_lsIters = lsIterations ; }
+	//! Sets whether gaussSeidel() should be run before the first Newton iteration
+	void setWarmStart( bool warmStart ) { m_warmStart = warmStart ; }
+
+	krylov::Method linearSolver() const { return m_linearSolver ; }
+	unsigned linearSolverIterations() const { return m_linearSolverIters ; }
+	Scalar forcingFactor() const { return m_forcingFactor ; }
+	unsigned lineSearchIterations() const { return m_lsIters ; }
+	bool warmStart() const { return m_warmStart ; }
+
+	//! Gauss-Seidel solver used for warm-starting and as a fallback when the line-search fails
+	/*! Its maximum number of iterations is the number of sweeps performed for each of these uses */
+	GaussSeidelType& gaussSeidel() { return m_gs ; }
+	const GaussSeidelType& gaussSeidel() const { return m_gs ; }
+
+	// Row kernel of the parallel evaluation task ; also computes the row of \p J if it is not null
+	template < typename NSLaw, typename VectorT >
+	void evalRow( const NSLaw &law, const Index i, const VectorT &x, const VectorT &y,
+				  VectorT &F, JacobianType *J ) const ;
+
+protected:
+
+	//! Sets up the default values for all parameters
+	void init()
+	{
+		m_tol = 1.e-12 ;
+		m_maxIters = 50 ;
+		m_linearSolver = krylov::GMRES ;
+		m_linearSolverIters = 100 ;
+		m_forcingFactor = 1.e-2 ;
+		m_lsIters = 12 ;
+		m_warmStart = true ;
+		m_gs.setMaxIters( 10 ) ;
+	}
+
+	template < typename NSLaw, typename VectorT >
+	void evalFunction( const NSLaw &law, const VectorT &x, const VectorT &y,
+					   VectorT &F, JacobianType *J ) const ;
+
+	using Base::m_matrix ;
+	using Base::m_maxIters ;
+	using Base::m_tol ;
+	using Base::m_scaling ;
+	using Base::m_stats ;
+
+	krylov::Method m_linearSolver ;
+	unsigned m_linearSolverIters ;
+	Scalar m_forcingFactor ;
+	unsigned m_lsIters ;
+	bool m_warmStart ;
+
+	//! Block of the system matrix from which each block of the Jacobian is computed
+	struct Source {
+		BlockPtr ptr ;
+		bool transpose ;
+	} ;
+
+	//! Jacobian with the full pattern of the system matrix, and the sources of its blocks
+	JacobianType m_jacobian ;
+	std::vector< Source > m_sources ;
+
+	GaussSeidelType m_gs ;
+} ;
+
+} //namespace bogus
+
+#endif
@@ -0,0 +1,289 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_SEMISMOOTH_NEWTON_IMPL_HPP
+#define BOGUS_SEMISMOOTH_NEWTON_IMPL_HPP
+
+#include "SemismoothNewton.hpp"
+#include "ConstrainedSolverBase.impl.hpp"
+#include "GaussSeidel.impl.hpp"
+#include "Krylov.impl.hpp"
+
+#include "../Block/Access.hpp"
+#include "../Utils/Executor.hpp"
+
+#include <map>
+
+namespace bogus
+{
+
+namespace semismooth_newton_impl
+{
+
+//! Evaluates the Fischer-Burmeister function, and optionally its Jacobian, on a range of rows
+template < typename Solver, typename NSLaw, typename VectorT >
+struct EvalTask : public RangeTask
+{
+	typedef typename Solver::JacobianType JacobianType ;
+
+	EvalTask( const Solver &solver_, const NSLaw &law_, const VectorT &x_, const VectorT &y_,
+			  VectorT &F_, JacobianType *J_ )
+		: solver( solver_ ), law( law_ ), x( x_ ), y( y_ ), F( F_ ), J( J_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		for( std::ptrdiff_t i = begin ; i < end ; ++i )
+			solver.evalRow( law, (typename Solver::Index) i, x, y, F, J ) ;
+	}
+
+	const Solver &solver ;
+	const NSLaw &law ;
+	const VectorT &x ;
+	const VectorT &y ;
+	VectorT &F ;
+	JacobianType *J ;
+} ;
+
+} //namespace semismooth_newton_impl
+
+template < typename BlockMatrixType >
+SemismoothNewton< BlockMatrixType >& SemismoothNewton< BlockMatrixType >::setMatrix(
+		const BlockObjectBase< BlockMatrixType > & matrix )
+{
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Setup ) ; )
+
+	m_matrix = &matrix ;
+	Base::updateScalings() ;
+	m_gs.setMatrix( matrix ) ;
+
+	const BlockMatrixType &M = matrix.derived() ;
+	const Index n = M.rowsOfBlocks() ;
+
+	// Full pattern of M, by rows
+	std::vector< std::map< Index, Source > > rows( n ) ;
+	for( Index o = 0 ; o < (Index) M.majorIndex().outerSize() ; ++o )
+	{
+		for( typename BlockMatrixType::InnerIterator it( M.innerIterator( o ) ) ; it ; ++it )
+		{
+			const Index r = Traits::is_col_major ? it.inner() : o ;
+			const Index c = Traits::is_col_major ? o : it.inner() ;
+
+			Source src ;
+			src.ptr = it.ptr() ;
+			src.transpose = false ;
+			rows[ r ][ c ] = src ;
+
+			if( Traits::is_symmetric && r != c )
+			{
+				src.transpose = true ;
+				rows[ c ][ r ] = src ;
+			}
+		}
+	}
+
+	std::vector< unsigned > dims( n ) ;
+	for( Index i = 0 ; i < n ; ++i )
+		dims[ i ] = M.blockRows( i ) ;
+
+	m_jacobian.clear() ;
+	m_jacobian.setRows( dims ) ;
+	m_jacobian.setCols( dims ) ;
+	m_sources.clear() ;
+
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		for( typename std::map< Index, Source >::const_iterator it = rows[ i ].begin() ; it != rows[ i ].end() ; ++it )
+		{
+			m_jacobian.insertBack( i, it->first ).setZero() ;
+			m_sources.push_back( it->second ) ;
+		}
+	}
+	m_jacobian.finalize() ;
+
+	return *this ;
+}
+
+template < typename BlockMatrixType >
+template < typename NSLaw, typename VectorT >
+void SemismoothNewton< BlockMatrixType >::evalRow( const NSLaw &law, const Index i,
+												   const VectorT &x, const VectorT &y,
+												   VectorT &F, JacobianType *J ) const
+{
+	typedef typename NSLaw::Traits LocalTraits ;
+
+	const Segmenter< LocalTraits::dimension, const VectorT, Index > xSegmenter( x, m_matrix->rowOffsets() ) ;
+	const Segmenter< LocalTraits::dimension, const VectorT, Index > ySegmenter( y, m_matrix->rowOffsets() ) ;
+	Segmenter< LocalTraits::dimension, VectorT, Index > fSegmenter( F, m_matrix->rowOffsets() ) ;
+
+	const typename LocalTraits::Vector lx = xSegmenter[ i ] * m_scaling[ i ] ;
+	const typename LocalTraits::Vector ly = ySegmenter[ i ] ;
+	typename LocalTraits::Vector fb ;
+
+	if( !J )
+	{
+		law.evalFunction( i, lx, ly, fb ) ;
+		fSegmenter[ i ] = fb ;
+		return ;
+	}
+
+	typename LocalTraits::Matrix dFb_dx, dFb_dy ;
+	law.evalJacobian( i, lx, ly, fb, dFb_dx, dFb_dy ) ;
+	fSegmenter[ i ] = fb ;
+
+	// dF_i / dx_j = dFb_dy M_ij + s_i dFb_dx delta_ij
+	const BlockMatrixType &M = m_matrix->derived() ;
+	for( typename JacobianType::InnerIterator it( J->innerIterator( i ) ) ; it ; ++it )
+	{
+		const Source &src = m_sources[ it.ptr() ] ;
+		BlockType &block = J->block( it.ptr() ) ;
+
+		if( src.transpose )
+			block.noalias() = dFb_dy * M.block( src.ptr ).transpose() ;
+		else
+			block.noalias() = dFb_dy * M.block( src.ptr ) ;
+
+		if( it.inner() == i )
+			block += m_scaling[ i ] * dFb_dx ;
+	}
+}
+
+template < typename BlockMatrixType >
+template < typename NSLaw, typename VectorT >
+void SemismoothNewton< BlockMatrixType >::evalFunction( const NSLaw &law,
+														const VectorT &x, const VectorT &y,
+														VectorT &F, JacobianType *J ) const
+{
+	typedef semismooth_newton_impl::EvalTask< SemismoothNewton, NSLaw, VectorT > Task ;
+
+	F.resize( x.rows() ) ;
+	const Task task( *this, law, x, y, F, J ) ;
+	parallel_for( 0, m_matrix->rowsOfBlocks(), task ) ;
+}
+
+template < typename BlockMatrixType >
+template < typename NSLaw, typename RhsT, typename ResT >
+typename SemismoothNewton< BlockMatrixType >::Scalar
+SemismoothNewton< BlockMatrixType >::solve( const NSLaw &law, const RhsT &b, ResT &x ) const
+{
+	assert( m_matrix ) ;
+
+	BOGUS_STATS( const SolverStats::Scope statsScope( m_stats, SolverStats::Total ) ; )
+
+	typedef typename GlobalProblemTraits::DynVector Vector ;
+
+	// Armijo coefficient
+	const Scalar sigma = 1.e-4 ;
+
+	Vector xk = x ;
+	if( m_warmStart )
+		m_gs.solve( law, b, xk ) ;
+
+	Vector y = b ;
+	{
+		BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+		m_matrix->template multiply< false >( xk, y, 1, 1 ) ;
+	}
+
+	Scalar err = Base::eval( law, y, xk ) ;
+	Scalar errBest = err ;
+	Vector xBest = xk ;
+	this->m_callback.trigger( 0, err ) ;
+
+	// All the blocks of J are overwritten by evalFunction()
+	JacobianType J ;
+	J.cloneStructure( m_jacobian ) ;
+	Vector F, Ft, rhs, d, Jd, Md, xt, yt ;
+
+	for( unsigned k = 0 ; k < m_maxIters && !( err < m_tol ) ; ++k )
+	{
+		evalFunction( law, xk, y, F, &J ) ;
+		const Scalar phi = .5 * F.squaredNorm() ;
+
+		// Inexact Newton direction
+
+		rhs = -F ;
+		d.setZero( F.rows() ) ;
+		{
+			KrylovType linearSolver( J ) ;
+			linearSolver.setMaxIters( m_linearSolverIters ) ;
+			linearSolver.setTol( m_forcingFactor * F.squaredNorm() / ( 1 + F.rows() ) ) ;
+
+			switch( m_linearSolver )
+			{
+			case krylov::BiCGSTAB:
+				linearSolver.solve_BiCGSTAB( rhs, d ) ;
+				break ;
+			case krylov::CGS:
+				linearSolver.solve_CGS( rhs, d ) ;
+				break ;
+			case krylov::TFQMR:
+				linearSolver.solve_TFQMR( rhs, d ) ;
+				break ;
+			default:
+				linearSolver.solve_GMRES( rhs, d ) ;
+			}
+		}
+
+		Jd = J * d ;
+		const Scalar slope = F.dot( Jd ) ;
+
+		// Armijo line-search on 1/2 |F|^2
+
+		bool accepted = false ;
+		if( slope < 0 )
+		{
+			Md.setZero( d.rows() ) ;
+			{
+				BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+				m_matrix->template multiply< false >( d, Md, 1, 0 ) ;
+			}
+
+			Scalar t = 1 ;
+			for( unsigned ls = 0 ; ls < m_lsIters && !accepted ; ++ls )
+			{
+				xt = xk + t * d ;
+				yt = y + t * Md ;
+				evalFunction( law, xt, yt, Ft, BOGUS_NULL_PTR( JacobianType ) ) ;
+
+				accepted = .5 * Ft.squaredNorm() <= phi + sigma * t * slope ;
+				t *= .5 ;
+			}
+		}
+
+		if( accepted ) {
+			xk = xt ;
+		} else {
+			// Not a descent direction ; fall back on Gauss-Seidel sweeps
+			m_gs.solve( law, b, xk ) ;
+		}
+
+		y = b ;
+		{
+			BOGUS_STATS( const SolverStats::Scope spmvScope( m_stats, SolverStats::SpMV ) ; )
+			m_matrix->template multiply< false >( xk, y, 1, 1 ) ;
+		}
+
+		err = Base::eval( law, y, xk ) ;
+		if( err < errBest ) {
+			errBest = err ;
+			xBest = xk ;
+		}
+
+		this->m_callback.trigger( k+1, err ) ;
+	}
+
+	x = xBest ;
+	return errBest ;
+}
+
+} //namespace bogus
+
+#endif
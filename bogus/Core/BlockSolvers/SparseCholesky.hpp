@@ -0,0 +1,184 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_SPARSE_CHOLESKY_HPP
+#define BOGUS_SPARSE_CHOLESKY_HPP
+
+#include "../BlockSolvers.fwd.hpp"
+
+#include "Reordering.hpp"
+
+#include "../Utils/LinearSolverBase.hpp"
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace bogus {
+
+template < typename BlockMatrixType >
+struct LinearSolverTraits< SparseBlockCholesky< BlockMatrixType > >
+{
+	typedef typename BlockMatrixTraits< BlockMatrixType >::Scalar Scalar ;
+	typedef Eigen::Matrix< Scalar, Eigen::Dynamic, Eigen::Dynamic > MatrixType ;
+
+	template < typename RhsT > struct Result {
+		typedef Eigen::Matrix< Scalar, Eigen::Dynamic, RhsT::ColsAtCompileTime > Type ;
+	} ;
+	template < typename RhsT >
+	struct Result< Eigen::MatrixBase< RhsT > > {
+		typedef typename Result< RhsT >::Type Type ;
+	} ;
+} ;
+
+//! Supernodal sparse Cholesky factorization of a symmetric positive definite SparseBlockMatrix
+/*!
+	Computes \f$ P M P^T = L L^T \f$, where \p P is a fill-reducing permutation of the block rows of \p M
+	( minimum degree by default, see reordering() ), and \p L a sparse lower-triangular matrix.
+
+	The columns of \p L sharing the same sparsity pattern are grouped in supernodes, which are stored
+	and factorized as dense panels. Supernodes that do not descend from each other in the elimination tree
+	are factorized in parallel.
+
+	The symbolic analysis only depends on the sparsity pattern of \p M, and is reused by compute()
+	as long as this pattern does not change ; factorize() may also be called directly.
+
+	\p M may have dense blocks of any size, and may be stored with or without the SYMMETRIC flag ;
+	only its lower triangle is read.
+
+	\sa PrimalFrictionProblem::computeMInv()
+*/
+template < typename BlockMatrixType >
+class SparseBlockCholesky : public LinearSolverBase< SparseBlockCholesky< BlockMatrixType > >
+{
+public:
+	typedef BlockMatrixTraits< BlockMatrixType > Traits ;
+	typedef typename Traits::Scalar   Scalar ;
+	typedef typename Traits::Index    Index ;
+	typedef typename Traits::BlockPtr BlockPtr ;
+
+	typedef LinearSolverTraits< SparseBlockCholesky > SolverTraits ;
+	typedef typename SolverTraits::MatrixType DenseMatrix ;
+
+	//! Status of the last factorization
+	enum Status {
+		Success,
+		//! No analysis has been performed, or the matrix pattern does not match it
+		NotAnalyzed,
+		//! The matrix is not positive definite
+		NumericalIssue
+	} ;
+
+	SparseBlockCholesky()
+		: m_status( NotAnalyzed )
+	{ m_reordering.setMethod( Reordering::MinimumDegree ) ; }
+
+	explicit SparseBlockCholesky( const SparseBlockMatrixBase< BlockMatrixType >& matrix )
+		: m_status( NotAnalyzed )
+	{
+		m_reordering.setMethod( Reordering::MinimumDegree ) ;
+		compute( matrix ) ;
+	}
+
+	//! Computes the factorization of \p matrix, performing the symbolic analysis only if its sparsity pattern changed
+	SparseBlockCholesky& compute( const SparseBlockMatrixBase< BlockMatrixType >& matrix )
+	{
+		if( !samePattern( matrix ) )
+			analyzePattern( matrix ) ;
+		return factorize( matrix ) ;
+	}
+
+	//! Computes the fill-reducing permutation, the elimination tree and the supernodes of \p matrix
+	void analyzePattern( const SparseBlockMatrixBase< BlockMatrixType >& matrix ) ;
+
+	//! Computes the numeric factorization of \p matrix, which must have the pattern given to analyzePattern()
+	SparseBlockCholesky& factorize( const SparseBlockMatrixBase< BlockMatrixType >& matrix ) ;
+
+	Status status() const { return m_status ; }
+
+	//! Finds the solution \b x of the linear system \b M \c * \b x \c = \c rhs
+	template < typename RhsT, typename ResT >
+	void solve( const Eigen::MatrixBase< RhsT >& rhs, ResT& x ) const ;
+
+	//! Returns the solution \b x of the linear system \b M \c * \b x \c = \c rhs
+	template < typename RhsT >
+	typename SolverTraits::template Result< Eigen::MatrixBase< RhsT > >::Type
+	solve( const Eigen::MatrixBase< RhsT >& rhs ) const
+	{
+		typename SolverTraits::template Result< Eigen::MatrixBase< RhsT > >::Type x ;
+		solve( rhs, x ) ;
+		return x ;
+	}
+
+	//! Fill-reducing reordering ; its method may be changed before calling analyzePattern()
+	Reordering& reordering() { return m_reordering ; }
+	const Reordering& reordering() const { return m_reordering ; }
+
+	//! Number of supernodes of the factor
+	Index nSupernodes() const { return m_supernodes.size() - 1 ; }
+	//! Number of scalar non-zeros of the lower triangle of the factor
+	std::size_t nonZeros() const ;
+
+	// Supernode kernel of the parallel factorization task
+	bool factorizeSupernode( const SparseBlockMatrixBase< BlockMatrixType >& matrix, Index s ) ;
+
+private:
+
+	//! Lower-triangular block of the permuted matrix, stored in a column
+	struct Entry {
+		Index row ;
+		BlockPtr ptr ;
+		bool transpose ;
+
+		bool operator<( const Entry& other ) const { return row < other.row ; }
+	} ;
+
+	bool samePattern( const SparseBlockMatrixBase< BlockMatrixType >& matrix ) const ;
+
+	template < typename Derived >
+	void forwardSubstitution( Eigen::MatrixBase< Derived >& x ) const ;
+	template < typename Derived >
+	void backwardSubstitution( Eigen::MatrixBase< Derived >& x ) const ;
+
+	Status m_status ;
+	Reordering m_reordering ;
+
+	// Stored pattern of the analyzed matrix
+	std::vector< Index > m_patternStart ;
+	std::vector< Index > m_pattern ;
+	std::vector< Index > m_originalOffsets ;
+
+	// Permuted lower triangle : entries of each block column, and diagonal blocks
+	std::vector< Index > m_entryStart ;
+	std::vector< Entry > m_entries ;
+	std::vector< BlockPtr > m_diagonal ;
+
+	// Scalar offsets of the permuted block rows
+	std::vector< Index > m_offsets ;
+
+	// First block column of each supernode
+	std::vector< Index > m_supernodes ;
+	// Block rows of each supernode, its own columns first, and their scalar offsets in the panel
+	std::vector< Index > m_rowStart ;
+	std::vector< Index > m_rows ;
+	std::vector< Index > m_rowOffsets ;
+	// Descendant supernodes updating each supernode
+	std::vector< Index > m_updateStart ;
+	std::vector< Index > m_updates ;
+	// Supernodes grouped by height in the supernodal elimination tree
+	std::vector< Index > m_levels ;
+	std::vector< Index > m_levelSupernodes ;
+
+	std::vector< DenseMatrix > m_panels ;
+} ;
+
+}
+
+#endif
@@ -0,0 +1,481 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_SPARSE_CHOLESKY_IMPL_HPP
+#define BOGUS_SPARSE_CHOLESKY_IMPL_HPP
+
+#include "SparseCholesky.hpp"
+#include "Reordering.impl.hpp"
+
+#include "../Block/SparseBlockMatrixBase.hpp"
+#include "../Utils/Executor.hpp"
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+
+namespace bogus {
+
+namespace sparse_cholesky_impl {
+
+//! Factorizes the supernodes of a level of the supernodal elimination tree
+template < typename Factorization, typename MatrixT >
+struct FactorizeTask : public RangeTask
+{
+	FactorizeTask( Factorization& fact_, const MatrixT& matrix_,
+	               const typename Factorization::Index* supernodes_, std::vector< unsigned char > &failed_ )
+	    : fact( fact_ ), matrix( matrix_ ), supernodes( supernodes_ ), failed( failed_ )
+	{}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		for( std::ptrdiff_t k = begin ; k < end ; ++k )
+		{
+			if( !fact.factorizeSupernode( matrix, supernodes[ k ] ) )
+				failed[ k ] = 1 ;
+		}
+	}
+
+	Factorization& fact ;
+	const MatrixT& matrix ;
+	const typename Factorization::Index* supernodes ;
+	std::vector< unsigned char > &failed ;
+} ;
+
+} //namespace sparse_cholesky_impl
+
+template < typename BlockMatrixType >
+bool SparseBlockCholesky< BlockMatrixType >::samePattern( const SparseBlockMatrixBase< BlockMatrixType >& matrix ) const
+{
+	const Index n = matrix.majorIndex().outerSize() ;
+	if( m_patternStart.size() != (std::size_t) n + 1 ||
+	    m_originalOffsets.size() != (std::size_t) matrix.rowsOfBlocks() + 1 )
+		return false ;
+
+	for( Index i = 0 ; i <= matrix.rowsOfBlocks() ; ++i )
+	{
+		if( m_originalOffsets[i] != matrix.rowOffsets()[i] )
+			return false ;
+	}
+
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		Index p = m_patternStart[i] ;
+		for( typename BlockMatrixType::InnerIterator it( matrix.innerIterator( i ) ) ; it ; ++it, ++p )
+		{
+			if( p == m_patternStart[i+1] || m_pattern[p] != it.inner() )
+				return false ;
+		}
+		if( p != m_patternStart[i+1] )
+			return false ;
+	}
+
+	return true ;
+}
+
+template < typename BlockMatrixType >
+void SparseBlockCholesky< BlockMatrixType >::analyzePattern( const SparseBlockMatrixBase< BlockMatrixType >& matrix )
+{
+	const Index n = matrix.rowsOfBlocks() ;
+	assert( n == matrix.colsOfBlocks() ) ;
+
+	// Cache pattern
+
+	m_patternStart.assign( 1, 0 ) ;
+	m_pattern.clear() ;
+	for( Index i = 0 ; i < (Index) matrix.majorIndex().outerSize() ; ++i )
+	{
+		for( typename BlockMatrixType::InnerIterator it( matrix.innerIterator( i ) ) ; it ; ++it )
+			m_pattern.push_back( it.inner() ) ;
+		m_patternStart.push_back( m_pattern.size() ) ;
+	}
+	m_originalOffsets.assign( matrix.rowOffsets(), matrix.rowOffsets() + n + 1 ) ;
+
+	// Fill-reducing permutation
+
+	m_reordering.update( true, matrix.derived() ) ;
+	const std::vector< std::size_t > &perm = m_reordering.permutation ;
+	std::vector< Index > invPerm( n ) ;
+	for( Index k = 0 ; k < n ; ++k )
+		invPerm[ perm[k] ] = k ;
+
+	m_offsets.assign( n+1, 0 ) ;
+	for( Index k = 0 ; k < n ; ++k )
+		m_offsets[ k+1 ] = m_offsets[ k ] + matrix.blockRows( perm[k] ) ;
+
+	// Lower triangle of the permuted matrix, by columns
+
+	m_diagonal.assign( n, (BlockPtr) -1 ) ;
+	m_entryStart.assign( n+1, 0 ) ;
+	m_entries.clear() ;
+
+	std::vector< std::vector< Entry > > columns( n ) ;
+	for( Index o = 0 ; o < (Index) matrix.majorIndex().outerSize() ; ++o )
+	{
+		for( typename BlockMatrixType::InnerIterator it( matrix.innerIterator( o ) ) ; it ; ++it )
+		{
+			const Index r = Traits::is_col_major ? it.inner() : o ;
+			const Index c = Traits::is_col_major ? o : it.inner() ;
+
+			if( r == c ) {
+				m_diagonal[ invPerm[r] ] = it.ptr() ;
+				continue ;
+			}
+			if( !Traits::is_symmetric && r < c )
+				continue ;
+
+			Entry entry ;
+			entry.ptr = it.ptr() ;
+			entry.transpose = invPerm[r] < invPerm[c] ;
+			entry.row = std::max( invPerm[r], invPerm[c] ) ;
+			columns[ std::min( invPerm[r], invPerm[c] ) ].push_back( entry ) ;
+		}
+	}
+	for( Index j = 0 ; j < n ; ++j )
+	{
+		std::sort( columns[j].begin(), columns[j].end() ) ;
+		m_entries.insert( m_entries.end(), columns[j].begin(), columns[j].end() ) ;
+		m_entryStart[ j+1 ] = m_entries.size() ;
+		std::vector< Entry >().swap( columns[j] ) ;
+	}
+
+	// Column patterns of L and elimination tree
+	// The pattern of column j is the union of the lower pattern of column j of the matrix
+	// and of the patterns of its children in the tree, the parent of j being its first off-diagonal row
+
+	std::vector< std::vector< Index > > structure( n ) ;
+	std::vector< std::vector< Index > > children( n ) ;
+	std::vector< Index > parent( n, -1 ) ;
+	std::vector< Index > merged ;
+
+	for( Index j = 0 ; j < n ; ++j )
+	{
+		std::vector< Index > &col = structure[j] ;
+		col.push_back( j ) ;
+		for( Index p = m_entryStart[j] ; p < m_entryStart[j+1] ; ++p )
+			col.push_back( m_entries[p].row ) ;
+
+		for( std::size_t c = 0 ; c < children[j].size() ; ++c )
+		{
+			const std::vector< Index > &child = structure[ children[j][c] ] ;
+			merged.clear() ;
+			std::set_union( col.begin(), col.end(), child.begin() + 1, child.end(),
+			                std::back_inserter( merged ) ) ;
+			col.swap( merged ) ;
+		}
+
+		if( col.size() > 1 )
+		{
+			parent[j] = col[1] ;
+			children[ col[1] ].push_back( j ) ;
+		}
+	}
+
+	// Fundamental supernodes : chains of columns with nested patterns
+
+	m_supernodes.assign( 1, 0 ) ;
+	for( Index j = 1 ; j < n ; ++j )
+	{
+		const bool chained = parent[j-1] == j && children[j].size() == 1 &&
+		        structure[j-1].size() == structure[j].size() + 1 ;
+		if( !chained )
+			m_supernodes.push_back( j ) ;
+	}
+	if( n > 0 ) m_supernodes.push_back( n ) ;
+	const Index nSn = m_supernodes.size() - 1 ;
+
+	std::vector< Index > supernodeOf( n ) ;
+	m_rowStart.assign( 1, 0 ) ;
+	m_rows.clear() ;
+	m_rowOffsets.clear() ;
+	for( Index s = 0 ; s < nSn ; ++s )
+	{
+		const std::vector< Index > &col = structure[ m_supernodes[s] ] ;
+		m_rows.insert( m_rows.end(), col.begin(), col.end() ) ;
+		m_rowStart.push_back( m_rows.size() ) ;
+
+		Index offset = 0 ;
+		for( std::size_t k = 0 ; k < col.size() ; ++k )
+		{
+			m_rowOffsets.push_back( offset ) ;
+			offset += m_offsets[ col[k] + 1 ] - m_offsets[ col[k] ] ;
+		}
+		m_rowOffsets.push_back( offset ) ;
+
+		for( Index j = m_supernodes[s] ; j < m_supernodes[s+1] ; ++j )
+		{
+			supernodeOf[j] = s ;
+			std::vector< Index >().swap( structure[j] ) ;
+		}
+	}
+
+	// Descendants updating each supernode, and height in the supernodal tree
+
+	std::vector< std::vector< Index > > updates( nSn ) ;
+	std::vector< Index > height( nSn, 0 ) ;
+	Index maxHeight = 0 ;
+	for( Index s = 0 ; s < nSn ; ++s )
+	{
+		const Index nCols = m_supernodes[s+1] - m_supernodes[s] ;
+		Index last = -1 ;
+		for( Index k = m_rowStart[s] + nCols ; k < m_rowStart[s+1] ; ++k )
+		{
+			const Index t = supernodeOf[ m_rows[k] ] ;
+			if( t != last )
+				updates[t].push_back( s ) ;
+			last = t ;
+		}
+
+		maxHeight = std::max( maxHeight, height[s] ) ;
+		const Index p = parent[ m_supernodes[s+1] - 1 ] ;
+		if( p >= 0 )
+			height[ supernodeOf[p] ] = std::max( height[ supernodeOf[p] ], height[s] + 1 ) ;
+	}
+
+	m_updateStart.assign( 1, 0 ) ;
+	m_updates.clear() ;
+	for( Index s = 0 ; s < nSn ; ++s )
+	{
+		m_updates.insert( m_updates.end(), updates[s].begin(), updates[s].end() ) ;
+		m_updateStart.push_back( m_updates.size() ) ;
+	}
+
+	m_levels.assign( nSn > 0 ? maxHeight + 2 : 1, 0 ) ;
+	for( Index s = 0 ; s < nSn ; ++s )
+		++m_levels[ height[s] + 1 ] ;
+	for( std::size_t l = 1 ; l < m_levels.size() ; ++l )
+		m_levels[l] += m_levels[l-1] ;
+
+	m_levelSupernodes.resize( nSn ) ;
+	{
+		std::vector< Index > cursor( m_levels.begin(), m_levels.end() - 1 ) ;
+		for( Index s = 0 ; s < nSn ; ++s )
+			m_levelSupernodes[ cursor[ height[s] ]++ ] = s ;
+	}
+
+	m_panels.resize( nSn ) ;
+	m_status = NotAnalyzed ;
+}
+
+template < typename BlockMatrixType >
+SparseBlockCholesky< BlockMatrixType >& SparseBlockCholesky< BlockMatrixType >::factorize(
+        const SparseBlockMatrixBase< BlockMatrixType >& matrix )
+{
+	if( m_originalOffsets.size() != (std::size_t) matrix.rowsOfBlocks() + 1 )
+	{
+		m_status = NotAnalyzed ;
+		return *this ;
+	}
+
+	typedef sparse_cholesky_impl::FactorizeTask< SparseBlockCholesky,
+	        SparseBlockMatrixBase< BlockMatrixType > > Task ;
+
+	m_status = Success ;
+	std::vector< unsigned char > failed ;
+	for( std::size_t l = 0 ; l + 1 < m_levels.size() && m_status == Success ; ++l )
+	{
+		const std::ptrdiff_t count = m_levels[l+1] - m_levels[l] ;
+		failed.assign( count, 0 ) ;
+
+		const Task task( *this, matrix, &m_levelSupernodes[ m_levels[l] ], failed ) ;
+		parallel_for( 0, count, task, count > 1, 1 ) ;
+
+		if( std::find( failed.begin(), failed.end(), 1 ) != failed.end() )
+			m_status = NumericalIssue ;
+	}
+
+	return *this ;
+}
+
+template < typename BlockMatrixType >
+bool SparseBlockCholesky< BlockMatrixType >::factorizeSupernode(
+        const SparseBlockMatrixBase< BlockMatrixType >& matrix, Index s )
+{
+	const Index c0 = m_supernodes[s], c1 = m_supernodes[s+1] ;
+	const Index nCols = c1 - c0 ;
+	const Index* rows = &m_rows[ m_rowStart[s] ] ;
+	const Index* offsets = &m_rowOffsets[ m_rowStart[s] + s ] ;
+	const Index nRows = m_rowStart[s+1] - m_rowStart[s] ;
+
+	DenseMatrix &panel = m_panels[s] ;
+	panel.setZero( offsets[ nRows ], offsets[ nCols ] ) ;
+
+	// Assemble the columns of the matrix
+
+	for( Index j = c0 ; j < c1 ; ++j )
+	{
+		const Index col = offsets[ j - c0 ] ;
+		const Index cols = offsets[ j - c0 + 1 ] - col ;
+
+		if( m_diagonal[j] != (BlockPtr) -1 )
+			panel.block( col, col, cols, cols ) = matrix.block( m_diagonal[j] ) ;
+
+		const Index* pos = rows ;
+		for( Index p = m_entryStart[j] ; p < m_entryStart[j+1] ; ++p )
+		{
+			const Entry &entry = m_entries[p] ;
+			pos = std::lower_bound( pos, rows + nRows, entry.row ) ;
+			const Index k = pos - rows ;
+
+			if( entry.transpose )
+				panel.block( offsets[k], col, offsets[k+1] - offsets[k], cols ) = matrix.block( entry.ptr ).transpose() ;
+			else
+				panel.block( offsets[k], col, offsets[k+1] - offsets[k], cols ) = matrix.block( entry.ptr ) ;
+		}
+	}
+
+	// Updates from descendants : panel -= L_d L_d^T on the rows and columns shared with d
+
+	DenseMatrix update ;
+	for( Index u = m_updateStart[s] ; u < m_updateStart[s+1] ; ++u )
+	{
+		const Index d = m_updates[u] ;
+		const Index* dRows = &m_rows[ m_rowStart[d] ] ;
+		const Index* dOffsets = &m_rowOffsets[ m_rowStart[d] + d ] ;
+		const Index dNRows = m_rowStart[d+1] - m_rowStart[d] ;
+		const Index dNCols = m_supernodes[d+1] - m_supernodes[d] ;
+
+		const Index a = std::lower_bound( dRows + dNCols, dRows + dNRows, c0 ) - dRows ;
+		const Index b = std::lower_bound( dRows + a, dRows + dNRows, c1 ) - dRows ;
+		const Index r0 = dOffsets[a] ;
+
+		const DenseMatrix &L = m_panels[d] ;
+		update.noalias() = L.middleRows( r0, dOffsets[ dNRows ] - r0 )
+		        * L.middleRows( r0, dOffsets[b] - r0 ).transpose() ;
+
+		const Index* pos = rows ;
+		for( Index k = a ; k < dNRows ; ++k )
+		{
+			pos = std::lower_bound( pos, rows + nRows, dRows[k] ) ;
+			const Index tk = pos - rows ;
+			const Index rowSize = offsets[ tk+1 ] - offsets[ tk ] ;
+
+			for( Index m = a ; m < b && dRows[m] <= dRows[k] ; ++m )
+			{
+				const Index tm = dRows[m] - c0 ;
+				panel.block( offsets[tk], offsets[tm], rowSize, offsets[ tm+1 ] - offsets[tm] )
+				        -= update.block( dOffsets[k] - r0, dOffsets[m] - r0, rowSize, offsets[ tm+1 ] - offsets[tm] ) ;
+			}
+		}
+	}
+
+	// Dense factorization of the panel
+
+	const Index n = offsets[ nCols ] ;
+	Eigen::LLT< DenseMatrix > llt( panel.topRows( n ) ) ;
+	if( llt.info() != Eigen::Success )
+		return false ;
+
+	panel.topRows( n ) = llt.matrixL() ;
+	if( nRows > nCols )
+	{
+		typename DenseMatrix::RowsBlockXpr below( panel.bottomRows( panel.rows() - n ) ) ;
+		panel.topRows( n ).template triangularView< Eigen::Lower >().transpose()
+		        .template solveInPlace< Eigen::OnTheRight >( below ) ;
+	}
+
+	return true ;
+}
+
+template < typename BlockMatrixType >
+template < typename Derived >
+void SparseBlockCholesky< BlockMatrixType >::forwardSubstitution( Eigen::MatrixBase< Derived >& x ) const
+{
+	DenseMatrix tmp ;
+	for( Index s = 0 ; s < nSupernodes() ; ++s )
+	{
+		const Index nCols = m_supernodes[s+1] - m_supernodes[s] ;
+		const Index* rows = &m_rows[ m_rowStart[s] ] ;
+		const Index* offsets = &m_rowOffsets[ m_rowStart[s] + s ] ;
+		const Index nRows = m_rowStart[s+1] - m_rowStart[s] ;
+		const Index n = offsets[ nCols ] ;
+		const DenseMatrix &L = m_panels[s] ;
+
+		typename Derived::RowsBlockXpr xs( x.middleRows( m_offsets[ m_supernodes[s] ], n ) ) ;
+		L.topRows( n ).template triangularView< Eigen::Lower >().solveInPlace( xs ) ;
+
+		tmp.noalias() = L.bottomRows( L.rows() - n ) * xs ;
+		for( Index k = nCols ; k < nRows ; ++k )
+		{
+			x.middleRows( m_offsets[ rows[k] ], offsets[k+1] - offsets[k] )
+			        -= tmp.middleRows( offsets[k] - n, offsets[k+1] - offsets[k] ) ;
+		}
+	}
+}
+
+template < typename BlockMatrixType >
+template < typename Derived >
+void SparseBlockCholesky< BlockMatrixType >::backwardSubstitution( Eigen::MatrixBase< Derived >& x ) const
+{
+	DenseMatrix tmp ;
+	for( Index s = nSupernodes() - 1 ; s >= 0 ; --s )
+	{
+		const Index nCols = m_supernodes[s+1] - m_supernodes[s] ;
+		const Index* rows = &m_rows[ m_rowStart[s] ] ;
+		const Index* offsets = &m_rowOffsets[ m_rowStart[s] + s ] ;
+		const Index nRows = m_rowStart[s+1] - m_rowStart[s] ;
+		const Index n = offsets[ nCols ] ;
+		const DenseMatrix &L = m_panels[s] ;
+
+		tmp.resize( L.rows() - n, x.cols() ) ;
+		for( Index k = nCols ; k < nRows ; ++k )
+		{
+			tmp.middleRows( offsets[k] - n, offsets[k+1] - offsets[k] )
+			        = x.middleRows( m_offsets[ rows[k] ], offsets[k+1] - offsets[k] ) ;
+		}
+
+		typename Derived::RowsBlockXpr xs( x.middleRows( m_offsets[ m_supernodes[s] ], n ) ) ;
+		xs.noalias() -= L.bottomRows( L.rows() - n ).transpose() * tmp ;
+		L.topRows( n ).template triangularView< Eigen::Lower >().transpose().solveInPlace( xs ) ;
+	}
+}
+
+template < typename BlockMatrixType >
+template < typename RhsT, typename ResT >
+void SparseBlockCholesky< BlockMatrixType >::solve( const Eigen::MatrixBase< RhsT >& rhs, ResT& x ) const
+{
+	assert( m_status == Success ) ;
+
+	const Index n = m_originalOffsets.size() - 1 ;
+	const std::vector< std::size_t > &perm = m_reordering.permutation ;
+
+	DenseMatrix y( rhs.rows(), rhs.cols() ) ;
+	for( Index k = 0 ; k < n ; ++k )
+	{
+		y.middleRows( m_offsets[k], m_offsets[k+1] - m_offsets[k] ) =
+		        rhs.middleRows( m_originalOffsets[ perm[k] ], m_offsets[k+1] - m_offsets[k] ) ;
+	}
+
+	forwardSubstitution( y ) ;
+	backwardSubstitution( y ) ;
+
+	x.resize( rhs.rows(), rhs.cols() ) ;
+	for( Index k = 0 ; k < n ; ++k )
+	{
+		x.middleRows( m_originalOffsets[ perm[k] ], m_offsets[k+1] - m_offsets[k] ) =
+		        y.middleRows( m_offsets[k], m_offsets[k+1] - m_offsets[k] ) ;
+	}
+}
+
+template < typename BlockMatrixType >
+std::size_t SparseBlockCholesky< BlockMatrixType >::nonZeros() const
+{
+	std::size_t nnz = 0 ;
+	for( Index s = 0 ; s < nSupernodes() ; ++s )
+	{
+		const Index n = m_offsets[ m_supernodes[s+1] ] - m_offsets[ m_supernodes[s] ] ;
+		nnz += m_panels[s].rows() * n - ( n * ( n - 1 ) ) / 2 ;
+	}
+	return nnz ;
+}
+
+} //namespace bogus
+
+#endif
@@ -165,6 +165,34 @@ struct BlockBlockProductTraits <
 	ReturnType ;
 } ;
 
+// Dense vector traits for plain Eigen vectors, matrices, maps and blocks
+
+template< typename EigenDerived >
+struct EigenDenseVectorTraits {
+	enum {
+		Columns = ( int( EigenDerived::ColsAtCompileTime ) > 0
+			&& ( int( EigenDerived::InnerStrideAtCompileTime ) == 1 )
+			&& ( Eigen::internal::traits< EigenDerived >::Flags & Eigen::DirectAccessBit ) )
+			? int( EigenDerived::ColsAtCompileTime ) : 0,
+		is_row_major = int( EigenDerived::ColsAtCompileTime ) != 1 && EigenDerived::IsRowMajor
+	} ;
+} ;
+
+template< typename _Scalar, int _Rows, int _Cols, int _Options, int _MaxRows, int _MaxCols >
+struct DenseVectorTraits< Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols> >
+		: public EigenDenseVectorTraits< Eigen::Matrix<_Scalar, _Rows, _Cols, _Options, _MaxRows, _MaxCols> >
+{} ;
+
+template< typename XprType, int BlockRows, int BlockCols, bool InnerPanel >
+struct DenseVectorTraits< Eigen::Block< XprType, BlockRows, BlockCols, InnerPanel > >
+		: public EigenDenseVectorTraits< Eigen::Block< XprType, BlockRows, BlockCols, InnerPanel > >
+{} ;
+
+template< typename PlainObjectType, int MapOptions, typename StrideType >
+struct DenseVectorTraits< Eigen::Map< PlainObjectType, MapOptions, StrideType > >
+		: public EigenDenseVectorTraits< Eigen::Map< PlainObjectType, MapOptions, StrideType > >
+{} ;
+
 template< typename Derived >
 inline typename Eigen::internal::plain_matrix_type<Derived>::type
 get_mutable_vector( const Eigen::MatrixBase< Derived > & )
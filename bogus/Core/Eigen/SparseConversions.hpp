@@ -132,7 +132,7 @@ void convert( const SparseBlockMatrixBase< BogusDerived >& source,
 	dest.setZero() ;
 	dest.resize( source.rows(), source.cols() ) ;
 
-	typename BogusDerived::UncompressedIndexType auxIndex ;
+	typename BogusDerived::MinorIndexType auxIndex ;
 	const typename IndexGetter::ReturnType& index = IndexGetter::getOrCompute( source, auxIndex )  ;
 
 	const std::vector< Index > &outerOffsets =
@@ -0,0 +1,166 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_ATOMICS_HPP
+#define BOGUS_ATOMICS_HPP
+
+#if defined( _MSC_VER ) && !defined( BOGUS_DONT_USE_BUILTIN_ATOMICS )
+	#define BOGUS_DONT_USE_BUILTIN_ATOMICS
+#endif
+
+namespace bogus {
+
+//! Minimal set of atomic operations on plain ( non std::atomic ) memory locations
+/*!
+  Uses the gcc/clang \c __atomic builtins when available, and OpenMP flushes and critical
+  sections otherwise ( in which case aligned loads and stores of \p T are assumed to be indivisible ).
+  */
+namespace atomics {
+
+#ifndef BOGUS_DONT_USE_BUILTIN_ATOMICS
+
+template < typename T >
+inline T load_relaxed( const T* ptr )
+{
+	T val ;
+	__atomic_load( ptr, &val, __ATOMIC_RELAXED ) ;
+	return val ;
+}
+
+template < typename T >
+inline T load_acquire( const T* ptr )
+{
+	T val ;
+	__atomic_load( ptr, &val, __ATOMIC_ACQUIRE ) ;
+	return val ;
+}
+
+template < typename T >
+inline void store_relaxed( T* ptr, T val )
+{
+	__atomic_store( ptr, &val, __ATOMIC_RELAXED ) ;
+}
+
+template < typename T >
+inline void store_release( T* ptr, T val )
+{
+	__atomic_store( ptr, &val, __ATOMIC_RELEASE ) ;
+}
+
+inline void fence_acquire() { __atomic_thread_fence( __ATOMIC_ACQUIRE ) ; }
+inline void fence_release() { __atomic_thread_fence( __ATOMIC_RELEASE ) ; }
+
+//! Sets \p *ptr to max( \p *ptr, \p val )
+template < typename T >
+inline void fetch_max( T* ptr, T val )
+{
+	T cur = load_relaxed( ptr ) ;
+	while( val > cur &&
+	       !__atomic_compare_exchange( ptr, &cur, &val, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+	{}
+}
+
+#else
+
+template < typename T >
+inline T load_relaxed( const T* ptr )
+{
+	return *static_cast< const volatile T* >( ptr ) ;
+}
+
+template < typename T >
+inline T load_acquire( const T* ptr )
+{
+	const T val = *static_cast< const volatile T* >( ptr ) ;
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp flush
+#endif
+	return val ;
+}
+
+template < typename T >
+inline void store_relaxed( T* ptr, T val )
+{
+	*static_cast< volatile T* >( ptr ) = val ;
+}
+
+template < typename T >
+inline void store_release( T* ptr, T val )
+{
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp flush
+#endif
+	*static_cast< volatile T* >( ptr ) = val ;
+}
+
+inline void fence_acquire()
+{
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp flush
+#endif
+}
+
+inline void fence_release()
+{
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp flush
+#endif
+}
+
+//! Sets \p *ptr to max( \p *ptr, \p val )
+template < typename T >
+inline void fetch_max( T* ptr, T val )
+{
+	if( val > load_relaxed( ptr ) )
+	{
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp critical (BogusAtomicMax)
+#endif
+		if( val > *ptr ) *ptr = val ;
+	}
+}
+
+#endif
+
+//! Copies \p size elements from \p src to \p dst, publishing them under the sequence lock \p version
+/*! There must be a single writer per \p version ; readers should use read_versioned() */
+template < typename T, typename SizeT >
+inline void write_versioned( unsigned* version, const T* src, T* dst, const SizeT size )
+{
+	const unsigned v = load_relaxed( version ) ;
+	store_relaxed( version, v + 1 ) ;
+	fence_release() ;
+	for( SizeT k = 0 ; k < size ; ++k )
+		store_relaxed( dst + k, src[k] ) ;
+	store_release( version, v + 2 ) ;
+}
+
+//! Copies \p size elements from \p src to \p dst, such that they are never partially updated by write_versioned()
+template < typename T, typename SizeT >
+inline void read_versioned( const unsigned* version, const T* src, T* dst, const SizeT size )
+{
+	for( ;; )
+	{
+		const unsigned v = load_acquire( version ) ;
+		if( v & 1u ) continue ; // Write in progress
+
+		for( SizeT k = 0 ; k < size ; ++k )
+			dst[k] = load_relaxed( src + k ) ;
+		fence_acquire() ;
+
+		if( v == load_relaxed( version ) ) break ;
+	}
+}
+
+} //namespace atomics
+
+} //namespace bogus
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2016 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_UTILS_EXECUTOR_HPP
+#define BOGUS_UTILS_EXECUTOR_HPP
+
+#include "CppTools.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+#ifndef BOGUS_DONT_PARALLELIZE
+#include <omp.h>
+#endif
+
+namespace bogus {
+
+//! Body of a parallel loop
+/*! Implementations should process the indices in the range [ \p begin, \p end ) ;
+  \p worker identifies the calling thread, and is guaranteed to be lower than Executor::nWorkers().
+  Two ranges are never processed concurrently with the same \p worker index. */
+struct RangeTask
+{
+	virtual ~RangeTask() {}
+
+	virtual void run( std::ptrdiff_t begin, std::ptrdiff_t end, int worker ) const = 0 ;
+} ;
+
+//! Abstract interface for the thread pools running the parallel loops of bogus
+/*!
+  The executor that is used by the library can be changed with setExecutor(),
+  for instance to share a thread pool with a host application.
+  \sa SerialExecutor, OpenMPExecutor, WorkStealingExecutor
+  */
+class Executor
+{
+public:
+	virtual ~Executor() {}
+
+	//! Upper bound on the worker indices that will be passed to RangeTask::run()
+	virtual int nWorkers() const = 0 ;
+
+	//! Runs \p task on a partition of [ \p begin, \p end ) into chunks of at most \p grain indices
+	/*! Returns once all chunks have been processed. May be called from within a running task,
+	  in which case implementations are expected to process the nested loop sequentially */
+	virtual void parallelFor( std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain,
+	                          const RangeTask& task ) = 0 ;
+
+	//! Reasonable chunk size for a loop of \p n iterations
+	std::ptrdiff_t defaultGrain( std::ptrdiff_t n ) const
+	{
+		return std::max( (std::ptrdiff_t) 1, n / ( 4 * std::max( 1, nWorkers() ) ) ) ;
+	}
+} ;
+
+//! Executor that runs everything in the calling thread
+class SerialExecutor : public Executor
+{
+public:
+	int nWorkers() const { return 1 ; }
+
+	void parallelFor( std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t,
+	                  const RangeTask& task )
+	{
+		if( begin < end ) task.run( begin, end, 0 ) ;
+	}
+} ;
+
+#ifndef BOGUS_DONT_PARALLELIZE
+//! Executor using an OpenMP parallel loop with dynamic scheduling
+/*! Respects the current number of OpenMP threads ( \sa WithMaxThreads ) */
+class OpenMPExecutor : public Executor
+{
+public:
+	int nWorkers() const { return omp_get_max_threads() ; }
+
+	void parallelFor( std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain,
+	                  const RangeTask& task )
+	{
+		if( begin >= end ) return ;
+		if( grain <= 0 ) grain = defaultGrain( end - begin ) ;
+
+		const std::ptrdiff_t nChunks = ( end - begin + grain - 1 ) / grain ;
+
+		if( nChunks == 1 || omp_in_parallel() ) {
+			task.run( begin, end, omp_get_thread_num() ) ;
+			return ;
+		}
+
+#pragma omp parallel for schedule( dynamic )
+		for( std::ptrdiff_t c = 0 ; c < nChunks ; ++c )
+		{
+			const std::ptrdiff_t b = begin + c * grain ;
+			task.run( b, std::min( end, b + grain ), omp_get_thread_num() ) ;
+		}
+	}
+} ;
+#endif
+
+namespace executor_impl {
+
+inline Executor*& custom()
+{
+	static Executor* executor = BOGUS_NULL_PTR( Executor ) ;
+	return executor ;
+}
+
+inline Executor& builtin()
+{
+#ifndef BOGUS_DONT_PARALLELIZE
+	static OpenMPExecutor executor ;
+#else
+	static SerialExecutor executor ;
+#endif
+	return executor ;
+}
+
+} //namespace executor_impl
+
+//! Returns the executor used by the parallel loops of bogus
+inline Executor& executor()
+{
+	Executor* custom = executor_impl::custom() ;
+	return custom ? *custom : executor_impl::builtin() ;
+}
+
+//! Sets the executor used by the parallel loops of bogus
+/*! The executor is not owned by bogus and must outlive any parallel computation.
+  Passing a null pointer restores the built-in executor ( OpenMPExecutor, or SerialExecutor
+  when BOGUS_DONT_PARALLELIZE is defined ). */
+inline void setExecutor( Executor* executor )
+{
+	executor_impl::custom() = executor ;
+}
+
+//! Runs \p task over [ \p begin, \p end ) using the current executor() if \p parallelize is true, or serially otherwise
+/*! If \p grain is zero, Executor::defaultGrain() will be used */
+inline void parallel_for( std::ptrdiff_t begin, std::ptrdiff_t end, const RangeTask& task,
+                          bool parallelize = true, std::ptrdiff_t grain = 0 )
+{
+	if( begin >= end ) return ;
+
+	if( parallelize ) {
+		Executor& ex = executor() ;
+		ex.parallelFor( begin, end, grain > 0 ? grain : ex.defaultGrain( end - begin ), task ) ;
+	} else {
+		task.run( begin, end, 0 ) ;
+	}
+}
+
+} //namespace bogus
+
+#endif
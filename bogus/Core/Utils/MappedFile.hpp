@@ -0,0 +1,142 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2016 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_UTILS_MAPPED_FILE_HPP
+#define BOGUS_UTILS_MAPPED_FILE_HPP
+
+#include "CppTools.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+
+#if !defined( _WIN32 ) && !defined( BOGUS_DONT_USE_MMAP )
+#define BOGUS_USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bogus {
+
+//! Private, writable view of the contents of a file
+/*!
+  Uses a copy-on-write \c mmap when available, so that pages are only read from disk when they are
+  first accessed and modifications are never written back to the file.
+  On other platforms ( or if BOGUS_DONT_USE_MMAP is defined ), the file is read at once into a
+  heap-allocated buffer.
+
+  In both cases the data is aligned on at least 64 bytes.
+  */
+class MappedFile
+{
+public:
+	MappedFile()
+		: m_data( BOGUS_NULL_PTR( char ) ), m_size( 0 )
+#ifndef BOGUS_USE_MMAP
+		, m_buffer( BOGUS_NULL_PTR( char ) )
+#endif
+	{}
+
+	~MappedFile()
+	{
+		close() ;
+	}
+
+	//! Maps \p fileName, returns false if it could not be opened
+	bool open( const char* fileName )
+	{
+		close() ;
+
+#ifdef BOGUS_USE_MMAP
+		const int fd = ::open( fileName, O_RDONLY ) ;
+		if( fd < 0 ) return false ;
+
+		struct stat st ;
+		if( 0 != ::fstat( fd, &st ) || 0 == st.st_size ) {
+			::close( fd ) ;
+			return false ;
+		}
+
+		void* addr = ::mmap( 0, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 ) ;
+		::close( fd ) ;
+		if( MAP_FAILED == addr ) return false ;
+
+		m_data = static_cast< char* >( addr ) ;
+		m_size = st.st_size ;
+#else
+		std::ifstream ifs( fileName, std::ios::binary | std::ios::ate ) ;
+		if( !ifs.is_open() ) return false ;
+
+		const std::streamoff size = ifs.tellg() ;
+		if( size <= 0 ) return false ;
+
+		// Over-allocate to align the data on 64 bytes
+		m_buffer = static_cast< char* >( std::malloc( size + 64 ) ) ;
+		if( !m_buffer ) return false ;
+		m_data = m_buffer + ( 64 - ( reinterpret_cast< std::size_t >( m_buffer ) & 63 ) ) ;
+
+		ifs.seekg( 0 ) ;
+		if( !ifs.read( m_data, size ) ) {
+			close() ;
+			return false ;
+		}
+		m_size = size ;
+#endif
+		return true ;
+	}
+
+	//! Releases the mapping ; pointers to the data are invalidated
+	void close()
+	{
+#ifdef BOGUS_USE_MMAP
+		if( m_data ) ::munmap( m_data, m_size ) ;
+#else
+		std::free( m_buffer ) ;
+		m_buffer = BOGUS_NULL_PTR( char ) ;
+#endif
+		m_data = BOGUS_NULL_PTR( char ) ;
+		m_size = 0 ;
+	}
+
+	//! Hints that the range [ \p offset, \p offset + \p size ) will soon be accessed
+	void prefetch( std::size_t offset, std::size_t size ) const
+	{
+#if defined( BOGUS_USE_MMAP ) && defined( MADV_WILLNEED )
+		const std::size_t page = ::sysconf( _SC_PAGESIZE ) ;
+		const std::size_t begin = offset - ( offset % page ) ;
+		::madvise( m_data + begin, std::min( m_size, offset + size ) - begin, MADV_WILLNEED ) ;
+#else
+		(void) offset ; (void) size ;
+#endif
+	}
+
+	bool isOpen() const { return m_data != BOGUS_NULL_PTR( char ) ; }
+
+	char* data() { return m_data ; }
+	const char* data() const { return m_data ; }
+	std::size_t size() const { return m_size ; }
+
+private:
+	MappedFile( const MappedFile& ) ;
+	MappedFile& operator=( const MappedFile& ) ;
+
+	char* m_data ;
+	std::size_t m_size ;
+#ifndef BOGUS_USE_MMAP
+	char* m_buffer ;
+#endif
+} ;
+
+} //namespace bogus
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2016 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_SOLVER_STATS_HPP
+#define BOGUS_SOLVER_STATS_HPP
+
+#include "CppTools.hpp"
+#include "Timer.hpp"
+
+#include <algorithm>
+#include <vector>
+
+//! Expands to its arguments only when solver statistics are enabled
+/*! Statistics are gathered only if BOGUS_WITH_SOLVER_STATS is defined ;
+  otherwise the instrumentation code is removed at compile time */
+#ifdef BOGUS_WITH_SOLVER_STATS
+#define BOGUS_STATS( ... ) __VA_ARGS__
+#else
+#define BOGUS_STATS( ... )
+#endif
+
+#if BOGUS_HAS_CPP11
+#define BOGUS_THREAD_LOCAL thread_local
+#elif defined( _MSC_VER )
+#define BOGUS_THREAD_LOCAL __declspec( thread )
+#else
+#define BOGUS_THREAD_LOCAL __thread
+#endif
+
+namespace bogus
+{
+
+//! Counts the code paths taken by the local solvers of the calling thread
+struct LocalSolverCounters
+{
+	//! Cases solved in closed form : take-off, frictionless, and sticking contacts detected by solveBatch
+	unsigned long trivial ;
+	//! Solves that converged with the non-smooth Newton algorithm alone
+	unsigned long newton ;
+	//! Solves that fell back to the enumerative algorithm
+	unsigned long enumerative ;
+
+	LocalSolverCounters& operator+=( const LocalSolverCounters& o )
+	{
+		trivial += o.trivial ; newton += o.newton ; enumerative += o.enumerative ;
+		return *this ;
+	}
+	LocalSolverCounters& operator-=( const LocalSolverCounters& o )
+	{
+		trivial -= o.trivial ; newton -= o.newton ; enumerative -= o.enumerative ;
+		return *this ;
+	}
+} ;
+
+//! Returns the LocalSolverCounters of the calling thread
+/*! Counters are never reset ; users should compare snapshots */
+inline LocalSolverCounters& localSolverCounters()
+{
+	static BOGUS_THREAD_LOCAL LocalSolverCounters counters ;
+	return counters ;
+}
+
+//! Statistics gathered by constrained solvers over one or several solves
+/*!
+  When passed to ConstrainedSolverBase::setStats(), a SolverStats object accumulates
+  wall-clock times per phase and per-worker counters until reset() is called.
+  Nothing is recorded unless the code is compiled with BOGUS_WITH_SOLVER_STATS
+  */
+struct SolverStats
+{
+	enum Phase {
+		Setup = 0, //!< Computation of the local matrices, coloring
+		Sweeps,    //!< Gauss-Seidel sweeps
+		Eval,      //!< Evaluation of the global residual
+		SpMV,      //!< Global matrix-vector products
+		Total,     //!< Whole solve() calls
+		NPhases
+	} ;
+
+	//! Counters of a single worker thread
+	struct Worker
+	{
+		//! Time spent by this worker processing Gauss-Seidel rows, in seconds
+		double time ;
+		//! Number of local problems that were solved
+		unsigned long localSolves ;
+		//! Number of local problems that were skipped ( see GaussSeidelBase::setSkipTol() )
+		unsigned long skipped ;
+		//! Number of local solves that did not succeed
+		unsigned long failed ;
+		//! Code paths taken by the local solver
+		LocalSolverCounters local ;
+
+		Worker() : time( 0 ), localSolves( 0 ), skipped( 0 ), failed( 0 )
+		{
+			local.trivial = local.newton = local.enumerative = 0 ;
+		}
+
+		Worker& operator+=( const Worker& o )
+		{
+			time += o.time ;
+			localSolves += o.localSolves ; skipped += o.skipped ; failed += o.failed ;
+			local += o.local ;
+			return *this ;
+		}
+	} ;
+
+	//! Accumulated wall-clock time of each Phase, in seconds
+	double time[ NPhases ] ;
+	//! Number of iterations ( sweeps for Gauss-Seidel solvers )
+	unsigned long iterations ;
+	std::vector< Worker > workers ;
+
+	SolverStats() { reset() ; }
+
+	void reset()
+	{
+		std::fill( time, time + NPhases, 0. ) ;
+		iterations = 0 ;
+		workers.clear() ;
+	}
+
+	//! Makes sure that counters exist for workers [ 0, \p nWorkers )
+	/*! Should not be called concurrently with worker updates */
+	void reserveWorkers( std::size_t nWorkers )
+	{
+		if( workers.size() < nWorkers )
+			workers.resize( nWorkers ) ;
+	}
+
+	//! Sum of the counters of all workers
+	Worker sum() const
+	{
+		Worker s ;
+		for( std::size_t w = 0 ; w < workers.size() ; ++w )
+			s += workers[w] ;
+		return s ;
+	}
+
+	//! Load imbalance between workers, defined as ( max/mean - 1 ) of the Worker::time
+	double imbalance() const
+	{
+		if( workers.empty() ) return 0. ;
+
+		double max = 0, total = 0 ;
+		for( std::size_t w = 0 ; w < workers.size() ; ++w )
+		{
+			max = std::max( max, workers[w].time ) ;
+			total += workers[w].time ;
+		}
+		return total > 0. ? max * workers.size() / total - 1. : 0. ;
+	}
+
+	//! Adds the time spent in its scope to a Phase of a SolverStats object, if non-null
+	class Scope
+	{
+	public:
+		Scope( SolverStats* stats, Phase phase )
+			: m_stats( stats ), m_phase( phase )
+		{}
+		~Scope()
+		{
+			if( m_stats ) m_stats->time[ m_phase ] += m_timer.elapsed() ;
+		}
+	private:
+		SolverStats* m_stats ;
+		const Phase m_phase ;
+		Timer m_timer ;
+	} ;
+
+	//! Accumulates counters for a worker in its scope, then adds them to a SolverStats object, if non-null
+	/*! Counting happens locally so that workers do not write to shared cache lines in inner loops */
+	class WorkerScope
+	{
+	public:
+		WorkerScope( SolverStats* stats, int worker )
+			: m_stats( stats ), m_worker( worker ), m_start( localSolverCounters() )
+		{}
+		~WorkerScope()
+		{
+			if( !m_stats ) return ;
+			m_counters.time = m_timer.elapsed() ;
+			m_counters.local = localSolverCounters() ;
+			m_counters.local -= m_start ;
+			m_stats->workers[ m_worker ] += m_counters ;
+		}
+
+		void solved( bool ok )
+		{
+			++m_counters.localSolves ;
+			if( !ok ) ++m_counters.failed ;
+		}
+		void skipped() { ++m_counters.skipped ; }
+
+	private:
+		SolverStats* m_stats ;
+		const int m_worker ;
+		const LocalSolverCounters m_start ;
+		Worker m_counters ;
+		Timer m_timer ;
+	} ;
+
+} ;
+
+} //namespace bogus
+
+#endif
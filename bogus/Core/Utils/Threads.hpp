@@ -25,6 +25,8 @@ namespace bogus {
 		int nThreads() const { return 1 ; }
 	} ;
 
+	inline int currentThread() { return 0 ; }
+
 #else
 	struct WithMaxThreads {
 
@@ -47,6 +49,9 @@ namespace bogus {
 		const int m_newMaxThreads ;
 
 	};
+
+	//! Index of the calling thread within the current OpenMP parallel region
+	inline int currentThread() { return omp_get_thread_num() ; }
 #endif
 
 } // bogus
@@ -0,0 +1,214 @@
+/*
+ * This file is part of bogus, a C++ sparse block matrix library.
+ *
+ * Copyright 2016 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#ifndef BOGUS_UTILS_WORK_STEALING_EXECUTOR_HPP
+#define BOGUS_UTILS_WORK_STEALING_EXECUTOR_HPP
+
+#include "Executor.hpp"
+
+#if BOGUS_HAS_CPP11
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bogus {
+
+//! Thread pool executor with per-worker chunk queues and work stealing
+/*!
+  The chunks of each parallel loop are initially distributed evenly between the workers ;
+  a worker that runs out of chunks steals from the back of the queues of the others,
+  which balances loops with very uneven iteration costs.
+  The thread calling parallelFor() participates as worker 0.
+
+  Concurrent calls to parallelFor() from different threads are serialized, and nested calls
+  from within a running task are executed sequentially by the calling worker.
+
+  \warning Requires C++11
+  \sa setExecutor()
+  */
+class WorkStealingExecutor : public Executor
+{
+public:
+	//! Constructor
+	/*! \param nThreads Total number of workers, including the calling thread.
+	  If zero, uses the number of hardware threads */
+	explicit WorkStealingExecutor( int nThreads = 0 )
+		: m_nWorkers( nThreads > 0 ? nThreads : std::max( 1, (int) std::thread::hardware_concurrency() ) ),
+		  m_queues( new Queue[ m_nWorkers ] ),
+		  m_job( nullptr ), m_generation( 0 ), m_busy( 0 ), m_stop( false )
+	{
+		for( int w = 1 ; w < m_nWorkers ; ++w )
+			m_threads.push_back( std::thread( &WorkStealingExecutor::workerLoop, this, w ) ) ;
+	}
+
+	~WorkStealingExecutor()
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex ) ;
+			m_stop = true ;
+		}
+		m_wake.notify_all() ;
+		for( std::size_t t = 0 ; t < m_threads.size() ; ++t )
+			m_threads[t].join() ;
+	}
+
+	int nWorkers() const { return m_nWorkers ; }
+
+	void parallelFor( std::ptrdiff_t begin, std::ptrdiff_t end, std::ptrdiff_t grain,
+	                  const RangeTask& task )
+	{
+		if( begin >= end ) return ;
+		if( grain <= 0 ) grain = defaultGrain( end - begin ) ;
+
+		const std::ptrdiff_t nChunks = ( end - begin + grain - 1 ) / grain ;
+		const int current = currentWorker() ;
+
+		if( nChunks == 1 || m_nWorkers == 1 || current >= 0 ) {
+			// Nothing to share, or nested loop
+			task.run( begin, end, std::max( 0, current ) ) ;
+			return ;
+		}
+
+		std::lock_guard< std::mutex > submit( m_submit ) ;
+
+		Job job = { &task, begin, end, grain } ;
+		for( int w = 0 ; w < m_nWorkers ; ++w )
+		{
+			m_queues[w].front = ( nChunks *  w      ) / m_nWorkers ;
+			m_queues[w].back  = ( nChunks * ( w+1 ) ) / m_nWorkers ;
+		}
+
+		{
+			std::lock_guard< std::mutex > lock( m_mutex ) ;
+			m_job = &job ;
+			m_busy = m_nWorkers - 1 ;
+			++m_generation ;
+		}
+		m_wake.notify_all() ;
+
+		currentWorker() = 0 ;
+		work( job, 0 ) ;
+		currentWorker() = -1 ;
+
+		std::unique_lock< std::mutex > lock( m_mutex ) ;
+		m_done.wait( lock, [this]{ return m_busy == 0 ; } ) ;
+		m_job = nullptr ;
+	}
+
+private:
+	// Range of chunk indices [ front, back ) that remain to be processed
+	struct Queue
+	{
+		std::mutex mutex ;
+		std::ptrdiff_t front ;
+		std::ptrdiff_t back ;
+
+		Queue() : front( 0 ), back( 0 ) {}
+	} ;
+
+	struct Job
+	{
+		const RangeTask* task ;
+		std::ptrdiff_t begin ;
+		std::ptrdiff_t end ;
+		std::ptrdiff_t grain ;
+	} ;
+
+	//! Index of the worker running on the current thread, or -1
+	static int& currentWorker()
+	{
+		static thread_local int worker = -1 ;
+		return worker ;
+	}
+
+	bool popFront( int w, std::ptrdiff_t &chunk )
+	{
+		Queue &q = m_queues[w] ;
+		std::lock_guard< std::mutex > lock( q.mutex ) ;
+		if( q.front == q.back ) return false ;
+		chunk = q.front++ ;
+		return true ;
+	}
+
+	bool stealBack( int w, std::ptrdiff_t &chunk )
+	{
+		Queue &q = m_queues[w] ;
+		std::lock_guard< std::mutex > lock( q.mutex ) ;
+		if( q.front == q.back ) return false ;
+		chunk = --q.back ;
+		return true ;
+	}
+
+	void work( const Job& job, int w )
+	{
+		std::ptrdiff_t chunk ;
+		for( ;; )
+		{
+			bool found = popFront( w, chunk ) ;
+			for( int k = 1 ; !found && k < m_nWorkers ; ++k )
+				found = stealBack( ( w + k ) % m_nWorkers, chunk ) ;
+			if( !found ) return ;
+
+			const std::ptrdiff_t b = job.begin + chunk * job.grain ;
+			job.task->run( b, std::min( job.end, b + job.grain ), w ) ;
+		}
+	}
+
+	void workerLoop( int w )
+	{
+		currentWorker() = w ;
+		unsigned generation = 0 ;
+
+		for( ;; )
+		{
+			const Job* job ;
+			{
+				std::unique_lock< std::mutex > lock( m_mutex ) ;
+				m_wake.wait( lock, [&]{ return m_stop || m_generation != generation ; } ) ;
+				if( m_stop ) return ;
+				generation = m_generation ;
+				job = m_job ;
+			}
+
+			work( *job, w ) ;
+
+			{
+				std::lock_guard< std::mutex > lock( m_mutex ) ;
+				if( 0 == --m_busy ) m_done.notify_one() ;
+			}
+		}
+	}
+
+	WorkStealingExecutor( const WorkStealingExecutor& ) ;
+	WorkStealingExecutor& operator=( const WorkStealingExecutor& ) ;
+
+	const int m_nWorkers ;
+	std::unique_ptr< Queue[] > m_queues ;
+	std::vector< std::thread > m_threads ;
+
+	std::mutex m_submit ;
+	std::mutex m_mutex ;
+	std::condition_variable m_wake ;
+	std::condition_variable m_done ;
+
+	const Job* m_job ;
+	unsigned m_generation ;
+	int m_busy ;
+	bool m_stop ;
+} ;
+
+} //namespace bogus
+
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * This file is part of So-bogus, a C++ sparse block matrix library and
+ * Second Order Cone solver.
+ *
+ * Copyright 2013 Gilles Daviet <gdaviet@gmail.com>
+ *
+ * So-bogus is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+
+ * So-bogus is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with So-bogus.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef BOGUS_LOCAL_SOC_BATCH_HPP
+#define BOGUS_LOCAL_SOC_BATCH_HPP
+
+#include "../SecondOrder.fwd.hpp"
+
+#include <Eigen/Core>
+
+namespace bogus {
+
+//! Structure-of-arrays storage for a batch of independent local SOC problems
+/*!
+	Each coefficient of the local matrices and vectors is stored as an array of \p BatchSize lanes,
+	one per local problem, so that the batch can be processed simultaneously using SIMD instructions.
+	Only the first \c count lanes are considered by the solvers.
+	\sa LocalSOCSolver::solveBatch(), SOCLaw::solveLocalBatch()
+  */
+template< DenseIndexType Dimension, typename Scalar, int BatchSize >
+struct LocalSOCBatch
+{
+	enum { batchSize = BatchSize } ;
+
+	typedef LocalProblemTraits< Dimension, Scalar > Traits ;
+	typedef Eigen::Array< Scalar, BatchSize, 1 > Lanes ;
+	typedef Eigen::Array< bool, BatchSize, 1 > Mask ;
+
+	//! Local matrices
+	Lanes A[ Dimension ][ Dimension ] ;
+	//! Local constant terms
+	Lanes b[ Dimension ] ;
+	//! Initial guesses and solutions
+	Lanes x[ Dimension ] ;
+	//! Cone apertures
+	Lanes mu ;
+	//! Error scaling factors
+	Lanes scaling ;
+
+	//! Number of lanes actually used
+	unsigned count ;
+
+	LocalSOCBatch() : count( 0 )
+	{
+		for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+		{
+			for( DenseIndexType j = 0 ; j < Dimension ; ++j )
+				A[i][j].setZero() ;
+			b[i].setZero() ;
+			x[i].setZero() ;
+		}
+		mu.setZero() ;
+		scaling.setOnes() ;
+	}
+
+	//! Sets the problem data of a given lane
+	/*! The cone aperture \c mu[ \p lane ] has to be set separately ; SOCLaw::solveLocalBatch() does it automatically */
+	template < typename MatrixT, typename RhsT, typename VectorT >
+	void set( const unsigned lane, const MatrixT& Al, const RhsT& bl, const VectorT& xl,
+	          const Scalar scalingl = 1 )
+	{
+		for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+		{
+			for( DenseIndexType j = 0 ; j < Dimension ; ++j )
+				A[i][j][lane] = Al( i, j ) ;
+			b[i][lane] = bl[i] ;
+			x[i][lane] = xl[i] ;
+		}
+		scaling[lane] = scalingl ;
+	}
+
+	//! Gets the solution of a given lane
+	template < typename VectorT >
+	void get( const unsigned lane, VectorT& xl ) const
+	{
+		for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+			xl[i] = x[i][lane] ;
+	}
+
+	//! Gathers the data of a given lane into a dense matrix and vectors
+	template < typename MatrixT, typename VectorT >
+	void gather( const unsigned lane, MatrixT& Al, VectorT& bl, VectorT& xl ) const
+	{
+		for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+		{
+			for( DenseIndexType j = 0 ; j < Dimension ; ++j )
+				Al( i, j ) = A[i][j][lane] ;
+			bl[i] = b[i][lane] ;
+			xl[i] = x[i][lane] ;
+		}
+	}
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+} ;
+
+}
+
+#endif
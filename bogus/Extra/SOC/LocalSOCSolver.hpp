@@ -44,6 +44,20 @@ struct LocalSOCSolver
 		  const Scalar scaling = 1
 		  ) ;
 
+#ifndef BOGUS_WITHOUT_EIGEN
+  //! Solves simultaneously the \c batch.count first local problems of \p batch
+  /*!
+	The take-off, frictionless and sticking cases are detected and solved for all lanes at once ;
+	the remaining lanes are solved one by one using solve().
+	\param res Array of size \c batch.count that will receive the residual of each local problem
+	*/
+  template < int BatchSize >
+  static void solveBatch(
+		  LocalSOCBatch< Dimension, Scalar, BatchSize > &batch,
+		  const Scalar tol, Scalar *res
+		  ) ;
+#endif
+
 } ;
 
 }
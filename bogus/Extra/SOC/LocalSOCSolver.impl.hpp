@@ -29,6 +29,11 @@
 #include "../../Core/Utils/LinearSolverBase.hpp"
 #include "../../Core/Utils/NonSmoothNewton.impl.hpp"
 #include "../../Core/Utils/Polynomial.impl.hpp"
+#include "../../Core/Utils/SolverStats.hpp"
+
+#ifndef BOGUS_WITHOUT_EIGEN
+#include "LocalSOCBatch.hpp"
+#endif
 
 namespace bogus {
 
@@ -321,17 +326,20 @@ Scalar LocalSOCSolver< Dimension, Scalar, DeSaxceCOV, Strat >::solve(
 
 	if( Strat == local_soc_solver::PureNewton )
 	{
+		BOGUS_STATS( ++localSolverCounters().newton ; )
 		return nsNewton.solve( x ) ;
 	}
 
 	if( Traits::np(b) >= ( DeSaxceCOV ? 0 : mu * Traits::tp(b).norm() ) )
 	{
 		// Take-off case ( -b in normal cone of constraint )
+		BOGUS_STATS( ++localSolverCounters().trivial ; )
 		x.setZero() ;
 		return 0. ;
 	}
 	if( NumTraits< Scalar >::isZero( mu ) )
 	{
+		BOGUS_STATS( ++localSolverCounters().trivial ; )
 		//Frictionless case
 		if( A(0,0) < NumTraits< Scalar >::epsilon() )
 		{
@@ -350,10 +358,14 @@ Scalar LocalSOCSolver< Dimension, Scalar, DeSaxceCOV, Strat >::solve(
 	if( Strat == local_soc_solver::Hybrid )
 	{
 		res = nsNewton.solve( x ) ;
-		if( res < tol ) return res ;
+		if( res < tol ) {
+			BOGUS_STATS( ++localSolverCounters().newton ; )
+			return res ;
+		}
 	}
 
 	// Continuing enumerative fallback
+	BOGUS_STATS( ++localSolverCounters().enumerative ; )
 
 	Vector x0 = x ;
 	LUType( A ).solve( -b, x ) ;
@@ -385,6 +397,174 @@ Scalar LocalSOCSolver< Dimension, Scalar, DeSaxceCOV, Strat >::solve(
 	return res ;
 }
 
+#ifndef BOGUS_WITHOUT_EIGEN
+
+namespace soc_batch_impl {
+
+// Solves A x = -b on each lane of a batch ; returns the lanes for which A is invertible
+// No closed-form expression in the general case
+template < DenseIndexType Dimension, typename Scalar, int BatchSize >
+struct LinearSolve
+{
+	typedef LocalSOCBatch< Dimension, Scalar, BatchSize > Batch ;
+	typedef typename Batch::Lanes Lanes ;
+	typedef typename Batch::Mask Mask ;
+
+	static Mask solve( const Batch &, Lanes * )
+	{
+		return Mask::Constant( false ) ;
+	}
+} ;
+
+template < typename Scalar, int BatchSize >
+struct LinearSolve< 2u, Scalar, BatchSize >
+{
+	typedef LocalSOCBatch< 2u, Scalar, BatchSize > Batch ;
+	typedef typename Batch::Lanes Lanes ;
+	typedef typename Batch::Mask Mask ;
+
+	static Mask solve( const Batch &batch, Lanes *x )
+	{
+		const Lanes (&A)[2][2] = batch.A ;
+		const Lanes (&b)[2] = batch.b ;
+
+		const Lanes det = A[0][0]*A[1][1] - A[0][1]*A[1][0] ;
+		const Mask ok = det.abs() > NumTraits< Scalar >::epsilon() *
+				( ( A[0][0]*A[1][1] ).abs() + ( A[0][1]*A[1][0] ).abs() ) ;
+		const Lanes invDet = ok.select( det, Lanes::Ones() ).inverse() ;
+
+		x[0] = ( A[0][1]*b[1] - A[1][1]*b[0] ) * invDet ;
+		x[1] = ( A[1][0]*b[0] - A[0][0]*b[1] ) * invDet ;
+
+		return ok ;
+	}
+} ;
+
+template < typename Scalar, int BatchSize >
+struct LinearSolve< 3u, Scalar, BatchSize >
+{
+	typedef LocalSOCBatch< 3u, Scalar, BatchSize > Batch ;
+	typedef typename Batch::Lanes Lanes ;
+	typedef typename Batch::Mask Mask ;
+
+	static Mask solve( const Batch &batch, Lanes *x )
+	{
+		const Lanes (&A)[3][3] = batch.A ;
+		const Lanes (&b)[3] = batch.b ;
+
+		// Cofactors
+		const Lanes c00 = A[1][1]*A[2][2] - A[1][2]*A[2][1] ;
+		const Lanes c01 = A[1][2]*A[2][0] - A[1][0]*A[2][2] ;
+		const Lanes c02 = A[1][0]*A[2][1] - A[1][1]*A[2][0] ;
+		const Lanes c10 = A[0][2]*A[2][1] - A[0][1]*A[2][2] ;
+		const Lanes c11 = A[0][0]*A[2][2] - A[0][2]*A[2][0] ;
+		const Lanes c12 = A[0][1]*A[2][0] - A[0][0]*A[2][1] ;
+		const Lanes c20 = A[0][1]*A[1][2] - A[0][2]*A[1][1] ;
+		const Lanes c21 = A[0][2]*A[1][0] - A[0][0]*A[1][2] ;
+		const Lanes c22 = A[0][0]*A[1][1] - A[0][1]*A[1][0] ;
+
+		const Lanes det = A[0][0]*c00 + A[0][1]*c01 + A[0][2]*c02 ;
+		const Mask ok = det.abs() > NumTraits< Scalar >::epsilon() *
+				( ( A[0][0]*c00 ).abs() + ( A[0][1]*c01 ).abs() + ( A[0][2]*c02 ).abs() ) ;
+		const Lanes invDet = ok.select( det, Lanes::Ones() ).inverse() ;
+
+		x[0] = - ( c00*b[0] + c10*b[1] + c20*b[2] ) * invDet ;
+		x[1] = - ( c01*b[0] + c11*b[1] + c21*b[2] ) * invDet ;
+		x[2] = - ( c02*b[0] + c12*b[1] + c22*b[2] ) * invDet ;
+
+		return ok ;
+	}
+} ;
+
+} //namespace soc_batch_impl
+
+template< DenseIndexType Dimension, typename Scalar, bool DeSaxceCOV, local_soc_solver::Strategy Strat >
+template< int BatchSize >
+void LocalSOCSolver< Dimension, Scalar, DeSaxceCOV, Strat >::solveBatch(
+		LocalSOCBatch< Dimension, Scalar, BatchSize > &batch,
+		const Scalar tol, Scalar *res
+		)
+{
+	typedef LocalSOCBatch< Dimension, Scalar, BatchSize > Batch ;
+	typedef typename Batch::Lanes Lanes ;
+	typedef typename Batch::Mask Mask ;
+
+	// Norms of the tangential components of b
+	Lanes bT = Lanes::Zero() ;
+	for( DenseIndexType i = 1 ; i < Dimension ; ++i )
+		bT += batch.b[i].square() ;
+	bT = bT.sqrt() ;
+
+	// Sticking candidates : solutions of A x = -b
+	Lanes xs[ Dimension ] ;
+	Lanes xsT = Lanes::Zero() ;
+	Lanes linRes = Lanes::Zero() ;
+
+	const Mask invertible = soc_batch_impl::LinearSolve< Dimension, Scalar, BatchSize >::solve( batch, xs ) ;
+	for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+	{
+		Lanes r = batch.b[i] ;
+		for( DenseIndexType j = 0 ; j < Dimension ; ++j )
+			r += batch.A[i][j] * xs[j] ;
+		linRes += r.square() ;
+		if( i > 0 ) xsT += xs[i].square() ;
+	}
+	xsT = xsT.sqrt() ;
+
+	for( unsigned k = 0 ; k < batch.count ; ++k )
+	{
+		const Scalar mu = batch.mu[k] ;
+
+		if( Strat != local_soc_solver::PureNewton && mu >= 0 )
+		{
+			if( batch.b[0][k] >= ( DeSaxceCOV ? 0 : mu * bT[k] ) )
+			{
+				// Take-off case
+				BOGUS_STATS( ++localSolverCounters().trivial ; )
+				for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+					batch.x[i][k] = 0 ;
+				res[k] = 0 ;
+				continue ;
+			}
+
+			if( NumTraits< Scalar >::isZero( mu ) )
+			{
+				// Frictionless case
+				BOGUS_STATS( ++localSolverCounters().trivial ; )
+				for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+					batch.x[i][k] = 0 ;
+				if( batch.A[0][0][k] < NumTraits< Scalar >::epsilon() )
+				{
+					res[k] = batch.b[0][k] * batch.b[0][k] ;
+				} else {
+					batch.x[0][k] = - batch.b[0][k] / batch.A[0][0][k] ;
+					res[k] = 0 ;
+				}
+				continue ;
+			}
+
+			if( invertible[k] && linRes[k] < tol && mu * xs[0][k] >= xsT[k] )
+			{
+				// Sticking case
+				BOGUS_STATS( ++localSolverCounters().trivial ; )
+				for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+					batch.x[i][k] = xs[i][k] ;
+				res[k] = 0 ;
+				continue ;
+			}
+		}
+
+		// Sliding case, or unsupported strategy ; use the scalar solver
+		typename Traits::Matrix A ;
+		typename Traits::Vector b, x ;
+		batch.gather( k, A, b, x ) ;
+		res[k] = solve( A, b, x, mu, tol, batch.scaling[k] ) ;
+		for( DenseIndexType i = 0 ; i < Dimension ; ++i )
+			batch.x[i][k] = x[i] ;
+	}
+}
+
+#endif
 
 }
 
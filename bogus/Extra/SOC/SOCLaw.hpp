@@ -68,6 +68,22 @@ public:
 		return fb.squaredNorm() ;
 	}
 
+	//! Computes the Fischer-Burmeister function \p fb := fb( mu, x, y ), as used by eval()
+	void evalFunction( const unsigned problemIndex,
+	                   const typename Traits::Vector &x,
+	                   const typename Traits::Vector &y,
+	                   typename Traits::Vector &fb ) const ;
+
+	//! Computes the Fischer-Burmeister function \p fb and its jacobians with respect to \p x and \p y
+	/*! The jacobians include the derivative of the De Saxce change of variable when \p DeSaxceCOV is true.
+		Used by global Newton solvers \sa SemismoothNewton */
+	void evalJacobian( const unsigned problemIndex,
+	                   const typename Traits::Vector &x,
+	                   const typename Traits::Vector &y,
+	                   typename Traits::Vector &fb,
+	                   typename Traits::Matrix &dFb_dx,
+	                   typename Traits::Matrix &dFb_dy ) const ;
+
 	//! Solves the local problem
 	/*!
 	  \f[
@@ -92,6 +108,26 @@ public:
 	        const Scalar scaling
 	        ) const ;
 
+#ifndef BOGUS_WITHOUT_EIGEN
+	//! Solves simultaneously a batch of local problems
+	/*!
+	  \param problemIndices Array of size \c batch.count containing the index of the local problem
+	   associated to each lane of \p batch
+	  \param ok Array of size \c batch.count that will receive, for each lane, the same
+	   value as solveLocal() would have returned
+	  \sa LocalSOCSolver::solveBatch()
+	  */
+	template < int BatchSize >
+	void solveLocalBatch(
+	        const unsigned *problemIndices,
+	        LocalSOCBatch< Dimension, Scalar, BatchSize > &batch,
+	        bool *ok
+	        ) const ;
+#endif
+
+	//! Returns the aperture of the cone of the \p problemIndex-th local problem, or a negative value if it is unconstrained
+	Scalar mu( const unsigned problemIndex ) const { return m_mu[problemIndex] ; }
+
 	//! Projects x on \f$ K_{ \mu } \f$
 	void projectOnConstraint( const unsigned problemIndex, typename Traits::Vector &x ) const ;
 
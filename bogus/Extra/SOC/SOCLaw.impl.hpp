@@ -26,6 +26,7 @@
 #include "../../Core/Utils/NumTraits.hpp"
 
 #include "FischerBurmeister.hpp"
+#include "FischerBurmeister.impl.hpp"
 #include "LocalSOCSolver.hpp"
 #include "LocalSOCSolver.impl.hpp"
 
@@ -38,6 +39,63 @@ SOCLaw< Dimension, Scalar, DeSaxceCOV, Strat >::SOCLaw(const unsigned n, const d
 }
 
 
+template < DenseIndexType Dimension, typename Scalar, bool DeSaxceCOV, local_soc_solver::Strategy Strat >
+void SOCLaw< Dimension, Scalar, DeSaxceCOV, Strat >::evalFunction( const unsigned problemIndex,
+			const typename Traits::Vector &x,
+			const typename Traits::Vector &y,
+			typename Traits::Vector &fb ) const
+{
+	typedef FischerBurmeister< Traits::dimension, typename Traits::Scalar, DeSaxceCOV > FBFunction ;
+
+	if( m_mu[problemIndex] < 0 ) {
+		fb = y ;
+		return ;
+	}
+
+	fb.resize( x.rows() ) ;
+	FBFunction::compute( m_mu[problemIndex], x, y, fb ) ;
+}
+
+template < DenseIndexType Dimension, typename Scalar, bool DeSaxceCOV, local_soc_solver::Strategy Strat >
+void SOCLaw< Dimension, Scalar, DeSaxceCOV, Strat >::evalJacobian( const unsigned problemIndex,
+			const typename Traits::Vector &x,
+			const typename Traits::Vector &y,
+			typename Traits::Vector &fb,
+			typename Traits::Matrix &dFb_dx,
+			typename Traits::Matrix &dFb_dy ) const
+{
+	typedef FBBaseFunction< Traits::dimension, typename Traits::Scalar > BaseFunction ;
+
+	const Scalar mu = m_mu[problemIndex] ;
+	const DenseIndexType d = x.rows() ;
+
+	if( mu < 0 ) {
+		fb = y ;
+		dFb_dx.setZero( d, d ) ;
+		dFb_dy.setIdentity( d, d ) ;
+		return ;
+	}
+
+	typename Traits::Vector yt( y ) ;
+	Scalar s = 0 ;
+	if( DeSaxceCOV ) {
+		s = Traits::tp( y ).norm() ;
+		Traits::np( yt ) += mu * s ;
+	}
+
+	fb.resize( d ) ;
+	dFb_dx.resize( d, d ) ;
+	dFb_dy.resize( d, d ) ;
+	BaseFunction::computeJacobian( mu, x, yt, fb, dFb_dx, dFb_dy ) ;
+
+	// Chain rule through the change of variable
+	if( DeSaxceCOV && !NumTraits< Scalar >::isZero( s ) )
+	{
+		Traits::tc( dFb_dy ).noalias() +=
+		  Traits::nc( dFb_dy ) *  ( mu / s ) * Traits::tp( y ).transpose() ;
+	}
+}
+
 template < DenseIndexType Dimension, typename Scalar, bool DeSaxceCOV, local_soc_solver::Strategy Strat >
 bool SOCLaw< Dimension, Scalar, DeSaxceCOV, Strat >::solveLocal(const unsigned problemIndex,
 			const typename Traits::Matrix &A,
@@ -48,6 +106,27 @@ bool SOCLaw< Dimension, Scalar, DeSaxceCOV, Strat >::solveLocal(const unsigned p
 	return m_localTol > LocalSolver::solve(  A, b, xm, m_mu[ problemIndex ], m_localTol, scaling ) ;
 }
 
+#ifndef BOGUS_WITHOUT_EIGEN
+template < DenseIndexType Dimension, typename Scalar, bool DeSaxceCOV, local_soc_solver::Strategy Strat >
+template < int BatchSize >
+void SOCLaw< Dimension, Scalar, DeSaxceCOV, Strat >::solveLocalBatch(
+			const unsigned *problemIndices,
+			LocalSOCBatch< Dimension, Scalar, BatchSize > &batch,
+			bool *ok ) const
+{
+	typedef LocalSOCSolver< Traits::dimension, typename Traits::Scalar, DeSaxceCOV, Strat > LocalSolver ;
+
+	for( unsigned k = 0 ; k < batch.count ; ++k )
+		batch.mu[k] = m_mu[ problemIndices[k] ] ;
+
+	Scalar res[ BatchSize ] ;
+	LocalSolver::solveBatch( batch, m_localTol, res ) ;
+
+	for( unsigned k = 0 ; k < batch.count ; ++k )
+		ok[k] = m_localTol > res[k] ;
+}
+#endif
+
 template < DenseIndexType Dimension, typename Scalar, bool DeSaxceCOV, local_soc_solver::Strategy Strat >
 void SOCLaw< Dimension, Scalar, DeSaxceCOV, Strat >::projectOnConstraint(
 		const unsigned problemIndex, typename Traits::Vector &x ) const
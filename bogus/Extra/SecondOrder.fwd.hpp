@@ -47,6 +47,11 @@ enum Strategy
 template< DenseIndexType Dimension, typename Scalar >
 struct LocalProblemTraits ;
 
+#ifndef BOGUS_WITHOUT_EIGEN
+template< DenseIndexType Dimension, typename Scalar, int BatchSize >
+struct LocalSOCBatch ;
+#endif
+
 template < DenseIndexType Dimension, typename Scalar, bool DeSaxceCOV,
 #ifndef BOGUS_WITHOUT_EIGEN
 			 local_soc_solver::Strategy Strat = local_soc_solver::RevHybrid  >
@@ -25,6 +25,7 @@
 #include "SecondOrder.fwd.hpp"
 #ifndef BOGUS_WITHOUT_EIGEN
 #include "../Core/Eigen/EigenProblemTraits.hpp"
+#include "SOC/LocalSOCBatch.hpp"
 #endif
 #include "SOC/SOCLaw.hpp"
 
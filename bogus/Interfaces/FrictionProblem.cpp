@@ -22,6 +22,11 @@
 
 #include "../Core/BlockSolvers/GaussSeidel.impl.hpp"
 #include "../Core/BlockSolvers/ProjectedGradient.impl.hpp"
+#include "../Core/BlockSolvers/SemismoothNewton.impl.hpp"
+#include "../Core/BlockSolvers/InteriorPoint.impl.hpp"
+#include "../Core/BlockSolvers/MultilevelGaussSeidel.impl.hpp"
+
+#include <algorithm>
 
 
 namespace bogus {
@@ -33,15 +38,237 @@ void DualFrictionProblem< Dimension >::computeFrom(const PrimalFrictionProblem<D
 {
 
 	//W
-	W = primal.H * ( primal.MInv * primal.H.transpose() ) ;
+	if( primal.hasSparseMFactorization() )
+	{
+		computeFromSparseFactorization( primal ) ;
+	} else {
+		MInvHtType MInvHt ;
+		MInvHt.setFromProduct( primal.MInv * primal.H.transpose(), m_MInvHtPlan ) ;
+		W.setFromProduct( primal.H * MInvHt, m_WPlan ) ;
+	}
 
 	// M^-1 f, b
 	b = primal.E.transpose() * Eigen::VectorXd::Map( primal.w, primal.H.rows())
-	        - primal.H * ( primal.MInv * Eigen::VectorXd::Map( primal.f, primal.H.cols() ) );
+	        - primal.H * primal.applyMInv( Eigen::VectorXd::Map( primal.f, primal.H.cols() ) );
 
 	mu = Eigen::VectorXd::Map( primal.mu, W.rowsOfBlocks() ) ;
 }
 
+template< unsigned Dimension >
+void DualFrictionProblem< Dimension >::updateFrom( const PrimalFrictionProblem< Dimension > &primal,
+                                                   const std::vector< std::size_t > &removed,
+                                                   const std::vector< std::size_t > &inserted )
+{
+	typedef typename PrimalFrictionProblem< Dimension >::HType HType ;
+	typedef SparseBlockMatrix< typename WType::BlockType > PType ;
+	typedef typename WType::Index Index ;
+	typedef typename WType::BlockPtr BlockPtr ;
+
+	// Source of a block of the updated W
+	struct Entry
+	{
+		enum Source { Previous, Cross, CrossTranspose } ;
+
+		Index col ;
+		BlockPtr ptr ;
+		Source source ;
+
+		Entry( Index c, BlockPtr p, Source s ) : col( c ), ptr( p ), source( s ) {}
+		bool operator< ( const Entry& o ) const { return col < o.col ; }
+	} ;
+
+	assert( !permuted() ) ;
+	assert( !primal.hasSparseMFactorization() ) ;
+
+	const Index None = (Index) -1 ;
+	const Index nPrev = W.rowsOfBlocks() ;
+	const Index n = primal.H.rowsOfBlocks() ;
+	const Index nIns = inserted.size() ;
+	assert( nPrev + nIns == n + removed.size() ) ;
+
+	// Mappings between previous and updated contact indices
+
+	std::vector< Index > insertedRank( n, None ) ;
+	for( Index k = 0 ; k < nIns ; ++k )
+		insertedRank[ inserted[k] ] = k ;
+
+	std::vector< Index > newIndex( nPrev, None ) ;
+	std::vector< Index > prevIndex( n, None ) ;
+	{
+		std::size_t r = 0 ;
+		Index i = 0 ;
+		for( Index o = 0 ; o < nPrev ; ++o )
+		{
+			if( r < removed.size() && (Index) removed[r] == o )
+			{
+				++r ;
+				continue ;
+			}
+			while( insertedRank[i] != None ) ++i ;
+			newIndex[o] = i ;
+			prevIndex[i] = o ;
+			++i ;
+		}
+	}
+
+	// Cross products P = H M^-1 Hins^T, with Hins the rows of H of the inserted contacts
+
+	std::vector< unsigned > rowDims( n ), insDims( nIns ), colDims( primal.H.colsOfBlocks() ) ;
+	for( Index i = 0 ; i < n ; ++i )
+		rowDims[i] = primal.H.blockRows( i ) ;
+	for( Index k = 0 ; k < nIns ; ++k )
+		insDims[k] = rowDims[ inserted[k] ] ;
+	for( Index j = 0 ; j < (Index) colDims.size() ; ++j )
+		colDims[j] = primal.H.blockCols( j ) ;
+
+	HType Hins ;
+	Hins.setRows( insDims ) ;
+	Hins.setCols( colDims ) ;
+	for( Index k = 0 ; k < nIns ; ++k )
+	{
+		for( typename HType::InnerIterator it( primal.H.innerIterator( inserted[k] ) ) ; it ; ++it )
+			Hins.insertBack( k, it.inner() ) = primal.H.block( it.ptr() ) ;
+	}
+	Hins.finalize() ;
+
+	const MInvHtType MInvHinst = primal.MInv * Hins.transpose() ;
+	const PType P = primal.H * MInvHinst ;
+
+	// Bucket the lower-triangular blocks provided by P by row of the updated W
+	// P( i, k ) = W( i, inserted[k] )
+
+	std::vector< std::size_t > crossOffsets( n + 1, 0 ) ;
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		for( typename PType::InnerIterator it( P.innerIterator( i ) ) ; it ; ++it )
+		{
+			const Index j = inserted[ it.inner() ] ;
+			if( j <= i )
+				++crossOffsets[ i+1 ] ;
+			else if( insertedRank[i] == None )
+				++crossOffsets[ j+1 ] ;
+		}
+	}
+	for( Index i = 0 ; i < n ; ++i )
+		crossOffsets[ i+1 ] += crossOffsets[ i ] ;
+
+	std::vector< Entry > cross ;
+	cross.reserve( crossOffsets[n] ) ;
+	{
+		std::vector< std::size_t > cursor( crossOffsets.begin(), crossOffsets.end() - 1 ) ;
+		cross.resize( crossOffsets[n], Entry( 0, 0, Entry::Cross ) ) ;
+		for( Index i = 0 ; i < n ; ++i )
+		{
+			for( typename PType::InnerIterator it( P.innerIterator( i ) ) ; it ; ++it )
+			{
+				const Index j = inserted[ it.inner() ] ;
+				if( j <= i )
+					cross[ cursor[i]++ ] = Entry( j, it.ptr(), Entry::Cross ) ;
+				else if( insertedRank[i] == None )
+					cross[ cursor[j]++ ] = Entry( i, it.ptr(), Entry::CrossTranspose ) ;
+			}
+		}
+	}
+
+	// Assemble updated W, one row at a time
+
+	WType updated ;
+	updated.setRows( rowDims ) ;
+	updated.setCols( rowDims ) ;
+	updated.reserve( W.nBlocks() + cross.size() ) ;
+
+	std::vector< Entry > row ;
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		row.assign( cross.begin() + crossOffsets[i], cross.begin() + crossOffsets[i+1] ) ;
+
+		if( prevIndex[i] != None )
+		{
+			for( typename WType::InnerIterator it( W.innerIterator( prevIndex[i] ) ) ; it ; ++it )
+			{
+				const Index j = newIndex[ it.inner() ] ;
+				if( j != None )
+					row.push_back( Entry( j, it.ptr(), Entry::Previous ) ) ;
+			}
+		}
+
+		std::sort( row.begin(), row.end() ) ;
+
+		for( std::size_t e = 0 ; e < row.size() ; ++e )
+		{
+			switch( row[e].source )
+			{
+			case Entry::Previous:
+				updated.insertBack( i, row[e].col ) = W.block( row[e].ptr ) ;
+				break ;
+			case Entry::Cross:
+				updated.insertBack( i, row[e].col ) = P.block( row[e].ptr ) ;
+				break ;
+			case Entry::CrossTranspose:
+				updated.insertBack( i, row[e].col ) = P.block( row[e].ptr ).transpose() ;
+				break ;
+			}
+		}
+	}
+	updated.finalize() ;
+
+	W = updated ;
+
+	// b, mu
+
+	b = primal.E.transpose() * Eigen::VectorXd::Map( primal.w, primal.H.rows())
+	        - primal.H * primal.applyMInv( Eigen::VectorXd::Map( primal.f, primal.H.cols() ) );
+
+	mu = Eigen::VectorXd::Map( primal.mu, W.rowsOfBlocks() ) ;
+}
+
+template< unsigned Dimension >
+void DualFrictionProblem< Dimension >::computeFromSparseFactorization( const PrimalFrictionProblem< Dimension > &primal )
+{
+	typedef typename WType::Index Index ;
+
+	const Index n = primal.H.rowsOfBlocks() ;
+
+	// M^-1 H^T, one column at a time, and W = H M^-1 H^T as a dense matrix
+
+	const Eigen::MatrixXd Ht = primal.H.transpose() * Eigen::MatrixXd::Identity( primal.H.rows(), primal.H.rows() ) ;
+	const Eigen::MatrixXd MInvHt = primal.MFactorization.solve( Ht ) ;
+	const Eigen::MatrixXd Wd = primal.H * MInvHt ;
+
+	// Lower-triangular non-zero blocks of W
+
+	std::vector< unsigned > rowDims( n ) ;
+	for( Index i = 0 ; i < n ; ++i )
+		rowDims[i] = primal.H.blockRows( i ) ;
+
+	W.clear() ;
+	W.setRows( rowDims ) ;
+	W.setCols( rowDims ) ;
+
+	for( Index i = 0 ; i < n ; ++i )
+	{
+		const Index ri = primal.H.rowOffsets()[i] ;
+		for( Index j = 0 ; j <= i ; ++j )
+		{
+			const Index rj = primal.H.rowOffsets()[j] ;
+			const Eigen::MatrixXd::ConstBlockXpr block = Wd.block( ri, rj, rowDims[i], rowDims[j] ) ;
+			if( i == j || !block.isZero( 0 ) )
+				W.insertBack( i, j ) = block ;
+		}
+	}
+	W.finalize() ;
+}
+
+template< unsigned Dimension >
+void DualFrictionProblem< Dimension >::computeMixedPrecision()
+{
+	typedef typename MixedWType::BlockType::Scalar MixedScalar ;
+
+	Wf.cloneStructure( W ) ;
+	for( typename WType::BlockPtr k = 0 ; k < (typename WType::BlockPtr) W.nBlocks() ; ++k )
+		Wf.block( k ) = W.block( k ).template cast< MixedScalar >() ;
+}
+
 template< unsigned Dimension >
 double DualFrictionProblem< Dimension >::solveWith( GaussSeidelType &gs, double *r,
                                          const bool staticProblem ) const
@@ -60,6 +287,44 @@ double DualFrictionProblem< Dimension >::solveWith( ProjectedGradientType &pg,
 	return friction_problem::solve( *this, pg, r, staticProblem ) ;
 }
 
+template< unsigned Dimension >
+double DualFrictionProblem< Dimension >::solveWith( SemismoothNewtonType &ssn,
+                                                    double *r, const bool staticProblem ) const
+{
+	ssn.setMatrix( W );
+
+	return friction_problem::solve( *this, ssn, r, staticProblem ) ;
+}
+
+template< unsigned Dimension >
+double DualFrictionProblem< Dimension >::solveWith( InteriorPointType &ip, double *r ) const
+{
+	ip.setMatrix( W );
+
+	return friction_problem::solve( *this, ip, r, true ) ;
+}
+
+template< unsigned Dimension >
+double DualFrictionProblem< Dimension >::solveWith( MultilevelGaussSeidelType &mgs,
+                                                    double *r, const bool staticProblem ) const
+{
+	mgs.setMatrix( W );
+
+	return friction_problem::solve( *this, mgs, r, staticProblem ) ;
+}
+
+template< unsigned Dimension >
+double DualFrictionProblem< Dimension >::solveWith( MixedGaussSeidelType &gs, double *r,
+                                                    const bool staticProblem, const unsigned maxRefinements ) const
+{
+	assert( Wf.nBlocks() == W.nBlocks() ) ;
+	gs.setMatrix( Wf );
+
+	return staticProblem
+	        ? friction_problem::solveMixed( *this, gs, SOCLawType( W.rowsOfBlocks(), mu.data() ), r, maxRefinements )
+	        : friction_problem::solveMixed( *this, gs, CoulombLawType( W.rowsOfBlocks(), mu.data() ), r, maxRefinements ) ;
+}
+
 template< unsigned Dimension >
 double DualFrictionProblem< Dimension >::evalWith( const GaussSeidelType &gs,
                                                      const double *r,
@@ -125,6 +390,8 @@ void DualFrictionProblem< Dimension >::applyPermutation(
 		m_invPermutation[ m_permutation[i] ] = i ;
 
 	W.applyPermutation( data_pointer(m_permutation) ) ;
+	if( Wf.nBlocks() )
+		Wf.applyPermutation( data_pointer(m_permutation) ) ;
 	friction_problem::applyPermutation< Dimension >( m_permutation, b, W.colOffsets() ) ;
 	bogus::applyPermutation( m_permutation.size(), data_pointer(m_permutation), mu ) ;
 }
@@ -136,6 +403,8 @@ void DualFrictionProblem< Dimension >::undoPermutation()
 		return ;
 
 	W.applyPermutation( data_pointer(m_invPermutation) ) ;
+	if( Wf.nBlocks() )
+		Wf.applyPermutation( data_pointer(m_invPermutation) ) ;
 	friction_problem::applyPermutation< Dimension >( m_invPermutation, b, W.colOffsets() ) ;
 	bogus::applyPermutation( m_invPermutation.size(), data_pointer(m_invPermutation), mu ) ;
 
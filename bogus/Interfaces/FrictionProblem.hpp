@@ -23,6 +23,7 @@
 
 #include "../Core/Block.hpp"
 #include "../Core/BlockSolvers.fwd.hpp"
+#include "../Core/BlockSolvers/SparseCholesky.hpp"
 
 #include "../Extra/SecondOrder.fwd.hpp"
 
@@ -82,10 +83,24 @@ struct PrimalFrictionProblem
 	typedef SparseBlockMatrix< LU< Eigen::MatrixBase< Eigen::MatrixXd > > > MInvType ;
 	MInvType MInv ;
 
+	//! Sparse Cholesky factorization of M, used instead of MInv when M is not block-diagonal
+	typedef SparseBlockCholesky< MType > MFactorizationType ;
+	MFactorizationType MFactorization ;
+
 	//! Computes MInv from M. Required to build a DualFrictionProblem for the PrimalFrictionProblem,
 	//! or to use the ADMM and matrix-free Gauss-Seidel solvers.
+	/*! If M has off-diagonal blocks, as for reduced-coordinate articulated bodies, MFactorization is computed instead
+		and MInv is left empty. Its symbolic analysis is reused as long as the sparsity pattern of M does not change.
+		Only DualFrictionProblem::computeFrom() supports such non block-diagonal mass matrices.
+	*/
 	void computeMInv () ;
 
+	//! Whether M^-1 is represented by MFactorization rather than MInv
+	bool hasSparseMFactorization() const { return MInv.rowsOfBlocks() == 0 && M.rowsOfBlocks() != 0 ; }
+
+	//! Returns M^-1 \p rhs, using either MInv or MFactorization
+	Eigen::VectorXd applyMInv( const Eigen::VectorXd& rhs ) const ;
+
 
 	// Primal-dual solve functions
 
@@ -134,6 +149,18 @@ struct DualFrictionProblem
 
 	typedef GaussSeidel< WType > GaussSeidelType ;
 	typedef ProjectedGradient< WType > ProjectedGradientType ;
+	typedef SemismoothNewton< WType > SemismoothNewtonType ;
+	typedef InteriorPoint< WType > InteriorPointType ;
+	typedef MultilevelGaussSeidel< WType > MultilevelGaussSeidelType ;
+
+	//! Single-precision storage for W, on which solvers operate in double precision
+	/*! Blocks are kept in double precision for dynamically-sized problems, which are not supported
+		by the mixed-precision matrix-vector products \sa flags::MIXED_PRECISION */
+	typedef SparseBlockMatrix< Eigen::Matrix< typename TypeSwapIf< Dimension == (unsigned) Eigen::Dynamic, float, double >::First,
+	                                          Dimension, Dimension, Eigen::RowMajor >,
+	                           SYMMETRIC | MIXED_PRECISION > MixedWType ;
+
+	typedef GaussSeidel< MixedWType > MixedGaussSeidelType ;
 
 	typedef SOCLaw< Dimension, double, true  > CoulombLawType	;
 	typedef SOCLaw< Dimension, double, false > SOCLawType	;
@@ -143,6 +170,9 @@ struct DualFrictionProblem
 	//! W -- Delassus operator
 	WType W ;
 
+	//! Wf -- single-precision copy of W, see computeMixedPrecision()
+	MixedWType Wf ;
+
 	//! Rhs ( such that u = Wr + b )
 	Eigen::VectorXd b ;
 
@@ -150,9 +180,32 @@ struct DualFrictionProblem
 	Eigen::VectorXd mu ;
 
 	//! Computes this DualFrictionProblem from the given \p primal
-	/*! \warning Assumes MInv has been computed */
+	/*! The symbolic structure of W is cached between successive calls, and only recomputed
+		when the sparsity pattern of H or MInv changes. \sa SparseBlockProductPlan
+		\warning Assumes MInv has been computed, see PrimalFrictionProblem::computeMInv() */
 	void computeFrom( const PrimalFrictionProblem< Dimension >& primal ) ;
 
+	//! Updates this DualFrictionProblem after contacts have been removed from or inserted into \p primal
+	/*!
+	  Only the blocks of W involving inserted contacts are computed from \p primal ; the blocks
+	  coupling two persisting contacts are copied from the current W. This is much cheaper than
+	  computeFrom() when only a small fraction of the contacts change.
+
+	  The contacts that are not removed must keep their relative ordering, and their rows of H
+	  as well as MInv must be unchanged since the last call to computeFrom() or updateFrom().
+	  \param primal The updated primal problem
+	  \param removed Sorted indices of the removed contacts, relative to the current problem
+	  \param inserted Sorted indices of the inserted contacts, relative to the updated \p primal
+	  \warning Assumes MInv has been computed for a block-diagonal M, and that no permutation is currently applied
+	  */
+	void updateFrom( const PrimalFrictionProblem< Dimension >& primal,
+	                 const std::vector< std::size_t >& removed,
+	                 const std::vector< std::size_t >& inserted ) ;
+
+	//! Computes the single-precision copy Wf of the current W
+	/*! Required by the mixed-precision solveWith(), and must be called again whenever W is recomputed or updated */
+	void computeMixedPrecision() ;
+
 	//! Solves this problem
 	/*!
 	  \param gs The GaussSeidel< WType > solver to use
@@ -164,6 +217,29 @@ struct DualFrictionProblem
 	//! Same as above
 	/*! \warning staticProblem defaults tp true (as solving Coulomb probles with PG is unreliable)*/
 	double solveWith( ProjectedGradientType &pg, double * r, const bool staticProblem = true ) const ;
+	//! Same as above, using a global semismooth Newton method
+	/*! Much more accurate than GaussSeidel for a given time budget when high precision is required */
+	double solveWith( SemismoothNewtonType &ssn, double * r, const bool staticProblem = false ) const ;
+	//! Solves this problem as a \b SOCQP, using a primal-dual interior-point method
+	/*! Only static problems are supported ; the initial value of \p r is ignored */
+	double solveWith( InteriorPointType &ip, double * r ) const ;
+	//! Solves this problem with Gauss-Seidel sweeps accelerated by aggregation-based coarse corrections
+	/*! Requires much fewer iterations than GaussSeidel on large contact networks, such as tall stacks */
+	double solveWith( MultilevelGaussSeidelType &mgs, double * r, const bool staticProblem = false ) const ;
+	//! Solves this problem with Gauss-Seidel sweeps reading the single-precision Wf
+	/*!
+	  The forces, local problems and accumulations remain in double precision. Since Wf only approximates W,
+	  each outer refinement iteration solves u = Wf r + b + ( W - Wf ) r_k, with r_k the previous iterate,
+	  until the residual of the double-precision problem drops below the tolerance of \p gs.
+	  \warning Requires computeMixedPrecision()
+	  \param gs The MixedGaussSeidelType solver to use
+	  \param r  Both the initial guess and the result
+	  \param staticProblem If true, solve this problem as a \b SOCQP instead of a Coulomb Friction problem
+	  \param maxRefinements Maximum number of outer refinement iterations
+	  \returns the error of the double-precision problem, as returned by the GaussSeidel::eval() function
+	  */
+	double solveWith( MixedGaussSeidelType &gs, double * r, const bool staticProblem = false,
+	                  const unsigned maxRefinements = 8 ) const ;
 
 	//! Evaluate a residual using the GS's error function
 	/*!
@@ -213,6 +289,17 @@ struct DualFrictionProblem
 	const std::vector< std::size_t > &invPermutation() const { return m_invPermutation ; }
 private:
 
+	typedef typename Product< typename PrimalFrictionProblem< Dimension >::MInvType,
+	                          Transpose< typename PrimalFrictionProblem< Dimension >::HType > >::PlainObjectType
+	MInvHtType ;
+
+	// Cached structure of the products M^-1 H^T and H ( M^-1 H^T )
+	SparseBlockProductPlan< MInvHtType > m_MInvHtPlan ;
+	SparseBlockProductPlan< WType > m_WPlan ;
+
+	//! Computes W when M^-1 is given by the sparse factorization of a non block-diagonal M
+	void computeFromSparseFactorization( const PrimalFrictionProblem< Dimension >& primal ) ;
+
 	// Current permutation of contact indices
 	std::vector< std::size_t > m_permutation ;
 	std::vector< std::size_t > m_invPermutation ;
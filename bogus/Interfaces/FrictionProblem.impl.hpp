@@ -22,6 +22,7 @@
 #include "Cadoux.hpp"
 
 #include "../Core/Block.impl.hpp"
+#include "../Core/BlockSolvers/SparseCholesky.impl.hpp"
 #include "../Extra/SecondOrder.impl.hpp"
 
 namespace bogus {
@@ -62,6 +63,39 @@ static double solve( const DualFrictionProblem< Dimension >& dual,
 	return res ;
 }
 
+template< unsigned Dimension, typename NSLaw >
+static double solveMixed( const DualFrictionProblem< Dimension >& dual,
+		const typename DualFrictionProblem< Dimension >::MixedGaussSeidelType &gs,
+		const NSLaw &law, double *r, const unsigned maxRefinements )
+{
+	typename Eigen::VectorXd::MapType r_map ( r, dual.W.rows() ) ;
+
+	if( dual.permuted() )
+		applyPermutation< Dimension >( dual.permutation(), r_map, dual.W.majorIndex().innerOffsetsData() ) ;
+
+	// u = W r + b, in double precision
+	Eigen::VectorXd u = dual.b, c ;
+	dual.W.template multiply< false >( r_map, u, 1, 1 ) ;
+	double res = gs.eval( law, u, r_map ) ;
+
+	for( unsigned k = 0 ; k < maxRefinements && !( res < gs.tol() ) ; ++k )
+	{
+		// c = b + ( W - Wf ) r, so that Wf r + c = W r + b
+		c = u ;
+		dual.Wf.template multiply< false >( r_map, c, -1, 1 ) ;
+		gs.solve( law, c, r_map ) ;
+
+		u = dual.b ;
+		dual.W.template multiply< false >( r_map, u, 1, 1 ) ;
+		res = gs.eval( law, u, r_map ) ;
+	}
+
+	if( dual.permuted() )
+		applyPermutation< Dimension >( dual.invPermutation(), r_map, dual.W.majorIndex().innerOffsetsData() ) ;
+
+	return res ;
+}
+
 template< unsigned Dimension, typename Method, typename MatrixT >
 static double eval( const DualFrictionProblem< Dimension >& dual,
 		const ConstrainedSolverBase< Method, MatrixT > &gs,
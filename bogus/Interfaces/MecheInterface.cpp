@@ -29,11 +29,13 @@
 #include "../Core/BlockSolvers/ProductGaussSeidel.hpp"
 #include "../Core/BlockSolvers/ProjectedGradient.hpp"
 #include "../Core/BlockSolvers/Coloring.impl.hpp"
+#include "../Core/BlockSolvers/Reordering.impl.hpp"
 
 #include "../Core/BlockSolvers/ADMM.hpp"
 #include "../Extra/SecondOrder.impl.hpp"
 
 #include "../Core/Utils/Timer.hpp"
+#include "../Core/Utils/Threads.hpp"
 
 #include <algorithm>
 
@@ -51,7 +53,7 @@ MecheFrictionProblemOptions::MecheFrictionProblemOptions()
     : maxThreads(0), maxIters(0), cadouxIters(0),
       tolerance(0), useInfinityNorm( false ),
       algorithm( GaussSeidel ),
-      gsRegularization( 0 ), gsColoring( false ),
+      gsRegularization( 0 ), gsColoring( false ), gsReordering( false ),
       gsSkipIters( -1 ), // -1 means default
       tryZeroAsWell( true ),
       pgVariant( projected_gradient::SPG ),
@@ -66,6 +68,7 @@ MecheFrictionProblem::MecheFrictionProblem()
         m_f( BOGUS_NULL_PTR(double) ),
         m_w( BOGUS_NULL_PTR(double) ),
         m_mu( BOGUS_NULL_PTR(double) ),
+        m_binaryFile( BOGUS_NULL_PTR(binary::Reader) ),
         m_out( &std::cout )
 {
 }
@@ -77,6 +80,14 @@ MecheFrictionProblem::~MecheFrictionProblem()
 
 void MecheFrictionProblem::destroy()
 {
+	if( m_binaryFile )
+	{
+		// Data arrays belong to the mapped file
+		m_f = m_w = m_mu = BOGUS_NULL_PTR(double) ;
+		delete m_binaryFile ;
+		m_binaryFile = BOGUS_NULL_PTR(binary::Reader) ;
+	}
+
 	delete[] m_f ;
 	m_f = BOGUS_NULL_PTR(double) ;
 	delete[] m_w ;
@@ -155,22 +166,13 @@ void MecheFrictionProblem::fromPrimal (
 
 	// Build H
 
-	std::size_t Hnnz = 0 ;
-#ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp parallel for reduction( +:Hnnz )
-#endif
-	for( std::ptrdiff_t i = 0 ; i < (std::ptrdiff_t) n_in ; ++i )
-	{
-		Hnnz += 3*ndof[ObjA[i]] ;
-		if( ObjB[i] != -1 && ObjB[i] == ObjA[i] )
-		{
-			Hnnz += 3*ndof[ObjB[i]] ;
-		}
-	}
-
 	m_primal->H.setRows( n_in ) ;
 	m_primal->H.setCols( NObj, ndof ) ;
-	m_primal->H.reserve( 2*n_in, Hnnz ) ;
+
+	// Blocks are first gathered in per-thread buffers, without locking,
+	// then moved into H in index order
+	SparseBlockMatrixBuilder< PrimalFrictionProblem< 3u >::HType > Hbuilder ;
+	Hbuilder.reserve( 2*n_in ) ;
 
 #ifndef BOGUS_DONT_PARALLELIZE
 #pragma omp parallel for
@@ -180,21 +182,21 @@ void MecheFrictionProblem::fromPrimal (
 		const Eigen::Matrix3d Et = m_primal->E.diagonal(i).transpose() ;
 		if( ObjB[i] == -1 )
 		{
-			m_primal->H.insert( i, ObjA[i] ) =  Et *
+			Hbuilder.insert( i, ObjA[i] ) =  Et *
 			        Eigen::MatrixXd::Map( HA[i], 3, ndof[ ObjA[i] ] ) ;
 		} else if( ObjB[i] == ObjA[i] )
 		{
-			m_primal->H.insert( i, ObjA[i] ) =  Et *
+			Hbuilder.insert( i, ObjA[i] ) =  Et *
 			        ( Eigen::MatrixXd::Map( HA[i], 3, ndof[ ObjA[i] ] ) -
 			        Eigen::MatrixXd::Map( HB[i], 3, ndof[ ObjA[i] ] ) ) ;
 		} else {
-			m_primal->H.insert( i, ObjA[i] ) =  Et *
+			Hbuilder.insert( i, ObjA[i] ) =  Et *
 			        Eigen::MatrixXd::Map( HA[i], 3, ndof[ ObjA[i] ] ) ;
-			m_primal->H.insert( i, ObjB[i] ) =  - Et *
+			Hbuilder.insert( i, ObjB[i] ) =  - Et *
 			        Eigen::MatrixXd::Map( HB[i], 3, ndof[ ObjB[i] ] ) ;
 		}
 	}
-	m_primal->H.finalize() ;
+	Hbuilder.finalize( m_primal->H ) ;
 
 	m_primal->f = f_in ;
 	m_primal->w = w_in ;
@@ -385,12 +387,26 @@ double MecheFrictionProblem::solve(
 
 				const bool useColoring =
 				        options.maxThreads != 1 && options.gsColoring ;
-				gs.coloring().update( useColoring, m_dual->W );
+				{
+					// Parallel coloring, avoiding colors that cannot keep all threads busy
+					const WithMaxThreads wmt( options.maxThreads ) ;
+					gs.coloring().setAlgorithm( Coloring::JonesPlassmann ) ;
+					gs.coloring().setBalancing( wmt.nThreads() ) ;
+					gs.coloring().update( useColoring, m_dual->W );
+				}
+
+				Reordering reordering ;
+				reordering.update( options.gsReordering, m_dual->W ) ;
 
 				if( useColoring )
 				{
+					if( options.gsReordering )
+						reordering.sortColors( gs.coloring() ) ;
+
 					m_dual->applyPermutation( gs.coloring().permutation ) ;
 					gs.coloring().resetPermutation();
+				} else if( options.gsReordering ) {
+					m_dual->applyPermutation( reordering.permutation ) ;
 				}
 				m_dual->W.cacheTranspose() ;
 
@@ -530,6 +546,20 @@ bool MecheFrictionProblem::fromFile( const char* fileName, double *& r0, bool ol
 	return true ;
 }
 
+bool MecheFrictionProblem::convertToBinaryFile( const char* fileName, const char* binaryFileName, bool old )
+{
+	MecheFrictionProblem mfp ;
+	mfp.setOutStream( BOGUS_NULL_PTR( std::ostream ) ) ;
+
+	double *r0 = BOGUS_NULL_PTR(double) ;
+	if( !mfp.fromFile( fileName, r0, old ) )
+		return false ;
+
+	const bool ok = mfp.dumpToBinaryFile( binaryFileName, r0 ) ;
+	delete[] r0 ;
+	return ok ;
+}
+
 #else
 bool MecheFrictionProblem::dumpToFile( const char*, const double* ) const
 {
@@ -540,8 +570,109 @@ bool MecheFrictionProblem::fromFile(const char*, double *& ) {
 	std::cerr << "MecheInterface::fromFile: Error, bogus compiled without serialization capabilities" ;
 	return false ;
 }
+bool MecheFrictionProblem::convertToBinaryFile( const char*, const char*, bool )
+{
+	std::cerr << "MecheInterface::convertToBinaryFile: Error, bogus compiled without serialization capabilities" ;
+	return false ;
+}
 #endif
 
+bool MecheFrictionProblem::dumpToBinaryFile( const char* fileName, const double * r0 ) const
+{
+	if( !m_primal ) return false ;
+
+	binary::Writer writer ;
+	if( !writer.open( fileName ) )
+	{
+		std::cerr << "Error writing MecheFrictionProblem to "<< fileName << std::endl ;
+		return false ;
+	}
+
+	binary::writeMatrix( writer, "M", m_primal->M ) ;
+	binary::writeMatrix( writer, "H", m_primal->H ) ;
+	binary::writeMatrix( writer, "E", m_primal->E ) ;
+
+	writer.write( "f" , m_primal->f , nDegreesOfFreedom() ) ;
+	writer.write( "w" , m_primal->w , 3 * nContacts() ) ;
+	writer.write( "mu", m_primal->mu, nContacts() ) ;
+	if( r0 )
+	{
+		writer.write( "r0", r0, 3 * nContacts() ) ;
+	}
+
+	if( !writer.close() )
+	{
+		std::cerr << "Error writing MecheFrictionProblem to "<< fileName << std::endl ;
+		return false ;
+	}
+
+	return true ;
+}
+
+bool MecheFrictionProblem::fromBinaryFile( const char* fileName, double *& r0, bool verify )
+{
+	reset() ;
+
+	m_binaryFile = new binary::Reader() ;
+	if( !m_binaryFile->open( fileName, verify ) )
+	{
+		std::cerr << "Error reading MecheFrictionProblem from "<< fileName << ": invalid file" << std::endl ;
+		reset() ;
+		return false ;
+	}
+
+	// Start reading the largest matrix while the smaller ones are being copied
+	m_binaryFile->prefetch( "H.data" ) ;
+
+	if(    !binary::readMatrix( *m_binaryFile, "M", m_primal->M )
+	    || !binary::readMatrix( *m_binaryFile, "E", m_primal->E )
+	    || !binary::readMatrix( *m_binaryFile, "H", m_primal->H ) )
+	{
+		std::cerr << "Error reading MecheFrictionProblem from "<< fileName << ": invalid matrices" << std::endl ;
+		reset() ;
+		return false ;
+	}
+	m_primal->E.cacheTranspose() ;
+
+	std::size_t nf, nw, nmu, nr0 ;
+	m_f  = m_binaryFile->section< double >( "f" , nf  ) ;
+	m_w  = m_binaryFile->section< double >( "w" , nw  ) ;
+	m_mu = m_binaryFile->section< double >( "mu", nmu ) ;
+	const double* r0_in = m_binaryFile->section< const double >( "r0", nr0 ) ;
+
+	if(    nf  != nDegreesOfFreedom()
+	    || nw  != 3 * nContacts()
+	    || nmu != nContacts()
+	    || ( r0_in && nr0 != 3 * nContacts() )
+	    || m_primal->H.cols() != (int) nDegreesOfFreedom()
+	    || m_primal->E.rowsOfBlocks() != (int) nContacts() )
+	{
+		std::cerr << "Error reading MecheFrictionProblem from "<< fileName << ": inconsistent dimensions" << std::endl ;
+		reset() ;
+		return false ;
+	}
+
+	if( m_out )
+	{
+		*m_out << fileName << ": " << nDegreesOfFreedom() << " dofs, " << nContacts() << " contacts" << std::endl ;
+	}
+
+	r0 = new double[ 3 * nContacts() ] ;
+	if( r0_in ) {
+		std::copy( r0_in, r0_in + 3 * nContacts(), r0 ) ;
+	} else {
+		Eigen::VectorXd::Map( r0, 3*nContacts() ).setZero() ;
+	}
+
+	m_primal->f  = m_f ;
+	m_primal->w  = m_w ;
+	m_primal->mu = m_mu ;
+
+	m_primal->computeMInv();
+
+	return true ;
+}
+
 }
 
 
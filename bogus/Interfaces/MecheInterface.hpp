@@ -34,6 +34,7 @@ namespace bogus
 
 template< unsigned Dimension > struct PrimalFrictionProblem ;
 template< unsigned Dimension > struct DualFrictionProblem ;
+namespace binary { class Reader ; }
 
 
 struct BOGUS_API MecheFrictionProblemOptions
@@ -60,6 +61,7 @@ struct BOGUS_API MecheFrictionProblemOptions
 
 	double gsRegularization; //!< GS proximal regularization coefficient
 	bool   gsColoring;       //!< Use coloring for parallel GS; slower but deterministic
+	bool   gsReordering;     //!< Reorder contacts for memory locality ( reverse Cuthill-McKee ) before solving with GS
 	int    gsSkipIters;       //!< Number of frozen iterations for sleeping heuristics
 	bool   tryZeroAsWell;    //!< Try to see if starting at zero yields a lower initial error
 
@@ -147,6 +149,21 @@ public:
 	*/
 	bool fromFile( const char* fileName, double* &r0, bool old = false ) ;
 
+	//! Dumps the current primal() to \p fileName, using the memory-mappable binary format
+	/*! \sa binary::Writer */
+	bool dumpToBinaryFile( const char* fileName, const double *r0 = BOGUS_NULL_PTR(const double) ) const ;
+	//! Loads the primal from a problem previously saved with dumpToBinaryFile()
+	/*! The file is memory-mapped and kept open until the next call to reset() ; f(), w() and mu()
+		point directly to its ( copy-on-write ) data, and the matrices are copied
+		from their contiguous storage.
+		\param r0 Will be set to point to a newly allocated array containing the initial
+		guess, or zero if none was saved. Will have to be freed by the caller using the delete[] operator.
+		\param verify If true, check the checksums of the whole file before loading it
+	*/
+	bool fromBinaryFile( const char* fileName, double* &r0, bool verify = false ) ;
+	//! Converts a problem file written by dumpToFile() to the binary format of dumpToBinaryFile()
+	static bool convertToBinaryFile( const char* fileName, const char* binaryFileName, bool old = false ) ;
+
 	// solvers Callback
 	void ackCurrentResidual( unsigned GSIter, double err ) ;
 
@@ -186,6 +203,8 @@ private:
 	double *m_f ;
 	double *m_w ;
 	double *m_mu ;
+	// Mapped file that m_f, m_w and m_mu point to, if any
+	binary::Reader *m_binaryFile ;
 
 	std::ostream *m_out ;
 } ;
@@ -27,18 +27,59 @@
 namespace bogus {
 
 
+namespace friction_problem_impl {
+
+// Factorizes a range of diagonal blocks of M
+template < typename MType, typename MInvType >
+struct FactorizeTask : public RangeTask
+{
+	FactorizeTask( const MType& M_, MInvType& MInv_ ) : M( M_ ), MInv( MInv_ ) {}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		for( std::ptrdiff_t i = begin ; i < end ; ++ i )
+		{
+			MInv.block(i).compute( M.block(i) ) ;
+		}
+	}
+
+	const MType& M ;
+	MInvType& MInv ;
+} ;
+
+} //namespace friction_problem_impl
+
 template< unsigned Dimension >
 void PrimalFrictionProblem< Dimension >::computeMInv( )
 {
-	// M^-1
-	MInv.cloneStructure( M ) ;
-#ifndef BOGUS_DONT_PARALLELIZE
-#pragma omp parallel for
-#endif
-	for( std::ptrdiff_t i = 0 ; i < (std::ptrdiff_t) M.nBlocks()  ; ++ i )
+	bool blockDiagonal = true ;
+	for( typename MType::Index i = 0 ; blockDiagonal && i < M.rowsOfBlocks() ; ++i )
 	{
-		MInv.block(i).compute( M.block(i) ) ;
+		for( typename MType::InnerIterator it( M.innerIterator( i ) ) ; it ; ++it )
+			blockDiagonal &= ( it.inner() == i ) ;
 	}
+
+	if( !blockDiagonal )
+	{
+		MInv = MInvType() ;
+		MFactorization.compute( M ) ;
+		return ;
+	}
+
+	// M^-1
+	MInv.cloneStructure( M ) ;
+
+	const friction_problem_impl::FactorizeTask< typename PrimalFrictionProblem::MType, typename PrimalFrictionProblem::MInvType > task( M, MInv ) ;
+	parallel_for( 0, M.nBlocks(), task, true, 1 ) ;
+}
+
+template< unsigned Dimension >
+Eigen::VectorXd PrimalFrictionProblem< Dimension >::applyMInv( const Eigen::VectorXd& rhs ) const
+{
+	if( hasSparseMFactorization() )
+		return MFactorization.solve( rhs ) ;
+
+	return MInv * rhs ;
 }
 
 template< unsigned Dimension >
@@ -27,6 +27,7 @@ The \ref block_solvers module is a collection of solvers operating on \ref block
 
 At the moment, those solvers are:
  - \ref block_solvers_is
+ - \ref block_solvers_ds
  - \ref block_solvers_ns, which include
    - \ref block_solvers_gs
    - \ref block_solvers_pg
@@ -121,6 +122,23 @@ krylov::GMRES method.
 
 \endcode
 
+\section block_solvers_ds Direct Linear Solvers
+
+Symmetric positive definite sparse block matrices with dense blocks may be factorized
+with the SparseBlockCholesky class, a supernodal sparse Cholesky factorization.
+The symbolic analysis, including the fill-reducing Reordering, is only performed again when
+the sparsity pattern of the matrix changes.
+
+\code
+  typedef bogus::SparseBlockMatrix< Eigen::MatrixXd > MType ;
+  bogus::SparseBlockCholesky< MType > chol( M ) ;
+
+  x = chol.solve( b ) ;
+
+  // Later, with the same sparsity pattern
+  chol.compute( M ) ;
+\endcode
+
 \section block_solvers_ns Constrained Iterative Solvers
 
 The main feature of the \ref block_solvers module is providing solvers for
@@ -159,8 +177,8 @@ Supplemental methods may need to
 be provided by the \p NSLaw depending on the solver chosen. See LCPLaw, SOCLaw or PyramidLaw for examples of
 the interfaces that should be provided by a \p NSLaw.
 
-Implementations of \ref block_solvers_ns include \ref block_solvers_gs (GaussSeidel, ProductGaussSeidel) and \ref block_solvers_pg (ProjectedGradient)
-, as well as the experimental ADMM and DualAMA classes.
+Implementations of \ref block_solvers_ns include \ref block_solvers_gs (GaussSeidel, ProductGaussSeidel), \ref block_solvers_pg (ProjectedGradient)
+\ref block_solvers_ssn (SemismoothNewton) and \ref block_solvers_ip (InteriorPoint), as well as the experimental ADMM and DualAMA classes.
 
 \section block_solvers_gs Projected Gauss Seidel
 
@@ -239,6 +257,39 @@ The \p NSLaw passed to the ProjectedGradient::solve() method should define a pro
 \note This algorithm should in theory only be used to solve constrained quadratic optimization problems.
 Coulomb friction does not belong to this class, but Linear and Cone Complementarity problems do.
 In practice, bogus does not disallow using a ProjectedGradient with a NSLaw for which the term s(y) is non-zero, but convergence may be degraded.
+
+\section block_solvers_ssn Semismooth Newton
+
+When high accuracy is required, the SemismoothNewton class solves the same problems as the GaussSeidel
+with a global Newton method on the Fischer-Burmeister function of the whole system.
+Newton directions are computed inexactly using a Krylov method on the generalized Jacobian, which has
+the sparsity pattern of \p M. A few Gauss-Seidel sweeps are used for warm-starting, and whenever the Newton
+direction fails to decrease the residual.
+
+\code
+bogus::SemismoothNewton< WType > ssn( W ) ;
+ssn.setTol( 1.e-14 ) ;
+ssn.setLinearSolver( bogus::krylov::GMRES ) ;
+res = ssn.solve( bogus::Coulomb3D( n, mu ), b, x ) ;
+\endcode
+
+The \p NSLaw passed to the SemismoothNewton::solve() method should define the evalFunction() and evalJacobian()
+functions, as SOCLaw does.
+
+\section block_solvers_ip Interior Point
+
+Second Order Cone Quadratic Programs, such as static friction problems, can also be solved with the InteriorPoint class,
+a primal-dual Mehrotra predictor-corrector method using Nesterov-Todd scaling \cite NT97. Each iteration solves
+linear systems with the sparsity pattern of \p M, using either a SparseBlockCholesky factorization or
+a preconditioned Conjugate Gradient ; see InteriorPoint::setLinearSolver().
+The number of iterations does not depend much on the conditioning of the problem.
+
+\code
+bogus::InteriorPoint< WType > ip( W ) ;
+res = ip.solve( bogus::SOC3D( n, mu ), b, x ) ;
+\endcode
+
+The \p NSLaw passed to the InteriorPoint::solve() method should define the mu() function, as SOCLaw does.
 */
 
 }
@@ -255,6 +255,10 @@ TEST( BlockMV, Symmetric )
 
 	bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC | bogus::flags::COL_MAJOR > ssbm_col_major = ssbm ;
 	//std::cout << ssbm_col_major << std::endl ;
+	EXPECT_EQ( expected_1, ssbm_col_major * rhs ) ;
+	EXPECT_EQ( expected_1, ssbm_col_major.transpose() * rhs ) ;
+	ssbm_col_major.cacheTranspose() ;
+	EXPECT_EQ( expected_1, ssbm_col_major * rhs ) ;
 
 	res.setZero() ;
 
@@ -591,3 +595,106 @@ TEST_F( SmallSBM, Flat )
 
 	EXPECT_EQ( expected_1, res ) ;
 }
+
+template < int NRhs, int Options, typename MatrixT >
+static void checkMultiVectorProducts( const MatrixT& sbm, const Eigen::MatrixXd& dense )
+{
+	typedef Eigen::Matrix< double, Eigen::Dynamic, NRhs, Options > MultiVec ;
+
+	MultiVec rhs( dense.cols(), NRhs ) ;
+	for( int i = 0 ; i < rhs.rows() ; ++i )
+		for( int k = 0 ; k < NRhs ; ++k )
+			rhs( i, k ) = ( 3*i + k ) % 7 - 3 ;
+
+	MultiVec res( dense.rows(), NRhs ) ;
+	res.setOnes() ;
+	sbm.template multiply< false >( rhs, res, 2, 1 ) ;
+	EXPECT_TRUE( res.isApprox( 2 * dense * rhs + MultiVec::Ones( dense.rows(), NRhs ) ) ) ;
+
+	res.setZero() ;
+	sbm.template multiply< true >( rhs, res ) ;
+	EXPECT_TRUE( res.isApprox( dense.transpose() * rhs ) ) ;
+}
+
+template < typename BlockT, unsigned Flags >
+static void checkFixedSizeProducts()
+{
+	const int N = BlockT::RowsAtCompileTime ;
+	const int n = 4 ;
+
+	bogus::SparseBlockMatrix< BlockT, Flags > sbm ;
+	sbm.setRows( n ) ;
+	sbm.setCols( n ) ;
+
+	Eigen::MatrixXd dense = Eigen::MatrixXd::Zero( n*N, n*N ) ;
+
+	for( int outer = 0 ; outer < n ; ++outer )
+	{
+		for( int inner = 0 ; inner < n ; ++inner )
+		{
+			const int i = ( Flags & bogus::flags::COL_MAJOR ) ? inner : outer ;
+			const int j = ( Flags & bogus::flags::COL_MAJOR ) ? outer : inner ;
+
+			if( ( i + 2*j ) % 3 == 1 || i == j )
+			{
+				if( ( Flags & bogus::flags::SYMMETRIC ) && j > i ) continue ;
+
+				BlockT b ;
+				for( int k = 0 ; k < N*N ; ++k ) b.data()[k] = ( 7*i + 5*j + 3*k ) % 11 - 5 ;
+				if( i == j && ( Flags & bogus::flags::SYMMETRIC ) ) b = ( b + b.transpose() ).eval() ;
+
+				sbm.insertBack( i, j ) = b ;
+				dense.block( N*i, N*j, N, N ) = b ;
+				if( i != j && ( Flags & bogus::flags::SYMMETRIC ) )
+					dense.block( N*j, N*i, N, N ) = b.transpose() ;
+			}
+		}
+	}
+	sbm.finalize() ;
+
+	checkMultiVectorProducts< 2, Eigen::ColMajor >( sbm, dense ) ;
+	checkMultiVectorProducts< 4, Eigen::ColMajor >( sbm, dense ) ;
+	checkMultiVectorProducts< 4, Eigen::RowMajor >( sbm, dense ) ;
+	checkMultiVectorProducts< 8, Eigen::RowMajor >( sbm, dense ) ;
+
+	Eigen::VectorXd rhs( n*N ) ;
+	for( int k = 0 ; k < n*N ; ++k ) rhs[k] = k % 5 - 2 ;
+
+	const Eigen::VectorXd expected   = dense * rhs ;
+	const Eigen::VectorXd expected_t = dense.transpose() * rhs ;
+
+	Eigen::VectorXd res( n*N ) ;
+	res.setOnes() ;
+	sbm.template multiply< false >( rhs, res, 2, 1 ) ;
+	EXPECT_TRUE( res.isApprox( 2*expected + Eigen::VectorXd::Ones( n*N ) ) ) ;
+
+	EXPECT_TRUE( expected_t.isApprox( sbm.transpose() * rhs ) ) ;
+
+	sbm.cacheTranspose() ;
+	EXPECT_TRUE( expected.isApprox( sbm * rhs ) ) ;
+	EXPECT_TRUE( expected_t.isApprox( sbm.transpose() * rhs ) ) ;
+
+	for( int i = 0 ; i < n ; ++i )
+	{
+		Eigen::Matrix< double, N, 1 > row ;
+		row.setZero() ;
+		sbm.template rowMultiply< false >( i, rhs, row ) ;
+		EXPECT_TRUE( expected.segment( N*i, N ).isApprox( row ) ) ;
+	}
+}
+
+TEST( BlockMV, FixedSize )
+{
+	typedef Eigen::Matrix< double, 3, 3, Eigen::RowMajor > RowMat3 ;
+	typedef Eigen::Matrix< double, 2, 2, Eigen::RowMajor > RowMat2 ;
+
+	checkFixedSizeProducts< Eigen::Matrix3d, bogus::flags::NONE >() ;
+	checkFixedSizeProducts< Eigen::Matrix3d, bogus::flags::SYMMETRIC >() ;
+	checkFixedSizeProducts< RowMat3, bogus::flags::NONE >() ;
+	checkFixedSizeProducts< RowMat3, bogus::flags::SYMMETRIC >() ;
+	checkFixedSizeProducts< RowMat3, bogus::flags::COL_MAJOR >() ;
+	checkFixedSizeProducts< Eigen::Matrix2d, bogus::flags::NONE >() ;
+	checkFixedSizeProducts< Eigen::Matrix2d, bogus::flags::SYMMETRIC >() ;
+	checkFixedSizeProducts< RowMat2, bogus::flags::UNCOMPRESSED >() ;
+	checkFixedSizeProducts< RowMat2, bogus::flags::SYMMETRIC >() ;
+}
@@ -6,8 +6,10 @@
 
 #include <bogus/Core/Block.impl.hpp>
 #include <bogus/Core/BlockSolvers/GaussSeidel.impl.hpp>
+#include <bogus/Core/BlockSolvers/Reordering.impl.hpp>
 #include <bogus/Core/BlockSolvers/LCPLaw.impl.hpp>
 #include <bogus/Core/BlockSolvers/PyramidLaw.impl.hpp>
+#include <bogus/Core/Utils/WorkStealingExecutor.hpp>
 
 #include <bogus/Extra/SecondOrder.impl.hpp>
 
@@ -16,6 +18,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdlib>
+
 TEST_F( SmallFrictionPb, GaussSeidel )
 {
 	ResidualInfo ri ;
@@ -68,6 +73,91 @@ TEST_F( SmallFrictionPb, GaussSeidel )
 
 }
 
+TEST_F( SmallFrictionPb, SolverStats )
+{
+	Eigen::VectorXd b = w - H * ( InvMassMat * f );
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > WType ;
+	WType W ;
+	W = H * InvMassMat * H.transpose() ;
+
+	bogus::SolverStats stats ;
+	bogus::GaussSeidel< WType > gs ;
+	gs.setStats( &stats ) ;
+	gs.setMatrix( W ) ;
+	gs.setEvalEvery( 1 ) ;
+
+	Eigen::VectorXd x = Eigen::VectorXd::Ones( W.rows() ) ;
+	const double res = gs.solve( bogus::SOCLaw< 3u, double, true, bogus::local_soc_solver::Hybrid >( 2, mu.data() ), b, x ) ;
+	ASSERT_LT( res, 1.e-8 ) ;
+
+#ifdef BOGUS_WITH_SOLVER_STATS
+	const bogus::SolverStats::Worker total = stats.sum() ;
+
+	EXPECT_LT( 0u, stats.iterations ) ;
+	EXPECT_EQ( 2 * stats.iterations, total.localSolves + total.skipped ) ;
+	EXPECT_EQ( total.localSolves, total.local.trivial + total.local.newton + total.local.enumerative ) ;
+	EXPECT_EQ( 0u, total.failed ) ;
+
+	EXPECT_LT( 0., stats.time[ bogus::SolverStats::Total ] ) ;
+	EXPECT_LE( stats.time[ bogus::SolverStats::Sweeps ] + stats.time[ bogus::SolverStats::Eval ],
+			   stats.time[ bogus::SolverStats::Total ] ) ;
+	EXPECT_LE( 0., stats.imbalance() ) ;
+
+	stats.reset() ;
+	EXPECT_EQ( 0u, stats.iterations ) ;
+	EXPECT_TRUE( stats.workers.empty() ) ;
+#else
+	// Instrumentation is compiled out
+	EXPECT_EQ( 0u, stats.iterations ) ;
+	EXPECT_EQ( 0., stats.time[ bogus::SolverStats::Total ] ) ;
+	EXPECT_TRUE( stats.workers.empty() ) ;
+#endif
+}
+
+TEST_F( SmallFrictionPb, MixedPrecision )
+{
+	Eigen::VectorXd b = w - H * ( InvMassMat * f );
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > WType ;
+	WType W ;
+	W = H * InvMassMat * H.transpose() ;
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3f, bogus::flags::SYMMETRIC | bogus::flags::MIXED_PRECISION > WfType ;
+	WfType Wf ;
+	Wf.cloneStructure( W ) ;
+	for( std::size_t k = 0 ; k < W.nBlocks() ; ++k )
+		Wf.block( k ) = W.block( k ).cast< float >() ;
+
+	const Eigen::VectorXd ones = Eigen::VectorXd::Ones( W.rows() ) ;
+	Eigen::VectorXd y( W.rows() ), yf( W.rows() ) ;
+	W.multiply< false >( ones, y ) ;
+	Wf.multiply< false >( ones, yf ) ;
+	EXPECT_TRUE( y.isApprox( yf, 1.e-6 ) ) ;
+
+	bogus::GaussSeidel< WfType > gs( Wf ) ;
+	gs.setTol( 1.e-12 ) ;
+	const bogus::SOCLaw< 3u, double, true > law( 2, mu.data() ) ;
+
+	// Iterative refinement : solve u = Wf x + b + ( W - Wf ) x_k
+	Eigen::VectorXd x = ones, c, u = b ;
+	W.multiply< false >( x, u, 1, 1 ) ;
+	double res = gs.eval( law, u, x ) ;
+	for( unsigned k = 0 ; k < 8 && !( res < 1.e-12 ) ; ++k )
+	{
+		c = u ;
+		Wf.multiply< false >( x, c, -1, 1 ) ;
+		gs.solve( law, c, x ) ;
+
+		u = b ;
+		W.multiply< false >( x, u, 1, 1 ) ;
+		res = gs.eval( law, u, x ) ;
+	}
+
+	ASSERT_LT( res, 1.e-12 ) ;
+	ASSERT_TRUE( sol.isApprox( x, 1.e-4 ) ) ;
+}
+
 TEST( GaussSeidel, LCP )
 {
 	ResidualInfo ri ;
@@ -213,3 +303,308 @@ TEST( GaussSeidel, Pyramid )
 
 	ASSERT_NEAR( 0, (r - ds).squaredNorm(), 1.e-6 ) ;
 }
+
+TEST( GaussSeidel, Coloring )
+{
+	// Random symmetric sparsity pattern
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix< double, 1, 1 >, bogus::SYMMETRIC > WType ;
+	const std::ptrdiff_t n = 500 ;
+
+	WType W ;
+	W.setRows( n ) ;
+	W.setCols( n ) ;
+
+	std::srand( 42 ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		std::vector< std::ptrdiff_t > cols ;
+		for( unsigned k = 0 ; k < 4 ; ++k )
+			cols.push_back( std::rand() % ( i+1 ) ) ;
+		cols.push_back( i ) ;
+		std::sort( cols.begin(), cols.end() ) ;
+		cols.erase( std::unique( cols.begin(), cols.end() ), cols.end() ) ;
+
+		for( std::size_t k = 0 ; k < cols.size() ; ++k )
+			W.insertBack( i, cols[k] ).setConstant( cols[k] == i ? 10. : -.1 ) ;
+	}
+	W.finalize() ;
+
+	const bogus::Coloring::Algorithm algorithms[] =
+	{ bogus::Coloring::Greedy, bogus::Coloring::JonesPlassmann } ;
+
+	for( unsigned a = 0 ; a < 2 ; ++a )
+	{
+		std::size_t unbalancedColors = 0, unbalancedSmallColors = 0 ;
+		const unsigned nThreads = 8 ;
+
+		for( unsigned balancing = 0 ; balancing <= nThreads ; balancing += nThreads )
+		{
+			bogus::Coloring coloring ;
+			coloring.setAlgorithm( algorithms[a] ) ;
+			coloring.setBalancing( balancing ) ;
+			coloring.update( true, W ) ;
+
+			ASSERT_EQ( (std::size_t) n, coloring.size() ) ;
+			ASSERT_EQ( n, coloring.colors.back() ) ;
+
+			std::vector< std::ptrdiff_t > rowColors( n, -1 ) ;
+			for( std::size_t c = 0 ; c < coloring.nColors() ; ++c )
+			{
+				ASSERT_LT( 0u, coloring.colorSize( c ) ) ;
+				for( std::ptrdiff_t k = coloring.colors[c] ; k < coloring.colors[c+1] ; ++k )
+				{
+					ASSERT_EQ( -1, rowColors[ coloring.permutation[k] ] ) ;
+					rowColors[ coloring.permutation[k] ] = c ;
+				}
+			}
+
+			// No interaction within a color
+			for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+			{
+				for( WType::InnerIterator it( W.innerIterator( i ) ) ; it ; ++it )
+				{
+					if( (std::ptrdiff_t) it.inner() != i ) {
+						EXPECT_NE( rowColors[i], rowColors[ it.inner() ] ) ;
+					}
+				}
+			}
+
+			std::vector< std::size_t > histogram ;
+			coloring.sizeHistogram( histogram ) ;
+			std::size_t nColors = 0 ;
+			for( std::size_t k = 0 ; k < histogram.size() ; ++k )
+				nColors += histogram[k] ;
+			EXPECT_EQ( coloring.nColors(), nColors ) ;
+
+			std::size_t smallColors = 0 ;
+			for( std::size_t c = 0 ; c < coloring.nColors() ; ++c )
+				if( coloring.colorSize( c ) < nThreads ) ++smallColors ;
+
+			if( balancing == 0 )
+			{
+				unbalancedColors = coloring.nColors() ;
+				unbalancedSmallColors = smallColors ;
+			} else {
+				EXPECT_GE( unbalancedColors, coloring.nColors() ) ;
+				EXPECT_GE( unbalancedSmallColors, smallColors ) ;
+			}
+		}
+	}
+
+	// Solving with a coloring gives the same result as without
+	Eigen::VectorXd b = Eigen::VectorXd::Ones( W.rows() ) ;
+	Eigen::VectorXd x0( W.rows() ), x1( W.rows() ) ;
+
+	bogus::GaussSeidel< WType > gs( W ) ;
+	gs.setTol( 1.e-12 ) ;
+
+	x0.setZero() ;
+	ASSERT_GT( 1.e-12, gs.solve( bogus::LCPLaw< double >(), -b, x0 ) ) ;
+
+	gs.coloring().setAlgorithm( bogus::Coloring::JonesPlassmann ) ;
+	gs.coloring().setBalancing( 4 ) ;
+	gs.coloring().update( true, W ) ;
+
+	x1.setZero() ;
+	ASSERT_GT( 1.e-12, gs.solve( bogus::LCPLaw< double >(), -b, x1 ) ) ;
+
+	EXPECT_TRUE( x0.isApprox( x1, 1.e-5 ) ) ;
+}
+
+TEST( GaussSeidel, Reordering )
+{
+	// 2D grid with shuffled row indices
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix< double, 1, 1 >, bogus::SYMMETRIC > WType ;
+	const std::ptrdiff_t width = 20, n = width * width ;
+
+	std::vector< std::size_t > shuffle( n ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		shuffle[i] = i ;
+	std::srand( 42 ) ;
+	for( std::ptrdiff_t i = n-1 ; i > 0 ; --i )
+		std::swap( shuffle[i], shuffle[ std::rand() % ( i+1 ) ] ) ;
+
+	std::vector< std::vector< std::ptrdiff_t > > lower( n ) ;
+	for( std::ptrdiff_t x = 0 ; x < width ; ++x )
+	{
+		for( std::ptrdiff_t y = 0 ; y < width ; ++y )
+		{
+			const std::ptrdiff_t i = shuffle[ x*width + y ] ;
+			if( x > 0 )
+			{
+				const std::ptrdiff_t j = shuffle[ (x-1)*width + y ] ;
+				lower[ std::max( i, j ) ].push_back( std::min( i, j ) ) ;
+			}
+			if( y > 0 )
+			{
+				const std::ptrdiff_t j = shuffle[ x*width + y-1 ] ;
+				lower[ std::max( i, j ) ].push_back( std::min( i, j ) ) ;
+			}
+		}
+	}
+
+	WType W ;
+	W.setRows( n ) ;
+	W.setCols( n ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		lower[i].push_back( i ) ;
+		std::sort( lower[i].begin(), lower[i].end() ) ;
+		for( std::size_t k = 0 ; k < lower[i].size() ; ++k )
+			W.insertBack( i, lower[i][k] ).setConstant( lower[i][k] == i ? 5. : -1. ) ;
+	}
+	W.finalize() ;
+
+	bogus::Reordering reordering ;
+	reordering.update( true, W ) ;
+	ASSERT_EQ( (std::size_t) n, reordering.size() ) ;
+
+	std::vector< std::size_t > sorted( reordering.permutation ) ;
+	std::sort( sorted.begin(), sorted.end() ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+		ASSERT_EQ( (std::size_t) i, sorted[i] ) ;
+
+	// Bandwidth should now be close to the width of the grid
+	WType P = W ;
+	P.applyPermutation( &reordering.permutation[0] ) ;
+	std::ptrdiff_t bandwidth = 0 ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		for( WType::InnerIterator it( P.innerIterator( i ) ) ; it ; ++it )
+			bandwidth = std::max( bandwidth, i - (std::ptrdiff_t) it.inner() ) ;
+	}
+	EXPECT_GE( width + 1, bandwidth ) ;
+
+	// Sorting colors preserves the color of each row
+	bogus::Coloring coloring ;
+	coloring.update( true, W ) ;
+	bogus::Coloring sortedColoring = coloring ;
+	reordering.sortColors( sortedColoring ) ;
+
+	std::vector< std::size_t > rank( n ) ;
+	for( std::ptrdiff_t k = 0 ; k < n ; ++k )
+		rank[ reordering.permutation[k] ] = k ;
+
+	for( std::size_t c = 0 ; c < coloring.nColors() ; ++c )
+	{
+		std::vector< std::size_t > before( coloring.permutation.begin() + coloring.colors[c],
+		                                   coloring.permutation.begin() + coloring.colors[c+1] ) ;
+		std::vector< std::size_t > after( sortedColoring.permutation.begin() + coloring.colors[c],
+		                                  sortedColoring.permutation.begin() + coloring.colors[c+1] ) ;
+		for( std::size_t k = 1 ; k < after.size() ; ++k )
+			EXPECT_LT( rank[ after[k-1] ], rank[ after[k] ] ) ;
+
+		std::sort( before.begin(), before.end() ) ;
+		std::sort( after.begin(), after.end() ) ;
+		EXPECT_TRUE( before == after ) ;
+	}
+}
+
+TEST( GaussSeidel, Asynchronous )
+{
+	// Symmetric block-tridiagonal system
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::SYMMETRIC > WType ;
+	const std::ptrdiff_t n = 400 ;
+
+	WType W ;
+	W.setRows( n, 3 ) ;
+	W.setCols( n, 3 ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		if( i > 0 ) W.insertBack( i, i-1 ) = -Eigen::Matrix3d::Identity() ;
+		W.insertBack( i, i ) = 4 * Eigen::Matrix3d::Identity() ;
+	}
+	W.finalize() ;
+
+	Eigen::VectorXd b = Eigen::VectorXd::Ones( W.rows() ) ;
+	b.tail( W.rows() / 2 ) *= -1 ;
+	Eigen::VectorXd x0( W.rows() ), x1( W.rows() ) ;
+
+	std::vector< double > mu( n, .5 ) ;
+	bogus::Coulomb3D law( n, &mu[0] ) ;
+
+	bogus::GaussSeidel< WType > gs( W ) ;
+	gs.setTol( 1.e-12 ) ;
+	gs.setMaxIters( 1000 ) ;
+	gs.setMaxThreads( 1 ) ;
+
+	x0.setZero() ;
+	ASSERT_GT( 1.e-12, gs.solve( law, b, x0 ) ) ;
+
+	gs.setMaxThreads( 4 ) ;
+	gs.setAsynchronous( true ) ;
+	EXPECT_TRUE( gs.asynchronous() ) ;
+
+	x1.setZero() ;
+	ASSERT_GT( 1.e-12, gs.solve( law, b, x1 ) ) ;
+
+	EXPECT_TRUE( x0.isApprox( x1, 1.e-5 ) ) ;
+}
+
+namespace {
+
+struct CountTask : public bogus::RangeTask
+{
+	explicit CountTask( std::vector< int > &counts_ ) : counts( counts_ ) {}
+
+	void run( std::ptrdiff_t begin, std::ptrdiff_t end, int ) const
+	{
+		for( std::ptrdiff_t i = begin ; i < end ; ++i )
+			++counts[i] ;
+	}
+
+	std::vector< int > &counts ;
+} ;
+
+}
+
+TEST( GaussSeidel, Executor )
+{
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix< double, 1, 1 >, bogus::SYMMETRIC > WType ;
+	const std::ptrdiff_t n = 300 ;
+
+	WType W ;
+	W.setRows( n ) ;
+	W.setCols( n ) ;
+	for( std::ptrdiff_t i = 0 ; i < n ; ++i )
+	{
+		if( i > 0 ) W.insertBack( i, i-1 ).setConstant( -1. ) ;
+		W.insertBack( i, i ).setConstant( 4. ) ;
+	}
+	W.finalize() ;
+
+	const Eigen::VectorXd b = Eigen::VectorXd::LinSpaced( n, -1., 1. ) ;
+	const Eigen::VectorXd Wb = W * b ;
+
+	bogus::GaussSeidel< WType > gs( W ) ;
+	gs.setTol( 1.e-12 ) ;
+	gs.coloring().update( true, W ) ;
+
+	Eigen::VectorXd x0 = Eigen::VectorXd::Zero( n ) ;
+	ASSERT_GT( 1.e-12, gs.solve( bogus::LCPLaw< double >(), b, x0 ) ) ;
+
+	bogus::SerialExecutor serial ;
+	bogus::WorkStealingExecutor pool( 4 ) ;
+	EXPECT_EQ( 4, pool.nWorkers() ) ;
+
+	bogus::Executor* executors[2] = { &serial, &pool } ;
+	for( unsigned e = 0 ; e < 2 ; ++e )
+	{
+		bogus::setExecutor( executors[e] ) ;
+		EXPECT_EQ( executors[e], &bogus::executor() ) ;
+
+		std::vector< int > counts( 1000, 0 ) ;
+		bogus::parallel_for( 0, 1000, CountTask( counts ), true, 7 ) ;
+		EXPECT_EQ( 1000, std::count( counts.begin(), counts.end(), 1 ) ) ;
+
+		const Eigen::VectorXd Wb1 = W * b ;
+		EXPECT_TRUE( Wb.isApprox( Wb1 ) ) ;
+
+		gs.coloring().update( true, W ) ;
+		Eigen::VectorXd x1 = Eigen::VectorXd::Zero( n ) ;
+		ASSERT_GT( 1.e-12, gs.solve( bogus::LCPLaw< double >(), b, x1 ) ) ;
+		EXPECT_TRUE( x0.isApprox( x1, 1.e-8 ) ) ;
+	}
+
+	bogus::setExecutor( BOGUS_NULL_PTR( bogus::Executor ) ) ;
+}
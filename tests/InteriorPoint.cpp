@@ -0,0 +1,116 @@
+/*
+ * Any copyright is dedicated to the Public Domain.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <bogus/Core/Block.impl.hpp>
+#include <bogus/Core/BlockSolvers/GaussSeidel.impl.hpp>
+#include <bogus/Core/BlockSolvers/InteriorPoint.impl.hpp>
+#include <bogus/Extra/SecondOrder.impl.hpp>
+
+#include "ResidualInfo.hpp"
+#include "SmallFrictionPb.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+struct IterationCounter {
+	IterationCounter() : iters( 0 ) {}
+	void ack( unsigned iter, double ) { iters = iter ; }
+	unsigned iters ;
+} ;
+
+}
+
+TEST_F( SmallFrictionPb, InteriorPoint )
+{
+	ResidualInfo ri ;
+
+	const Eigen::VectorXd b = w - H * ( InvMassMat * f );
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > WType ;
+	WType W ;
+	W = H * InvMassMat * H.transpose() ;
+
+	bogus::GaussSeidel< WType > gs( W ) ;
+	gs.setTol( 1.e-14 ) ;
+	Eigen::VectorXd xgs = Eigen::VectorXd::Ones( W.rows() ) ;
+	gs.solve( bogus::SOC3D( 2, mu.data() ), b, xgs ) ;
+
+	bogus::InteriorPoint< WType > ip( W ) ;
+	ri.bindTo( ip.callback() ) ;
+	ri.setMethodName( "IP" ) ;
+
+	Eigen::VectorXd x = Eigen::VectorXd::Ones( W.rows() ) ;
+	double res = ip.solve( bogus::SOC3D( 2, mu.data() ), b, x ) ;
+	ASSERT_LT( res, 1.e-12 ) ;
+	EXPECT_TRUE( xgs.isApprox( x, 1.e-5 ) ) << x ;
+
+	ip.setLinearSolver( bogus::interior_point::ConjugateGradient ) ;
+	x.setZero() ;
+	res = ip.solve( bogus::SOC3D( 2, mu.data() ), b, x ) ;
+	ASSERT_LT( res, 1.e-12 ) ;
+	EXPECT_TRUE( xgs.isApprox( x, 1.e-5 ) ) << x ;
+}
+
+TEST( InteriorPoint, Stack )
+{
+	std::srand( 1 ) ;
+
+	// Stack of bodies, each one resting on the one below ; the heavy bottom of the stack
+	// makes the problem badly conditioned
+	const unsigned n = 60 ;
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d > HType ;
+	HType H ;
+	H.setRows( n ) ;
+	H.setCols( n+1 ) ;
+	for( unsigned i = 0 ; i < n ; ++i )
+	{
+		const double scale = std::pow( 1.1, (double) i ) ;
+		H.insertBack( i, i ) = scale * ( Eigen::Matrix3d::Random() + 2 * Eigen::Matrix3d::Identity() ) ;
+		H.insertBack( i, i+1 ) = -scale * ( Eigen::Matrix3d::Random() + 2 * Eigen::Matrix3d::Identity() ) ;
+	}
+	H.finalize() ;
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > WType ;
+	WType W ;
+	W = H * H.transpose() ;
+
+	const Eigen::VectorXd b = Eigen::VectorXd::Random( W.rows() ) ;
+	Eigen::VectorXd mu = Eigen::VectorXd::Constant( n, 0.5 ) ;
+	mu[ n/2 ] = -1 ; // Unconstrained contact
+	const bogus::SOC3D law( n, mu.data() ) ;
+
+	bogus::InteriorPoint< WType > ip( W ) ;
+	IterationCounter count ;
+	ip.callback().connect( count, &IterationCounter::ack ) ;
+
+	Eigen::VectorXd x = Eigen::VectorXd::Zero( W.rows() ) ;
+	double res = ip.solve( law, b, x ) ;
+	EXPECT_LT( res, 1.e-12 ) ;
+	EXPECT_LT( ip.eval( law, W*x + b, x ), 1.e-12 ) ;
+	EXPECT_GT( 30u, count.iters ) ;
+	const unsigned cholIters = count.iters ;
+
+	// The symbolic factorization is reused
+	const Eigen::VectorXd x0 = x ;
+	x.setZero() ;
+	res = ip.solve( law, b, x ) ;
+	EXPECT_EQ( cholIters, count.iters ) ;
+	EXPECT_TRUE( x0.isApprox( x ) ) ;
+
+	ip.setLinearSolver( bogus::interior_point::ConjugateGradient ) ;
+	x.setZero() ;
+	res = ip.solve( law, b, x ) ;
+	EXPECT_LT( res, 1.e-12 ) ;
+	EXPECT_GT( 30u, count.iters ) ;
+
+	// Gauss-Seidel needs many more sweeps
+	bogus::GaussSeidel< WType > gs( W ) ;
+	gs.setTol( 1.e-12 ) ;
+	gs.setMaxIters( 10 * cholIters ) ;
+	x.setZero() ;
+	EXPECT_LT( res, gs.solve( law, b, x ) ) ;
+}
@@ -56,6 +56,16 @@ TEST( Krylov, CG )
 	cg.solve_BiCGSTAB( rhs, res ) ;
 	EXPECT_EQ( expected_1, res ) ;
 
+	res.setZero() ;
+	ri.setMethodName("PipelinedCG");
+	cg.solve( rhs, res, bogus::krylov::PipelinedCG ) ;
+	EXPECT_EQ( expected_1, res ) ;
+
+	res.setZero() ;
+	ri.setMethodName("ChronopoulosGearCG");
+	cg.solve_ChronopoulosGearCG( rhs, res ) ;
+	EXPECT_EQ( expected_1, res ) ;
+
 	sbm.block(0) << 0, 1, 0, 1, 0, 0, 0, 0, 1 ;
 	rhs << 1, 2, 3 ;
 
@@ -124,6 +134,18 @@ TEST( Krylov, Preconditioner )
 	EXPECT_GT( 1.e-16, err ) ;
 	EXPECT_GT( 1.e-16, ( sbm*res - rhs ).squaredNorm() ) ;
 
+	res.setZero() ;
+	ri.setMethodName("PipelinedCG");
+	err = pcg.solve_PipelinedCG( rhs, res ) ;
+	EXPECT_GT( 1.e-16, err ) ;
+	EXPECT_GT( 1.e-16, ( sbm*res - rhs ).squaredNorm() ) ;
+
+	res.setZero() ;
+	ri.setMethodName("ChronopoulosGearCG");
+	err = pcg.solve( rhs, res, bogus::krylov::ChronopoulosGearCG ) ;
+	EXPECT_GT( 1.e-16, err ) ;
+	EXPECT_GT( 1.e-16, ( sbm*res - rhs ).squaredNorm() ) ;
+
 	res.setZero() ;
 	ri.setMethodName("BiCG");
 	err = pcg.solve_BiCG( rhs, res ) ;
@@ -346,3 +368,196 @@ TEST( Krylov, ProductLhs )
 	EXPECT_GT( 1.e-8, (prod * res - rhs).lpNorm<Eigen::Infinity>() ) ;
 }
 
+
+namespace {
+
+struct IterationCounter {
+	IterationCounter() : iters( 0 ) {}
+	void ack( unsigned iter, double ) { iters = iter ; }
+	unsigned iters ;
+} ;
+
+// Block 2D Laplacian-like matrix ; SPD if symmetric is true
+void laplacian2D( const int m, bool symmetric, bogus::SparseBlockMatrix< Eigen::Matrix3d > &sbm )
+{
+	const int n = m*m ;
+
+	sbm.setRows( n, 3 ) ;
+	sbm.setCols( n, 3 ) ;
+
+	Eigen::Matrix3d coupling ;
+	coupling << 1, .2, 0,  .1, 1, .3,  0, .1, 1 ;
+	const Eigen::Matrix3d lower = symmetric ? coupling.transpose() : Eigen::Matrix3d( .5 * coupling ) ;
+
+	for( int i = 0 ; i < n ; ++i )
+	{
+		const int x = i % m, y = i / m ;
+		if( y > 0 )   sbm.insertBack( i, i-m ) = -lower ;
+		if( x > 0 )   sbm.insertBack( i, i-1 ) = -lower ;
+		sbm.insertBack( i, i ) = Eigen::Matrix3d::Identity() * ( 6 + .01*(i%7) ) ;
+		if( x < m-1 ) sbm.insertBack( i, i+1 ) = -coupling ;
+		if( y < m-1 ) sbm.insertBack( i, i+m ) = -coupling ;
+	}
+	sbm.finalize() ;
+}
+
+}
+
+TEST( Krylov, IncompleteLDLT )
+{
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d > Mat ;
+	Mat sbm ;
+	laplacian2D( 12, true, sbm ) ;
+
+	Eigen::VectorXd rhs( sbm.rows() ), res ;
+	for( int i = 0 ; i < rhs.rows() ; ++i )
+		rhs[i] = std::cos( .37 * i ) ;
+
+	IterationCounter count ;
+
+	bogus::Krylov< Mat > cg( sbm ) ;
+	cg.setTol( 1.e-16 ) ;
+	cg.callback().connect( count, &IterationCounter::ack ) ;
+	res.setZero( rhs.rows() ) ;
+	cg.solve_CG( rhs, res ) ;
+	const unsigned cgIters = count.iters ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	bogus::Krylov< Mat, bogus::IncompleteLDLTPreconditioner > icg( sbm ) ;
+	icg.setTol( 1.e-16 ) ;
+	icg.callback().connect( count, &IterationCounter::ack ) ;
+	res.setZero( rhs.rows() ) ;
+	icg.solve_CG( rhs, res ) ;
+	const unsigned icIters = count.iters ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+	EXPECT_GT( cgIters, icIters ) ;
+
+	res.setZero( rhs.rows() ) ;
+	icg.solve_BiCGSTAB( rhs, res ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Same pattern, different values : symbolic analysis is reused
+	sbm.block( sbm.diagonalBlockPtr( 0 ) ) *= 2 ;
+	icg.setMatrix( sbm ) ;
+	res.setZero( rhs.rows() ) ;
+	icg.solve_CG( rhs, res ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Higher fill levels
+	icg.preconditioner().setFillLevel( 2 ) ;
+	EXPECT_EQ( 2u, icg.preconditioner().fillLevel() ) ;
+	icg.setMatrix( sbm ) ;
+	res.setZero( rhs.rows() ) ;
+	icg.solve_CG( rhs, res ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+	EXPECT_GE( icIters, count.iters ) ;
+
+	// Multiple right-hand sides
+	Eigen::MatrixXd rhs2( sbm.rows(), 2 ), res2 ;
+	rhs2.col(0) = rhs ;
+	rhs2.col(1).setOnes() ;
+	res2.setZero( rhs2.rows(), 2 ) ;
+	icg.solve_CG( rhs2, res2 ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res2 - rhs2 ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Single-reduction CG variants follow the same iterates as CG, up to rounding errors
+	res.setZero( rhs.rows() ) ;
+	icg.solve_CG( rhs, res ) ;
+	const unsigned refIters = count.iters ;
+
+	res.setZero( rhs.rows() ) ;
+	icg.solve_ChronopoulosGearCG( rhs, res ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+	EXPECT_GE( refIters + 2, count.iters ) ;
+
+	res.setZero( rhs.rows() ) ;
+	icg.solve_PipelinedCG( rhs, res ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+	EXPECT_GE( refIters + 2, count.iters ) ;
+
+	res.setZero( rhs.rows() ) ;
+	cg.solve_PipelinedCG( rhs, res ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+	EXPECT_GE( cgIters + 2, count.iters ) ;
+}
+
+TEST( Krylov, BlockMethods )
+{
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d > Mat ;
+	Mat sbm ;
+	laplacian2D( 12, true, sbm ) ;
+
+	// Several rhs, two of them linearly dependent
+	Eigen::MatrixXd rhs( sbm.rows(), 6 ), res ;
+	for( int i = 0 ; i < rhs.rows() ; ++i )
+	{
+		rhs( i, 0 ) = std::cos( .37 * i ) ;
+		rhs( i, 1 ) = std::sin( .11 * i ) ;
+		rhs( i, 2 ) = 1 ;
+		rhs( i, 3 ) = ( i % 5 ) - 2 ;
+		rhs( i, 4 ) = std::cos( .02 * i * i ) ;
+	}
+	rhs.col( 5 ) = 2 * rhs.col( 0 ) ;
+
+	IterationCounter count ;
+
+	bogus::Krylov< Mat > cg( sbm ) ;
+	cg.setTol( 1.e-16 ) ;
+	cg.callback().connect( count, &IterationCounter::ack ) ;
+
+	res.setZero( rhs.rows(), 1 ) ;
+	cg.solve_CG( rhs.col( 0 ), res ) ;
+	const unsigned cgIters = count.iters ;
+
+	// Shared Krylov subspace : fewer iterations than for a single rhs
+	res.setZero( rhs.rows(), rhs.cols() ) ;
+	double err = cg.solve( rhs, res, bogus::krylov::BlockCG ) ;
+	EXPECT_GT( rhs.cols() * 1.e-16, err ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+	EXPECT_GT( cgIters, count.iters ) ;
+
+	// Warm-started columns are deflated
+	res.col( 1 ).setZero() ;
+	res.col( 4 ).setZero() ;
+	err = cg.solve_BlockCG( rhs, res ) ;
+	EXPECT_GT( rhs.cols() * 1.e-16, err ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Single rhs
+	Eigen::VectorXd vres = Eigen::VectorXd::Zero( rhs.rows() ) ;
+	cg.solve_BlockCG( rhs.col( 0 ), vres ) ;
+	EXPECT_GT( 1.e-6, ( sbm*vres - rhs.col( 0 ) ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Preconditioned, through the LinearSolverBase interface
+	bogus::Krylov< Mat, bogus::DiagonalPreconditioner > pcg( sbm ) ;
+	pcg.setTol( 1.e-16 ) ;
+	res = pcg.asBlockCG() * rhs ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	res.setZero( rhs.rows(), rhs.cols() ) ;
+	err = pcg.solve( rhs, res, bogus::krylov::BlockGMRES ) ;
+	EXPECT_GT( rhs.cols() * 1.e-16, err ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Non-symmetric system, restarted block GMRES
+	laplacian2D( 12, false, sbm ) ;
+	pcg.setMatrix( sbm ) ;
+	pcg.setMaxIters( 200 ) ;
+	pcg.callback().connect( count, &IterationCounter::ack ) ;
+
+	res.setZero( rhs.rows(), rhs.cols() ) ;
+	err = pcg.asBlockGMRES().setRestart( 5 ).solve( rhs, res ) ;
+	EXPECT_GT( rhs.cols() * 1.e-16, err ) ;
+	EXPECT_GT( 1.e-6, ( sbm*res - rhs ).lpNorm< Eigen::Infinity >() ) ;
+	const unsigned blockIters = count.iters ;
+
+	// Fewer matrix traversals than solving for each column separately
+	unsigned totalIters = 0 ;
+	for( int c = 0 ; c < rhs.cols() ; ++c )
+	{
+		res.setZero( rhs.rows(), 1 ) ;
+		pcg.asGMRES().setRestart( 5 ).solve( rhs.col( c ), res ) ;
+		totalIters += count.iters ;
+	}
+	EXPECT_GT( totalIters, 2 * blockIters ) ;
+}
@@ -14,6 +14,9 @@
 #include <bogus/Core/Eigen/EigenLinearSolvers.hpp>
 #include <bogus/Extra/SOC/LocalSOCSolver.impl.hpp>
 
+#include <cmath>
+#include <cstdlib>
+
 TEST( Polynomial, Quadratic )
 {
 	double c[2] = {-1, 0} ;
@@ -103,3 +106,51 @@ TEST( Polynomial, SOQPQuartic )
 	 // std::cout << r.transpose() << std::endl ;
 }
 
+
+TEST( Polynomial, LocalSOCBatch )
+{
+	typedef bogus::LocalSOCSolver< 3, double, true, bogus::local_soc_solver::RevHybrid > LocalSolver ;
+	typedef bogus::LocalSOCBatch< 3, double, 4 > Batch ;
+
+	const double tol = 1.e-12 ;
+	const double mus[3] = { 0., 0.5, 2. } ;
+
+	std::srand( 42 ) ;
+
+	for( unsigned n = 0 ; n < 16 ; ++n )
+	{
+		Batch batch ;
+		batch.count = 1 + n % 4 ;
+
+		Eigen::Matrix3d W[4] ;
+		Eigen::Vector3d b[4] ;
+
+		for( unsigned k = 0 ; k < batch.count ; ++k )
+		{
+			const Eigen::Matrix3d M = Eigen::Matrix3d::Random() ;
+			W[k] = M * M.transpose() + Eigen::Matrix3d::Identity() ;
+			b[k] = Eigen::Vector3d::Random() ;
+			// Alternate between take-off, sticking and sliding configurations
+			if( k % 2 ) b[k][0] = - 4 * std::fabs( b[k][0] ) - 1 ;
+
+			batch.set( k, W[k], b[k], Eigen::Vector3d::Zero() ) ;
+			batch.mu[k] = mus[ ( n + k ) % 3 ] ;
+		}
+
+		double res[4] ;
+		LocalSolver::solveBatch( batch, tol, res ) ;
+
+		for( unsigned k = 0 ; k < batch.count ; ++k )
+		{
+			Eigen::Vector3d x = Eigen::Vector3d::Zero() ;
+			const double ref = LocalSolver::solve( W[k], b[k], x, batch.mu[k], tol ) ;
+
+			Eigen::Vector3d xb ;
+			batch.get( k, xb ) ;
+
+			EXPECT_GT( tol, ref ) ;
+			EXPECT_GT( tol, res[k] ) ;
+			EXPECT_TRUE( xb.isApprox( x, 1.e-6 ) || ( xb.isZero() && x.isZero() ) ) ;
+		}
+	}
+}
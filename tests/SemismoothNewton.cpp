@@ -0,0 +1,135 @@
+/*
+ * Any copyright is dedicated to the Public Domain.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <bogus/Core/Block.impl.hpp>
+#include <bogus/Core/BlockSolvers/GaussSeidel.impl.hpp>
+#include <bogus/Core/BlockSolvers/SemismoothNewton.impl.hpp>
+#include <bogus/Extra/SecondOrder.impl.hpp>
+
+#include "ResidualInfo.hpp"
+#include "SmallFrictionPb.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+struct IterationCounter {
+	IterationCounter() : iters( 0 ) {}
+	void ack( unsigned iter, double ) { iters = iter ; }
+	unsigned iters ;
+} ;
+
+}
+
+TEST( SemismoothNewton, Jacobian )
+{
+	std::srand( 1 ) ;
+
+	const double mu[2] = { 0.6, -1 } ;
+	const bogus::Coulomb3D law( 2, mu ) ;
+
+	for( unsigned i = 0 ; i < 2 ; ++i )
+	{
+		const Eigen::Vector3d x = Eigen::Vector3d::Random() ;
+		const Eigen::Vector3d y = Eigen::Vector3d::Random() ;
+
+		Eigen::Vector3d fb, fb2 ;
+		Eigen::Matrix3d dFb_dx, dFb_dy ;
+		law.evalJacobian( i, x, y, fb, dFb_dx, dFb_dy ) ;
+		law.evalFunction( i, x, y, fb2 ) ;
+		EXPECT_TRUE( fb.isApprox( fb2 ) ) ;
+
+		// Compare with finite differences
+		const double h = 1.e-7 ;
+		for( unsigned k = 0 ; k < 3 ; ++k )
+		{
+			const Eigen::Vector3d dk = h * Eigen::Vector3d::Unit( k ) ;
+			law.evalFunction( i, x + dk, y, fb2 ) ;
+			EXPECT_GT( 1.e-5, ( ( fb2 - fb ) / h - dFb_dx.col( k ) ).lpNorm< Eigen::Infinity >() ) ;
+			law.evalFunction( i, x, y + dk, fb2 ) ;
+			EXPECT_GT( 1.e-5, ( ( fb2 - fb ) / h - dFb_dy.col( k ) ).lpNorm< Eigen::Infinity >() ) ;
+		}
+	}
+}
+
+TEST_F( SmallFrictionPb, SemismoothNewton )
+{
+	ResidualInfo ri ;
+
+	const Eigen::VectorXd b = w - H * ( InvMassMat * f );
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > WType ;
+	WType W ;
+	W = H * InvMassMat * H.transpose() ;
+
+	bogus::SemismoothNewton< WType > ssn( W ) ;
+	ri.bindTo( ssn.callback() ) ;
+	ri.setMethodName( "SSN" ) ;
+
+	Eigen::VectorXd x = Eigen::VectorXd::Ones( W.rows() ) ;
+	double res = ssn.solve( bogus::Coulomb3D( 2, mu.data() ), b, x ) ;
+	ASSERT_LT( res, 1.e-12 ) ;
+	ASSERT_TRUE( sol.isApprox( x, 1.e-4 ) ) << x ;
+
+	// Pure Newton iterations, with other Krylov methods
+	ssn.setWarmStart( false ) ;
+	ssn.setLinearSolver( bogus::krylov::BiCGSTAB ) ;
+	x.setOnes() ;
+	res = ssn.solve( bogus::Coulomb3D( 2, mu.data() ), b, x ) ;
+	ASSERT_LT( res, 1.e-12 ) ;
+	ASSERT_TRUE( sol.isApprox( x, 1.e-4 ) ) << x ;
+
+	ssn.setLinearSolver( bogus::krylov::TFQMR ) ;
+	x.setZero() ;
+	res = ssn.solve( bogus::SOC3D( 2, mu.data() ), b, x ) ;
+	ASSERT_LT( res, 1.e-12 ) ;
+	EXPECT_LT( ssn.eval( bogus::SOC3D( 2, mu.data() ), W*x + b, x ), 1.e-12 ) ;
+}
+
+TEST( SemismoothNewton, Chain )
+{
+	std::srand( 1 ) ;
+
+	// Chain of contacts between consecutive bodies
+	const unsigned n = 50 ;
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d > HType ;
+	HType H ;
+	H.setRows( n ) ;
+	H.setCols( n+1 ) ;
+	for( unsigned i = 0 ; i < n ; ++i )
+	{
+		H.insertBack( i, i ) = Eigen::Matrix3d::Random() ;
+		H.insertBack( i, i+1 ) = Eigen::Matrix3d::Random() ;
+	}
+	H.finalize() ;
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > WType ;
+	WType W ;
+	W = H * H.transpose() ;
+
+	const Eigen::VectorXd b = Eigen::VectorXd::Random( W.rows() ) ;
+	const Eigen::VectorXd mu = Eigen::VectorXd::Constant( n, 0.6 ) ;
+	const bogus::Coulomb3D law( n, mu.data() ) ;
+
+	bogus::SemismoothNewton< WType > ssn( W ) ;
+	ssn.setTol( 1.e-14 ) ;
+
+	IterationCounter count ;
+	ssn.callback().connect( count, &IterationCounter::ack ) ;
+
+	Eigen::VectorXd x = Eigen::VectorXd::Zero( W.rows() ) ;
+	const double res = ssn.solve( law, b, x ) ;
+	EXPECT_LT( res, 1.e-14 ) ;
+	EXPECT_LT( ssn.eval( law, W*x + b, x ), 1.e-14 ) ;
+	EXPECT_GT( 30u, count.iters ) ;
+
+	// Gauss-Seidel does not reach this accuracy with ten times as many sweeps
+	bogus::GaussSeidel< WType > gs( W ) ;
+	gs.setTol( 1.e-14 ) ;
+	gs.setMaxIters( 10 * count.iters + ssn.gaussSeidel().maxIters() ) ;
+	x.setZero() ;
+	EXPECT_LT( res, gs.solve( law, b, x ) ) ;
+}
@@ -173,6 +173,104 @@ TEST( Serialization, Vectors )
 
 }
 
+TEST( Serialization, Binary )
+{
+	typedef Eigen::Matrix< double, 3, Eigen::Dynamic > HBlock ;
+	typedef bogus::FlatSparseBlockMatrix< HBlock, bogus::UNCOMPRESSED > HType ;
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d > EType ;
+	typedef bogus::SparseBlockMatrix< Eigen::MatrixXd, bogus::SYMMETRIC > MType ;
+
+	const unsigned ndof[] = { 2, 5, 3 } ;
+
+	HType H ;
+	H.setRows( 4 ) ;
+	H.setCols( 3, ndof ) ;
+	H.insert( 2, 1 ) = HBlock::Constant( 3, 5, 2. ) ;
+	H.insert( 0, 2 ) = HBlock::Constant( 3, 3, 1. ) ;
+	H.insert( 2, 0 ) = HBlock::Constant( 3, 2, -1. ) ;
+	H.insert( 3, 2 ) = HBlock::Constant( 3, 3, 4. ) ;
+	H.finalize() ;
+
+	EType E ;
+	E.setRows( 4 ) ;
+	E.setCols( 4 ) ;
+	for( int i = 0 ; i < 4 ; ++i )
+		E.insertBack( i, ( i * 3 ) % 4 ) = Eigen::Matrix3d::Random() ;
+	E.finalize() ;
+
+	MType M ;
+	M.setRows( 3, ndof ) ;
+	M.insertBackAndResize( 0, 0 ).setIdentity() ;
+	M.insertBackAndResize( 1, 0 ).setConstant( 3. ) ;
+	M.insertBackAndResize( 2, 2 ).setConstant( 2. ) ;
+	M.finalize() ;
+
+	const Eigen::VectorXd v = Eigen::VectorXd::LinSpaced( 10, 0., 1. ) ;
+	const std::string fileName = temp_file_name() ;
+
+	{
+		bogus::binary::Writer writer ;
+		ASSERT_TRUE( writer.open( fileName.c_str() ) ) ;
+		writer.write( "v", v.data(), v.size() ) ;
+		bogus::binary::writeMatrix( writer, "H", H ) ;
+		bogus::binary::writeMatrix( writer, "E", E ) ;
+		bogus::binary::writeMatrix( writer, "M", M ) ;
+		ASSERT_TRUE( writer.close() ) ;
+	}
+
+	const Eigen::VectorXd x = Eigen::VectorXd::Random( 10 ) ;
+	const Eigen::VectorXd r = Eigen::VectorXd::Random( 12 ) ;
+
+	{
+		bogus::binary::Reader reader ;
+		ASSERT_TRUE( reader.open( fileName.c_str(), true ) ) ;
+
+		std::size_t n ;
+		const double* v_ = reader.section< const double >( "v", n ) ;
+		ASSERT_EQ( 10u, n ) ;
+		EXPECT_EQ( v, Eigen::VectorXd::Map( v_, n ) ) ;
+		EXPECT_FALSE( reader.section< const float >( "v", n ) ) ;
+		EXPECT_FALSE( reader.has( "w" ) ) ;
+
+		HType H_ ;
+		EType E_ ;
+		MType M_ ;
+		ASSERT_TRUE( bogus::binary::readMatrix( reader, "H", H_ ) ) ;
+		ASSERT_TRUE( bogus::binary::readMatrix( reader, "E", E_ ) ) ;
+		ASSERT_TRUE( bogus::binary::readMatrix( reader, "M", M_ ) ) ;
+
+		EXPECT_EQ( H.nBlocks(), H_.nBlocks() ) ;
+		EXPECT_EQ( H * x, H_ * x ) ;
+		EXPECT_EQ( E * r, E_ * r ) ;
+		EXPECT_EQ( M * x, M_ * x ) ;
+
+		// Matrices with fixed-size blocks can be used in-place
+		bogus::MappedSparseBlockMatrix< Eigen::Matrix3d > Em ;
+		ASSERT_TRUE( bogus::binary::mapMatrix( reader, "E", Em ) ) ;
+		EXPECT_EQ( E * r, Em * r ) ;
+		EXPECT_EQ( E.transpose() * r, Em.transpose() * r ) ;
+
+		// Inconsistent flags
+		bogus::SparseBlockMatrix< Eigen::MatrixXd > Mu ;
+		EXPECT_FALSE( bogus::binary::readMatrix( reader, "M", Mu ) ) ;
+	}
+
+	// Corrupt the first section
+	{
+		std::fstream fs( fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary ) ;
+		fs.seekp( bogus::binary::Alignment ) ;
+		fs.put( 'x' ) ;
+	}
+
+	{
+		bogus::binary::Reader reader ;
+		EXPECT_FALSE( reader.open( fileName.c_str(), true ) ) ;
+		ASSERT_TRUE( reader.open( fileName.c_str(), false ) ) ;
+		EXPECT_FALSE( reader.verifySection( "v" ) ) ;
+		EXPECT_TRUE( reader.verifySection( "H.data" ) ) ;
+	}
+}
+
 TEST( Serialization, CleanUp )
 {
 	std::remove( temp_file_name().c_str() ) ;
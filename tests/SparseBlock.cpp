@@ -130,6 +130,66 @@ TEST( SparseBlock, MMult )
 
 }
 
+TEST( SparseBlock, ProductPlan )
+{
+	typedef Eigen::Matrix< double, 3, 4 > BlockT ;
+	typedef bogus::SparseBlockMatrix< BlockT > SBM ;
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > SymSBM ;
+
+	BlockT sample ;
+	sample<< 1, 2, 3, 4, 3, 2, 1, 0, 1, 2, 3, 4 ;
+
+	SBM sbm ;
+	sbm.setRows( 4, 3 ) ;
+	sbm.setCols( 2, 4 ) ;
+	sbm.insertBack( 0, 1 ) = BlockT::Ones() ;
+	sbm.insertBack( 1, 0 ) = sample ;
+	sbm.insertBack( 2, 0 ) = 3 * BlockT::Ones() ;
+	sbm.insertBack( 2, 1 ) = 5 * BlockT::Ones() ;
+	sbm.finalize() ;
+
+	Eigen::VectorXd rhs( sbm.rows() ) ;
+	for( int i = 0 ; i < rhs.rows() ; ++i ) rhs[i] = i % 3 ;
+
+	bogus::SparseBlockProductPlan< SymSBM > plan ;
+	EXPECT_FALSE( plan.valid() ) ;
+
+	SymSBM mm, expected ;
+	mm.setFromProduct( sbm * sbm.transpose(), plan ) ;
+	EXPECT_TRUE( plan.valid() ) ;
+	EXPECT_FALSE( plan.reused() ) ;
+
+	expected = sbm * sbm.transpose() ;
+	EXPECT_EQ( expected.nBlocks(), mm.nBlocks() ) ;
+	EXPECT_TRUE( ( expected * rhs ).isApprox( mm * rhs ) ) ;
+
+	// Same pattern, different values
+	sbm.block( 1 ) = 2 * sample ;
+	mm.setFromProduct( 2 * sbm * sbm.transpose(), plan ) ;
+	EXPECT_TRUE( plan.reused() ) ;
+
+	expected = 2 * sbm * sbm.transpose() ;
+	EXPECT_TRUE( ( expected * rhs ).isApprox( mm * rhs ) ) ;
+
+	// Different pattern
+	sbm.clear() ;
+	sbm.setRows( 4, 3 ) ;
+	sbm.setCols( 2, 4 ) ;
+	sbm.insertBack( 0, 0 ) = sample ;
+	sbm.insertBack( 3, 1 ) = BlockT::Ones() ;
+	sbm.finalize() ;
+
+	mm.setFromProduct( sbm * sbm.transpose(), plan ) ;
+	EXPECT_FALSE( plan.reused() ) ;
+
+	expected = sbm * sbm.transpose() ;
+	EXPECT_EQ( expected.nBlocks(), mm.nBlocks() ) ;
+	EXPECT_TRUE( ( expected * rhs ).isApprox( mm * rhs ) ) ;
+
+	plan.clear() ;
+	EXPECT_FALSE( plan.valid() ) ;
+}
+
 TEST( SparseBlock, Inv )
 {
 	const Eigen::Vector2d expected_1 ( .5, .5 ) ;
@@ -542,3 +602,151 @@ TEST(SparseBlock, FixedSize)
 }
 
 
+
+TEST( SparseBlock, MinorIndex )
+{
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix2d > Mat ;
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix2d, bogus::SYMMETRIC > SymMat ;
+
+	Mat sbm ;
+	sbm.setRows( 5 ) ;
+	sbm.setCols( 4 ) ;
+	for( int i = 0 ; i < 5 ; ++i )
+		for( int j = ( i % 2 ) ; j < 4 ; j += 2 )
+			sbm.insertBack( i, j ) = ( i + 4*j ) * Eigen::Matrix2d::Identity() ;
+	sbm.finalize() ;
+
+	ASSERT_TRUE( sbm.computeMinorIndex() ) ;
+	const Mat::MinorIndexType& minor = sbm.minorIndex() ;
+	ASSERT_EQ( 4, minor.outerSize() ) ;
+	ASSERT_EQ( (int) sbm.nBlocks(), minor.nonZeros() ) ;
+
+	for( int j = 0 ; j < 4 ; ++j )
+	{
+		int prev = -1 ;
+		for( Mat::MinorIndexType::InnerIterator it( minor, j ) ; it ; ++it )
+		{
+			EXPECT_LT( prev, it.inner() ) ;
+			EXPECT_EQ( sbm.blockPtr( it.inner(), j ), it.ptr() ) ;
+			prev = it.inner() ;
+		}
+		EXPECT_EQ( 3 - ( j % 2 ), minor.size( j ) ) ;
+	}
+
+	SymMat W ;
+	W.setRows( 4 ) ;
+	W.setCols( 4 ) ;
+	for( int i = 0 ; i < 4 ; ++i )
+	{
+		if( i > 1 ) W.insertBack( i, 0 ) = Eigen::Matrix2d::Constant( i ) ;
+		if( i > 0 ) W.insertBack( i, i-1 ) << 1, i, 2, 3 ;
+		W.insertBack( i, i ) = ( 4 + i ) * Eigen::Matrix2d::Identity() ;
+	}
+	W.finalize() ;
+	ASSERT_TRUE( W.computeMinorIndex() ) ;
+	// Diagonal blocks are not stored in the minor index
+	EXPECT_EQ( (int) W.nBlocks() - 4, W.minorIndex().nonZeros() ) ;
+
+	Eigen::MatrixXd dW = Eigen::MatrixXd::Zero( 8, 8 ) ;
+	for( int i = 0 ; i < 4 ; ++i )
+	{
+		for( SymMat::InnerIterator it( W.majorIndex(), i ) ; it ; ++it )
+		{
+			dW.block< 2, 2 >( 2*i, 2*it.inner() ) = W.block( it.ptr() ) ;
+			dW.block< 2, 2 >( 2*it.inner(), 2*i ) = W.block( it.ptr() ).transpose() ;
+		}
+	}
+	const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced( 8, -1., 1. ) ;
+	Eigen::VectorXd Wx = W * x ;
+	EXPECT_TRUE( Wx.isApprox( dW * x ) ) ;
+
+	W.cacheTranspose() ;
+	Wx = W * x ;
+	EXPECT_TRUE( Wx.isApprox( dW * x ) ) ;
+}
+
+TEST( SparseBlock, Builder )
+{
+	typedef Eigen::Matrix< double, 3, Eigen::Dynamic > Block ;
+	typedef bogus::FlatSparseBlockMatrix< Block, bogus::UNCOMPRESSED > FlatMat ;
+	typedef bogus::SparseBlockMatrix< Block > Mat ;
+
+	const int n = 200 ;
+	const int nObj = 17 ;
+	std::vector< unsigned > ndof( nObj ) ;
+	for( int k = 0 ; k < nObj ; ++k )
+		ndof[k] = 1 + k % 6 ;
+
+	FlatMat ref ;
+	ref.setRows( n ) ;
+	ref.setCols( nObj, &ndof[0] ) ;
+	for( int i = 0 ; i < n ; ++i )
+	{
+		for( int k = 0 ; k < 3 ; ++k )
+		{
+			const int j = ( 5*i + 7*k ) % nObj ;
+			ref.insert( i, j ) = Block::Constant( 3, ndof[j], i - j ) ;
+		}
+	}
+	ref.finalize() ;
+
+	bogus::SparseBlockMatrixBuilder< FlatMat > flatBuilder ;
+	bogus::SparseBlockMatrixBuilder< Mat > builder ;
+	flatBuilder.reserve( 3*n ) ;
+
+	// Insert in decreasing order, from several threads
+#ifndef BOGUS_DONT_PARALLELIZE
+#pragma omp parallel for
+#endif
+	for( int i = n-1 ; i >= 0 ; --i )
+	{
+		for( int k = 2 ; k >= 0 ; --k )
+		{
+			const int j = ( 5*i + 7*k ) % nObj ;
+			flatBuilder.insert( i, j ) = Block::Constant( 3, ndof[j], i - j ) ;
+			builder.insert( i, j ) = Block::Constant( 3, ndof[j], i - j ) ;
+		}
+	}
+	ASSERT_EQ( (std::size_t) 3*n, flatBuilder.nBlocks() ) ;
+
+	FlatMat flat ;
+	flat.setRows( n ) ;
+	flat.setCols( nObj, &ndof[0] ) ;
+	flatBuilder.finalize( flat ) ;
+	EXPECT_EQ( 0u, flatBuilder.nBlocks() ) ;
+
+	Mat sbm ;
+	sbm.setRows( n ) ;
+	sbm.setCols( nObj, &ndof[0] ) ;
+	builder.finalize( sbm ) ;
+
+	ASSERT_EQ( ref.nBlocks(), flat.nBlocks() ) ;
+	ASSERT_EQ( ref.nBlocks(), sbm.nBlocks() ) ;
+
+	// Blocks should be laid out in index order
+	Mat::BlockPtr ptr = 0 ;
+	for( int i = 0 ; i < n ; ++i )
+	{
+		FlatMat::MajorIndexType::InnerIterator refIt( ref.majorIndex(), i ) ;
+		FlatMat::MajorIndexType::InnerIterator flatIt( flat.majorIndex(), i ) ;
+		Mat::MajorIndexType::InnerIterator it( sbm.majorIndex(), i ) ;
+		for( ; refIt ; ++refIt, ++flatIt, ++it, ++ptr )
+		{
+			ASSERT_TRUE( flatIt ) ;
+			ASSERT_TRUE( it ) ;
+			EXPECT_EQ( refIt.inner(), flatIt.inner() ) ;
+			EXPECT_EQ( refIt.inner(), it.inner() ) ;
+			EXPECT_EQ( ptr, flatIt.ptr() ) ;
+			EXPECT_EQ( ptr, it.ptr() ) ;
+			EXPECT_TRUE( ref.block( refIt.ptr() ) == flat.block( flatIt.ptr() ) ) ;
+			EXPECT_TRUE( ref.block( refIt.ptr() ) == sbm.block( it.ptr() ) ) ;
+		}
+		EXPECT_FALSE( flatIt ) ;
+		EXPECT_FALSE( it ) ;
+	}
+
+	const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced( ref.cols(), -1., 1. ) ;
+	const Eigen::VectorXd y = ref * x ;
+	EXPECT_TRUE( y.isApprox( flat * x ) ) ;
+	EXPECT_TRUE( y.isApprox( sbm * x ) ) ;
+}
@@ -0,0 +1,188 @@
+/*
+ * Any copyright is dedicated to the Public Domain.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <bogus/Core/Block.impl.hpp>
+#include <bogus/Core/BlockSolvers/GaussSeidel.impl.hpp>
+#include <bogus/Core/BlockSolvers/SparseCholesky.impl.hpp>
+
+#include <bogus/Extra/SecondOrder.impl.hpp>
+
+#include "SmallFrictionPb.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Mass matrix of a binary tree of bodies with varying numbers of dofs,
+// each one coupled to its parent and some to a distant body
+void treeMassMatrix( const int n, std::vector< unsigned >& dofs, Eigen::MatrixXd& dense )
+{
+	dofs.resize( n ) ;
+	std::vector< int > offsets( n+1, 0 ) ;
+	for( int i = 0 ; i < n ; ++i )
+	{
+		dofs[i] = 1 + ( i % 3 ) * 2 ;
+		offsets[i+1] = offsets[i] + dofs[i] ;
+	}
+
+	dense.setZero( offsets[n], offsets[n] ) ;
+	for( int i = 0 ; i < n ; ++i )
+	{
+		dense.block( offsets[i], offsets[i], dofs[i], dofs[i] ).diagonal().setConstant( 10 ) ;
+
+		std::vector< int > coupled ;
+		if( i > 0 ) coupled.push_back( ( i-1 ) / 2 ) ;
+		if( i % 7 == 3 && i + 5 < n ) coupled.push_back( i + 5 ) ;
+
+		for( std::size_t k = 0 ; k < coupled.size() ; ++k )
+		{
+			const int j = coupled[k] ;
+			const Eigen::MatrixXd C = Eigen::MatrixXd::Random( dofs[i], dofs[j] ) ;
+			dense.block( offsets[i], offsets[j], dofs[i], dofs[j] ) = C ;
+			dense.block( offsets[j], offsets[i], dofs[j], dofs[i] ) = C.transpose() ;
+		}
+	}
+}
+
+template < typename MatrixT >
+void fromDense( const Eigen::MatrixXd& dense, const std::vector< unsigned >& dofs, bool lowerOnly, MatrixT& sbm )
+{
+	sbm.setRows( dofs ) ;
+	sbm.setCols( dofs ) ;
+	for( int i = 0 ; i < (int) dofs.size() ; ++i )
+	{
+		for( int j = 0 ; j < ( lowerOnly ? i+1 : (int) dofs.size() ) ; ++j )
+		{
+			const Eigen::MatrixXd block = dense.block( sbm.rowOffsets()[i], sbm.colOffsets()[j], dofs[i], dofs[j] ) ;
+			if( !block.isZero( 0 ) )
+				sbm.insertBack( i, j ) = block ;
+		}
+	}
+	sbm.finalize() ;
+}
+
+}
+
+TEST( SparseCholesky, Solve )
+{
+	std::srand( 1 ) ;
+
+	std::vector< unsigned > dofs ;
+	Eigen::MatrixXd dense ;
+	treeMassMatrix( 40, dofs, dense ) ;
+
+	typedef bogus::SparseBlockMatrix< Eigen::MatrixXd > Mat ;
+	Mat M ;
+	fromDense( dense, dofs, false, M ) ;
+
+	const Eigen::VectorXd rhs = Eigen::VectorXd::Random( M.rows() ) ;
+
+	bogus::SparseBlockCholesky< Mat > chol( M ) ;
+	ASSERT_EQ( bogus::SparseBlockCholesky< Mat >::Success, chol.status() ) ;
+
+	const Eigen::VectorXd x = chol.solve( rhs ) ;
+	EXPECT_GT( 1.e-12, ( dense * x - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// LinearSolverBase interface
+	const Eigen::VectorXd y = chol * rhs ;
+	EXPECT_TRUE( x.isApprox( y ) ) ;
+
+	// Multiple right-hand sides
+	const Eigen::MatrixXd rhs2 = Eigen::MatrixXd::Random( M.rows(), 3 ) ;
+	Eigen::MatrixXd x2 ;
+	chol.solve( rhs2, x2 ) ;
+	EXPECT_GT( 1.e-12, ( dense * x2 - rhs2 ).lpNorm< Eigen::Infinity >() ) ;
+
+	// The tree structure is eliminated from the leaves without fill-in,
+	// while the natural ordering fills the factor
+	const std::size_t nnz = chol.nonZeros() ;
+	chol.reordering().setMethod( bogus::Reordering::Identity ) ;
+	chol.analyzePattern( M ) ;
+	chol.factorize( M ) ;
+	ASSERT_EQ( bogus::SparseBlockCholesky< Mat >::Success, chol.status() ) ;
+	EXPECT_LT( nnz, chol.nonZeros() ) ;
+	EXPECT_GT( 1.e-12, ( dense * chol.solve( rhs ) - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Lower triangle storage, with a symbolic analysis reused across different values
+	typedef bogus::SparseBlockMatrix< Eigen::MatrixXd, bogus::SYMMETRIC > SymMat ;
+	SymMat Ms ;
+	fromDense( dense, dofs, true, Ms ) ;
+
+	bogus::SparseBlockCholesky< SymMat > schol( Ms ) ;
+	ASSERT_EQ( bogus::SparseBlockCholesky< SymMat >::Success, schol.status() ) ;
+	EXPECT_GT( 1.e-12, ( dense * schol.solve( rhs ) - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	const bogus::SparseBlockCholesky< SymMat >::Index nSupernodes = schol.nSupernodes() ;
+	dense.diagonal() *= 2 ;
+	for( SymMat::Index i = 0 ; i < Ms.rowsOfBlocks() ; ++i )
+		Ms.diagonal( i ).diagonal() *= 2 ;
+	schol.factorize( Ms ) ;
+	EXPECT_EQ( nSupernodes, schol.nSupernodes() ) ;
+	EXPECT_GT( 1.e-12, ( dense * schol.solve( rhs ) - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Dense matrix : a single supernode
+	const Eigen::MatrixXd R = Eigen::MatrixXd::Random( M.rows(), M.rows() ) ;
+	dense = R * R.transpose() + Eigen::MatrixXd::Identity( M.rows(), M.rows() ) ;
+	Mat F ;
+	fromDense( dense, dofs, false, F ) ;
+	chol.compute( F ) ;
+	ASSERT_EQ( bogus::SparseBlockCholesky< Mat >::Success, chol.status() ) ;
+	EXPECT_EQ( 1, chol.nSupernodes() ) ;
+	EXPECT_GT( 1.e-8, ( dense * chol.solve( rhs ) - rhs ).lpNorm< Eigen::Infinity >() ) ;
+
+	// Indefinite matrix
+	F.block( F.diagonalBlockPtr( 0 ) )( 0, 0 ) = -1 ;
+	chol.compute( F ) ;
+	EXPECT_EQ( bogus::SparseBlockCholesky< Mat >::NumericalIssue, chol.status() ) ;
+}
+
+TEST_F( SmallFrictionPb, SparseCholesky )
+{
+	// Couple the two bodies of the mass matrix
+	MType M ;
+	const unsigned dofs[2] = { 4, 2 } ;
+	M.setRows( 2, dofs ) ;
+	M.setCols( 2, dofs ) ;
+	M.insertBack( 0, 0 ) = MassMat.block( 0 ) ;
+	M.insertBack( 0, 1 ) = Eigen::MatrixXd::Constant( 4, 2, .1 ) ;
+	M.insertBack( 1, 0 ) = Eigen::MatrixXd::Constant( 2, 4, .1 ) ;
+	M.insertBack( 1, 1 ) = MassMat.block( 1 ) ;
+	M.finalize() ;
+
+	const Eigen::MatrixXd dense = M * Eigen::MatrixXd::Identity( M.rows(), M.cols() ) ;
+	const Eigen::MatrixXd denseInv = dense.inverse() ;
+
+	bogus::SparseBlockCholesky< MType > MFact( M ) ;
+	ASSERT_EQ( bogus::SparseBlockCholesky< MType >::Success, MFact.status() ) ;
+
+	// W = H M^-1 H^T
+	const Eigen::MatrixXd Ht = H.transpose() * Eigen::MatrixXd::Identity( H.rows(), H.rows() ) ;
+	const Eigen::MatrixXd Wd = H * MFact.solve( Ht ) ;
+	const Eigen::MatrixXd Wexp = H * ( denseInv * Ht ) ;
+	EXPECT_TRUE( Wexp.isApprox( Wd, 1.e-12 ) ) ;
+
+	typedef bogus::SparseBlockMatrix< Eigen::Matrix3d, bogus::flags::SYMMETRIC > WType ;
+	WType W ;
+	W.setRows( 2 ) ;
+	W.setCols( 2 ) ;
+	W.insertBack( 0, 0 ) = Wd.block< 3, 3 >( 0, 0 ) ;
+	W.insertBack( 1, 0 ) = Wd.block< 3, 3 >( 3, 0 ) ;
+	W.insertBack( 1, 1 ) = Wd.block< 3, 3 >( 3, 3 ) ;
+	W.finalize() ;
+
+	const Eigen::VectorXd b = w - H * MFact.solve( f ) ;
+
+	bogus::GaussSeidel< WType > gs( W ) ;
+	gs.setTol( 1.e-12 ) ;
+	const bogus::SOCLaw< 3u, double, true > law( 2, mu.data() ) ;
+
+	Eigen::VectorXd x = Eigen::VectorXd::Ones( W.rows() ) ;
+	const double res = gs.solve( law, b, x ) ;
+	EXPECT_LT( res, 1.e-12 ) ;
+
+	// Check complementarity on the dense problem
+	const Eigen::VectorXd u = Wexp * x + ( w - H * ( denseInv * f ) ) ;
+	EXPECT_LT( gs.eval( law, u, x ), 1.e-10 ) ;
+}